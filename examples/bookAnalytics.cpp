@@ -0,0 +1,101 @@
+/**
+ * Measures analytics::BookAnalytics over synthetic market books, with and without SIMD.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "greentop/analytics/BookAnalytics.h"
+
+using namespace greentop;
+
+namespace {
+
+std::vector<PriceSize> makeLadder(double price, double step, unsigned levels) {
+    std::vector<PriceSize> ladder;
+    for (unsigned level = 0; level < levels; ++level) {
+        ladder.push_back(PriceSize(price + step * level, 2 + std::rand() % 500));
+    }
+    return ladder;
+}
+
+MarketBook makeMarketBook(unsigned n, unsigned runners) {
+    std::vector<Runner> runnerBooks;
+    for (unsigned r = 0; r < runners; ++r) {
+        double price = 1.5 + (std::rand() % 2000) / 100.0;
+        ExchangePrices ex(makeLadder(price, -0.02, 3), makeLadder(price + 0.02, 0.02, 3),
+            makeLadder(price - 0.3, 0.02, 30));
+        Runner runner;
+        runner.setSelectionId(1000 + r);
+        runner.setHandicap(0.0);
+        runner.setEx(ex);
+        runnerBooks.push_back(runner);
+    }
+    MarketBook marketBook;
+    marketBook.setMarketId("1." + std::to_string(200000000 + n));
+    marketBook.setRunners(runnerBooks);
+    return marketBook;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+
+    unsigned markets = argc > 1 ? std::atoi(argv[1]) : 5000;
+    unsigned runners = argc > 2 ? std::atoi(argv[2]) : 12;
+    unsigned iterations = 200;
+    if (markets == 0 || runners == 0) {
+        std::cerr << "Usage: " << argv[0] << " [number of markets] [runners per market]" << std::endl;
+        return 1;
+    }
+
+    std::vector<MarketBook> marketBooks;
+    for (unsigned i = 0; i < markets; ++i) {
+        marketBooks.push_back(makeMarketBook(i, runners));
+    }
+
+    analytics::BookBatch batch(3);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < 10; ++i) {
+        batch.clear();
+        for (const MarketBook& marketBook : marketBooks) {
+            batch.add(marketBook);
+        }
+    }
+    double fill = secondsSince(start) / 10;
+
+    analytics::BookMetrics scalar;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        analytics::BookAnalytics::computeScalar(batch, 3, scalar);
+    }
+    double scalarTime = secondsSince(start) / iterations;
+
+    analytics::BookMetrics vectorized;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        analytics::BookAnalytics::compute(batch, 3, vectorized);
+    }
+    double vectorizedTime = secondsSince(start) / iterations;
+
+    double difference = 0;
+    for (size_t r = 0; r < batch.getRunnerCount(); ++r) {
+        difference = std::max(difference, std::fabs(scalar.vwap[r] - vectorized.vwap[r]));
+        difference = std::max(difference, std::fabs(scalar.microprice[r] - vectorized.microprice[r]));
+        difference = std::max(difference, std::fabs(scalar.weightOfMoney[r] - vectorized.weightOfMoney[r]));
+    }
+
+    std::cout << "markets: " << markets << ", runners: " << batch.getRunnerCount() << std::endl;
+    std::cout << "fill batch: " << markets / fill << " markets/s" << std::endl;
+    std::cout << "scalar: " << markets / scalarTime << " markets/s" << std::endl;
+    std::cout << (analytics::BookAnalytics::isVectorized() ? "vectorized: " : "vectorized (unavailable): ") <<
+        markets / vectorizedTime << " markets/s" << std::endl;
+    std::cout << "max difference: " << difference << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * Compares the memory used by MarketCatalogues and by a market::CatalogueStore holding the same synthetic
+ * horse racing catalogues, with runner metadata.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include "greentop/market/CatalogueStore.h"
+
+using namespace greentop;
+
+namespace {
+
+// heap bytes currently allocated, tracked by the operators below.
+size_t allocated = 0;
+
+// allocations are prefixed with their size, padded to keep the alignment malloc gives.
+const size_t HEADER = 16;
+
+void* allocate(size_t size) {
+    char* block = static_cast<char*>(std::malloc(size + HEADER));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    allocated += size;
+    return block + HEADER;
+}
+
+void deallocate(void* pointer) {
+    if (pointer) {
+        char* block = static_cast<char*>(pointer) - HEADER;
+        allocated -= *reinterpret_cast<size_t*>(block);
+        std::free(block);
+    }
+}
+
+const char* const METADATA_KEYS[] = {
+    "SIRE_NAME", "CLOTH_NUMBER_ALPHA", "OFFICIAL_RATING", "COLOURS_DESCRIPTION", "COLOURS_FILENAME",
+    "FORECASTPRICE_DENOMINATOR", "DAMSIRE_NAME", "WEIGHT_VALUE", "SEX_TYPE", "DAYS_SINCE_LAST_RUN", "WEARING",
+    "OWNER_NAME", "DAM_YEAR_BORN", "SIRE_BRED", "JOCKEY_NAME", "DAM_BRED", "ADJUSTED_RATING", "runnerId",
+    "CLOTH_NUMBER", "SIRE_YEAR_BORN", "TRAINER_NAME", "COLOUR_TYPE", "AGE", "DAMSIRE_BRED", "JOCKEY_CLAIM",
+    "FORM", "FORECASTPRICE_NUMERATOR", "BRED", "DAM_NAME", "DAMSIRE_YEAR_BORN", "STALL_DRAW", "WEIGHT_UNITS"
+};
+const unsigned METADATA_KEY_COUNT = sizeof(METADATA_KEYS) / sizeof(METADATA_KEYS[0]);
+
+std::string toString(unsigned n) {
+    std::ostringstream out;
+    out << n;
+    return out.str();
+}
+
+/**
+ * Make the catalogue of market n.  Races have a win and a place market with the same runners, and there are
+ * 8 races per meeting (event).
+ */
+MarketCatalogue makeCatalogue(unsigned n) {
+    unsigned race = n / 2;
+    unsigned meeting = race / 8;
+
+    std::tm startTime = std::tm();
+    startTime.tm_year = 126;
+    startTime.tm_mon = 9;
+    startTime.tm_mday = 1 + meeting % 28;
+    startTime.tm_hour = 13 + race % 8 / 2;
+    startTime.tm_min = race % 2 * 30;
+
+    std::string rules = "<br>Horse Racing - Rules for meeting " + toString(meeting) + "<br>" +
+        std::string(1500, 'r');
+    MarketDescription description(false, true, startTime, startTime, std::tm(),
+        MarketBettingType(MarketBettingType::ODDS), true,
+        n % 2 == 0 ? "WIN" : "PLACE", "GIBRALTAR REGULATOR", 5.0, true, "UK wallet", rules, false);
+
+    std::vector<RunnerCatalog> runners;
+    for (unsigned r = 0; r < 10; ++r) {
+        unsigned horse = race * 10 + r;
+        std::map<std::string, std::string> metadata;
+        for (unsigned k = 0; k < METADATA_KEY_COUNT; ++k) {
+            std::string key = METADATA_KEYS[k];
+            if (key == "runnerId" || key == "COLOURS_FILENAME" || key == "COLOURS_DESCRIPTION" ||
+                key == "FORM" || key == "DAM_NAME") {
+                // specific to the horse
+                metadata[key] = key + " of horse " + toString(horse);
+            } else {
+                // drawn from a small set, eg jockeys, trainers, weights
+                metadata[key] = key.substr(0, 6) + " " + toString((horse * 7 + k * 13) % 300);
+            }
+        }
+        runners.push_back(RunnerCatalog(horse, "Horse " + toString(horse), 0, r + 1, metadata));
+    }
+
+    return MarketCatalogue("1." + toString(200000000 + n), n % 2 == 0 ? "1m2f Hcap" : "To Be Placed", startTime,
+        description, Optional<double>(), runners, EventType("7", "Horse Racing"), Competition(),
+        Event("3000" + toString(meeting), "Meeting " + toString(meeting), "GB", "Europe/London", "Venue " +
+            toString(meeting % 60), startTime));
+}
+
+}
+
+void* operator new(size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    deallocate(pointer);
+}
+
+int main(int argc, char* argv[]) {
+
+    unsigned markets = argc > 1 ? std::atoi(argv[1]) : 20000;
+    if (markets == 0) {
+        std::cerr << "Usage: " << argv[0] << " [number of markets]" << std::endl;
+        return 1;
+    }
+
+    size_t before = 0;
+    size_t after = 0;
+
+    {
+        before = allocated;
+        std::vector<MarketCatalogue> catalogues;
+        catalogues.reserve(markets);
+        for (unsigned i = 0; i < markets; ++i) {
+            catalogues.push_back(makeCatalogue(i));
+        }
+        after = allocated;
+    }
+    double plain = static_cast<double>(after - before) / markets;
+
+    {
+        before = allocated;
+        market::CatalogueStore store;
+        for (unsigned i = 0; i < markets; ++i) {
+            store.put(makeCatalogue(i));
+        }
+        after = allocated;
+        std::cout << "interned strings: " << store.getStringPool()->size() << std::endl;
+    }
+    double compact = static_cast<double>(after - before) / markets;
+
+    std::cout << "markets: " << markets << std::endl;
+    std::cout << "MarketCatalogue: " << plain << " bytes per market" << std::endl;
+    std::cout << "CatalogueStore: " << compact << " bytes per market" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * Measures an emergency cancel of every market, end to end against a stand-in for the exchange that answers
+ * cancelOrders after a fixed latency: a request per market made one at a time with ExchangeApi, the same
+ * requests made in parallel by trading::MassCanceller over cold and warm connections, and a single account
+ * wide cancel.
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "greentop/ExchangeApi.h"
+#include "greentop/trading/MassCanceller.h"
+
+using namespace greentop;
+
+namespace {
+
+/**
+ * A keep alive HTTP server on the loopback interface, with a thread per connection.
+ */
+class StandInServer {
+    public:
+        StandInServer(unsigned latencyMs) : latencyMs(latencyMs) {
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+            int on = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            sockaddr_in address;
+            std::memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                    listen(listener, 64) != 0) {
+                throw std::runtime_error("Failed to listen");
+            }
+            socklen_t length = sizeof(address);
+            getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+            port = ntohs(address.sin_port);
+            std::thread(&StandInServer::accept, this).detach();
+        }
+
+        unsigned short getPort() const {
+            return port;
+        }
+
+    private:
+        int listener;
+        unsigned short port;
+        unsigned latencyMs;
+
+        void accept() {
+            int connection;
+            while ((connection = ::accept(listener, NULL, NULL)) >= 0) {
+                std::thread(&StandInServer::serve, this, connection).detach();
+            }
+        }
+
+        void serve(int connection) {
+            int on = 1;
+            setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            std::string buffer;
+            char chunk[4096];
+            while (true) {
+                size_t headerEnd;
+                while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                    ssize_t n = recv(connection, chunk, sizeof(chunk), 0);
+                    if (n <= 0) {
+                        close(connection);
+                        return;
+                    }
+                    buffer.append(chunk, n);
+                }
+                size_t contentLength = 0;
+                size_t field = buffer.find("ontent-Length:");
+                if (field == std::string::npos) {
+                    field = buffer.find("ontent-length:");
+                }
+                if (field != std::string::npos && field < headerEnd) {
+                    contentLength = std::strtoul(buffer.c_str() + field + 14, NULL, 10);
+                }
+                while (buffer.size() < headerEnd + 4 + contentLength) {
+                    ssize_t n = recv(connection, chunk, sizeof(chunk), 0);
+                    if (n <= 0) {
+                        close(connection);
+                        return;
+                    }
+                    buffer.append(chunk, n);
+                }
+                std::string path = buffer.substr(0, buffer.find("\r\n"));
+                std::string body = buffer.substr(headerEnd + 4, contentLength);
+                buffer.erase(0, headerEnd + 4 + contentLength);
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+                std::string content = path.find("cancelOrders") != std::string::npos ? cancelReport(body) :
+                    "{\"currentOrders\":[],\"moreAvailable\":false}";
+                std::string response = "HTTP/1.1 200 OK\r\ncontent-type: application/json\r\ncontent-length: " +
+                    std::to_string(content.size()) + "\r\n\r\n" + content;
+                send(connection, response.data(), response.size(), 0);
+            }
+        }
+
+        std::string cancelReport(const std::string& body) {
+            std::string marketId;
+            size_t field = body.find("\"marketId\"");
+            if (field != std::string::npos) {
+                size_t start = body.find('"', body.find(':', field)) + 1;
+                marketId = body.substr(start, body.find('"', start) - start);
+            }
+            std::string report = "{\"status\":\"SUCCESS\",";
+            if (!marketId.empty()) {
+                report += "\"marketId\":\"" + marketId + "\",";
+            }
+            return report + "\"instructionReports\":[{\"status\":\"SUCCESS\",\"sizeCancelled\":2.0,"
+                "\"instruction\":{\"betId\":\"1\"}}]}";
+        }
+};
+
+/**
+ * Sends requests meant for the exchange to the stand in.
+ */
+class StandInCurl : public Curl {
+    public:
+        StandInCurl(unsigned short port) : host("http://127.0.0.1:" + std::to_string(port)) {
+        }
+
+        using Curl::easySetopt;
+
+        CURLcode easySetopt(const CurlHandle& handle, const CURLoption& option, const char* parameter) const {
+            if (option == CURLOPT_URL) {
+                std::string uri(parameter);
+                uri.replace(0, uri.find('/', uri.find("//") + 2), host);
+                return Curl::easySetopt(handle, option, uri.c_str());
+            }
+            return Curl::easySetopt(handle, option, parameter);
+        }
+
+    private:
+        std::string host;
+};
+
+double millisecondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void print(const std::string& name, const trading::MassCanceller::Result& result) {
+    std::cout << name << ": " << result.elapsed.count() / 1e6 << " ms, " << result.requests << " requests, "
+        << result.sizeCancelled << " cancelled" << (result.success ? "" : ", FAILED") << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+
+    unsigned markets = argc > 1 ? std::atoi(argv[1]) : 100;
+    unsigned connections = argc > 2 ? std::atoi(argv[2]) : 8;
+    unsigned latencyMs = argc > 3 ? std::atoi(argv[3]) : 20;
+    if (markets == 0 || connections == 0) {
+        std::cerr << "Usage: " << argv[0] << " [number of markets] [connections] [latency in ms]" << std::endl;
+        return 1;
+    }
+
+    StandInServer server(latencyMs);
+    ExchangeApi exchangeApi("applicationKey", std::unique_ptr<ICurl>(new StandInCurl(server.getPort())));
+    exchangeApi.setSsoid("ssoid");
+
+    std::vector<std::string> marketIds;
+    for (unsigned i = 0; i < markets; ++i) {
+        marketIds.push_back("1." + std::to_string(200000000 + i));
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double sizeCancelled = 0;
+    for (const std::string& marketId : marketIds) {
+        CancelExecutionReport report = exchangeApi.cancelOrders(CancelOrdersRequest(marketId));
+        for (const CancelInstructionReport& instructionReport : report.getInstructionReports()) {
+            sizeCancelled += instructionReport.getSizeCancelled().getValue();
+        }
+    }
+    std::cout << "ExchangeApi, one market at a time: " << millisecondsSince(start) << " ms, " << markets
+        << " requests, " << sizeCancelled << " cancelled" << std::endl;
+
+    trading::MassCanceller cold(exchangeApi, connections,
+        std::unique_ptr<ICurl>(new StandInCurl(server.getPort())));
+    cold.setMarketIds(marketIds);
+    print("MassCanceller, cold connections", cold.cancelMarkets());
+
+    trading::MassCanceller canceller(exchangeApi, connections,
+        std::unique_ptr<ICurl>(new StandInCurl(server.getPort())));
+    canceller.setMarketIds(marketIds);
+    start = std::chrono::steady_clock::now();
+    unsigned warmed = canceller.warm();
+    std::cout << "Warmed " << warmed << " connections in " << millisecondsSince(start) << " ms" << std::endl;
+    print("MassCanceller, warm connections", canceller.cancelMarkets());
+    print("MassCanceller, account wide", canceller.cancelAll());
+
+    return 0;
+}
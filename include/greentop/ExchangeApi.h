@@ -6,6 +6,7 @@
 #define EXCHANGEAPI_H
 
 #include <curl/curl.h>
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
@@ -111,6 +112,8 @@
 
 #include "greentop/JsonRequest.h"
 #include "greentop/JsonResponse.h"
+#include "greentop/RequestHook.h"
+#include "greentop/RequestTiming.h"
 #include "greentop/curl/SList.h"
 #include "greentop/Exchange.h"
 #include "greentop/menu/Menu.h"
@@ -133,6 +136,8 @@ class ExchangeApi {
         /** There are three APIs - "account", "betting", and "heartbeat". */
         enum class Api {ACCOUNT, BETTING, HEARTBEAT};
 
+        typedef std::function<void(const RequestTiming& timing)> TimingCallback;
+
         /**
          * Constructor.
          *
@@ -180,6 +185,20 @@ class ExchangeApi {
          */
         void setSsoid(const std::string& ssoid);
 
+        /**
+         * Gets the application key.
+         *
+         * @return The application key.
+         */
+        const std::string& getApplicationKey() const;
+
+        /**
+         * Gets the SSO token, empty if not logged in.
+         *
+         * @return The SSO token.
+         */
+        const std::string& getSsoid() const;
+
         /**
          * Retrieves the navigation menu from Betfair but does not parse it.  Call refreshMenu() to do both.  If
          * the cache filename is provided, the menu JSON is saved to this file.
@@ -211,6 +230,34 @@ class ExchangeApi {
          */
         menu::Menu& getMenu();
 
+        /**
+         * Sets a callback given the timing of each request, on the thread that made the request, before the
+         * response is returned.  Requests aren't timed unless a callback is set.  Set it before requests are
+         * made from other threads.
+         *
+         * @param timingCallback The callback, or an empty function to stop timing requests.
+         */
+        void setTimingCallback(const TimingCallback& timingCallback);
+
+        /**
+         * Sets a hook told as each request reaches each stage of its life.  Set it before requests are made
+         * from other threads.
+         *
+         * @param requestHook The hook, or null to remove it.
+         */
+        void setRequestHook(const std::shared_ptr<RequestHook>& requestHook);
+
+        const std::shared_ptr<RequestHook>& getRequestHook() const;
+
+        /**
+         * Gets the URI of an operation, eg for a client that prepares its own requests.
+         *
+         * @param api The API the operation belongs to.
+         * @param method The operation, eg "cancelOrders".
+         * @return The URI.
+         */
+        std::string buildUri(const Api api, const std::string method) const;
+
         /**
          * Returns a list of Event Types (i.e. Sports) associated with the markets selected by the
          * MarketFilter.
@@ -268,6 +315,15 @@ class ExchangeApi {
          */
         ListMarketBookResponse listMarketBook(const ListMarketBookRequest& request) const;
 
+        /**
+         * As listMarketBook but decodes into the response given, eg a market::CachedListMarketBookResponse.
+         *
+         * @param request The request.
+         * @param response The response to decode into.
+         * @return True if the request succeeded else false.
+         */
+        bool listMarketBook(const ListMarketBookRequest& request, JsonResponse& response) const;
+
         /**
          * Returns a list of dynamic data about a market and a specified runner. Dynamic data
          * includes prices, the status of the market, the status of selections, the traded volume,
@@ -540,6 +596,8 @@ class ExchangeApi {
         menu::Menu menu;
         Json::Value pendingMenuJson;
         std::unique_ptr<ICurl> curl;
+        TimingCallback timingCallback;
+        std::shared_ptr<RequestHook> requestHook;
 
         bool initRequest(const Api api, const std::string method, const CurlHandle& handle, SList& headers) const;
 
@@ -549,7 +607,11 @@ class ExchangeApi {
             JsonResponse& jsonResponse
         ) const;
 
-        std::string buildUri(const Api api, const std::string method) const;
+        void getTransferTimes(const CurlHandle& handle, const std::chrono::nanoseconds& elapsed,
+            RequestTiming& timing) const;
+
+        void notify(RequestHook::Event event, const std::string& method,
+            const std::chrono::steady_clock::time_point& time) const;
 };
 
 }
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef REQUESTHOOK_H
+#define REQUESTHOOK_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace greentop {
+
+/**
+ * Told when a request made by ExchangeApi reaches each stage of its life, eg to add spans to a trace.
+ *
+ * A hook can follow a request from the caller with a context, any object the caller makes current for the
+ * thread with a Scope; each event carries the context that was current when the request was made.  Requests
+ * queued by trading::OrderPipeline keep the context of the caller of place() when they are sent from the
+ * pipeline's threads.
+ *
+ *     class Tracer : public RequestHook {
+ *         void onEvent(Event event, const std::string& operation, Clock::time_point time,
+ *                 const std::shared_ptr<void>& context) {
+ *             Span* span = static_cast<Span*>(context.get());
+ *             ...
+ *         }
+ *     };
+ *
+ *     exchangeApi.setRequestHook(std::make_shared<Tracer>());
+ *     RequestHook::Scope scope(std::make_shared<Span>(spanId));
+ *     exchangeApi.placeOrders(request);
+ *
+ * Without a hook, the only cost to a request is testing for one.  Hooks are called on the thread making the
+ * request, which waits for them.
+ */
+class RequestHook {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        enum Event {
+            /** The request has been serialized. */
+            BUILT,
+            /** The request has been queued to be sent by another thread. */
+            ENQUEUED,
+            /** The request has been handed to curl to send. */
+            SENT,
+            /** The first byte of the response was received.  Reported once the transfer is complete. */
+            FIRST_BYTE,
+            /** The whole response was received.  Reported once the transfer is complete. */
+            BODY_COMPLETE,
+            /** The transfer failed, and the request is about to throw. */
+            FAILED,
+            /** The response has been parsed. */
+            PARSED,
+            /** The response is being returned to the caller. */
+            DELIVERED
+        };
+
+        /**
+         * Makes a context current for the thread until the scope ends, when the previous one is restored.
+         */
+        class Scope {
+            public:
+                explicit Scope(const std::shared_ptr<void>& context);
+                ~Scope();
+
+            private:
+                std::shared_ptr<void> previous;
+
+                // no copying
+                Scope(const Scope&);
+                Scope& operator=(const Scope&);
+        };
+
+        /**
+         * Gets the thread's current context, which is empty outside any Scope.
+         */
+        static const std::shared_ptr<void>& getContext();
+
+        /**
+         * Called as a request reaches each stage.
+         *
+         * @param event The stage.
+         * @param operation The operation, eg "placeOrders".
+         * @param time When the stage was reached.
+         * @param context The context that was current when the request was made.
+         */
+        virtual void onEvent(Event event, const std::string& operation, Clock::time_point time,
+            const std::shared_ptr<void>& context) = 0;
+
+        virtual ~RequestHook();
+
+    private:
+        static std::shared_ptr<void>& getCurrentContext();
+};
+
+}
+
+#endif // REQUESTHOOK_H
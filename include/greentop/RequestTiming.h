@@ -0,0 +1,63 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef REQUESTTIMING_H
+#define REQUESTTIMING_H
+
+#include <chrono>
+#include <curl/curl.h>
+#include <string>
+
+namespace greentop {
+
+/**
+ * Where the time went in one request made by ExchangeApi.
+ *
+ * The curl times are curl's own, each measured from the start of the transfer: a connection reused from a
+ * previous request has zero name lookup, connect and app connect times, and startTransfer less preTransfer is
+ * roughly the server's think time.
+ */
+struct RequestTiming {
+    RequestTiming() : curlCode(CURLE_OK), success(false), serialize(0), setup(0), nameLookup(0), connect(0),
+        appConnect(0), preTransfer(0), startTransfer(0), transfer(0), parse(0), total(0), bytesSent(0),
+        bytesReceived(0) {
+    }
+
+    /** The operation, eg "placeOrders". */
+    std::string operation;
+    /** The result of the transfer.  If it isn't CURLE_OK the request threw and there is no parse time. */
+    CURLcode curlCode;
+    /** Whether the response wasn't a fault. */
+    bool success;
+    /** The fault code if the response was a fault. */
+    std::string faultCode;
+    /** Serializing the request to JSON. */
+    std::chrono::nanoseconds serialize;
+    /** Getting and preparing the curl handle and headers. */
+    std::chrono::nanoseconds setup;
+    /** Until the name was resolved. */
+    std::chrono::nanoseconds nameLookup;
+    /** Until the TCP connection was made. */
+    std::chrono::nanoseconds connect;
+    /** Until the TLS handshake was done. */
+    std::chrono::nanoseconds appConnect;
+    /** Until the request was about to be sent. */
+    std::chrono::nanoseconds preTransfer;
+    /** Until the first byte of the response was received. */
+    std::chrono::nanoseconds startTransfer;
+    /** Until the transfer was complete. */
+    std::chrono::nanoseconds transfer;
+    /** Parsing the response. */
+    std::chrono::nanoseconds parse;
+    /** From entering the operation until the response was parsed. */
+    std::chrono::nanoseconds total;
+    /** The size of the request body. */
+    size_t bytesSent;
+    /** The size of the response body, after decompression. */
+    size_t bytesReceived;
+};
+
+}
+
+#endif // REQUESTTIMING_H
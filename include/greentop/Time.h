@@ -24,4 +24,25 @@ static char* strptime(const char* s, const char* f, struct tm* tm) {
 #error Platform not supported
 #endif
 
+#include <ctime>
+
+namespace greentop {
+
+/**
+ * Converts a UTC calendar time to seconds since the epoch, normalising its fields, as the POSIX timegm does.
+ */
+std::time_t timegm(std::tm* tm);
+
+/**
+ * Converts a UTC calendar time to seconds since the epoch.
+ */
+std::time_t toTime(const std::tm& tm);
+
+/**
+ * Converts seconds since the epoch to a UTC calendar time.
+ */
+std::tm fromTime(std::time_t seconds);
+
+}
+
 #endif // TIME_H
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef ANALYTICS_BOOKANALYTICS_H
+#define ANALYTICS_BOOKANALYTICS_H
+
+#include <vector>
+
+#include "greentop/analytics/BookBatch.h"
+
+namespace greentop {
+namespace analytics {
+
+/**
+ * Metrics computed by BookAnalytics.  Market metrics are indexed by market and runner metrics by runner, in
+ * the order of the BookBatch.
+ */
+struct BookMetrics {
+    /** The back book percentage of each market, the sum of the runners' backPercentage. */
+    std::vector<double> backBookPercentage;
+    /** The lay book percentage of each market, the sum of the runners' layPercentage. */
+    std::vector<double> layBookPercentage;
+
+    /** 100 / the best back price, or 0 if there is none. */
+    std::vector<double> backPercentage;
+    /** 100 / the best lay price, or 0 if there is none. */
+    std::vector<double> layPercentage;
+    /** The money available to back as a proportion of all the money in the book, 0 if the book is empty. */
+    std::vector<double> weightOfMoney;
+    /** The best back and lay prices weighted by the size on the opposite side, 0 if either side is empty. */
+    std::vector<double> microprice;
+    /** The volume weighted average price of the traded volume, 0 if nothing has traded. */
+    std::vector<double> vwap;
+};
+
+/**
+ * Computes book percentages, weight of money, microprice and traded volume VWAP for every runner in a
+ * BookBatch in one pass.  Where SSE2 is available, ie on all x86-64 targets, two runners are computed at once;
+ * elsewhere the scalar code is used.
+ *
+ *     analytics::BookBatch batch;
+ *     for (const MarketBook& marketBook : marketBooks) {
+ *         batch.add(marketBook);
+ *     }
+ *     analytics::BookMetrics metrics;
+ *     analytics::BookAnalytics::compute(batch, 3, metrics);
+ */
+class BookAnalytics {
+    public:
+        /**
+         * Compute the metrics of a batch.
+         *
+         * @param batch The markets.
+         * @param levels The number of levels of each side to include in the weight of money, at most the depth
+         *        of the batch.
+         * @param metrics Set to the metrics, reusing its memory.
+         */
+        static void compute(const BookBatch& batch, unsigned levels, BookMetrics& metrics);
+
+        /**
+         * As compute(), without SIMD instructions.
+         */
+        static void computeScalar(const BookBatch& batch, unsigned levels, BookMetrics& metrics);
+
+        /**
+         * Whether compute() uses SIMD instructions on this platform.
+         */
+        static bool isVectorized();
+};
+
+}
+}
+
+#endif // ANALYTICS_BOOKANALYTICS_H
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef ANALYTICS_BOOKBATCH_H
+#define ANALYTICS_BOOKBATCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "greentop/sport/MarketBook.h"
+
+namespace greentop {
+namespace analytics {
+
+/**
+ * The prices of the runners of many markets, laid out as a structure of arrays for BookAnalytics.  Each
+ * ladder level is a separate array indexed by runner, so the best back prices of all runners are contiguous,
+ * then the second best and so on; a missing level has price and size 0.  Runners are numbered in the order
+ * they were added, the runners of market m being getMarketStart(m) to getMarketStart(m + 1).  Traded volume is
+ * held per runner, runner r's being getTradedStart(r) to getTradedStart(r + 1).
+ *
+ * A batch can be cleared and refilled each cycle without reallocating.
+ */
+class BookBatch {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param depth The number of levels of each side of the book to hold.
+         * @throws std::runtime_error if depth is 0.
+         */
+        explicit BookBatch(unsigned depth = 3);
+
+        /**
+         * Remove all markets, keeping the memory allocated.
+         */
+        void clear();
+
+        /**
+         * Add the runners of a market.
+         *
+         * @param marketBook The market, with EX_BEST_OFFERS or EX_ALL_OFFERS and optionally EX_TRADED.
+         */
+        void add(const MarketBook& marketBook);
+
+        unsigned getDepth() const;
+
+        size_t getMarketCount() const;
+
+        size_t getRunnerCount() const;
+
+        const std::string& getMarketId(size_t market) const;
+
+        /**
+         * Gets the first runner of a market.  getMarketStart(getMarketCount()) is getRunnerCount().
+         */
+        size_t getMarketStart(size_t market) const;
+
+        int64_t getSelectionId(size_t runner) const;
+
+        double getHandicap(size_t runner) const;
+
+        const double* getBackPrices(unsigned level) const;
+        const double* getBackSizes(unsigned level) const;
+        const double* getLayPrices(unsigned level) const;
+        const double* getLaySizes(unsigned level) const;
+
+        /**
+         * Gets the first traded volume entry of a runner.  getTradedStart(getRunnerCount()) is the total.
+         */
+        size_t getTradedStart(size_t runner) const;
+
+        const double* getTradedPrices() const;
+        const double* getTradedSizes() const;
+
+    private:
+        unsigned depth;
+        std::vector<std::string> marketIds;
+        std::vector<size_t> marketStarts;
+        std::vector<int64_t> selectionIds;
+        std::vector<double> handicaps;
+        // [level][runner]
+        std::vector<std::vector<double>> backPrices;
+        std::vector<std::vector<double>> backSizes;
+        std::vector<std::vector<double>> layPrices;
+        std::vector<std::vector<double>> laySizes;
+        std::vector<size_t> tradedStarts;
+        std::vector<double> tradedPrices;
+        std::vector<double> tradedSizes;
+
+        void addLadder(const std::vector<PriceSize>& ladder, std::vector<std::vector<double>>& prices,
+            std::vector<std::vector<double>>& sizes);
+};
+
+}
+}
+
+#endif // ANALYTICS_BOOKBATCH_H
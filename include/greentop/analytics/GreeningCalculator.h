@@ -0,0 +1,95 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef ANALYTICS_GREENINGCALCULATOR_H
+#define ANALYTICS_GREENINGCALCULATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "greentop/analytics/BookBatch.h"
+#include "greentop/analytics/PositionBatch.h"
+#include "greentop/sport/PlaceOrdersRequest.h"
+#include "greentop/sport/enum/PersistenceType.h"
+
+namespace greentop {
+namespace analytics {
+
+/**
+ * The side of a hedge bet.
+ */
+enum class HedgeSide : uint8_t {NONE, BACK, LAY};
+
+/**
+ * Hedges computed by GreeningCalculator, indexed like the runners of the BookBatch.
+ */
+struct GreeningResults {
+    /** The side to bet, NONE if the position is already level or there is no price to hedge at. */
+    std::vector<HedgeSide> sides;
+    /** The hedge stake, unrounded. */
+    std::vector<double> stakes;
+    /** The price to hedge at, the best price available on the side. */
+    std::vector<double> prices;
+    /** The profit whether the runner wins or loses once hedged, or the worse of the two if it isn't. */
+    std::vector<double> profits;
+};
+
+/**
+ * Calculates the bet that levels ("greens up") the position on each runner of a batch at the best available
+ * price, so the profit is the same whether the runner wins or loses.  A position that wins more than it loses
+ * is laid at the best lay price, one that loses more is backed at the best back price.  Each runner is
+ * hedged on its own, as a win / lose bet on that selection.  Where SSE2 is available two runners are computed
+ * at once.
+ *
+ *     analytics::PositionBatch positions;
+ *     positions.reset(books.getRunnerCount());
+ *     positions.add(books, currentOrders);
+ *     analytics::GreeningResults results;
+ *     analytics::GreeningCalculator::compute(books, positions, results);
+ *     for (const PlaceOrdersRequest& request : analytics::GreeningCalculator::toPlaceOrdersRequests(books, results, 1)) {
+ *         exchangeApi.placeOrders(request);
+ *     }
+ */
+class GreeningCalculator {
+    public:
+        /** The maximum number of instructions in a placeOrders request. */
+        static const unsigned MAX_INSTRUCTIONS = 200;
+
+        /**
+         * Compute the hedge of every runner.
+         *
+         * @param books The current books, only the best prices are used.
+         * @param positions The positions, sized to the batch.
+         * @param results Set to the hedges, reusing its memory.
+         * @throws std::runtime_error if the positions don't match the batch.
+         */
+        static void compute(const BookBatch& books, const PositionBatch& positions, GreeningResults& results);
+
+        /**
+         * As compute(), without SIMD instructions.
+         */
+        static void computeScalar(const BookBatch& books, const PositionBatch& positions,
+            GreeningResults& results);
+
+        /**
+         * Make placeOrders requests for the hedges, one or more per market, with stakes rounded to hundredths.
+         *
+         * @param books The books the hedges were computed from.
+         * @param results The hedges.
+         * @param minimumStake Hedges with a smaller stake are left out.
+         * @param persistenceType The persistence type of the orders.
+         * @param customerStrategyRef The strategy reference of the requests.
+         * @return The requests.
+         */
+        static std::vector<PlaceOrdersRequest> toPlaceOrdersRequests(const BookBatch& books,
+            const GreeningResults& results, double minimumStake,
+            const PersistenceType& persistenceType = PersistenceType(PersistenceType::LAPSE),
+            const std::string& customerStrategyRef = std::string());
+};
+
+}
+}
+
+#endif // ANALYTICS_GREENINGCALCULATOR_H
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef ANALYTICS_POSITIONBATCH_H
+#define ANALYTICS_POSITIONBATCH_H
+
+#include <vector>
+
+#include "greentop/analytics/BookBatch.h"
+#include "greentop/sport/CurrentOrderSummary.h"
+#include "greentop/sport/enum/Side.h"
+
+namespace greentop {
+namespace analytics {
+
+/**
+ * Matched positions of the runners of a BookBatch, as structure of arrays indexed like the batch's runners.
+ * For each side the total stake and the total of stake * price are held, so the average price is
+ * return / stake.
+ */
+class PositionBatch {
+    public:
+        PositionBatch();
+
+        /**
+         * Clear the positions and size them for a batch.
+         *
+         * @param runners The number of runners, BookBatch::getRunnerCount().
+         */
+        void reset(size_t runners);
+
+        /**
+         * Add a matched bet.
+         *
+         * @param runner The runner's position in the book batch.
+         * @param side BACK or LAY.
+         * @param price The matched price.
+         * @param size The matched size.
+         */
+        void add(size_t runner, const Side& side, double price, double size);
+
+        /**
+         * Add the matched part of orders, matching each to a runner of the batch by market, selection and
+         * handicap.  Orders of other markets are ignored.
+         *
+         * @param books The book batch.
+         * @param orders Orders, eg from listCurrentOrders.
+         * @return The number of orders added.
+         */
+        size_t add(const BookBatch& books, const std::vector<CurrentOrderSummary>& orders);
+
+        size_t size() const;
+
+        double getBackStake(size_t runner) const;
+
+        /**
+         * Gets the average matched back price, 0 if nothing has been backed.
+         */
+        double getAverageBackPrice(size_t runner) const;
+
+        double getLayStake(size_t runner) const;
+
+        /**
+         * Gets the average matched lay price, 0 if nothing has been laid.
+         */
+        double getAverageLayPrice(size_t runner) const;
+
+        const double* getBackStakes() const;
+        const double* getBackReturns() const;
+        const double* getLayStakes() const;
+        const double* getLayReturns() const;
+
+    private:
+        std::vector<double> backStakes;
+        std::vector<double> backReturns;
+        std::vector<double> layStakes;
+        std::vector<double> layReturns;
+};
+
+}
+}
+
+#endif // ANALYTICS_POSITIONBATCH_H
@@ -0,0 +1,79 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_COLUMNARFORMAT_H
+#define ARCHIVE_COLUMNARFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Layout of the columnar table format shared by ColumnarWriter and ColumnarReader, used for exported order
+ * and statement history.
+ *
+ * A file is a header followed by records, each starting on an 8 byte boundary so that columns can be used in
+ * place from a memory mapping:
+ *
+ *     header:     fixed32 FILE_MAGIC, fixed32 FILE_VERSION, varint column count, (string name, varint type) per
+ *                 column, padding
+ *     dictionary: fixed32 DICTIONARY_MAGIC, fixed32 symbol count, fixed64 payload length, payload: string per
+ *                 symbol, padding
+ *     block:      fixed32 BLOCK_MAGIC, fixed32 flags, fixed64 payload length, fixed64 window from, fixed64
+ *                 window to, fixed32 row count, fixed32 session, payload: column data per column, each padded
+ *
+ * Column data is an array of row count values: little endian int64 for INT64, IEEE double for DOUBLE and
+ * uint32 symbol ids for SYMBOL.  Symbols are numbered in the order of the dictionary records, symbol 0 being
+ * the empty string.  TEXT columns, for values that are mostly distinct, are row count + 1 uint32 offsets
+ * followed by the bytes.  A missing INT64 is NULL_INT64 and a missing DOUBLE is NaN.
+ *
+ * Rows are exported in windows of time, each window's rows in one or more blocks.  The last block of a window
+ * has the WINDOW_COMPLETE flag.  Each run of an export is a new session, and blocks from a session whose
+ * window isn't complete, left by an interrupted run, are ignored.
+ */
+class ColumnarFormat {
+    public:
+        static const uint32_t FILE_MAGIC = 0x46435447;
+        static const uint32_t FILE_VERSION = 1;
+        static const uint32_t DICTIONARY_MAGIC = 0x54434944;
+        static const uint32_t BLOCK_MAGIC = 0x4b4c4243;
+        static const size_t DICTIONARY_HEADER_SIZE = 16;
+        static const size_t BLOCK_HEADER_SIZE = 40;
+        static const size_t ALIGNMENT = 8;
+
+        static const int64_t NULL_INT64 = INT64_MIN;
+
+        enum Type {
+            INT64,
+            DOUBLE,
+            SYMBOL,
+            TEXT
+        };
+
+        /** Block flags. */
+        enum BlockFlag {
+            WINDOW_COMPLETE = 1 << 0
+        };
+
+        struct Column {
+            std::string name;
+            Type type;
+
+            bool operator==(const Column& other) const;
+            bool operator!=(const Column& other) const;
+        };
+
+        /**
+         * Calculate the padding that takes a length to the next multiple of ALIGNMENT.
+         */
+        static size_t getPadding(size_t length);
+};
+
+}
+}
+
+#endif // ARCHIVE_COLUMNARFORMAT_H
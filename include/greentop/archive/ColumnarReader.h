@@ -0,0 +1,124 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_COLUMNARREADER_H
+#define ARCHIVE_COLUMNARREADER_H
+
+#include <string>
+#include <vector>
+
+#include "greentop/archive/ColumnarFormat.h"
+#include "greentop/archive/MappedFile.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Reads a file written by ColumnarWriter.  The file is memory mapped and the columns of each block are used in
+ * place, eg to sum the profit of cleared orders:
+ *
+ *     archive::ColumnarReader reader("orders.gtc");
+ *     size_t profit = reader.findColumn("profit");
+ *     double total = 0;
+ *     for (size_t block = 0; block < reader.getBlockCount(); ++block) {
+ *         const double* values = reader.getDoubles(block, profit);
+ *         for (uint32_t row = 0; row < reader.getRowCount(block); ++row) {
+ *             total += values[row];
+ *         }
+ *     }
+ *
+ * Only blocks of complete windows are read, so a file that is still being written, or whose export was
+ * interrupted, has no duplicate or partial windows.
+ */
+class ColumnarReader {
+    public:
+        /**
+         * Open a file.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be opened or isn't a columnar file.
+         */
+        explicit ColumnarReader(const std::string& fileName);
+
+        const std::vector<ColumnarFormat::Column>& getColumns() const;
+
+        /**
+         * Find a column by name.
+         *
+         * @throws std::runtime_error if there is no such column.
+         */
+        size_t findColumn(const std::string& name) const;
+
+        size_t getBlockCount() const;
+
+        uint32_t getRowCount(size_t block) const;
+
+        uint64_t getRowCount() const;
+
+        /**
+         * Gets the start of the window a block belongs to, milliseconds since the epoch.
+         */
+        int64_t getWindowFrom(size_t block) const;
+
+        /**
+         * Gets the end of the window a block belongs to, milliseconds since the epoch.
+         */
+        int64_t getWindowTo(size_t block) const;
+
+        /**
+         * Gets the values of an INT64 column.
+         *
+         * @throws std::runtime_error if the column isn't an INT64 column.
+         */
+        const int64_t* getInt64s(size_t block, size_t column) const;
+
+        /**
+         * Gets the values of a DOUBLE column.
+         *
+         * @throws std::runtime_error if the column isn't a DOUBLE column.
+         */
+        const double* getDoubles(size_t block, size_t column) const;
+
+        /**
+         * Gets the symbol ids of a SYMBOL column.  Pass them to getSymbol() for the values.
+         *
+         * @throws std::runtime_error if the column isn't a SYMBOL column.
+         */
+        const uint32_t* getSymbols(size_t block, size_t column) const;
+
+        const std::string& getSymbol(uint32_t id) const;
+
+        uint32_t getSymbolCount() const;
+
+        /**
+         * Gets a value of a TEXT column.
+         *
+         * @throws std::runtime_error if the column isn't a TEXT column.
+         */
+        std::string getText(size_t block, size_t column, uint32_t row) const;
+
+    private:
+        struct Block {
+            int64_t from;
+            int64_t to;
+            uint32_t rowCount;
+            std::vector<const char*> columns;
+        };
+
+        MappedFile file;
+        std::vector<ColumnarFormat::Column> columns;
+        std::vector<std::string> symbols;
+        std::vector<Block> blocks;
+        uint64_t rowCount;
+
+        const char* getColumn(size_t block, size_t column, ColumnarFormat::Type type) const;
+
+        // no copying
+        ColumnarReader(const ColumnarReader&);
+        ColumnarReader& operator=(const ColumnarReader&);
+};
+
+}
+}
+
+#endif // ARCHIVE_COLUMNARREADER_H
@@ -0,0 +1,143 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_COLUMNARWRITER_H
+#define ARCHIVE_COLUMNARWRITER_H
+
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "greentop/archive/ColumnarFormat.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Rows waiting to be written by a ColumnarWriter.  Values are put column by column for each row, then the row
+ * is ended.  A block isn't thread safe, each thread writing to a ColumnarWriter fills its own.
+ */
+class ColumnarBlock {
+    public:
+        explicit ColumnarBlock(const std::vector<ColumnarFormat::Column>& columns);
+
+        void putInt64(size_t column, int64_t value);
+
+        void putDouble(size_t column, double value);
+
+        void putSymbol(size_t column, const std::string& value);
+
+        void putText(size_t column, const std::string& value);
+
+        /**
+         * End the current row.
+         *
+         * @throws std::runtime_error if a column doesn't have a value for the row.
+         */
+        void endRow();
+
+        uint32_t getRowCount() const;
+
+        void clear();
+
+    private:
+        friend class ColumnarWriter;
+
+        struct ColumnData {
+            ColumnarFormat::Type type;
+            std::vector<int64_t> int64s;
+            std::vector<double> doubles;
+            std::vector<std::string> symbols;
+            std::vector<uint32_t> offsets;
+            std::string text;
+
+            size_t size() const;
+        };
+
+        std::vector<ColumnData> columns;
+        uint32_t rowCount;
+};
+
+/**
+ * Writes rows to a columnar file that can be memory mapped and scanned with ColumnarReader.  See
+ * ColumnarFormat for the layout.
+ *
+ * Rows are written in blocks, each belonging to a window of time.  Opening an existing file appends to it:
+ * the windows it already has are reported by isComplete() so they can be skipped, and anything after the last
+ * whole record, left by an interrupted run, is discarded.
+ *
+ * write() may be called from several threads at once.
+ */
+class ColumnarWriter {
+    public:
+        /**
+         * Open a file for writing, creating it if it doesn't exist.
+         *
+         * @param fileName The file name.
+         * @param columns The columns.  An existing file must have the same columns.
+         * @throws std::runtime_error if the file can't be opened, or it exists but isn't a columnar file with
+         *         the same columns.
+         */
+        ColumnarWriter(const std::string& fileName, const std::vector<ColumnarFormat::Column>& columns);
+
+        /**
+         * Closes the file.
+         */
+        ~ColumnarWriter();
+
+        const std::vector<ColumnarFormat::Column>& getColumns() const;
+
+        /**
+         * Whether the file has every row of a window.
+         *
+         * @param from The start of the window, milliseconds since the epoch.
+         * @param to The end of the window, milliseconds since the epoch.
+         */
+        bool isComplete(int64_t from, int64_t to) const;
+
+        /**
+         * Write a block of rows.  The block is left as it was, clear() it to reuse it.
+         *
+         * @param block The rows.
+         * @param from The start of the window the rows belong to, milliseconds since the epoch.
+         * @param to The end of the window the rows belong to, milliseconds since the epoch.
+         * @param complete Whether this is the window's last block.  The file is flushed.
+         * @throws std::runtime_error if the file can't be written or is closed.
+         */
+        void write(const ColumnarBlock& block, int64_t from, int64_t to, bool complete);
+
+        void close();
+
+        uint64_t getRowsWritten() const;
+
+    private:
+        mutable std::mutex mutex;
+        std::ofstream output;
+        std::vector<ColumnarFormat::Column> columns;
+        std::unordered_map<std::string, uint32_t> symbolIds;
+        std::set<std::pair<int64_t, int64_t>> completeWindows;
+        uint32_t session;
+        uint64_t rowsWritten;
+
+        /**
+         * Read back an existing file.
+         *
+         * @return The length of the valid part of the file, or 0 if it has no header.
+         */
+        uint64_t load(const std::string& fileName);
+
+        uint32_t getSymbolId(const std::string& symbol, std::vector<std::string>& added);
+
+        // no copying
+        ColumnarWriter(const ColumnarWriter&);
+        ColumnarWriter& operator=(const ColumnarWriter&);
+};
+
+}
+}
+
+#endif // ARCHIVE_COLUMNARWRITER_H
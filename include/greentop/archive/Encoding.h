@@ -0,0 +1,142 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_ENCODING_H
+#define ARCHIVE_ENCODING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace greentop {
+namespace archive {
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * Appends little endian fixed width integers, LEB128 varints and length prefixed strings to a byte buffer.
+ * Signed values are zigzag encoded so that small negative deltas stay small.
+ */
+class ByteWriter {
+    public:
+        ByteWriter();
+
+        void putFixed32(uint32_t value);
+
+        void putFixed64(uint64_t value);
+
+        void putVarint(uint64_t value);
+
+        void putSigned(int64_t value);
+
+        void putString(const std::string& value);
+
+        void putBytes(const char* data, size_t length);
+
+        const std::string& getBuffer() const;
+
+        size_t size() const;
+
+        void clear();
+
+    private:
+        std::string buffer;
+};
+
+/**
+ * Reads values written by ByteWriter from a region of memory it doesn't own.  Reading past the end of the
+ * region throws std::runtime_error.
+ */
+class ByteReader {
+    public:
+        ByteReader();
+
+        ByteReader(const char* data, size_t length);
+
+        uint32_t getFixed32();
+
+        uint64_t getFixed64();
+
+        uint64_t getVarint();
+
+        int64_t getSigned();
+
+        std::string getString();
+
+        /**
+         * Returns a pointer to the next length bytes and skips over them.
+         */
+        const char* getBytes(size_t length);
+
+        size_t remaining() const;
+
+        size_t position() const;
+
+        bool atEnd() const;
+
+    private:
+        const char* begin;
+        const char* current;
+        const char* end;
+
+        void require(size_t length) const;
+};
+
+// the varint functions are defined here so they can be inlined into the decoding loops.
+
+inline void ByteWriter::putVarint(uint64_t value) {
+    if (value < 0x80) {
+        buffer.push_back(static_cast<char>(value));
+        return;
+    }
+    char bytes[10];
+    int length = 0;
+    while (value >= 0x80) {
+        bytes[length++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = static_cast<char>(value);
+    buffer.append(bytes, length);
+}
+
+inline void ByteWriter::putSigned(int64_t value) {
+    putVarint(zigzagEncode(value));
+}
+
+inline void ByteReader::require(size_t length) const {
+    if (static_cast<size_t>(end - current) < length) {
+        throw std::runtime_error("unexpected end of encoded data");
+    }
+}
+
+inline uint64_t ByteReader::getVarint() {
+    if (current < end && (*current & 0x80) == 0) {
+        return static_cast<unsigned char>(*current++);
+    }
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        require(1);
+        unsigned char byte = static_cast<unsigned char>(*current++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("malformed varint");
+}
+
+inline int64_t ByteReader::getSigned() {
+    return zigzagDecode(getVarint());
+}
+
+}
+}
+
+#endif // ARCHIVE_ENCODING_H
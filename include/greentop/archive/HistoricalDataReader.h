@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_HISTORICALDATAREADER_H
+#define ARCHIVE_HISTORICALDATAREADER_H
+
+#include <deque>
+#include <functional>
+#include <json/json.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/archive/LineReader.h"
+#include "greentop/archive/MarketBookReader.h"
+#include "greentop/stream/MarketCache.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Reads Betfair historical data files: newline delimited Exchange Stream API market change messages,
+ * optionally bzip2 compressed.  The changes are applied to a stream::MarketCache and each market that changes
+ * is returned as a MarketBook snapshot at the publish time (pt) of the message, or the raw changes can be
+ * consumed instead.  The snapshots are RecordedMarketBooks so they can be fed to a MarketBookRecorder or a
+ * strategy written against MarketReplay.
+ *
+ *     archive::HistoricalDataReader::readFiles(fileNames,
+ *         [&](const archive::RecordedMarketBook& recorded) {
+ *             // called concurrently from worker threads
+ *         });
+ */
+class HistoricalDataReader {
+    public:
+        typedef std::function<void(const RecordedMarketBook& recorded)> MarketBookCallback;
+
+        /**
+         * Called with each market change as it is read.
+         *
+         * @param publishTime The publish time of the message, milliseconds since the epoch.
+         * @param marketChange An element of the "mc" array of the message.
+         */
+        typedef std::function<void(int64_t publishTime, const Json::Value& marketChange)> ChangeCallback;
+
+        /**
+         * Open a historical data file.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be opened.
+         */
+        explicit HistoricalDataReader(const std::string& fileName);
+
+        /**
+         * Only read these markets, a file of an event may contain several.  An empty set removes the filter.
+         */
+        void setMarketFilter(const std::set<std::string>& marketIds);
+
+        /**
+         * Gets the next snapshot of a changed market.
+         *
+         * @param recorded Set to the snapshot.  receivedTime is the publish time.
+         * @return false at the end of the file.
+         * @throws std::runtime_error if the file is corrupt.
+         */
+        bool next(RecordedMarketBook& recorded);
+
+        /**
+         * Read all the remaining snapshots.
+         *
+         * @return The number of snapshots read.
+         */
+        uint64_t read(const MarketBookCallback& callback);
+
+        /**
+         * Read all the remaining changes without building snapshots.  The cache is still kept up to date.
+         *
+         * @return The number of market changes read.
+         */
+        uint64_t readChanges(const ChangeCallback& callback);
+
+        /**
+         * Gets the market cache built from the changes read so far.
+         */
+        const stream::MarketCache& getCache() const;
+
+        /**
+         * Read many files in parallel, one file per thread at a time.  The callback is called concurrently
+         * from the worker threads but the snapshots of each file are delivered in order by a single thread.
+         *
+         * @param fileNames The files.
+         * @param callback Called with each snapshot.
+         * @param threads The number of worker threads, 0 for one per core.
+         * @param marketIds If not empty, only read these markets.
+         * @return The number of snapshots read.
+         * @throws std::runtime_error The first error reading a file, once all the workers have finished.
+         */
+        static uint64_t readFiles(const std::vector<std::string>& fileNames, const MarketBookCallback& callback,
+            unsigned threads = 0, const std::set<std::string>& marketIds = std::set<std::string>());
+
+    private:
+        LineReader lineReader;
+        std::unique_ptr<Json::CharReader> jsonReader;
+        std::set<std::string> marketFilter;
+        stream::MarketCache cache;
+        Json::Value message;
+        int64_t publishTime;
+        std::deque<std::string> changedMarketIds;
+        std::unordered_map<std::string, int32_t> eventTypeIds;
+
+        bool readMessage();
+        bool applyMessage(const ChangeCallback* callback, uint64_t& changes);
+
+        // no copying
+        HistoricalDataReader(const HistoricalDataReader&);
+        HistoricalDataReader& operator=(const HistoricalDataReader&);
+};
+
+}
+}
+
+#endif // ARCHIVE_HISTORICALDATAREADER_H
@@ -0,0 +1,106 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_HISTORYEXPORTER_H
+#define ARCHIVE_HISTORYEXPORTER_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+#include "greentop/archive/ColumnarFormat.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Exports cleared orders and account statement items to columnar files, which can be read with
+ * ColumnarReader.
+ *
+ * The requested date range is split into windows that are fetched side by side, each page by page.  Rows are
+ * written as they arrive, a block at a time, so memory use is bounded by the number of threads rather than the
+ * size of the export.  Exporting to a file that already exists resumes the export: windows the file already
+ * has are skipped, and a window that was interrupted is fetched again.
+ *
+ *     archive::HistoryExporter exporter(exchangeApi);
+ *     ListClearedOrdersRequest request(BetStatus(BetStatus::SETTLED));
+ *     request.setSettledDateRange(TimeRange(from, to));
+ *     exporter.exportClearedOrders(request, "orders.gtc");
+ *
+ * Times are stored as milliseconds since the epoch.  getClearedOrderColumns() and getStatementColumns() list
+ * the columns.
+ */
+class HistoryExporter {
+    public:
+        /** The maximum number of cleared orders listClearedOrders returns at once. */
+        static const int32_t MAX_CLEARED_ORDERS = 1000;
+
+        /** The maximum number of items getAccountStatement returns at once. */
+        static const int32_t MAX_STATEMENT_ITEMS = 100;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to fetch the rows.  It must outlive the exporter.
+         */
+        explicit HistoryExporter(const ExchangeApi& exchangeApi);
+
+        /**
+         * Sets the length of a window in seconds.  Defaults to a day.
+         */
+        void setWindow(std::time_t window);
+
+        /**
+         * Sets the number of windows fetched at once.  Defaults to 4.
+         */
+        void setThreads(unsigned threads);
+
+        /**
+         * Sets the number of rows in a block.  Defaults to 4096.
+         */
+        void setBlockRows(uint32_t blockRows);
+
+        /**
+         * Export cleared orders.  Orders are assigned to windows by their settled date.
+         *
+         * @param request The request, which must have a settledDateRange with both ends.  fromRecord and
+         *        recordCount are set by the exporter.
+         * @param fileName The file name.
+         * @return The number of orders written by this call.
+         * @throws std::runtime_error if the request has no settled date range or a request or write fails.
+         *         Windows written before the failure are kept.
+         */
+        uint64_t exportClearedOrders(const ListClearedOrdersRequest& request, const std::string& fileName);
+
+        /**
+         * Export account statement items.  Items are assigned to windows by their item date.
+         *
+         * @param request The request, which must have an itemDateRange with both ends.  fromRecord and
+         *        recordCount are set by the exporter.
+         * @param fileName The file name.
+         * @return The number of items written by this call.
+         * @throws std::runtime_error if the request has no item date range or a request or write fails.
+         *         Windows written before the failure are kept.
+         */
+        uint64_t exportAccountStatement(const GetAccountStatementRequest& request, const std::string& fileName);
+
+        static const std::vector<ColumnarFormat::Column>& getClearedOrderColumns();
+
+        static const std::vector<ColumnarFormat::Column>& getStatementColumns();
+
+    private:
+        const ExchangeApi& exchangeApi;
+        std::time_t window;
+        unsigned threads;
+        uint32_t blockRows;
+
+        // no copying
+        HistoryExporter(const HistoryExporter&);
+        HistoryExporter& operator=(const HistoryExporter&);
+};
+
+}
+}
+
+#endif // ARCHIVE_HISTORYEXPORTER_H
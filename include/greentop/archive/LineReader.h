@@ -0,0 +1,71 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_LINEREADER_H
+#define ARCHIVE_LINEREADER_H
+
+#include <bzlib.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Reads the lines of a text file, decompressing it as it goes if it is bzip2 compressed (including files made
+ * of several concatenated bzip2 streams).  Only a small window of the file is held in memory.
+ */
+class LineReader {
+    public:
+        /**
+         * Open a file.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be opened.
+         */
+        explicit LineReader(const std::string& fileName);
+
+        ~LineReader();
+
+        /**
+         * Read the next non empty line.  The line is valid until the next call.
+         *
+         * @param data Set to the start of the line.
+         * @param length Set to the length of the line, excluding the line terminator.
+         * @return false at the end of the file.
+         * @throws std::runtime_error if the file is corrupt.
+         */
+        bool next(const char*& data, size_t& length);
+
+        /**
+         * Gets the number of (compressed) bytes read from the file so far.
+         */
+        uint64_t getBytesRead() const;
+
+    private:
+        std::FILE* file;
+        bool compressed;
+        bool streamOpen;
+        bool endOfFile;
+        bz_stream stream;
+        std::vector<char> input;
+        std::vector<char> buffer;
+        size_t start;
+        /** Where the search for the end of the current line continues from. */
+        size_t searched;
+        size_t end;
+        uint64_t bytesRead;
+
+        bool fill();
+        size_t readInput();
+
+        // no copying
+        LineReader(const LineReader&);
+        LineReader& operator=(const LineReader&);
+};
+
+}
+}
+
+#endif // ARCHIVE_LINEREADER_H
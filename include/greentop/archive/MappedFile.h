@@ -0,0 +1,48 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_MAPPEDFILE_H
+#define ARCHIVE_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace greentop {
+namespace archive {
+
+/**
+ * A read only view of a whole file.  The file is memory mapped where supported, otherwise it is read into
+ * memory.
+ */
+class MappedFile {
+    public:
+        /**
+         * Map a file.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be opened.
+         */
+        explicit MappedFile(const std::string& fileName);
+
+        ~MappedFile();
+
+        const char* data() const;
+
+        size_t size() const;
+
+    private:
+        const char* address;
+        size_t length;
+        bool mapped;
+        std::vector<char> contents;
+
+        // no copying
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
+};
+
+}
+}
+
+#endif // ARCHIVE_MAPPEDFILE_H
@@ -0,0 +1,170 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_MARKETBOOKFORMAT_H
+#define ARCHIVE_MARKETBOOKFORMAT_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "greentop/sport/enum/MarketStatus.h"
+#include "greentop/sport/enum/RunnerStatus.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Layout of the MarketBook recording format shared by MarketBookRecorder and MarketBookReader.
+ *
+ * A file is a header, a sequence of independently decodable blocks and an index:
+ *
+ *     header:  fixed32 FILE_MAGIC, fixed32 FILE_VERSION
+ *     block:   fixed32 BLOCK_MAGIC, fixed32 payload length, fixed32 snapshot count, fixed64 min time,
+ *              fixed64 max time, payload
+ *     payload: varint market count, (string market id, signed event type id) per market,
+ *              varint column count, varint length per column, column bytes
+ *     index:   fixed32 INDEX_MAGIC, varint market count, (string market id, signed event type id) per market,
+ *              varint block count, (varint offset, varint snapshot count, signed min time, signed max time,
+ *              varint market count, varint market index per market) per block
+ *     trailer: fixed64 index offset, fixed32 TRAILER_MAGIC
+ *
+ * Each column is a stream of varints holding one field of every snapshot (market columns), runner (runner
+ * columns) or ladder level (PRICE and SIZE) in the block.  Numeric fields are fixed point and stored as the
+ * zigzag encoded difference from the same field of the previous snapshot of the market in the block, so an
+ * unchanged value costs one byte.  Ladder prices are stored relative to the level above, except for the best
+ * level which is relative to the previous snapshot's best level.
+ */
+class MarketBookFormat {
+    public:
+        static const uint32_t FILE_MAGIC = 0x424d5447;
+        static const uint32_t FILE_VERSION = 1;
+        static const uint32_t BLOCK_MAGIC = 0x4b4c4254;
+        static const uint32_t INDEX_MAGIC = 0x58444e49;
+        static const uint32_t TRAILER_MAGIC = 0x444e4547;
+        static const size_t FILE_HEADER_SIZE = 8;
+        static const size_t BLOCK_HEADER_SIZE = 28;
+        static const size_t TRAILER_SIZE = 12;
+
+        /** Prices, sizes, handicaps and volumes are stored in hundredths. */
+        static const int64_t PRICE_SCALE = 100;
+        /** Adjustment factors are stored in ten thousandths. */
+        static const int64_t ADJUSTMENT_SCALE = 10000;
+
+        enum Column {
+            TIME,
+            MARKET,
+            MARKET_FLAGS,
+            MARKET_STATUS,
+            VERSION,
+            MARKET_MATCHED,
+            MARKET_AVAILABLE,
+            LAST_MATCH,
+            MARKET_COUNTS,
+            RUNNER_COUNT,
+            SELECTION,
+            HANDICAP,
+            RUNNER_STATUS,
+            RUNNER_FLAGS,
+            ADJUSTMENT,
+            LTP,
+            RUNNER_MATCHED,
+            LADDER_SIZES,
+            PRICE,
+            SIZE,
+            COLUMN_COUNT
+        };
+
+        /** MARKET_FLAGS bits.  Each optional boolean has a "has" bit and a value bit. */
+        enum MarketFlag {
+            HAS_DELAYED = 1 << 0,
+            DELAYED = 1 << 1,
+            HAS_BSP_RECONCILED = 1 << 2,
+            BSP_RECONCILED = 1 << 3,
+            HAS_COMPLETE = 1 << 4,
+            COMPLETE = 1 << 5,
+            HAS_INPLAY = 1 << 6,
+            INPLAY = 1 << 7,
+            HAS_CROSS_MATCHING = 1 << 8,
+            CROSS_MATCHING = 1 << 9,
+            HAS_RUNNERS_VOIDABLE = 1 << 10,
+            RUNNERS_VOIDABLE = 1 << 11,
+            HAS_BET_DELAY = 1 << 12,
+            HAS_NUMBER_OF_WINNERS = 1 << 13,
+            HAS_VERSION = 1 << 14,
+            HAS_MARKET_MATCHED = 1 << 15,
+            HAS_MARKET_AVAILABLE = 1 << 16,
+            HAS_LAST_MATCH = 1 << 17,
+            HAS_ACTIVE_RUNNERS = 1 << 18,
+            HAS_NUMBER_OF_RUNNERS = 1 << 19
+        };
+
+        /** RUNNER_FLAGS bits. */
+        enum RunnerFlag {
+            HAS_HANDICAP = 1 << 0,
+            HAS_ADJUSTMENT = 1 << 1,
+            HAS_LTP = 1 << 2,
+            HAS_RUNNER_MATCHED = 1 << 3
+        };
+
+        /** The ladders stored for each runner, in order. */
+        enum Ladder {
+            BACK,
+            LAY,
+            TRADED,
+            LADDER_COUNT
+        };
+
+        struct LadderState {
+            std::vector<int64_t> prices;
+            std::vector<int64_t> sizes;
+        };
+
+        struct RunnerState {
+            int64_t selectionId;
+            int64_t handicap;
+            int64_t adjustment;
+            int64_t lastPriceTraded;
+            int64_t totalMatched;
+            LadderState ladders[LADDER_COUNT];
+
+            RunnerState();
+        };
+
+        struct MarketState {
+            int64_t version;
+            int64_t totalMatched;
+            int64_t totalAvailable;
+            int64_t lastMatchTime;
+            std::vector<RunnerState> runners;
+
+            MarketState();
+        };
+
+        static int64_t toFixed(double value, int64_t scale) {
+            return static_cast<int64_t>(std::llround(value * scale));
+        }
+
+        static double fromFixed(int64_t value, int64_t scale) {
+            return static_cast<double>(value) / scale;
+        }
+
+        /**
+         * Gets the code of a market status, 0 if unset.
+         */
+        static uint32_t encodeMarketStatus(const MarketStatus& status);
+
+        static MarketStatus decodeMarketStatus(uint32_t code);
+
+        /**
+         * Gets the code of a runner status, 0 if unset.
+         */
+        static uint32_t encodeRunnerStatus(const RunnerStatus& status);
+
+        static RunnerStatus decodeRunnerStatus(uint32_t code);
+};
+
+}
+}
+
+#endif // ARCHIVE_MARKETBOOKFORMAT_H
@@ -0,0 +1,152 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_MARKETBOOKREADER_H
+#define ARCHIVE_MARKETBOOKREADER_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/archive/Encoding.h"
+#include "greentop/archive/MappedFile.h"
+#include "greentop/archive/MarketBookFormat.h"
+#include "greentop/sport/MarketBook.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * A recorded snapshot.
+ */
+struct RecordedMarketBook {
+    /** When the market book was received, milliseconds since the epoch. */
+    int64_t receivedTime;
+    /** The event type of the market, 0 if unknown. */
+    int32_t eventTypeId;
+    MarketBook marketBook;
+};
+
+/**
+ * Reads a file written by MarketBookRecorder.  The file is memory mapped and snapshots are decoded a block at
+ * a time, in the order they were recorded.  Blocks that can't contain a wanted snapshot, because of the market
+ * or event type filters or the seek time, are skipped using the index without being decoded.
+ *
+ *     archive::MarketBookReader reader("20260101.gtmb");
+ *     reader.setMarketFilter({"1.123456789"});
+ *     archive::RecordedMarketBook recorded;
+ *     while (reader.next(recorded)) {
+ *     }
+ */
+class MarketBookReader {
+    public:
+        /**
+         * Summary of a block, from the index.
+         */
+        struct BlockInfo {
+            uint64_t offset;
+            uint32_t snapshots;
+            int64_t minTime;
+            int64_t maxTime;
+            /** Positions in getMarketIds(). */
+            std::vector<uint32_t> markets;
+        };
+
+        /**
+         * Open a recording.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be opened or isn't a recording.
+         */
+        explicit MarketBookReader(const std::string& fileName);
+
+        /**
+         * Only return snapshots of these markets.  An empty set removes the filter.
+         */
+        void setMarketFilter(const std::set<std::string>& marketIds);
+
+        /**
+         * Only return snapshots of markets of these event types.  An empty set removes the filter.
+         */
+        void setEventTypeFilter(const std::set<int32_t>& eventTypeIds);
+
+        /**
+         * Position the reader at the first snapshot received at or after a time.
+         *
+         * @param time Milliseconds since the epoch.
+         */
+        void seek(int64_t time);
+
+        /**
+         * Read the next snapshot that passes the filters.
+         *
+         * @param recorded Set to the snapshot.
+         * @return false at the end of the recording.
+         */
+        bool next(RecordedMarketBook& recorded);
+
+        /**
+         * Gets the ids of all the markets in the recording.
+         */
+        const std::vector<std::string>& getMarketIds() const;
+
+        /**
+         * Gets the event type of each market in getMarketIds().
+         */
+        const std::vector<int32_t>& getEventTypeIds() const;
+
+        const std::vector<BlockInfo>& getBlocks() const;
+
+        uint64_t getSnapshotCount() const;
+
+        /**
+         * Gets the earliest receive time in the recording, 0 if it is empty.
+         */
+        int64_t getStartTime() const;
+
+        /**
+         * Gets the latest receive time in the recording, 0 if it is empty.
+         */
+        int64_t getEndTime() const;
+
+    private:
+        MappedFile file;
+        std::vector<std::string> marketIds;
+        std::vector<int32_t> eventTypeIds;
+        std::unordered_map<std::string, uint32_t> marketIndexes;
+        std::vector<BlockInfo> blocks;
+
+        // filters, as flags indexed by market
+        std::vector<bool> wanted;
+        bool filtered;
+        std::set<std::string> marketFilter;
+        std::set<int32_t> eventTypeFilter;
+        int64_t seekTime;
+
+        // the current block
+        size_t nextBlock;
+        uint32_t remaining;
+        ByteReader columns[MarketBookFormat::COLUMN_COUNT];
+        const BlockInfo* currentBlock;
+        std::vector<MarketBookFormat::MarketState> blockStates;
+        int64_t lastTime;
+
+        void readIndex(uint64_t indexOffset);
+        void scanBlocks();
+        void updateFilter();
+        bool isWanted(const BlockInfo& block) const;
+        void openBlock(const BlockInfo& block);
+        bool decodeSnapshot(RecordedMarketBook& recorded);
+        void decodeRunner(MarketBookFormat::RunnerState& state, Runner* runner);
+        void decodeLadder(MarketBookFormat::LadderState& state, size_t levels, std::vector<PriceSize>* ladder);
+
+        // no copying
+        MarketBookReader(const MarketBookReader&);
+        MarketBookReader& operator=(const MarketBookReader&);
+};
+
+}
+}
+
+#endif // ARCHIVE_MARKETBOOKREADER_H
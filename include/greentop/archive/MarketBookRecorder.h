@@ -0,0 +1,125 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_MARKETBOOKRECORDER_H
+#define ARCHIVE_MARKETBOOKRECORDER_H
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/archive/Encoding.h"
+#include "greentop/archive/MarketBookFormat.h"
+#include "greentop/sport/MarketBook.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Records MarketBook snapshots to a compact binary, columnar file which can be memory mapped and scanned with
+ * MarketBookReader.  See MarketBookFormat for the layout.
+ *
+ * The market status and flags, counts, version, volumes, last match time and for each runner the status,
+ * handicap, adjustment factor, last price traded, total matched and the back, lay and traded ladders are
+ * recorded.  Prices, sizes and volumes are rounded to hundredths.  Starting prices, orders and matches are
+ * not recorded.
+ *
+ * Snapshots are buffered and written a block at a time.  The index is written by close(); a file that wasn't
+ * closed can still be read, the reader rebuilds the index by scanning the blocks.  A recorder isn't thread
+ * safe.
+ */
+class MarketBookRecorder {
+    public:
+        /**
+         * Create a new recording, replacing any existing file.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be created.
+         */
+        explicit MarketBookRecorder(const std::string& fileName);
+
+        /**
+         * Closes the recording.
+         */
+        ~MarketBookRecorder();
+
+        /**
+         * Sets the number of snapshots per block.  Smaller blocks make seeking and filtering by market more
+         * selective, larger blocks compress better.  Defaults to 4096.
+         */
+        void setBlockSnapshots(uint32_t blockSnapshots);
+
+        /**
+         * Record a snapshot.
+         *
+         * @param marketBook The market book.
+         * @param receivedTime When the market book was received, milliseconds since the epoch.  Times must not
+         *        decrease.
+         * @param eventTypeId The event type of the market, or 0 if unknown.
+         * @throws std::runtime_error if the recorder is closed or receivedTime is before the last snapshot's.
+         */
+        void record(const MarketBook& marketBook, int64_t receivedTime, int32_t eventTypeId = 0);
+
+        /**
+         * Write out the current block.
+         */
+        void flush();
+
+        /**
+         * Write out the current block and the index, and close the file.
+         */
+        void close();
+
+        uint64_t getSnapshotCount() const;
+
+        /**
+         * Gets the number of bytes written to the file so far, excluding the current block.
+         */
+        uint64_t getBytesWritten() const;
+
+    private:
+        struct BlockIndex {
+            uint64_t offset;
+            uint32_t snapshots;
+            int64_t minTime;
+            int64_t maxTime;
+            std::vector<uint32_t> markets;
+        };
+
+        std::ofstream output;
+        uint32_t blockSnapshots;
+        uint64_t snapshotCount;
+        uint64_t bytesWritten;
+
+        // the current block
+        ByteWriter columns[MarketBookFormat::COLUMN_COUNT];
+        std::unordered_map<std::string, uint32_t> blockMarketIndexes;
+        std::vector<uint32_t> blockMarkets;
+        std::vector<MarketBookFormat::MarketState> blockStates;
+        uint32_t blockSnapshotCount;
+        int64_t blockMinTime;
+        int64_t blockMaxTime;
+        int64_t lastTime;
+        /** The receive time of the last snapshot recorded. */
+        int64_t latestTime;
+
+        // the index
+        std::unordered_map<std::string, uint32_t> marketIndexes;
+        std::vector<std::string> marketIds;
+        std::vector<int32_t> eventTypeIds;
+        std::vector<BlockIndex> blocks;
+
+        void encodeRunner(const Runner& runner, MarketBookFormat::RunnerState& state);
+        void encodeLadder(const std::vector<PriceSize>& ladder, MarketBookFormat::LadderState& state);
+        void write(const std::string& data);
+
+        // no copying
+        MarketBookRecorder(const MarketBookRecorder&);
+        MarketBookRecorder& operator=(const MarketBookRecorder&);
+};
+
+}
+}
+
+#endif // ARCHIVE_MARKETBOOKRECORDER_H
@@ -0,0 +1,144 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef ARCHIVE_MARKETREPLAY_H
+#define ARCHIVE_MARKETREPLAY_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "greentop/archive/MarketBookReader.h"
+
+namespace greentop {
+namespace archive {
+
+/**
+ * Replays recordings made by MarketBookRecorder, returning the snapshots of all the recordings merged into
+ * receive time order.  Recordings can overlap in time and market, eg one file per poller or per day.
+ *
+ * By default snapshots are returned as fast as they can be decoded.  With a speed set, next() waits so that
+ * snapshots are returned at that multiple of the rate they were received.
+ *
+ *     archive::MarketReplay replay;
+ *     replay.addFile("horses.gtmb");
+ *     replay.addFile("football.gtmb");
+ *     replay.seek(startTime);
+ *     replay.run([&](const archive::RecordedMarketBook& recorded) {
+ *         strategy.onMarketBook(recorded.marketBook);
+ *     });
+ */
+class MarketReplay {
+    public:
+        typedef std::function<void(const RecordedMarketBook& recorded)> Callback;
+
+        MarketReplay();
+
+        /**
+         * Add a recording.  Filters and the seek time already set are applied to it.
+         *
+         * @param fileName The file name.
+         * @throws std::runtime_error if the file can't be opened or isn't a recording.
+         */
+        void addFile(const std::string& fileName);
+
+        /**
+         * Only replay snapshots of these markets.  An empty set removes the filter.
+         *
+         * Set part way through a replay, the filter applies from the current time, so snapshots received in the
+         * same millisecond as the last one returned may be returned again.
+         */
+        void setMarketFilter(const std::set<std::string>& marketIds);
+
+        /**
+         * Only replay snapshots of markets of these event types.  An empty set removes the filter.
+         *
+         * Set part way through a replay, the filter applies from the current time, so snapshots received in the
+         * same millisecond as the last one returned may be returned again.
+         */
+        void setEventTypeFilter(const std::set<int32_t>& eventTypeIds);
+
+        /**
+         * Restart the replay from the first snapshot received at or after a time.
+         *
+         * @param time Milliseconds since the epoch.
+         */
+        void seek(int64_t time);
+
+        /**
+         * Sets the replay speed as a multiple of the rate the snapshots were received, eg 1 for real time or 10
+         * for ten times faster.  0, the default, replays as fast as possible.
+         */
+        void setSpeed(double speed);
+
+        /**
+         * Gets the next snapshot in receive time order, waiting for it to be due if a speed is set.
+         *
+         * @param recorded Set to the snapshot.
+         * @return false when all the recordings are exhausted.
+         */
+        bool next(RecordedMarketBook& recorded);
+
+        /**
+         * Replay until the recordings are exhausted or stop() is called.
+         *
+         * @param callback Called with each snapshot.
+         * @return The number of snapshots replayed.
+         */
+        uint64_t run(const Callback& callback);
+
+        /**
+         * Make run() return after the current snapshot, or as soon as it's called if it isn't running yet.  May be
+         * called from any thread.  The replay stays stopped until reset().
+         */
+        void stop();
+
+        /**
+         * Clear a stop(), so that run() replays again.
+         */
+        void reset();
+
+        /**
+         * Gets the receive time of the last snapshot returned, 0 before the first.
+         */
+        int64_t getCurrentTime() const;
+
+    private:
+        struct Source {
+            std::unique_ptr<MarketBookReader> reader;
+            RecordedMarketBook head;
+            bool hasHead;
+        };
+
+        std::vector<std::unique_ptr<Source>> sources;
+        // a min heap of sources with a head, ordered by head receive time
+        std::vector<size_t> heap;
+        bool primed;
+        std::set<std::string> marketFilter;
+        std::set<int32_t> eventTypeFilter;
+        int64_t seekTime;
+        double speed;
+        std::atomic<bool> stopped;
+        int64_t currentTime;
+        bool paceStarted;
+        int64_t paceStartTime;
+        std::chrono::steady_clock::time_point paceStart;
+
+        void refilter();
+        void prime();
+        bool later(size_t a, size_t b) const;
+        void pace(int64_t receivedTime);
+
+        // no copying
+        MarketReplay(const MarketReplay&);
+        MarketReplay& operator=(const MarketReplay&);
+};
+
+}
+}
+
+#endif // ARCHIVE_MARKETREPLAY_H
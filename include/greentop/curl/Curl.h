@@ -50,6 +50,12 @@ class Curl : public ICurl {
 
         virtual CURLcode easyPerform(const CurlHandle& handle) const;
 
+        virtual CURLcode easyGetinfo(
+            const CurlHandle& handle,
+            const CURLINFO& info,
+            double* parameter
+        ) const;
+
         virtual ~Curl();
     private:
         // no copying
@@ -49,6 +49,14 @@ class ICurl {
 
         virtual CURLcode easyPerform(const CurlHandle& handle) const = 0;
 
+        virtual CURLcode easyGetinfo(
+            const CurlHandle& /* handle */,
+            const CURLINFO& /* info */,
+            double* /* parameter */
+        ) const {
+            return CURLE_UNKNOWN_OPTION;
+        }
+
         virtual ~ICurl() {}
 };
 
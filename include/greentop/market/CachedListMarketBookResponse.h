@@ -0,0 +1,52 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_CACHEDLISTMARKETBOOKRESPONSE_H
+#define MARKET_CACHEDLISTMARKETBOOKRESPONSE_H
+
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "greentop/JsonResponse.h"
+#include "greentop/market/MarketBookCache.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * A listMarketBook response that decodes through a MarketBookCache, so books that haven't moved since the
+ * last poll are shared rather than decoded again.
+ *
+ * @see ExchangeApi::listMarketBook(const ListMarketBookRequest&, JsonResponse&)
+ */
+class CachedListMarketBookResponse : public JsonResponse {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param cache The cache to decode through.
+         * @param projection The projection of the request, from MarketBookCache::getProjection().
+         */
+        CachedListMarketBookResponse(MarketBookCache& cache, const std::string& projection = std::string());
+
+        virtual void fromJson(const Json::Value& json);
+
+        virtual Json::Value toJson() const;
+
+        virtual bool isValid() const;
+
+        const std::vector<std::shared_ptr<const MarketBook>>& getMarketBooks() const;
+
+    private:
+        MarketBookCache& cache;
+        std::string projection;
+        std::vector<std::shared_ptr<const MarketBook>> marketBooks;
+};
+
+}
+}
+
+#endif // MARKET_CACHEDLISTMARKETBOOKRESPONSE_H
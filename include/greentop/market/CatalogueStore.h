@@ -0,0 +1,124 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_CATALOGUESTORE_H
+#define MARKET_CATALOGUESTORE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "greentop/market/CompactMarketCatalogue.h"
+#include "greentop/market/StringPool.h"
+#include "greentop/sport/MarketCatalogue.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * Holds a large number of catalogues compactly, as CompactMarketCatalogues keyed by market id.  Runner names
+ * and metadata are interned, and event types, competitions and events are shared between catalogues with the
+ * same id, as are identical market descriptions.  Shared objects are freed when the last catalogue using them
+ * is; interned strings are kept until the store is cleared or destroyed and the catalogues using them are gone.
+ *
+ *     market::CatalogueStore store;
+ *     for (const MarketCatalogue& marketCatalogue : response.getMarketCatalogues()) {
+ *         store.put(marketCatalogue);
+ *     }
+ *     const std::string* jockey = store.get(marketId)->getRunner(selectionId)->getMetadataValue("JOCKEY_NAME");
+ *
+ * A store is thread safe.
+ */
+class CatalogueStore {
+    public:
+        CatalogueStore();
+
+        /**
+         * Add a catalogue, replacing any catalogue of the same market.
+         *
+         * @param marketCatalogue The catalogue.
+         * @return The compact catalogue.
+         */
+        std::shared_ptr<const CompactMarketCatalogue> put(const MarketCatalogue& marketCatalogue);
+
+        /**
+         * Gets a catalogue.
+         *
+         * @return The catalogue, or a null pointer if the market isn't in the store.
+         */
+        std::shared_ptr<const CompactMarketCatalogue> get(const std::string& marketId) const;
+
+        /**
+         * Remove a catalogue.  Strings interned for it stay in the pool, which never shrinks.
+         */
+        void remove(const std::string& marketId);
+
+        /**
+         * Remove every catalogue and start a new string pool.  Catalogues still held elsewhere keep the old pool.
+         */
+        void clear();
+
+        size_t size() const;
+
+        /**
+         * Gets the shared copy of an event type, or a null pointer if it has no id.
+         */
+        std::shared_ptr<const EventType> share(const EventType& eventType);
+
+        /**
+         * Gets the shared copy of a competition, or a null pointer if it has no id.
+         */
+        std::shared_ptr<const Competition> share(const Competition& competition);
+
+        /**
+         * Gets the shared copy of an event, or a null pointer if it has no id.
+         */
+        std::shared_ptr<const Event> share(const Event& event);
+
+        /**
+         * Gets the shared copy of a market description, or a null pointer if it isn't valid.
+         */
+        std::shared_ptr<const MarketDescription> share(const MarketDescription& description);
+
+        /**
+         * Gets the pool runner names and metadata are interned in.
+         */
+        std::shared_ptr<StringPool> getStringPool() const;
+
+    private:
+        /**
+         * Shared objects by key, swept of expired entries as the map grows.
+         */
+        template <typename K, typename T>
+        struct SharedMap {
+            SharedMap() : sweepSize(64) {
+            }
+
+            std::unordered_map<K, std::weak_ptr<const T>> objects;
+            size_t sweepSize;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<const CompactMarketCatalogue>> catalogues;
+        std::shared_ptr<StringPool> strings;
+
+        SharedMap<std::string, EventType> eventTypes;
+        SharedMap<std::string, Competition> competitions;
+        SharedMap<std::string, Event> events;
+        // by a hash of the json, collisions are resolved by comparing the json
+        SharedMap<size_t, MarketDescription> descriptions;
+
+        template <typename K, typename T>
+        std::shared_ptr<const T> share(SharedMap<K, T>& shared, const K& key, const T& value);
+
+        // no copying
+        CatalogueStore(const CatalogueStore&);
+        CatalogueStore& operator=(const CatalogueStore&);
+};
+
+}
+}
+
+#endif // MARKET_CATALOGUESTORE_H
@@ -0,0 +1,87 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_COMPACTMARKETCATALOGUE_H
+#define MARKET_COMPACTMARKETCATALOGUE_H
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "greentop/Optional.h"
+#include "greentop/market/CompactRunnerCatalog.h"
+#include "greentop/market/StringPool.h"
+#include "greentop/sport/MarketCatalogue.h"
+#include "greentop/sport/RunnerIndex.h"
+
+namespace greentop {
+namespace market {
+
+class CatalogueStore;
+
+/**
+ * A read only MarketCatalogue that takes less memory.  The event type, competition, event and description are
+ * shared with other catalogues in the same CatalogueStore, and the runners are CompactRunnerCatalogs.  The
+ * getters match MarketCatalogue's.
+ */
+class CompactMarketCatalogue {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param marketCatalogue The catalogue.
+         * @param store The store to share strings and parent objects with.
+         */
+        CompactMarketCatalogue(const MarketCatalogue& marketCatalogue, CatalogueStore& store);
+
+        const std::string& getMarketId() const;
+
+        const std::string& getMarketName() const;
+
+        const std::tm& getMarketStartTime() const;
+
+        const MarketDescription& getDescription() const;
+
+        const Optional<double>& getTotalMatched() const;
+
+        const std::vector<CompactRunnerCatalog>& getRunners() const;
+
+        /**
+         * Find a runner by selection id and handicap.
+         *
+         * @return The runner, or NULL if there is no such runner.
+         */
+        const CompactRunnerCatalog* getRunner(int64_t selectionId, double handicap = 0) const;
+
+        const EventType& getEventType() const;
+
+        const Competition& getCompetition() const;
+
+        const Event& getEvent() const;
+
+        /**
+         * Convert back to a MarketCatalogue.
+         */
+        MarketCatalogue toMarketCatalogue() const;
+
+    private:
+        std::string marketId;
+        std::string marketName;
+        std::tm marketStartTime;
+        Optional<double> totalMatched;
+        std::shared_ptr<const MarketDescription> description;
+        std::shared_ptr<const EventType> eventType;
+        std::shared_ptr<const Competition> competition;
+        std::shared_ptr<const Event> event;
+        std::vector<CompactRunnerCatalog> runners;
+        RunnerIndex runnerIndex;
+        // keeps the strings the runners point to alive
+        std::shared_ptr<StringPool> strings;
+};
+
+}
+}
+
+#endif // MARKET_COMPACTMARKETCATALOGUE_H
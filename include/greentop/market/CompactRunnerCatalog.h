@@ -0,0 +1,78 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_COMPACTRUNNERCATALOG_H
+#define MARKET_COMPACTRUNNERCATALOG_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "greentop/Optional.h"
+#include "greentop/market/StringPool.h"
+#include "greentop/sport/RunnerCatalog.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * A read only RunnerCatalog that takes less memory.  The runner name and the metadata keys and values are
+ * interned in a StringPool, and the metadata is held in a vector sorted by key rather than a map.  The
+ * getters match RunnerCatalog's, except that getMetadata() builds the map; use getMetadataValue() to look up
+ * a single value.
+ */
+class CompactRunnerCatalog {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param runnerCatalog The runner.
+         * @param strings The pool to intern strings in.  It must outlive this object.
+         */
+        CompactRunnerCatalog(const RunnerCatalog& runnerCatalog, StringPool& strings);
+
+        const Optional<int64_t>& getSelectionId() const;
+
+        const std::string& getRunnerName() const;
+
+        const Optional<double>& getHandicap() const;
+
+        const Optional<int32_t>& getSortPriority() const;
+
+        /**
+         * Gets a copy of the metadata.
+         */
+        std::map<std::string, std::string> getMetadata() const;
+
+        /**
+         * Gets a metadata value.
+         *
+         * @param key The key, eg JOCKEY_NAME.
+         * @return The value, or NULL if there isn't one.
+         */
+        const std::string* getMetadataValue(const std::string& key) const;
+
+        /**
+         * Gets the keys and values of the metadata, sorted by key.
+         */
+        const std::vector<std::pair<const std::string*, const std::string*>>& getMetadataEntries() const;
+
+        /**
+         * Convert back to a RunnerCatalog.
+         */
+        RunnerCatalog toRunnerCatalog() const;
+
+    private:
+        Optional<int64_t> selectionId;
+        const std::string* runnerName;
+        Optional<double> handicap;
+        Optional<int32_t> sortPriority;
+        std::vector<std::pair<const std::string*, const std::string*>> metadata;
+};
+
+}
+}
+
+#endif // MARKET_COMPACTRUNNERCATALOG_H
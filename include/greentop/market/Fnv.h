@@ -0,0 +1,38 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef MARKET_FNV_H
+#define MARKET_FNV_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace greentop {
+namespace market {
+
+/**
+ * The 64 bit FNV-1a hash, used to fingerprint market books cheaply.  Not for anything that needs resistance to
+ * collisions chosen by an attacker.
+ */
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * Add bytes to a hash.
+ *
+ * @param hash The hash so far, FNV_OFFSET_BASIS to start.
+ * @return The new hash.
+ */
+inline uint64_t hashBytes(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+}
+}
+
+#endif // MARKET_FNV_H
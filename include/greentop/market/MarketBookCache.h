@@ -0,0 +1,141 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_MARKETBOOKCACHE_H
+#define MARKET_MARKETBOOKCACHE_H
+
+#include <atomic>
+#include <json/json.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/sport/ListMarketBookRequest.h"
+#include "greentop/sport/MarketBook.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * A cache of decoded MarketBooks keyed by market id and projection.  Before decoding a market book the cache
+ * fingerprints the version, status, totalMatched, totalAvailable, lastMatchTime and a hash of the runners' json,
+ * ladders included; if the fingerprint hasn't changed since the last decode the cached MarketBook is reused
+ * instead of building new Runner / ExchangePrices objects.  Hashing the json costs far less than decoding it.
+ *
+ * The same market requested with different price, order or match projections gets a different book, so books
+ * are cached separately for each projection, as given by getProjection().
+ *
+ * Books are handed out as shared pointers to const so readers on other threads can hold on to a book while it
+ * is being replaced.
+ */
+class MarketBookCache {
+    public:
+        MarketBookCache();
+
+        /**
+         * Decode a listMarketBook response, reusing cached books where possible.
+         *
+         * @param json The listMarketBook result, an array of market books.
+         * @param projection The projection of the request, from getProjection().
+         * @return The market books in the order they appear in the response.
+         */
+        std::vector<std::shared_ptr<const MarketBook>> update(const Json::Value& json,
+            const std::string& projection = std::string());
+
+        /**
+         * Decode a single market book, reusing the cached book if possible.
+         *
+         * @param json The market book json.
+         * @param projection The projection of the request, from getProjection().
+         * @return The market book.
+         */
+        std::shared_ptr<const MarketBook> updateMarketBook(const Json::Value& json,
+            const std::string& projection = std::string());
+
+        /**
+         * Gets the latest book for the given market.
+         *
+         * @param marketId The market id.
+         * @param projection The projection the book was requested with.
+         * @return The market book or a null pointer if the market isn't cached.
+         */
+        std::shared_ptr<const MarketBook> get(const std::string& marketId,
+            const std::string& projection = std::string()) const;
+
+        /**
+         * Remove the given market from the cache, for every projection.
+         *
+         * @param marketId The market id.
+         */
+        void remove(const std::string& marketId);
+
+        /**
+         * Remove all markets from the cache.
+         */
+        void clear();
+
+        /**
+         * Gets the number of market books that were served from the cache.
+         */
+        uint64_t getHits() const;
+
+        /**
+         * Gets the number of market books that had to be decoded.
+         */
+        uint64_t getMisses() const;
+
+        /**
+         * Gets the proportion of market books served from the cache, between 0 and 1.
+         */
+        double getHitRate() const;
+
+        /**
+         * Reset the hit and miss counters.
+         */
+        void resetCounters();
+
+        /**
+         * Gets the projection of a listMarketBook request: everything but the market ids that decides what
+         * each market book contains.
+         */
+        static std::string getProjection(const ListMarketBookRequest& request);
+
+    private:
+        struct Fingerprint {
+            bool hasVersion;
+            int64_t version;
+            std::string status;
+            double totalMatched;
+            double totalAvailable;
+            std::string lastMatchTime;
+            unsigned numberOfRunners;
+            uint64_t runnersHash;
+
+            bool operator==(const Fingerprint& other) const;
+        };
+
+        struct Entry {
+            Fingerprint fingerprint;
+            std::shared_ptr<const MarketBook> marketBook;
+        };
+
+        mutable std::mutex mutex;
+        /** The entries of each market, by projection. */
+        std::unordered_map<std::string, std::unordered_map<std::string, Entry>> entries;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+
+        static Fingerprint makeFingerprint(const Json::Value& json);
+
+        // no copying
+        MarketBookCache(const MarketBookCache&);
+        MarketBookCache& operator=(const MarketBookCache&);
+};
+
+}
+}
+
+#endif // MARKET_MARKETBOOKCACHE_H
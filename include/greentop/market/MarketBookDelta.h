@@ -0,0 +1,98 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_MARKETBOOKDELTA_H
+#define MARKET_MARKETBOOKDELTA_H
+
+#include <string>
+#include <vector>
+
+#include "greentop/Optional.h"
+#include "greentop/sport/Match.h"
+#include "greentop/sport/Order.h"
+#include "greentop/sport/enum/MarketStatus.h"
+#include "greentop/sport/enum/RunnerStatus.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * A single price level that has changed between two snapshots.  A size of zero means the level has
+ * been removed.
+ */
+struct LadderChange {
+    enum class Ladder {AVAILABLE_TO_BACK, AVAILABLE_TO_LAY, TRADED_VOLUME};
+
+    LadderChange(Ladder ladder, double price, double size) : ladder(ladder), price(price), size(size) {
+    }
+
+    Ladder ladder;
+    double price;
+    double size;
+};
+
+/**
+ * The changes to one runner between two snapshots.  Only the members flagged as changed are meaningful.
+ */
+struct RunnerDelta {
+    RunnerDelta() : selectionId(0), handicap(0), isNew(false), isRemoved(false), statusChanged(false),
+        lastPriceTradedChanged(false), totalMatchedChanged(false) {
+    }
+
+    int64_t selectionId;
+    double handicap;
+    /** True if the runner was not in the previous snapshot. */
+    bool isNew;
+    /** True if the runner was in the previous snapshot but is missing from this one. */
+    bool isRemoved;
+    bool statusChanged;
+    RunnerStatus status;
+    bool lastPriceTradedChanged;
+    Optional<double> lastPriceTraded;
+    bool totalMatchedChanged;
+    Optional<double> totalMatched;
+    std::vector<LadderChange> ladderChanges;
+    /** Orders that are new or whose state has changed. */
+    std::vector<Order> orders;
+    /** Matches that are new or whose size has changed. */
+    std::vector<Match> matches;
+};
+
+/**
+ * The changes to a market between two successive MarketBook snapshots.
+ */
+struct MarketBookDelta {
+    MarketBookDelta() : isNew(false), versionChanged(false), statusChanged(false), inplayChanged(false),
+        totalMatchedChanged(false) {
+    }
+
+    /**
+     * Whether anything has changed.
+     *
+     * @return True if nothing has changed else false.
+     */
+    bool isEmpty() const {
+        return !isNew && !versionChanged && !statusChanged && !inplayChanged && !totalMatchedChanged &&
+            runners.empty();
+    }
+
+    std::string marketId;
+    /** True if there was no previous snapshot for this market. */
+    bool isNew;
+    bool versionChanged;
+    Optional<int64_t> version;
+    bool statusChanged;
+    MarketStatus status;
+    bool inplayChanged;
+    Optional<bool> inplay;
+    bool totalMatchedChanged;
+    Optional<double> totalMatched;
+    /** Only runners that have changed. */
+    std::vector<RunnerDelta> runners;
+};
+
+}
+}
+
+#endif // MARKET_MARKETBOOKDELTA_H
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_MARKETBOOKDIFFER_H
+#define MARKET_MARKETBOOKDIFFER_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "greentop/market/MarketBookDelta.h"
+#include "greentop/sport/MarketBook.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * Keeps the previous MarketBook snapshot for each market and computes what has changed when a new one
+ * arrives.  Each runner is hashed once, when it arrives, and an unchanged runner is skipped by comparing its
+ * hash with the previous one, without diffing its ladders.  Only the runners that changed are copied into
+ * the snapshot, the others keep their previous copy.  The market level definition (status, inplay, runner
+ * statuses) is only compared when the version has moved.
+ *
+ * Books shared by a MarketBookCache can be passed as they are; a book that is the one the previous snapshot
+ * was taken from, ie a cache hit, is skipped without looking at its runners at all.
+ */
+class MarketBookDiffer {
+    public:
+        MarketBookDiffer();
+
+        /**
+         * Compare a new snapshot with the previous one for the same market and remember it for next time.
+         *
+         * @param marketBook The new snapshot.
+         * @return The changes since the previous snapshot.
+         */
+        MarketBookDelta update(const MarketBook& marketBook);
+
+        /**
+         * Compare a new shared snapshot with the previous one for the same market and remember it for next time.
+         *
+         * @param marketBook The new snapshot, eg from a MarketBookCache.
+         * @return The changes since the previous snapshot, none if it is the same book as the previous one.
+         */
+        MarketBookDelta update(const std::shared_ptr<const MarketBook>& marketBook);
+
+        /**
+         * Forget the snapshot for the given market.
+         *
+         * @param marketId The market id.
+         */
+        void remove(const std::string& marketId);
+
+        /**
+         * Forget all snapshots.
+         */
+        void clear();
+
+        /**
+         * Whether a snapshot is held for the given market.
+         *
+         * @param marketId The market id.
+         * @return True if a snapshot is held else false.
+         */
+        bool hasSnapshot(const std::string& marketId) const;
+
+    private:
+        typedef std::pair<int64_t, double> RunnerKey;
+
+        struct RunnerSnapshot {
+            std::shared_ptr<const Runner> runner;
+            uint64_t hash;
+        };
+
+        struct Snapshot {
+            Optional<int64_t> version;
+            MarketStatus status;
+            Optional<bool> inplay;
+            Optional<double> totalMatched;
+            /** The shared book the snapshot was taken from, if any. */
+            std::shared_ptr<const MarketBook> source;
+            std::map<RunnerKey, RunnerSnapshot> runners;
+        };
+
+        std::unordered_map<std::string, Snapshot> snapshots;
+
+        MarketBookDelta update(const MarketBook& marketBook, const std::shared_ptr<const MarketBook>& source);
+
+        void diffRunner(const Runner& previous, const Runner& current, bool definitionChanged,
+            RunnerDelta& delta) const;
+};
+
+}
+}
+
+#endif // MARKET_MARKETBOOKDIFFER_H
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_MARKETCATALOGUECACHE_H
+#define MARKET_MARKETCATALOGUECACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <json/json.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+#include "greentop/archive/MappedFile.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * A cache of MarketCatalogues keyed by market id, in front of listMarketCatalogue.  Each cached catalogue
+ * remembers which market projections it was fetched with, so a request for RUNNER_METADATA isn't answered
+ * from a catalogue fetched without it.  Catalogues that are missing, expired or incomplete are fetched
+ * together, in as few requests as the data weight limit allows; the rest are served locally.
+ *
+ * The cache can be saved to a file and is loaded from it when constructed.  The file is memory mapped and
+ * catalogues are only decoded from it when first asked for, so a cache of tens of thousands of markets is
+ * ready almost immediately.
+ *
+ *     market::MarketCatalogueCache cache(exchangeApi, "catalogues.gtmc");
+ *     std::set<MarketProjection> projections = {MarketProjection(MarketProjection::RUNNER_METADATA)};
+ *     auto catalogues = cache.get(marketIds, projections);
+ *     ...
+ *     cache.save();
+ */
+class MarketCatalogueCache {
+    public:
+        /** The default maximum data weight of a listMarketCatalogue request. */
+        static const unsigned MAX_WEIGHT = 200;
+
+        /** The maximum number of markets listMarketCatalogue returns. */
+        static const unsigned MAX_RESULTS = 1000;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to call listMarketCatalogue.  It must outlive the cache.
+         * @param fileName The file the cache is loaded from and saved to, if any.  A missing file is ignored.
+         * @throws std::runtime_error if the file exists but isn't a catalogue cache.
+         */
+        MarketCatalogueCache(const ExchangeApi& exchangeApi, const std::string& fileName = std::string());
+
+        /**
+         * Sets how long a catalogue is served before it is fetched again.  Defaults to 1 hour.
+         */
+        void setTtl(const std::chrono::seconds& ttl);
+
+        /**
+         * Sets the maximum data weight of a single request.  Defaults to MAX_WEIGHT.
+         */
+        void setMaxWeight(unsigned maxWeight);
+
+        /**
+         * Sets the locale catalogues are requested in.
+         */
+        void setLocale(const std::string& locale);
+
+        /**
+         * Gets catalogues, fetching any that aren't cached with at least the given projections or have expired.
+         * If a fetch fails the previously cached catalogue is returned, even if it has expired.
+         *
+         * @param marketIds The market ids.
+         * @param marketProjection The projections the catalogues need.
+         * @return The catalogues in the order of marketIds, leaving out markets that couldn't be found.
+         */
+        std::vector<std::shared_ptr<const MarketCatalogue>> get(const std::vector<std::string>& marketIds,
+            const std::set<MarketProjection>& marketProjection);
+
+        /**
+         * Gets a single catalogue, fetching it if necessary.
+         *
+         * @return The catalogue, or a null pointer if it couldn't be found.
+         */
+        std::shared_ptr<const MarketCatalogue> get(const std::string& marketId,
+            const std::set<MarketProjection>& marketProjection);
+
+        /**
+         * Gets a cached catalogue without fetching it, whatever its age or projections.
+         *
+         * @return The catalogue, or a null pointer if it isn't cached.
+         */
+        std::shared_ptr<const MarketCatalogue> find(const std::string& marketId) const;
+
+        /**
+         * Add a catalogue obtained elsewhere, eg from your own listMarketCatalogue call.
+         *
+         * @param marketCatalogue The catalogue.
+         * @param marketProjection The projections it was requested with.
+         */
+        void put(const MarketCatalogue& marketCatalogue, const std::set<MarketProjection>& marketProjection);
+
+        void remove(const std::string& marketId);
+
+        void clear();
+
+        size_t size() const;
+
+        /**
+         * Write the catalogues that haven't expired to the file given to the constructor, replacing it.
+         *
+         * @throws std::runtime_error if there is no file name or the file can't be written.
+         */
+        void save() const;
+
+        /**
+         * Gets the number of catalogues served without a request.
+         */
+        uint64_t getHits() const;
+
+        /**
+         * Gets the number of catalogues that had to be requested.
+         */
+        uint64_t getMisses() const;
+
+        /**
+         * Gets the number of listMarketCatalogue requests made.
+         */
+        uint64_t getRequests() const;
+
+        /**
+         * Gets the number of listMarketCatalogue requests that failed.
+         */
+        uint64_t getErrors() const;
+
+        void resetCounters();
+
+        /**
+         * Calculate the data weight of one market for the given projections.
+         *
+         * @param marketProjection The projections.
+         * @return The weight, possibly 0.
+         */
+        static unsigned getMarketWeight(const std::set<MarketProjection>& marketProjection);
+
+    private:
+        struct Entry {
+            /** When the catalogue was fetched, milliseconds since the epoch. */
+            int64_t fetchedTime;
+            /** Bit set of the projections the catalogue was fetched with. */
+            uint32_t projections;
+            std::shared_ptr<const MarketCatalogue> catalogue;
+            /** The undecoded catalogue in the mapped file, if catalogue hasn't been decoded yet. */
+            const char* json;
+            size_t jsonLength;
+        };
+
+        const ExchangeApi& exchangeApi;
+        std::string fileName;
+        std::chrono::milliseconds ttl;
+        unsigned maxWeight;
+        std::string locale;
+
+        mutable std::mutex mutex;
+        mutable std::unordered_map<std::string, Entry> entries;
+        std::unique_ptr<archive::MappedFile> file;
+        std::unique_ptr<Json::CharReader> reader;
+
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        std::atomic<uint64_t> requests;
+        std::atomic<uint64_t> errors;
+
+        static uint32_t toProjections(const std::set<MarketProjection>& marketProjection);
+        static std::set<MarketProjection> fromProjections(uint32_t projections);
+        static int64_t now();
+
+        void load();
+        void fetch(const std::vector<std::string>& marketIds, uint32_t projections);
+        const std::shared_ptr<const MarketCatalogue>& decode(Entry& entry) const;
+
+        // no copying
+        MarketCatalogueCache(const MarketCatalogueCache&);
+        MarketCatalogueCache& operator=(const MarketCatalogueCache&);
+};
+
+}
+}
+
+#endif // MARKET_MARKETCATALOGUECACHE_H
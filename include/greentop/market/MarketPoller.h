@@ -0,0 +1,240 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_MARKETPOLLER_H
+#define MARKET_MARKETPOLLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace market {
+
+/**
+ * Polls listMarketBook for a watch list of markets, refreshing each market at a rate that depends on its
+ * priority class.  A market's class is derived from MarketBook::inplay and the time until
+ * MarketCatalogue::marketStartTime, or can be pinned per market.  Due markets are packed into requests that
+ * stay within the data weight limit, requests are throttled to a global rate budget and a market that falls
+ * due again while its previous refresh is still waiting is refreshed only once (conflated).
+ *
+ * Call poll() from your own loop or start() to poll on a background thread.  Closed markets are removed from
+ * the watch list after they have been delivered to subscribers.
+ */
+class MarketPoller {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        /** Priority classes, highest first. */
+        enum class Priority {IN_PLAY, NEAR_START, PRE_START, DISTANT};
+
+        static const unsigned NUMBER_OF_PRIORITIES = 4;
+
+        /** The default maximum data weight of a listMarketBook request. */
+        static const unsigned MAX_WEIGHT = 200;
+
+        /**
+         * Refresh statistics for one priority class.
+         */
+        struct Metrics {
+            Metrics() : markets(0), refreshes(0), totalIntervalMs(0), maxIntervalMs(0), conflated(0) {
+            }
+
+            /** The number of watched markets currently in this class. */
+            unsigned markets;
+            /** The number of refreshes that had a previous refresh to measure an interval from. */
+            uint64_t refreshes;
+            double totalIntervalMs;
+            double maxIntervalMs;
+            /** The number of refreshes that were dropped because the market was already waiting. */
+            uint64_t conflated;
+
+            double getMeanIntervalMs() const {
+                return refreshes > 0 ? totalIntervalMs / refreshes : 0;
+            }
+        };
+
+        typedef std::function<void(const MarketBook&)> Subscriber;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to call listMarketBook.  It must outlive the poller.
+         * @param requestTemplate The price, order and match projections etc. to request.  The market ids are
+         *        filled in by the poller.
+         */
+        MarketPoller(const ExchangeApi& exchangeApi,
+            const ListMarketBookRequest& requestTemplate = ListMarketBookRequest());
+
+        ~MarketPoller();
+
+        /**
+         * Sets the target refresh interval for a priority class.
+         */
+        void setInterval(Priority priority, const std::chrono::milliseconds& interval);
+
+        /**
+         * Markets starting within this time are NEAR_START.  Defaults to 5 minutes.
+         */
+        void setNearStartThreshold(const std::chrono::seconds& threshold);
+
+        /**
+         * Markets starting within this time are PRE_START, later ones are DISTANT.  Defaults to 2 hours.
+         */
+        void setPreStartThreshold(const std::chrono::seconds& threshold);
+
+        /**
+         * Sets the global budget of listMarketBook requests per second.  Defaults to 10.
+         */
+        void setRequestsPerSecond(double requestsPerSecond);
+
+        /**
+         * Sets the maximum data weight of a single request.  Defaults to MAX_WEIGHT.
+         */
+        void setMaxWeight(unsigned maxWeight);
+
+        /**
+         * Add a market to the watch list.  It is due for refresh immediately.
+         *
+         * @param marketId The market id.
+         * @param marketStartTime The scheduled start time (UTC), if known.
+         */
+        void watch(const std::string& marketId, const std::tm& marketStartTime = std::tm());
+
+        /**
+         * Add a market to the watch list using its catalogue for the start time.
+         */
+        void watch(const MarketCatalogue& marketCatalogue);
+
+        /**
+         * Remove a market from the watch list.
+         */
+        void unwatch(const std::string& marketId);
+
+        /**
+         * Pin a market to a priority class regardless of its state.
+         */
+        void setPriority(const std::string& marketId, Priority priority);
+
+        /**
+         * Undo setPriority().
+         */
+        void clearPriority(const std::string& marketId);
+
+        /**
+         * Whether a market is on the watch list.
+         */
+        bool isWatched(const std::string& marketId) const;
+
+        /**
+         * Register a function to be called with every refreshed book.  Subscribers are called on the polling
+         * thread.
+         *
+         * @return An id that can be passed to unsubscribe().
+         */
+        unsigned subscribe(const Subscriber& subscriber);
+
+        void unsubscribe(unsigned subscriberId);
+
+        /**
+         * Refresh the markets that are due, as far as the request budget allows.
+         *
+         * @return When the next market falls due.
+         */
+        Clock::time_point poll();
+
+        /**
+         * Start polling on a background thread.
+         */
+        void start();
+
+        /**
+         * Stop the background thread.
+         */
+        void stop();
+
+        /**
+         * Gets the refresh statistics for a priority class.
+         */
+        Metrics getMetrics(Priority priority) const;
+
+        /**
+         * Gets the number of listMarketBook requests that failed.
+         */
+        uint64_t getErrors() const;
+
+        void resetMetrics();
+
+        /**
+         * Calculate the data weight of one market for the given price projection.
+         *
+         * @param priceProjection The price projection.
+         * @return The weight.
+         */
+        static unsigned getMarketWeight(const PriceProjection& priceProjection);
+
+    private:
+        struct WatchedMarket {
+            time_t marketStartTime;
+            bool inplay;
+            bool pinned;
+            Priority pinnedPriority;
+            Priority priority;
+            Clock::time_point due;
+            Clock::time_point lastRefresh;
+            bool refreshed;
+            bool pending;
+        };
+
+        typedef std::pair<Clock::time_point, std::string> ScheduleEntry;
+
+        const ExchangeApi& exchangeApi;
+        ListMarketBookRequest requestTemplate;
+        unsigned maxWeight;
+        std::chrono::milliseconds intervals[NUMBER_OF_PRIORITIES];
+        std::chrono::seconds nearStartThreshold;
+        std::chrono::seconds preStartThreshold;
+        double requestsPerSecond;
+        double tokens;
+        Clock::time_point lastRefill;
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, WatchedMarket> markets;
+        std::set<ScheduleEntry> schedule;
+        std::vector<std::string> pending;
+        std::map<unsigned, Subscriber> subscribers;
+        unsigned nextSubscriberId;
+        Metrics metrics[NUMBER_OF_PRIORITIES];
+        uint64_t errors;
+
+        std::thread thread;
+        std::condition_variable condition;
+        bool running;
+
+        Priority classify(const WatchedMarket& market, time_t now) const;
+        void reschedule(const std::string& marketId, WatchedMarket& market, const Clock::time_point& from);
+        bool takeToken(const Clock::time_point& now);
+        void refresh(const std::vector<std::string>& marketIds);
+        void run();
+
+        // no copying
+        MarketPoller(const MarketPoller&);
+        MarketPoller& operator=(const MarketPoller&);
+};
+
+}
+}
+
+#endif // MARKET_MARKETPOLLER_H
@@ -0,0 +1,48 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef MARKET_STRINGPOOL_H
+#define MARKET_STRINGPOOL_H
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace greentop {
+namespace market {
+
+/**
+ * Interns strings, so that each distinct value is held once however many objects refer to it.  Interned
+ * strings live as long as the pool and are never removed.  A pool is thread safe.
+ */
+class StringPool {
+    public:
+        StringPool();
+
+        /**
+         * Gets the pooled copy of a string, adding it if necessary.
+         *
+         * @param value The string.
+         * @return The pooled string, valid for the lifetime of the pool.
+         */
+        const std::string* intern(const std::string& value);
+
+        /**
+         * Gets the number of distinct strings in the pool.
+         */
+        size_t size() const;
+
+    private:
+        mutable std::mutex mutex;
+        std::unordered_set<std::string> strings;
+
+        // no copying
+        StringPool(const StringPool&);
+        StringPool& operator=(const StringPool&);
+};
+
+}
+}
+
+#endif // MARKET_STRINGPOOL_H
@@ -0,0 +1,98 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef METRICS_HISTOGRAM_H
+#define METRICS_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace greentop {
+namespace metrics {
+
+/**
+ * A latency histogram in the style of HdrHistogram: values below 64 each have a bucket, and each power of two
+ * above that is split into 32 buckets, so a value read back from the histogram is within 1/32 of the value
+ * recorded.  Values up to MAX_VALUE (about 137 seconds in nanoseconds) are held in a fixed 8KB of buckets;
+ * larger values are counted as MAX_VALUE.
+ *
+ * record() may only be called by one thread at a time, which lets it update the buckets without atomic
+ * read-modify-write instructions.  Any number of threads can read the histogram meanwhile.
+ */
+class Histogram {
+    public:
+        /** The number of bits of each value kept, after the leading bit. */
+        static const unsigned SUB_BUCKET_BITS = 5;
+        static const uint64_t MAX_VALUE = (uint64_t(1) << 37) - 1;
+        static const size_t BUCKETS = (37 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+        Histogram();
+
+        Histogram(const Histogram& other);
+
+        Histogram& operator=(const Histogram& other);
+
+        /**
+         * Record a value.  Not safe to call from more than one thread at once.
+         */
+        void record(uint64_t value);
+
+        /**
+         * Add the values recorded by another histogram.
+         */
+        void add(const Histogram& other);
+
+        void clear();
+
+        uint64_t getCount() const;
+
+        /**
+         * Gets the sum of the values recorded, exactly.
+         */
+        uint64_t getSum() const;
+
+        uint64_t getMax() const;
+
+        double getMean() const;
+
+        /**
+         * Gets the value below which a percentage of the values recorded fall.
+         *
+         * @param percentile The percentage, eg 99.9.
+         * @return The highest value in the bucket the percentile falls in, or 0 if nothing has been recorded.
+         */
+        uint64_t getValueAtPercentile(double percentile) const;
+
+        /**
+         * Add to a value only the calling thread writes to, without an atomic read-modify-write.
+         */
+        static void increase(std::atomic<uint64_t>& value, uint64_t n);
+
+        /**
+         * Gets the bucket a value is counted in.
+         */
+        static size_t getIndex(uint64_t value);
+
+        /**
+         * Gets the lowest value counted in a bucket.
+         */
+        static uint64_t getLowestValue(size_t index);
+
+        /**
+         * Gets the highest value counted in a bucket.
+         */
+        static uint64_t getHighestValue(size_t index);
+
+    private:
+        std::atomic<uint64_t> counts[BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+};
+
+}
+}
+
+#endif // METRICS_HISTOGRAM_H
@@ -0,0 +1,141 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef METRICS_METRICSREGISTRY_H
+#define METRICS_METRICSREGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/RequestTiming.h"
+#include "greentop/metrics/Histogram.h"
+
+namespace greentop {
+namespace metrics {
+
+/**
+ * Counts the requests made by an ExchangeApi per operation: calls, errors by fault code, bytes, and histograms
+ * of the time taken end to end, on the network and parsing the response.
+ *
+ *     metrics::MetricsRegistry metrics;
+ *     exchangeApi.setTimingCallback([&](const RequestTiming& timing) {
+ *         metrics.record(timing);
+ *     });
+ *     ...
+ *     metrics.writePrometheus("/var/lib/node_exporter/greentop.prom");
+ *
+ * Each thread that records gets its own shard of counters, so threads don't contend for locks or cache lines;
+ * reading the metrics adds the shards up.  Recording a successful request to an operation the thread has
+ * recorded before takes no locks.  A thread's first request, its first to each operation and every error lock
+ * the registry or the thread's shard, so the count of each fault code can be read safely.  A shard is kept
+ * until the registry is destroyed, so counts recorded by threads that have exited are not lost.
+ */
+class MetricsRegistry {
+    public:
+
+        /**
+         * The metrics of one operation.
+         */
+        struct Operation {
+            Operation();
+
+            uint64_t calls;
+            /** Requests that failed, whether in transport or with a fault. */
+            uint64_t errors;
+            /** The number of failures by fault code, or "curl:" and the curl code for transport failures. */
+            std::map<std::string, uint64_t> faults;
+            uint64_t bytesSent;
+            uint64_t bytesReceived;
+            /** From entering the operation until the response was parsed, in nanoseconds. */
+            Histogram total;
+            /** curl's transfer time, in nanoseconds. */
+            Histogram network;
+            /** Parsing the response, in nanoseconds. */
+            Histogram parse;
+        };
+
+        MetricsRegistry();
+
+        /**
+         * Record a request.  Can be called by any number of threads at once.
+         */
+        void record(const RequestTiming& timing);
+
+        /**
+         * Gets the metrics of each operation, added up over all threads.
+         */
+        std::map<std::string, Operation> getSnapshot() const;
+
+        /**
+         * Write the metrics in the Prometheus text exposition format.  Times are in seconds, with the
+         * histograms written as summaries.
+         */
+        void writePrometheus(std::ostream& stream) const;
+
+        /**
+         * Gets the metrics in the Prometheus text exposition format, eg for a callback that serves them.
+         */
+        std::string getPrometheusText() const;
+
+        /**
+         * Write the metrics in the Prometheus text exposition format to a file.  The file is written under a
+         * temporary name then renamed, so a reader never sees it half written.
+         *
+         * @throws std::runtime_error if the file can't be written.
+         */
+        void writePrometheus(const std::string& fileName) const;
+
+    private:
+        struct Counters {
+            Counters();
+
+            std::atomic<uint64_t> calls;
+            std::atomic<uint64_t> errors;
+            std::atomic<uint64_t> bytesSent;
+            std::atomic<uint64_t> bytesReceived;
+            Histogram total;
+            Histogram network;
+            Histogram parse;
+            /** Guarded by the shard's mutex. */
+            std::map<std::string, uint64_t> faults;
+        };
+
+        /**
+         * The counters of one thread.  Only that thread changes them, and only it adds operations, under the
+         * mutex so that readers can look at them meanwhile.
+         */
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::unique_ptr<Counters>> operations;
+        };
+
+        static const double QUANTILES[];
+
+        static std::atomic<uint64_t> nextId;
+
+        /** Identifies the registry to threads' shard lookups, never reused unlike its address. */
+        const uint64_t id;
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<Shard>> shards;
+
+        Shard& getShard();
+        static void writeSummary(std::ostream& stream, const std::string& name, const std::string& help,
+            const std::map<std::string, Operation>& operations, Histogram Operation::* histogram);
+
+        // no copying
+        MetricsRegistry(const MetricsRegistry&);
+        MetricsRegistry& operator=(const MetricsRegistry&);
+};
+
+}
+}
+
+#endif // METRICS_METRICSREGISTRY_H
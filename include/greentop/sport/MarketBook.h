@@ -15,6 +15,7 @@
 #include "greentop/Time.h"
 #include "greentop/sport/KeyLineDescription.h"
 #include "greentop/sport/Runner.h"
+#include "greentop/sport/RunnerIndex.h"
 #include "greentop/sport/enum/MarketStatus.h"
 
 namespace greentop {
@@ -101,6 +102,16 @@ class MarketBook : public JsonMember {
         const std::vector<Runner>& getRunners() const;
         void setRunners(const std::vector<Runner>& runners);
 
+        /**
+         * Find a runner in getRunners() using an index built when the runners are set, rather than by searching.
+         *
+         * @param selectionId The selection id.
+         * @param handicap The handicap, 0 except in Asian handicap markets.
+         * @return The runner, or NULL if there is no such runner.  The pointer is invalidated by anything that
+         *         replaces the runners, eg fromJson() or setRunners().
+         */
+        const Runner* getRunner(int64_t selectionId, double handicap = 0) const;
+
         const KeyLineDescription& getKeyLineDescription() const;
         void setKeyLineDescription(const KeyLineDescription& keyLineDescription);
 
@@ -177,6 +188,10 @@ class MarketBook : public JsonMember {
          * Information about the runners (selections) in the market.
          */
         std::vector<Runner> runners;
+        /**
+         * Positions of the runners by selection id and handicap.
+         */
+        RunnerIndex runnerIndex;
         /**
          * Description of a markets key line for valid market types
          */
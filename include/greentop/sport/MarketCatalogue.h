@@ -18,6 +18,7 @@
 #include "greentop/sport/EventType.h"
 #include "greentop/sport/MarketDescription.h"
 #include "greentop/sport/RunnerCatalog.h"
+#include "greentop/sport/RunnerIndex.h"
 
 namespace greentop {
 /**
@@ -61,6 +62,16 @@ class MarketCatalogue : public JsonMember {
         const std::vector<RunnerCatalog>& getRunners() const;
         void setRunners(const std::vector<RunnerCatalog>& runners);
 
+        /**
+         * Find a runner in getRunners() using an index built when the runners are set, rather than by searching.
+         *
+         * @param selectionId The selection id.
+         * @param handicap The handicap, 0 except in Asian handicap markets.
+         * @return The runner, or NULL if there is no such runner.  The pointer is invalidated by anything that
+         *         replaces the runners, eg fromJson() or setRunners().
+         */
+        const RunnerCatalog* getRunner(int64_t selectionId, double handicap = 0) const;
+
         const EventType& getEventType() const;
         void setEventType(const EventType& eventType);
 
@@ -97,6 +108,10 @@ class MarketCatalogue : public JsonMember {
          * The runners (selections) contained in the market
          */
         std::vector<RunnerCatalog> runners;
+        /**
+         * Positions of the runners by selection id and handicap.
+         */
+        RunnerIndex runnerIndex;
         /**
          * The Event Type the market is contained within
          */
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef SPORT_RUNNERINDEX_H
+#define SPORT_RUNNERINDEX_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace greentop {
+
+/**
+ * Maps (selection id, handicap) to a position in a vector of runners, eg MarketBook::getRunners() or
+ * MarketCatalogue::getRunners().  The index is a flat, open addressed hash table holding positions rather than
+ * pointers, so it stays valid when the object owning the runners is copied or moved.  It must be rebuilt
+ * whenever the runners change.
+ *
+ * A runner without a selection id isn't indexed, a missing handicap is treated as 0.  If the same key appears
+ * more than once the first runner wins, as it would with a linear search.
+ */
+class RunnerIndex {
+    public:
+        /** Returned by find() if there is no such runner. */
+        static const int32_t NOT_FOUND = -1;
+
+        RunnerIndex();
+
+        /**
+         * Index a vector of runners, replacing the current contents.
+         *
+         * @param runners Runner or RunnerCatalog objects.
+         */
+        template <typename T>
+        void build(const std::vector<T>& runners) {
+            reset(runners.size());
+            for (size_t i = 0; i < runners.size(); ++i) {
+                const T& runner = runners[i];
+                if (runner.getSelectionId().isValid()) {
+                    insert(runner.getSelectionId().getValue(),
+                        runner.getHandicap().isValid() ? runner.getHandicap().getValue() : 0,
+                        static_cast<int32_t>(i));
+                }
+            }
+        }
+
+        /**
+         * Find a runner.
+         *
+         * @param selectionId The selection id.
+         * @param handicap The handicap, 0 except in Asian handicap markets.
+         * @return The position of the runner, or NOT_FOUND.
+         */
+        int32_t find(int64_t selectionId, double handicap = 0) const {
+            if (slots.empty()) {
+                return NOT_FOUND;
+            }
+            // adding 0 turns -0.0 into 0.0, so that both hash to the same slot.
+            handicap += 0.0;
+            for (size_t i = hash(selectionId, handicap) & mask; ; i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (slot.position == NOT_FOUND ||
+                    (slot.selectionId == selectionId && slot.handicap == handicap)) {
+                    return slot.position;
+                }
+            }
+        }
+
+        void clear();
+
+        /**
+         * Gets the number of runners indexed.
+         */
+        size_t size() const;
+
+    private:
+        struct Slot {
+            int64_t selectionId;
+            double handicap;
+            int32_t position;
+        };
+
+        std::vector<Slot> slots;
+        size_t mask;
+        size_t count;
+
+        static size_t hash(int64_t selectionId, double handicap) {
+            uint64_t bits;
+            std::memcpy(&bits, &handicap, sizeof(bits));
+            uint64_t h = (static_cast<uint64_t>(selectionId) ^ (bits >> 32) ^ bits) * 0x9e3779b97f4a7c15ULL;
+            return static_cast<size_t>(h >> 32);
+        }
+        void reset(size_t size);
+        void insert(int64_t selectionId, double handicap, int32_t position);
+};
+
+}
+
+#endif // SPORT_RUNNERINDEX_H
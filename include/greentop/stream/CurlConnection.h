@@ -0,0 +1,47 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_CURLCONNECTION_H
+#define STREAM_CURLCONNECTION_H
+
+#include <curl/curl.h>
+
+#include "greentop/curl/ICurl.h"
+#include "greentop/stream/IConnection.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * A connection using libcurl in connect-only mode, so TLS is handled by libcurl.
+ */
+class CurlConnection : public IConnection {
+    public:
+        CurlConnection();
+
+        virtual void open(const std::string& url);
+
+        virtual void close();
+
+        virtual bool isOpen() const;
+
+        virtual void send(const std::string& data);
+
+        virtual size_t receive(char* buffer, size_t length, int timeoutMs);
+
+        virtual ~CurlConnection();
+
+    private:
+        CurlHandle handle;
+
+        bool wait(bool forRead, int timeoutMs) const;
+
+        // no copying
+        CurlConnection(const CurlConnection&);
+        CurlConnection& operator=(const CurlConnection&);
+};
+
+}
+}
+
+#endif // STREAM_CURLCONNECTION_H
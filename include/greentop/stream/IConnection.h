@@ -0,0 +1,50 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_ICONNECTION_H
+#define STREAM_ICONNECTION_H
+
+#include <cstddef>
+#include <string>
+
+namespace greentop {
+namespace stream {
+
+/**
+ * A persistent, bidirectional byte stream to the Exchange Stream API.
+ */
+class IConnection {
+    public:
+
+        /**
+         * Open the connection.  Throws std::runtime_error on failure.
+         *
+         * @param url Eg "https://stream-api.betfair.com:443", or "http://127.0.0.1:9000" for an unencrypted
+         *        connection to a local stand-in server.
+         */
+        virtual void open(const std::string& url) = 0;
+
+        virtual void close() = 0;
+
+        virtual bool isOpen() const = 0;
+
+        /**
+         * Send all of the given data.  Throws std::runtime_error on failure.
+         */
+        virtual void send(const std::string& data) = 0;
+
+        /**
+         * Receive whatever data is available, waiting up to timeoutMs for some to arrive.  Throws
+         * std::runtime_error if the connection has been closed or has failed.
+         *
+         * @return The number of bytes received, 0 if the timeout expired.
+         */
+        virtual size_t receive(char* buffer, size_t length, int timeoutMs) = 0;
+
+        virtual ~IConnection() {}
+};
+
+}
+}
+
+#endif // STREAM_ICONNECTION_H
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_MARKETCACHE_H
+#define STREAM_MARKETCACHE_H
+
+#include <json/json.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "greentop/Optional.h"
+#include "greentop/sport/MarketBook.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * An in-memory image of the markets of a stream subscription, built by applying market change (mcm) messages.
+ * Views of the cached markets are returned as MarketBooks so code written against listMarketBook can consume
+ * them unchanged.
+ *
+ * A market is removed once its definition's status is CLOSED, when the next message is applied, so that the
+ * change that closed it can still be read.
+ */
+class MarketCache {
+    public:
+        MarketCache();
+
+        /**
+         * Apply all the market changes of an mcm message.
+         *
+         * @param message The mcm message.
+         * @return The ids of the markets that changed.
+         */
+        std::vector<std::string> applyMarketChangeMessage(const Json::Value& message);
+
+        /**
+         * Apply a single market change, an element of the "mc" array of an mcm message.
+         *
+         * @param marketChange The market change.
+         * @param publishTime The publish time (pt) of the message, milliseconds since the epoch.
+         */
+        void applyMarketChange(const Json::Value& marketChange, int64_t publishTime);
+
+        bool hasMarket(const std::string& marketId) const;
+
+        /**
+         * Gets a view of a market.  Best offers are taken from the virtual (display) ladder if subscribed to,
+         * else from the best offers ladder, else from the full depth ladder.
+         *
+         * @param marketId The market id.
+         * @return The market book, or an empty book if the market isn't cached.
+         */
+        MarketBook getMarketBook(const std::string& marketId) const;
+
+        std::vector<std::string> getMarketIds() const;
+
+        /**
+         * Gets the publish time of the last change to a market.
+         *
+         * @return Milliseconds since the epoch, 0 if the market isn't cached.
+         */
+        int64_t getPublishTime(const std::string& marketId) const;
+
+        /**
+         * Gets the market definition as last received.
+         */
+        Json::Value getMarketDefinition(const std::string& marketId) const;
+
+        void remove(const std::string& marketId);
+
+        void clear();
+
+        size_t size() const;
+
+    private:
+        typedef std::map<double, double> PriceLadder;
+        typedef std::map<int, std::pair<double, double>> LevelLadder;
+
+        struct RunnerState {
+            int64_t selectionId;
+            double handicap;
+            PriceLadder availableToBack;
+            PriceLadder availableToLay;
+            PriceLadder traded;
+            LevelLadder bestAvailableToBack;
+            LevelLadder bestAvailableToLay;
+            LevelLadder bestDisplayAvailableToBack;
+            LevelLadder bestDisplayAvailableToLay;
+            PriceLadder spBackStakeTaken;
+            PriceLadder spLayLiabilityTaken;
+            Optional<double> lastPriceTraded;
+            Optional<double> totalMatched;
+            Optional<double> spNearPrice;
+            Optional<double> spFarPrice;
+        };
+
+        typedef std::pair<int64_t, double> RunnerKey;
+
+        struct MarketState {
+            Json::Value definition;
+            Optional<double> totalMatched;
+            int64_t publishTime;
+            std::map<RunnerKey, RunnerState> runners;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, MarketState> markets;
+        /** The markets closed by the last message applied, to be removed when the next is applied. */
+        std::vector<std::string> closedMarketIds;
+
+        static void applyRunnerChange(const Json::Value& runnerChange, RunnerState& runner);
+        static MarketBook toMarketBook(const std::string& marketId, const MarketState& market);
+};
+
+}
+}
+
+#endif // STREAM_MARKETCACHE_H
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef STREAM_MARKETDATAFILTER_H
+#define STREAM_MARKETDATAFILTER_H
+
+#include <json/json.h>
+#include <set>
+#include <string>
+
+#include "greentop/JsonMember.h"
+#include "greentop/Optional.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * The market data fields delivered by a stream market subscription.
+ */
+class MarketDataFilter : public JsonMember {
+    public:
+
+        MarketDataFilter(const std::set<std::string>& fields = std::set<std::string>(),
+            const Optional<int32_t>& ladderLevels = Optional<int32_t>());
+
+        virtual void fromJson(const Json::Value& json);
+
+        virtual Json::Value toJson() const;
+
+        virtual bool isValid() const;
+
+        const std::set<std::string>& getFields() const;
+        void setFields(const std::set<std::string>& fields);
+
+        const Optional<int32_t>& getLadderLevels() const;
+        void setLadderLevels(const Optional<int32_t>& ladderLevels);
+
+
+    private:
+        /**
+         * EX_BEST_OFFERS_DISP, EX_BEST_OFFERS, EX_ALL_OFFERS, EX_TRADED, EX_TRADED_VOL, EX_LTP, EX_MARKET_DEF, SP_TRADED, SP_PROJECTED.
+         */
+        std::set<std::string> fields;
+        /**
+         * The depth of the best offers ladders, 1 to 10.
+         */
+        Optional<int32_t> ladderLevels;
+};
+
+}
+}
+
+#endif // STREAM_MARKETDATAFILTER_H
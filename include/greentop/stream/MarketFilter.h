@@ -0,0 +1,118 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef STREAM_MARKETFILTER_H
+#define STREAM_MARKETFILTER_H
+
+#include <json/json.h>
+#include <set>
+#include <string>
+
+#include "greentop/JsonMember.h"
+#include "greentop/Optional.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * Selects the markets of a stream market subscription.
+ */
+class MarketFilter : public JsonMember {
+    public:
+
+        MarketFilter(const std::set<std::string>& marketIds = std::set<std::string>(),
+            const Optional<bool>& bspMarket = Optional<bool>(),
+            const std::set<std::string>& bettingTypes = std::set<std::string>(),
+            const std::set<std::string>& eventTypeIds = std::set<std::string>(),
+            const std::set<std::string>& eventIds = std::set<std::string>(),
+            const Optional<bool>& turnInPlayEnabled = Optional<bool>(),
+            const std::set<std::string>& marketTypes = std::set<std::string>(),
+            const std::set<std::string>& venues = std::set<std::string>(),
+            const std::set<std::string>& countryCodes = std::set<std::string>(),
+            const std::set<std::string>& raceTypes = std::set<std::string>());
+
+        virtual void fromJson(const Json::Value& json);
+
+        virtual Json::Value toJson() const;
+
+        virtual bool isValid() const;
+
+        const std::set<std::string>& getMarketIds() const;
+        void setMarketIds(const std::set<std::string>& marketIds);
+
+        const Optional<bool>& getBspMarket() const;
+        void setBspMarket(const Optional<bool>& bspMarket);
+
+        const std::set<std::string>& getBettingTypes() const;
+        void setBettingTypes(const std::set<std::string>& bettingTypes);
+
+        const std::set<std::string>& getEventTypeIds() const;
+        void setEventTypeIds(const std::set<std::string>& eventTypeIds);
+
+        const std::set<std::string>& getEventIds() const;
+        void setEventIds(const std::set<std::string>& eventIds);
+
+        const Optional<bool>& getTurnInPlayEnabled() const;
+        void setTurnInPlayEnabled(const Optional<bool>& turnInPlayEnabled);
+
+        const std::set<std::string>& getMarketTypes() const;
+        void setMarketTypes(const std::set<std::string>& marketTypes);
+
+        const std::set<std::string>& getVenues() const;
+        void setVenues(const std::set<std::string>& venues);
+
+        const std::set<std::string>& getCountryCodes() const;
+        void setCountryCodes(const std::set<std::string>& countryCodes);
+
+        const std::set<std::string>& getRaceTypes() const;
+        void setRaceTypes(const std::set<std::string>& raceTypes);
+
+
+    private:
+        /**
+         * The market ids to subscribe to.
+         */
+        std::set<std::string> marketIds;
+        /**
+         * Restrict to BSP or non-BSP markets.
+         */
+        Optional<bool> bspMarket;
+        /**
+         * Betting types, eg ODDS, LINE, RANGE, ASIAN_HANDICAP_DOUBLE_LINE.
+         */
+        std::set<std::string> bettingTypes;
+        /**
+         * The event type (sport) ids.
+         */
+        std::set<std::string> eventTypeIds;
+        /**
+         * The event ids.
+         */
+        std::set<std::string> eventIds;
+        /**
+         * Restrict to markets that will or will not turn in play.
+         */
+        Optional<bool> turnInPlayEnabled;
+        /**
+         * Market types, eg MATCH_ODDS, WIN.
+         */
+        std::set<std::string> marketTypes;
+        /**
+         * Venues, horse racing only.
+         */
+        std::set<std::string> venues;
+        /**
+         * Country codes of the events.
+         */
+        std::set<std::string> countryCodes;
+        /**
+         * Race types, eg Hurdle, Flat.
+         */
+        std::set<std::string> raceTypes;
+};
+
+}
+}
+
+#endif // STREAM_MARKETFILTER_H
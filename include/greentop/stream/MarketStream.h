@@ -0,0 +1,67 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_MARKETSTREAM_H
+#define STREAM_MARKETSTREAM_H
+
+#include <string>
+#include <vector>
+
+#include "greentop/stream/MarketCache.h"
+#include "greentop/stream/MarketDataFilter.h"
+#include "greentop/stream/MarketFilter.h"
+#include "greentop/stream/StreamClient.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * Market data client for the Exchange Stream API.  Subscribes to the markets matching a filter and keeps a
+ * MarketCache up to date from the mcm messages received.  Segmented messages are applied as they arrive but
+ * the change callback is only called once the last segment has been applied, so it always sees a consistent
+ * image.
+ *
+ *     stream::MarketStream marketStream(exchangeApi, marketFilter, marketDataFilter);
+ *     marketStream.setChangeCallback([&](const std::vector<std::string>& marketIds) {
+ *         for (const std::string& marketId : marketIds) {
+ *             MarketBook marketBook = marketStream.getCache().getMarketBook(marketId);
+ *         }
+ *     });
+ *     marketStream.start();
+ */
+class MarketStream : public StreamClient {
+    public:
+        MarketStream(const ExchangeApi& exchangeApi, const MarketFilter& marketFilter,
+            const MarketDataFilter& marketDataFilter,
+            std::unique_ptr<IConnection>&& connection = std::unique_ptr<IConnection>(new CurlConnection()));
+
+        MarketStream(const std::string& applicationKey, const std::string& session,
+            const MarketFilter& marketFilter, const MarketDataFilter& marketDataFilter,
+            std::unique_ptr<IConnection>&& connection = std::unique_ptr<IConnection>(new CurlConnection()));
+
+        /**
+         * Destructor.  Stops the stream thread before the cache is destroyed.
+         */
+        virtual ~MarketStream();
+
+        const MarketCache& getCache() const;
+
+    protected:
+        virtual Json::Value buildSubscription() const;
+
+        virtual std::string getChangeOp() const;
+
+        virtual std::vector<std::string> applyChange(const Json::Value& message);
+
+        virtual void clearCache();
+
+    private:
+        MarketFilter marketFilter;
+        MarketDataFilter marketDataFilter;
+        MarketCache cache;
+};
+
+}
+}
+
+#endif // STREAM_MARKETSTREAM_H
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_ORDERCACHE_H
+#define STREAM_ORDERCACHE_H
+
+#include <json/json.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "greentop/sport/CurrentOrderSummary.h"
+#include "greentop/sport/Order.h"
+#include "greentop/sport/PriceSize.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * An in-memory image of the account's orders, built by applying order change (ocm) messages.  Orders are
+ * keyed by market, selection (with handicap) and bet id and are returned as CurrentOrderSummary or Order
+ * objects so code written against listCurrentOrders or listMarketBook can consume them unchanged.
+ */
+class OrderCache {
+    public:
+        OrderCache();
+
+        /**
+         * Apply all the order market changes of an ocm message.
+         *
+         * @param message The ocm message.
+         * @return The ids of the markets that changed.
+         */
+        std::vector<std::string> applyOrderChangeMessage(const Json::Value& message);
+
+        /**
+         * Apply a single order market change, an element of the "oc" array of an ocm message.
+         */
+        void applyOrderMarketChange(const Json::Value& orderMarketChange);
+
+        bool hasMarket(const std::string& marketId) const;
+
+        /**
+         * Whether the market has closed.  Closed markets are kept until removed.
+         */
+        bool isMarketClosed(const std::string& marketId) const;
+
+        std::vector<std::string> getMarketIds() const;
+
+        /**
+         * Gets an order by bet id.
+         *
+         * @param betId The bet id.
+         * @param order Set to the order if it is found.
+         * @return Whether the order was found.
+         */
+        bool getCurrentOrder(const std::string& betId, CurrentOrderSummary& order) const;
+
+        /**
+         * Gets all the cached orders.
+         */
+        std::vector<CurrentOrderSummary> getCurrentOrders() const;
+
+        /**
+         * Gets the cached orders on a market.
+         */
+        std::vector<CurrentOrderSummary> getCurrentOrders(const std::string& marketId) const;
+
+        /**
+         * Gets the cached orders on a runner, in the form returned in MarketBook runners.
+         */
+        std::vector<Order> getOrders(const std::string& marketId, int64_t selectionId, double handicap = 0) const;
+
+        /**
+         * Gets the matched backs of a runner, aggregated by price.
+         */
+        std::vector<PriceSize> getMatchedBacks(const std::string& marketId, int64_t selectionId,
+            double handicap = 0) const;
+
+        /**
+         * Gets the matched lays of a runner, aggregated by price.
+         */
+        std::vector<PriceSize> getMatchedLays(const std::string& marketId, int64_t selectionId,
+            double handicap = 0) const;
+
+        void remove(const std::string& marketId);
+
+        void clear();
+
+        /**
+         * Gets the number of cached orders.
+         */
+        size_t size() const;
+
+    private:
+        typedef std::pair<int64_t, double> RunnerKey;
+
+        struct RunnerOrders {
+            std::map<std::string, CurrentOrderSummary> orders;
+            std::map<double, double> matchedBacks;
+            std::map<double, double> matchedLays;
+        };
+
+        struct MarketOrders {
+            bool closed;
+            std::map<RunnerKey, RunnerOrders> runners;
+        };
+
+        struct BetLocation {
+            std::string marketId;
+            RunnerKey runner;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, MarketOrders> markets;
+        std::unordered_map<std::string, BetLocation> bets;
+
+        const RunnerOrders* findRunner(const std::string& marketId, const RunnerKey& key) const;
+        void removeBets(const RunnerOrders& runner);
+
+        static CurrentOrderSummary toCurrentOrderSummary(const std::string& marketId, const RunnerKey& key,
+            const Json::Value& unmatchedOrder);
+};
+
+}
+}
+
+#endif // STREAM_ORDERCACHE_H
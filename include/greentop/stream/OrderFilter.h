@@ -0,0 +1,62 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef STREAM_ORDERFILTER_H
+#define STREAM_ORDERFILTER_H
+
+#include <json/json.h>
+#include <set>
+#include <string>
+
+#include "greentop/JsonMember.h"
+#include "greentop/Optional.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * Restricts the orders delivered by a stream order subscription.
+ */
+class OrderFilter : public JsonMember {
+    public:
+
+        OrderFilter(const Optional<bool>& includeOverallPosition = Optional<bool>(),
+            const std::set<std::string>& customerStrategyRefs = std::set<std::string>(),
+            const Optional<bool>& partitionMatchedByStrategyRef = Optional<bool>());
+
+        virtual void fromJson(const Json::Value& json);
+
+        virtual Json::Value toJson() const;
+
+        virtual bool isValid() const;
+
+        const Optional<bool>& getIncludeOverallPosition() const;
+        void setIncludeOverallPosition(const Optional<bool>& includeOverallPosition);
+
+        const std::set<std::string>& getCustomerStrategyRefs() const;
+        void setCustomerStrategyRefs(const std::set<std::string>& customerStrategyRefs);
+
+        const Optional<bool>& getPartitionMatchedByStrategyRef() const;
+        void setPartitionMatchedByStrategyRef(const Optional<bool>& partitionMatchedByStrategyRef);
+
+
+    private:
+        /**
+         * Include the matched ladders (mb, ml) of all orders, defaults to true.
+         */
+        Optional<bool> includeOverallPosition;
+        /**
+         * Only orders placed with one of these customer strategy references.
+         */
+        std::set<std::string> customerStrategyRefs;
+        /**
+         * Also include matched ladders partitioned by customer strategy reference.
+         */
+        Optional<bool> partitionMatchedByStrategyRef;
+};
+
+}
+}
+
+#endif // STREAM_ORDERFILTER_H
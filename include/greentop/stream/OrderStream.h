@@ -0,0 +1,56 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_ORDERSTREAM_H
+#define STREAM_ORDERSTREAM_H
+
+#include <string>
+#include <vector>
+
+#include "greentop/stream/OrderCache.h"
+#include "greentop/stream/OrderFilter.h"
+#include "greentop/stream/StreamClient.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * Order client for the Exchange Stream API.  Subscribes to the account's orders and keeps an OrderCache up to
+ * date from the ocm messages received, so order state doesn't need to be polled with listCurrentOrders.  As
+ * with MarketStream the change callback is called once each complete (possibly segmented) message has been
+ * applied.
+ */
+class OrderStream : public StreamClient {
+    public:
+        OrderStream(const ExchangeApi& exchangeApi, const OrderFilter& orderFilter = OrderFilter(),
+            std::unique_ptr<IConnection>&& connection = std::unique_ptr<IConnection>(new CurlConnection()));
+
+        OrderStream(const std::string& applicationKey, const std::string& session,
+            const OrderFilter& orderFilter = OrderFilter(),
+            std::unique_ptr<IConnection>&& connection = std::unique_ptr<IConnection>(new CurlConnection()));
+
+        /**
+         * Destructor.  Stops the stream thread before the cache is destroyed.
+         */
+        virtual ~OrderStream();
+
+        const OrderCache& getCache() const;
+
+    protected:
+        virtual Json::Value buildSubscription() const;
+
+        virtual std::string getChangeOp() const;
+
+        virtual std::vector<std::string> applyChange(const Json::Value& message);
+
+        virtual void clearCache();
+
+    private:
+        OrderFilter orderFilter;
+        OrderCache cache;
+};
+
+}
+}
+
+#endif // STREAM_ORDERSTREAM_H
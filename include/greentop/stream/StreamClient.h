@@ -0,0 +1,214 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef STREAM_STREAMCLIENT_H
+#define STREAM_STREAMCLIENT_H
+
+#include <atomic>
+#include <functional>
+#include <json/json.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+#include "greentop/stream/CurlConnection.h"
+#include "greentop/stream/IConnection.h"
+
+namespace greentop {
+namespace stream {
+
+/**
+ * Base class for Exchange Stream API clients.  Handles the connection, authentication with the session of an
+ * ExchangeApi (or an explicit app key and session token), the CRLF delimited framing, heartbeat timeouts and
+ * reconnection.  On reconnect the subscription is resent with the last initialClk and clk so the server only
+ * sends what was missed.
+ *
+ * Subclasses build the subscription message and apply the change messages to their cache.  Segmented messages
+ * are applied as they arrive but the change callback is only called once the last segment has been applied,
+ * so it always sees a consistent image.
+ */
+class StreamClient {
+    public:
+        /** The production end point. */
+        static const std::string END_POINT;
+        /** The integration (test) end point. */
+        static const std::string INTEGRATION_END_POINT;
+
+        typedef std::function<void(const std::string& errorCode, const std::string& errorMessage)> ErrorCallback;
+
+        typedef std::function<void(const std::vector<std::string>& marketIds)> ChangeCallback;
+
+        /**
+         * Constructor.  The application key and session token are taken from the ExchangeApi each time the
+         * client connects.
+         *
+         * @param exchangeApi A logged in ExchangeApi.  It must outlive the client.
+         * @param connection The connection to use.
+         */
+        StreamClient(const ExchangeApi& exchangeApi,
+            std::unique_ptr<IConnection>&& connection = std::unique_ptr<IConnection>(new CurlConnection()));
+
+        /**
+         * Constructor.
+         *
+         * @param applicationKey The application key.
+         * @param session The session token (ssoid).
+         * @param connection The connection to use.
+         */
+        StreamClient(const std::string& applicationKey, const std::string& session,
+            std::unique_ptr<IConnection>&& connection = std::unique_ptr<IConnection>(new CurlConnection()));
+
+        virtual ~StreamClient();
+
+        /**
+         * Sets the end point, eg "http://127.0.0.1:9000" to use a local stand-in server.
+         */
+        void setEndPoint(const std::string& endPoint);
+
+        /**
+         * Sets the heartbeat interval requested from the server.  If nothing at all is received for three
+         * intervals the connection is considered dead and is re-established.  Defaults to 5000.
+         */
+        void setHeartbeatMs(int heartbeatMs);
+
+        /**
+         * Sets the conflation rate requested from the server, 0 for none.  Defaults to 0.
+         */
+        void setConflateMs(int conflateMs);
+
+        /**
+         * Sets the delay before reconnecting after a connection fails.  Defaults to 1000.
+         */
+        void setReconnectDelayMs(int reconnectDelayMs);
+
+        /**
+         * Sets a function to call when the connection fails or the server reports an error.  It is called on the
+         * stream thread.
+         */
+        void setErrorCallback(const ErrorCallback& errorCallback);
+
+        /**
+         * Sets a function to call with the ids of the markets changed by each complete message.  It is called on
+         * the stream thread after the cache has been updated.
+         */
+        void setChangeCallback(const ChangeCallback& changeCallback);
+
+        /**
+         * Connect and subscribe on a background thread.
+         */
+        void start();
+
+        /**
+         * Close the connection and stop the background thread.  Subclasses must call it from their destructor,
+         * so the thread doesn't call them once they are destroyed.  If it is called from a callback on the
+         * stream thread, the thread is detached and stops once the callback returns; the client mustn't be
+         * destroyed until it has.
+         */
+        void stop();
+
+        /**
+         * Connect and subscribe, then process messages until stop() is called or a permanent error (eg an
+         * invalid session) occurs.
+         */
+        void run();
+
+        /**
+         * Drop the current connection, forget the clocks and subscribe again from a full image.
+         */
+        void resubscribe();
+
+        /**
+         * Handle a single message received from the server.
+         *
+         * @param message The message without the CRLF terminator.
+         */
+        void processMessage(const std::string& message);
+
+        bool isConnected() const;
+
+        std::string getConnectionId() const;
+
+        std::string getInitialClk() const;
+
+        std::string getClk() const;
+
+        /**
+         * Gets the number of times the connection has been re-established.
+         */
+        uint64_t getReconnects() const;
+
+    protected:
+        /**
+         * Build the subscription message, eg a marketSubscription.  The id, clocks, heartbeatMs and conflateMs
+         * are added by the client.
+         */
+        virtual Json::Value buildSubscription() const = 0;
+
+        /**
+         * Gets the op of the change messages for this subscription, eg "mcm".
+         */
+        virtual std::string getChangeOp() const = 0;
+
+        /**
+         * Apply a change message, or one segment of it, to the cache.  Called on the stream thread.
+         *
+         * @return The ids of the markets changed.
+         */
+        virtual std::vector<std::string> applyChange(const Json::Value& message) = 0;
+
+        /**
+         * Clear the cache, when the next image will replace all cached state.
+         */
+        virtual void clearCache() = 0;
+
+    private:
+        const ExchangeApi* exchangeApi;
+        std::string applicationKey;
+        std::string session;
+        std::unique_ptr<IConnection> connection;
+        std::string endPoint;
+        int heartbeatMs;
+        int conflateMs;
+        int reconnectDelayMs;
+        ErrorCallback errorCallback;
+        ChangeCallback changeCallback;
+
+        mutable std::mutex mutex;
+        std::string connectionId;
+        std::string initialClk;
+        std::string clk;
+        int messageId;
+        std::atomic<bool> running;
+        std::atomic<bool> connected;
+        std::atomic<bool> resubscribeRequested;
+        std::atomic<uint64_t> reconnects;
+        bool permanentFailure;
+        std::thread thread;
+        /** The markets changed by the segments of the message being received. */
+        std::vector<std::string> pendingMarketIds;
+        std::set<std::string> pendingSet;
+
+        /**
+         * Process messages until stopped, reconnecting as needed.  The running flag is set by the caller.
+         */
+        void runLoop();
+        void connect();
+        void send(const Json::Value& message);
+        void reportError(const std::string& errorCode, const std::string& errorMessage);
+        void handleStatus(const Json::Value& message);
+        void handleChange(const Json::Value& message);
+        void reset();
+
+        // no copying
+        StreamClient(const StreamClient&);
+        StreamClient& operator=(const StreamClient&);
+};
+
+}
+}
+
+#endif // STREAM_STREAMCLIENT_H
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_CURRENTORDERPAGINATOR_H
+#define TRADING_CURRENTORDERPAGINATOR_H
+
+#include <functional>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Reads every order matching a listCurrentOrders request, page by page, keeping the next pages in flight
+ * while the caller processes the current one.
+ *
+ * A request that doesn't set orderBy is also split into partitions read side by side: by market if it has
+ * more than one market id, otherwise by time if it has a dateRange with both ends.  The orders of one
+ * partition are delivered in order, but partitions are interleaved.
+ *
+ * Pages overlap by a few records, so an order that moves to an earlier page during the scan, eg because an
+ * order before it completed, is still read.  Orders read twice, because of the overlap or because they moved
+ * to a later page, are only delivered once.
+ *
+ *     trading::CurrentOrderPaginator paginator(exchangeApi);
+ *     paginator.read(ListCurrentOrdersRequest(), [](const CurrentOrderSummary& order) {
+ *         ...
+ *     });
+ */
+class CurrentOrderPaginator {
+    public:
+        typedef std::function<void(const CurrentOrderSummary&)> Callback;
+
+        /** The maximum number of orders listCurrentOrders returns at once. */
+        static const unsigned MAX_RECORDS = 1000;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to call listCurrentOrders.  It must outlive the paginator.
+         */
+        CurrentOrderPaginator(const ExchangeApi& exchangeApi);
+
+        /**
+         * Sets the number of orders asked for at once.  Defaults to MAX_RECORDS.
+         */
+        void setPageSize(unsigned pageSize);
+
+        /**
+         * Sets the number of records a page shares with the page before.  Defaults to 10.
+         */
+        void setPageOverlap(unsigned pageOverlap);
+
+        /**
+         * Sets the maximum number of requests in flight at once.  Defaults to 4.
+         */
+        void setMaxRequests(unsigned maxRequests);
+
+        /**
+         * Sets the maximum number of partitions a request is split into.  Defaults to 4.
+         */
+        void setMaxPartitions(unsigned maxPartitions);
+
+        /**
+         * Read the orders matching a request.  The callback is called on the calling thread.
+         *
+         * @param request The request.  fromRecord and recordCount are set by the paginator.
+         * @param callback Called with each order.
+         * @return The number of orders read.
+         * @throws std::runtime_error if a request fails.
+         */
+        uint64_t read(const ListCurrentOrdersRequest& request, const Callback& callback) const;
+
+        /**
+         * Read the orders matching a request.
+         *
+         * @param request The request.  fromRecord and recordCount are set by the paginator.
+         * @return The orders.
+         * @throws std::runtime_error if a request fails.
+         */
+        std::vector<CurrentOrderSummary> read(const ListCurrentOrdersRequest& request) const;
+
+        /**
+         * Split a request into partitions that can be read side by side.
+         *
+         * @param request The request.
+         * @param maxPartitions The maximum number of partitions.
+         * @return The partitions, or the request itself if it can't be split.
+         */
+        static std::vector<ListCurrentOrdersRequest> partition(const ListCurrentOrdersRequest& request,
+            unsigned maxPartitions);
+
+    private:
+        const ExchangeApi& exchangeApi;
+        unsigned pageSize;
+        unsigned pageOverlap;
+        unsigned maxRequests;
+        unsigned maxPartitions;
+
+        // no copying
+        CurrentOrderPaginator(const CurrentOrderPaginator&);
+        CurrentOrderPaginator& operator=(const CurrentOrderPaginator&);
+};
+
+}
+}
+
+#endif // TRADING_CURRENTORDERPAGINATOR_H
@@ -0,0 +1,209 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_HEARTBEATKEEPER_H
+#define TRADING_HEARTBEATKEEPER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Sends heartbeats on a thread of its own, so that a busy process doesn't miss one and have its unmatched bets
+ * cancelled by the exchange.
+ *
+ * Heartbeats are sent several times per timeout, on a fixed schedule of the steady clock: each beat is
+ * scheduled from when the previous one was due, not when it was sent, so lateness doesn't accumulate.  The
+ * schedule follows the actualTimeoutSeconds the exchange returns.  Each request uses its own curl handle, so a
+ * heartbeat never waits for other requests made with the same ExchangeApi.
+ *
+ * The keeper raises an alarm if a heartbeat fails, if the time left before the exchange would have cancelled
+ * bets was short when a heartbeat got through, if the exchange changes the timeout, or if the exchange says it
+ * has acted on a missed heartbeat.  A separate watchdog thread acts as a dead man's switch: if no heartbeat
+ * has got through by shortly before the exchange's deadline, it raises a DEAD_MAN alarm and calls the dead
+ * man's callback, eg to cancel all orders over another route and stop trading, without waiting for the
+ * exchange to notice.
+ *
+ *     trading::HeartbeatKeeper keeper(exchangeApi, 10);
+ *     keeper.setAlarmCallback([](const trading::HeartbeatKeeper::Status& status) {
+ *         ...
+ *     });
+ *     keeper.setDeadManCallback([&]() {
+ *         // cancel all orders and stop trading
+ *     });
+ *     keeper.start();
+ */
+class HeartbeatKeeper {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        enum Alarm {
+            /** A heartbeat request failed. */
+            HEARTBEAT_FAILED,
+            /** A heartbeat got through with less time left than the margin threshold. */
+            MARGIN_LOW,
+            /** The exchange adopted a timeout other than the one last in effect or asked for. */
+            TIMEOUT_CHANGED,
+            /** The exchange acted on a missed heartbeat, as described by actionPerformed. */
+            ACTION_PERFORMED,
+            /** No heartbeat got through by the dead man's margin before the exchange's deadline. */
+            DEAD_MAN
+        };
+
+        struct Status {
+            Alarm alarm;
+            /** The timeout in effect, 0 if no heartbeat has got through. */
+            int32_t actualTimeoutSeconds;
+            /** The time that was left before the exchange's deadline, negative if it had passed. */
+            std::chrono::milliseconds margin;
+            /** The actionPerformed of the last heartbeat that got through. */
+            ActionPerformed actionPerformed;
+            /** Why the heartbeat failed, for HEARTBEAT_FAILED. */
+            std::string error;
+            /** The number of heartbeats that have failed in a row. */
+            unsigned consecutiveFailures;
+        };
+
+        typedef std::function<void(const Status& status)> AlarmCallback;
+
+        typedef std::function<void()> DeadManCallback;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to send heartbeats.  It must outlive the keeper.
+         * @param preferredTimeoutSeconds The timeout to ask the exchange for, limited to the 10 to 300 seconds
+         *        the exchange accepts.
+         */
+        HeartbeatKeeper(const ExchangeApi& exchangeApi, int32_t preferredTimeoutSeconds = 10);
+
+        /**
+         * Destructor.  Stops the keeper, unregistering the heartbeat.
+         */
+        ~HeartbeatKeeper();
+
+        /**
+         * Sets how many heartbeats are sent per timeout.  Defaults to 4.
+         */
+        void setBeatsPerTimeout(unsigned beatsPerTimeout);
+
+        /**
+         * Sets the fraction of the timeout below which the time left when a heartbeat gets through raises a
+         * MARGIN_LOW alarm.  Defaults to 0.5.
+         */
+        void setMarginThreshold(double marginThreshold);
+
+        /**
+         * Sets how long before the exchange's deadline the dead man's switch is triggered.  Defaults to 2
+         * seconds.
+         */
+        void setDeadManMargin(const std::chrono::milliseconds& deadManMargin);
+
+        /**
+         * Sets the callback told of alarms.  It is called on the keeper's threads, so should return quickly.
+         * Set it before start().
+         */
+        void setAlarmCallback(const AlarmCallback& alarmCallback);
+
+        /**
+         * Sets the callback called when the dead man's switch is triggered.  It is called once per outage, on
+         * the watchdog thread.  Set it before start().
+         */
+        void setDeadManCallback(const DeadManCallback& deadManCallback);
+
+        /**
+         * Start sending heartbeats.
+         */
+        void start();
+
+        /**
+         * Stop sending heartbeats.
+         *
+         * @param unregister Whether to send a heartbeat with a timeout of 0, so the exchange stops expecting
+         *        them and doesn't cancel bets.
+         */
+        void stop(bool unregister = true);
+
+        /**
+         * Gets the timeout in effect, 0 if no heartbeat has got through.
+         */
+        int32_t getActualTimeoutSeconds() const;
+
+        /**
+         * Gets when the last heartbeat that got through was sent.
+         */
+        Clock::time_point getLastDelivered() const;
+
+        /**
+         * Gets the time before the exchange's deadline, or 0 if no heartbeat has got through.
+         */
+        std::chrono::milliseconds getMargin() const;
+
+        /**
+         * Gets the number of heartbeats that got through.
+         */
+        uint64_t getBeats() const;
+
+        /**
+         * Gets the number of heartbeats that failed.
+         */
+        uint64_t getFailures() const;
+
+        /**
+         * Gets the latest a heartbeat has been sent after it was due.
+         */
+        std::chrono::nanoseconds getMaxLateness() const;
+
+    private:
+        const ExchangeApi& exchangeApi;
+        const int32_t preferredTimeoutSeconds;
+        std::atomic<unsigned> beatsPerTimeout;
+        std::atomic<double> marginThreshold;
+        std::atomic<int64_t> deadManMargin;
+        AlarmCallback alarmCallback;
+        DeadManCallback deadManCallback;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        bool running;
+        /** Whether a heartbeat has got through and the dead man's switch hasn't been triggered since. */
+        bool armed;
+        int32_t actualTimeoutSeconds;
+        Clock::time_point lastDelivered;
+        std::thread beatThread;
+        std::thread watchdogThread;
+
+        std::atomic<uint64_t> beats;
+        std::atomic<uint64_t> failures;
+        std::atomic<int64_t> maxLateness;
+
+        void runBeats();
+        void runWatchdog();
+        /**
+         * Send a heartbeat.
+         *
+         * @return Whether it got through.
+         */
+        bool beat(unsigned& consecutiveFailures);
+        void raise(Alarm alarm, std::chrono::milliseconds margin, const ActionPerformed& actionPerformed,
+            const std::string& error, unsigned consecutiveFailures) const;
+
+        // no copying
+        HeartbeatKeeper(const HeartbeatKeeper&);
+        HeartbeatKeeper& operator=(const HeartbeatKeeper&);
+};
+
+}
+}
+
+#endif // TRADING_HEARTBEATKEEPER_H
@@ -0,0 +1,172 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_MASSCANCELLER_H
+#define TRADING_MASSCANCELLER_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Cancels orders in an emergency, as fast as the connection allows.
+ *
+ * cancelAll() cancels every unmatched order on the account with a single cancelOrders request without a market
+ * id.  When only some markets should be cancelled, eg to leave another application's orders alone,
+ * cancelMarkets() cancels the markets set with setMarketIds(), sending a request per market in parallel.  The
+ * request bodies are built when the markets are set, not when they are cancelled.
+ *
+ * The canceller keeps its own curl handles, one per parallel request, whose connections stay open between
+ * requests.  warm() opens them with a harmless request so that a cancel doesn't wait for DNS, TCP and TLS; call
+ * it at start up and every minute or so to stop idle connections being closed.  Requests made by the canceller
+ * bypass ExchangeApi, so they aren't seen by its timing callback or request hook.
+ *
+ *     trading::MassCanceller canceller(exchangeApi);
+ *     canceller.setMarketIds(marketIds);
+ *     canceller.warm();
+ *     ...
+ *     trading::MassCanceller::Result result = canceller.cancelMarkets();
+ *     if (!result.success) {
+ *         result = canceller.cancel(result.failedMarketIds);
+ *     }
+ *
+ * One cancel runs at a time; a thread calling while another cancel is running waits for it.
+ */
+class MassCanceller {
+    public:
+        /**
+         * The outcome of all the requests of a cancel.
+         */
+        struct Result {
+            Result();
+
+            /** Whether every request got a successful report. */
+            bool success;
+            unsigned requests;
+            /** The markets whose request failed, an empty market id for a failed account wide cancel. */
+            std::vector<std::string> failedMarketIds;
+            /** Why each of the failed markets' request failed, in the same order. */
+            std::vector<std::string> errors;
+            /** The reports of the requests that got a response. */
+            std::vector<CancelExecutionReport> reports;
+            /** The total size cancelled by the instructions reported. */
+            double sizeCancelled;
+            /** From the call until the last response. */
+            std::chrono::nanoseconds elapsed;
+        };
+
+        /** The maximum number of instructions in a cancelOrders request. */
+        static const unsigned MAX_INSTRUCTIONS = 60;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api whose application key and session are used.  It must outlive the canceller.
+         * @param connections The number of requests sent in parallel.
+         * @param curl The wrapper around libcurl used to make requests.
+         */
+        MassCanceller(const ExchangeApi& exchangeApi, unsigned connections = 8,
+            std::unique_ptr<ICurl>&& curl = std::unique_ptr<ICurl>(new Curl()));
+
+        /**
+         * Sets the markets cancelled by cancelMarkets(), building their requests.
+         */
+        void setMarketIds(const std::vector<std::string>& marketIds);
+
+        /**
+         * Sets how long a request may take before it fails.  Defaults to 10 seconds.
+         */
+        void setTimeout(const std::chrono::milliseconds& timeout);
+
+        /**
+         * Open each connection, by making a listCurrentOrders request for a bet that doesn't exist.
+         *
+         * @return The number of connections that got a response.
+         */
+        unsigned warm();
+
+        /**
+         * Cancel every unmatched order on the account.
+         */
+        Result cancelAll();
+
+        /**
+         * Cancel every unmatched order on the markets set with setMarketIds().
+         */
+        Result cancelMarkets();
+
+        /**
+         * Cancel every unmatched order on some markets.
+         */
+        Result cancel(const std::vector<std::string>& marketIds);
+
+        /**
+         * Cancel orders by instruction, eg to reduce the size of some, with a request per market per
+         * MAX_INSTRUCTIONS instructions.
+         *
+         * @param instructions The instructions of each market.
+         */
+        Result cancel(const std::map<std::string, std::vector<CancelInstruction>>& instructions);
+
+        /**
+         * Destructor.
+         */
+        ~MassCanceller();
+
+    private:
+        struct Request {
+            std::string marketId;
+            std::string body;
+        };
+
+        const ExchangeApi& exchangeApi;
+        std::unique_ptr<ICurl> curl;
+        const std::string cancelUri;
+        const std::string warmUri;
+        std::atomic<long> timeout;
+
+        /** Held by a cancel or warm() while it uses the connections. */
+        std::mutex mutex;
+        std::vector<CurlHandle> handles;
+        /** The headers set on the handles, and the session they were made with. */
+        std::unique_ptr<SList> headers;
+        std::string ssoid;
+        const Request accountRequest;
+        const std::string warmBody;
+        std::vector<Request> marketRequests;
+
+        /**
+         * Update the handles with the current session and timeout.
+         */
+        void prepare();
+        Result send(const std::vector<Request>& requests);
+        /**
+         * Make a request on a connection.
+         *
+         * @return An empty string if a response was received, otherwise why not.
+         */
+        std::string perform(const CurlHandle& handle, const std::string& uri, const std::string& body,
+            std::stringstream& result) const;
+        static Request buildRequest(const std::string& marketId,
+            const std::vector<CancelInstruction>& instructions = std::vector<CancelInstruction>());
+
+        // no copying
+        MassCanceller(const MassCanceller&);
+        MassCanceller& operator=(const MassCanceller&);
+};
+
+}
+}
+
+#endif // TRADING_MASSCANCELLER_H
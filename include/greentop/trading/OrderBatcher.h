@@ -0,0 +1,203 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_ORDERBATCHER_H
+#define TRADING_ORDERBATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Collects PlaceInstructions submitted from any number of threads and sends them in as few placeOrders
+ * requests as possible.  Instructions for the same market and customer strategy ref are put in the same
+ * request, up to the instruction limit, and a request is sent as soon as it is full or its first instruction
+ * has waited the maximum delay.
+ *
+ * Submitted instructions are queued without a lock, the batching thread only being woken when the queue was
+ * empty.  Requests are sent by a small pool of threads, so a slow request doesn't hold up the others.  Each
+ * instruction's PlaceInstructionReport is routed back to its submitter through the instruction's
+ * customerOrderRef, which is generated if the instruction doesn't have one.  If a request fails the
+ * submitters of its instructions get a FAILURE report, or TIMEOUT if it isn't known whether the request
+ * reached the exchange.
+ *
+ *     trading::OrderBatcher batcher(exchangeApi);
+ *     batcher.start();
+ *     std::future<PlaceInstructionReport> report = batcher.submit(marketId, instruction);
+ *     ...
+ *     if (report.get().getStatus() == InstructionReportStatus(InstructionReportStatus::SUCCESS)) ...
+ */
+class OrderBatcher {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        typedef std::function<void(const PlaceInstructionReport&)> Callback;
+
+        /** The maximum number of instructions in a placeOrders request. */
+        static const unsigned MAX_INSTRUCTIONS = 200;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to call placeOrders.  It must outlive the batcher.
+         * @param maxInFlight The number of requests sent at the same time by the background threads.
+         */
+        OrderBatcher(const ExchangeApi& exchangeApi, unsigned maxInFlight = 4);
+
+        /**
+         * Destructor.  Stops the background threads, sending any instructions still waiting.
+         */
+        ~OrderBatcher();
+
+        /**
+         * Sets how long an instruction waits for others to join its request.  Defaults to 500 microseconds.
+         */
+        void setMaxDelay(const std::chrono::microseconds& maxDelay);
+
+        /**
+         * Sets the maximum number of instructions in a request.  Defaults to MAX_INSTRUCTIONS.
+         */
+        void setMaxInstructions(unsigned maxInstructions);
+
+        /**
+         * Submit an instruction.
+         *
+         * @param marketId The market id.
+         * @param placeInstruction The instruction.
+         * @param customerStrategyRef The customer strategy ref of the request it's sent in.
+         * @return The instruction's report.
+         */
+        std::future<PlaceInstructionReport> submit(const std::string& marketId,
+            const PlaceInstruction& placeInstruction, const std::string& customerStrategyRef = std::string());
+
+        /**
+         * Submit an instruction, calling a function with its report.  The function is called on the thread that
+         * sends the request, without any of the batcher's locks held, so it may submit or flush.
+         *
+         * @param marketId The market id.
+         * @param placeInstruction The instruction.
+         * @param customerStrategyRef The customer strategy ref of the request it's sent in.
+         * @param callback Called with the instruction's report.
+         */
+        void submit(const std::string& marketId, const PlaceInstruction& placeInstruction,
+            const std::string& customerStrategyRef, const Callback& callback);
+
+        /**
+         * Send every instruction submitted so far, whether or not its request is full or has waited long enough.
+         * Use this instead of start() to send requests from your own thread; requests are sent one after another,
+         * but several threads may flush at the same time.
+         *
+         * @return The number of requests sent.
+         */
+        unsigned flush();
+
+        /**
+         * Start batching instructions on a background thread and sending requests on maxInFlight others.
+         */
+        void start();
+
+        /**
+         * Stop the background threads, sending any instructions still waiting.
+         */
+        void stop();
+
+        /**
+         * Gets the number of placeOrders requests sent.
+         */
+        uint64_t getRequests() const;
+
+        /**
+         * Gets the number of instructions sent.
+         */
+        uint64_t getInstructions() const;
+
+        /**
+         * Gets the number of placeOrders requests that failed.
+         */
+        uint64_t getErrors() const;
+
+        void resetCounters();
+
+    private:
+        struct Node {
+            std::string marketId;
+            std::string customerStrategyRef;
+            PlaceInstruction instruction;
+            Callback callback;
+            Clock::time_point submitted;
+            Node* next;
+        };
+
+        struct Batch {
+            std::string marketId;
+            std::string customerStrategyRef;
+            std::vector<Node*> nodes;
+            Clock::time_point first;
+        };
+
+        const ExchangeApi& exchangeApi;
+        const unsigned maxInFlight;
+        std::atomic<int64_t> maxDelay;
+        std::atomic<unsigned> maxInstructions;
+
+        /** Submitted instructions, most recent first. */
+        std::atomic<Node*> intake;
+        std::string refPrefix;
+        std::atomic<uint64_t> nextRef;
+
+        /** Held while taking instructions from the intake and cutting them into requests, but not while sending. */
+        std::mutex sendMutex;
+        std::unordered_map<std::string, Batch> batches;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::thread thread;
+        bool running;
+        /** Requests cut by the background thread, waiting for a sender. */
+        std::deque<Batch> outgoing;
+        std::condition_variable sendCondition;
+        std::vector<std::thread> senders;
+
+        std::atomic<uint64_t> requests;
+        std::atomic<uint64_t> instructions;
+        std::atomic<uint64_t> errors;
+
+        void push(Node* node);
+        void drain();
+        /**
+         * Cut the batches that are full or have waited long enough, or all of them, into requests.
+         *
+         * @param next Set to when the earliest batch left will have waited long enough.
+         */
+        void take(bool all, Clock::time_point& next, std::vector<Batch>& requests);
+        /**
+         * Take the instructions of one request from the front of a batch.
+         */
+        Batch take(Batch& batch);
+        void send(const Batch& request);
+        void run();
+        void runSender();
+
+        // no copying
+        OrderBatcher(const OrderBatcher&);
+        OrderBatcher& operator=(const OrderBatcher&);
+};
+
+}
+}
+
+#endif // TRADING_ORDERBATCHER_H
@@ -0,0 +1,229 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_ORDERPIPELINE_H
+#define TRADING_ORDERPIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+#include "greentop/stream/OrderCache.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Places orders without waiting for them to be executed, keeping several placeOrders requests in flight and
+ * following each order until the exchange has given it a bet id.
+ *
+ * place() queues a request and returns a handle per instruction straight away.  The request is sent by one
+ * of the pipeline's threads, with async set so the exchange replies before the orders are executed.  Each
+ * order is then recognised by its customerOrderRef, generated if the instruction doesn't have one, in
+ * whichever comes first of:
+ *
+ *     - the execution report, when placing synchronously or if the order failed
+ *     - an order update applied with apply(), eg from an OrderStream change callback
+ *     - a listCurrentOrders request made by poll()
+ *
+ * An order that hasn't been seen by the time the resolve timeout has passed since it was placed is given up on
+ * by poll().  If a request fails without a reply its orders stay pending, since they may have been placed.
+ *
+ *     trading::OrderPipeline pipeline(exchangeApi);
+ *     orderStream.setChangeCallback([&](const std::vector<std::string>& marketIds) {
+ *         pipeline.apply(orderStream.getCache(), marketIds);
+ *     });
+ *     trading::OrderPipeline::Handle handle = pipeline.place(marketId, instruction);
+ *     ...
+ *     const trading::OrderPipeline::Result& result = handle.result.get();
+ *
+ * Each result says how long its order took at each stage, so synchronous and asynchronous placement can be
+ * compared with setAsync().
+ */
+class OrderPipeline {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        /**
+         * How an order's outcome became known.
+         */
+        enum Source {
+            /** The placeOrders execution report. */
+            EXECUTION_REPORT,
+            /** An order update passed to apply(). */
+            ORDER_UPDATE,
+            /** A listCurrentOrders request made by poll(). */
+            POLL,
+            /** The order wasn't seen before the resolve timeout. */
+            EXPIRED
+        };
+
+        struct Result {
+            std::string marketId;
+            std::string customerOrderRef;
+            /** The customerRef of the placeOrders request. */
+            std::string customerRef;
+            Source source;
+            /** Whether the order was placed. */
+            bool success;
+            /** The error code of the instruction or, if the whole request failed, of the request. */
+            std::string errorCode;
+            std::string betId;
+            OrderStatus orderStatus;
+            double sizeMatched;
+            double averagePriceMatched;
+            /** From place() until the request was sent. */
+            std::chrono::nanoseconds queueTime;
+            /** From place() until the execution report was received, or 0 if it wasn't. */
+            std::chrono::nanoseconds acknowledgeTime;
+            /** From place() until the outcome was known. */
+            std::chrono::nanoseconds latency;
+        };
+
+        struct Handle {
+            std::string customerOrderRef;
+            std::string customerRef;
+            std::shared_future<Result> result;
+        };
+
+        /** The maximum number of customer order refs in a listCurrentOrders request made by poll(). */
+        static const size_t MAX_REFS = 250;
+
+        /**
+         * Constructor.
+         *
+         * @param exchangeApi The api used to call placeOrders and listCurrentOrders.  It must outlive the
+         *        pipeline.
+         * @param maxInFlight The number of placeOrders requests that can be in flight at once.
+         */
+        OrderPipeline(const ExchangeApi& exchangeApi, unsigned maxInFlight = 8);
+
+        /**
+         * Destructor.  Waits for queued requests to be sent, then gives up on orders still pending.
+         */
+        ~OrderPipeline();
+
+        /**
+         * Whether orders are placed asynchronously.  Defaults to true.
+         */
+        void setAsync(bool async);
+
+        /**
+         * Sets how long an order can go unseen before poll() gives up on it.  Defaults to 30 seconds.
+         */
+        void setResolveTimeout(const std::chrono::milliseconds& resolveTimeout);
+
+        /**
+         * Queue an instruction.
+         *
+         * @param marketId The market id.
+         * @param placeInstruction The instruction.
+         * @param customerStrategyRef The customer strategy ref of the request.
+         * @return A handle for the order.
+         * @throws std::runtime_error if the instruction's customerOrderRef is already pending.
+         */
+        Handle place(const std::string& marketId, const PlaceInstruction& placeInstruction,
+            const std::string& customerStrategyRef = std::string());
+
+        /**
+         * Queue a request.
+         *
+         * @param marketId The market id.
+         * @param placeInstructions The instructions.
+         * @param customerStrategyRef The customer strategy ref of the request.
+         * @return A handle for each order, in the same order as the instructions.
+         * @throws std::runtime_error if an instruction's customerOrderRef is already pending.
+         */
+        std::vector<Handle> place(const std::string& marketId, const std::vector<PlaceInstruction>& placeInstructions,
+            const std::string& customerStrategyRef = std::string());
+
+        /**
+         * Resolve the pending order, if any, with the same customerOrderRef.
+         */
+        void apply(const CurrentOrderSummary& currentOrderSummary);
+
+        void apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries);
+
+        /**
+         * Resolve pending orders from the orders of some markets in an order stream's cache.
+         */
+        void apply(const stream::OrderCache& orderCache, const std::vector<std::string>& marketIds);
+
+        /**
+         * Look up the pending orders that have been sent with listCurrentOrders, then give up on those older than
+         * the resolve timeout.
+         *
+         * @return The number of orders resolved.
+         * @throws std::runtime_error if a request fails.
+         */
+        unsigned poll();
+
+        /**
+         * Gets the number of orders whose outcome isn't known yet.
+         */
+        size_t getPending() const;
+
+    private:
+        struct Order {
+            std::string marketId;
+            std::string customerOrderRef;
+            std::string customerRef;
+            std::promise<Result> promise;
+            Clock::time_point placed;
+            Clock::time_point sent;
+            Clock::time_point acknowledged;
+            /** Whether the request has been sent, so the order may be found by poll(). */
+            bool isSent;
+            bool isAcknowledged;
+        };
+
+        struct Request {
+            std::string marketId;
+            std::string customerRef;
+            std::string customerStrategyRef;
+            std::vector<PlaceInstruction> instructions;
+            /** The trace context of the caller of place(). */
+            std::shared_ptr<void> context;
+        };
+
+        const ExchangeApi& exchangeApi;
+        std::atomic<bool> async;
+        std::atomic<int64_t> resolveTimeout;
+        std::string refPrefix;
+        std::atomic<uint64_t> nextRef;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Request> queue;
+        std::unordered_map<std::string, std::shared_ptr<Order>> pending;
+        bool stopping;
+        std::vector<std::thread> threads;
+
+        std::string generateRef(const char* kind);
+        void run();
+        void send(const Request& request);
+        Result resolve(Order& order, Source source, Clock::time_point now) const;
+        /**
+         * @return Whether a pending order was resolved.
+         */
+        bool resolve(const CurrentOrderSummary& currentOrderSummary, Source source);
+
+        // no copying
+        OrderPipeline(const OrderPipeline&);
+        OrderPipeline& operator=(const OrderPipeline&);
+};
+
+}
+}
+
+#endif // TRADING_ORDERPIPELINE_H
@@ -0,0 +1,172 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_ORDERTRACKER_H
+#define TRADING_ORDERTRACKER_H
+
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * A local book of your orders, kept as CurrentOrderSummarys so it can be queried between listCurrentOrders
+ * calls.
+ *
+ * Orders are added and updated straight away from the reports of placeOrders, cancelOrders, replaceOrders and
+ * updateOrders, and brought up to date with the exchange by sync(), which only asks for what may have
+ * changed: the orders placed since the last sync and the orders that were still executable.  An update never
+ * takes an order back to an earlier state, so a poll that was answered before a report arrived doesn't undo
+ * it.
+ *
+ * Orders can be looked up by bet id, by customer order ref and by market, runner and side in constant time.
+ * A tracker is thread safe.
+ */
+class OrderTracker {
+    public:
+        /** The maximum number of bet ids in a listCurrentOrders request. */
+        static const unsigned MAX_BET_IDS = 250;
+
+        /** The maximum number of orders listCurrentOrders returns at once. */
+        static const unsigned MAX_RECORDS = 1000;
+
+        OrderTracker();
+
+        /**
+         * Sets how far before the last sync orders are asked for, to allow for the difference between the local
+         * and the exchange's clocks.  Defaults to 10 seconds.
+         */
+        void setOverlap(const std::chrono::seconds& overlap);
+
+        /**
+         * Apply the result of a placeOrders request.
+         *
+         * @param placeExecutionReport The report.
+         * @param customerStrategyRef The customer strategy ref the orders were placed with.
+         */
+        void apply(const PlaceExecutionReport& placeExecutionReport,
+            const std::string& customerStrategyRef = std::string());
+
+        /**
+         * Apply the result of placing one instruction, eg from an OrderBatcher.
+         *
+         * @param marketId The market id.
+         * @param placeInstructionReport The report.
+         * @param customerStrategyRef The customer strategy ref the order was placed with.
+         */
+        void apply(const std::string& marketId, const PlaceInstructionReport& placeInstructionReport,
+            const std::string& customerStrategyRef = std::string());
+
+        void apply(const CancelExecutionReport& cancelExecutionReport);
+
+        void apply(const CancelInstructionReport& cancelInstructionReport);
+
+        /**
+         * Apply the result of a replaceOrders request.  The replaced orders are cancelled and the new ones added.
+         */
+        void apply(const ReplaceExecutionReport& replaceExecutionReport);
+
+        void apply(const UpdateExecutionReport& updateExecutionReport);
+
+        void apply(const UpdateInstructionReport& updateInstructionReport);
+
+        /**
+         * Apply orders from listCurrentOrders or the order stream.
+         */
+        void apply(const CurrentOrderSummary& currentOrderSummary);
+
+        void apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries);
+
+        /**
+         * Bring the orders up to date with the exchange.  The first sync fetches every current order.
+         *
+         * @param exchangeApi The api to call listCurrentOrders with.
+         * @return The number of orders that were added or changed.
+         * @throws std::runtime_error if a request fails.
+         */
+        unsigned sync(const ExchangeApi& exchangeApi);
+
+        /**
+         * Gets an order by bet id.
+         *
+         * @return false if there is no such order.
+         */
+        bool getOrder(const std::string& betId, CurrentOrderSummary& currentOrderSummary) const;
+
+        /**
+         * Gets an order by customer order ref.
+         *
+         * @return false if there is no such order.
+         */
+        bool getOrderByCustomerOrderRef(const std::string& customerOrderRef,
+            CurrentOrderSummary& currentOrderSummary) const;
+
+        /**
+         * Gets the orders in a market.
+         */
+        std::vector<CurrentOrderSummary> getOrders(const std::string& marketId) const;
+
+        /**
+         * Gets the orders on one side of a runner.
+         */
+        std::vector<CurrentOrderSummary> getOrders(const std::string& marketId, int64_t selectionId,
+            const Side& side, double handicap = 0) const;
+
+        /**
+         * Gets the orders still executable on one side of a runner.
+         */
+        std::vector<CurrentOrderSummary> getExecutableOrders(const std::string& marketId, int64_t selectionId,
+            const Side& side, double handicap = 0) const;
+
+        /**
+         * Forget a market's orders, eg once it has been settled.
+         */
+        void remove(const std::string& marketId);
+
+        void clear();
+
+        size_t size() const;
+
+    private:
+        std::chrono::seconds overlap;
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, CurrentOrderSummary> orders;
+        std::unordered_map<std::string, std::string> customerOrderRefs;
+        std::unordered_map<std::string, std::vector<std::string>> markets;
+        std::unordered_map<std::string, std::vector<std::string>> runners;
+        /** The bet ids of the orders that were executable when last updated. */
+        std::unordered_set<std::string> executable;
+        /** The total size cancelled by the cancel reports applied to each order. */
+        std::unordered_map<std::string, double> reportedCancels;
+        time_t lastSync;
+
+        static std::string getRunnerKey(const std::string& marketId, int64_t selectionId, double handicap,
+            const Side& side);
+        static double getProgress(const CurrentOrderSummary& order);
+
+        bool update(const CurrentOrderSummary& currentOrderSummary);
+        void add(const std::string& marketId, const PlaceInstructionReport& placeInstructionReport,
+            const std::string& customerStrategyRef);
+        void cancel(const CancelInstructionReport& cancelInstructionReport);
+        unsigned fetch(const ExchangeApi& exchangeApi, const ListCurrentOrdersRequest& request);
+        std::vector<CurrentOrderSummary> getRunnerOrders(const std::string& runnerKey, bool executableOnly) const;
+
+        // no copying
+        OrderTracker(const OrderTracker&);
+        OrderTracker& operator=(const OrderTracker&);
+};
+
+}
+}
+
+#endif // TRADING_ORDERTRACKER_H
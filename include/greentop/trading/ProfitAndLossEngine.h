@@ -0,0 +1,215 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_PROFITANDLOSSENGINE_H
+#define TRADING_PROFITANDLOSSENGINE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+#include "greentop/sport/MarketRates.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Keeps the profit and loss of markets up to date locally from matched bets, giving the values
+ * listMarketProfitAndLoss would without a request.
+ *
+ * Bets are fed in as they are matched, from placeOrders execution reports, listCurrentOrders, the orders of
+ * a listMarketBook order projection or the order stream's CurrentOrderSummarys.  Each update carries the
+ * bet's total matched size and average price so far, so the same bet can be applied any number of times from
+ * any of these sources; applying a bet costs the same whatever the number of bets in the market.
+ *
+ * In a market with one winner ifWin is the market's profit if the runner wins, and ifLose isn't set.  In a
+ * market with more winners each runner is settled on its own, so ifWin and ifLose are the profit of the bets
+ * on that runner if it wins or loses.  The part of a bet that is voided, and all bets on a runner that is removed, are left
+ * out.  Prices aren't reduced by the adjustment factor of a removed runner; reconcile() shows the difference.
+ * Asian handicap markets aren't supported.
+ *
+ * An engine is thread safe.
+ */
+class ProfitAndLossEngine {
+    public:
+        /**
+         * A runner whose local profit and loss differs from the exchange's.
+         */
+        struct Discrepancy {
+            std::string marketId;
+            int64_t selectionId;
+            double localIfWin;
+            double serverIfWin;
+            double localIfLose;
+            double serverIfLose;
+        };
+
+        ProfitAndLossEngine();
+
+        /**
+         * Whether positive profits are given net of commission.  Defaults to false.
+         */
+        void setNetOfCommission(bool netOfCommission);
+
+        /**
+         * Sets the commission rate of a market.
+         *
+         * @param marketId The market id.
+         * @param rate The rate as a percentage, eg 5.
+         */
+        void setCommissionRate(const std::string& marketId, double rate);
+
+        /**
+         * Sets the commission rate of a market from its rates, eg from MarketDescription or listMarketTypes.
+         *
+         * @param marketId The market id.
+         * @param marketRates The market's base rate and whether a discount is allowed.
+         * @param discountRate Your discount, as a percentage of the base rate.
+         */
+        void setMarketRates(const std::string& marketId, const MarketRates& marketRates, double discountRate = 0);
+
+        /**
+         * Sets the number of winners of a market.  Defaults to 1.
+         */
+        void setNumberOfWinners(const std::string& marketId, int32_t numberOfWinners);
+
+        /**
+         * Update the matched part of a bet.
+         *
+         * @param marketId The market id.
+         * @param betId The bet id.
+         * @param selectionId The selection id.
+         * @param handicap The handicap.
+         * @param side BACK or LAY.
+         * @param sizeMatched The total size matched so far, less any size voided.
+         * @param averagePriceMatched The average price matched.
+         */
+        void updateBet(const std::string& marketId, const std::string& betId, int64_t selectionId,
+            double handicap, const Side& side, double sizeMatched, double averagePriceMatched);
+
+        /**
+         * Apply the bets matched by a placeOrders request.
+         */
+        void apply(const PlaceExecutionReport& placeExecutionReport);
+
+        /**
+         * Apply the matched part of an order.
+         */
+        void apply(const CurrentOrderSummary& currentOrderSummary);
+
+        void apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries);
+
+        /**
+         * Apply the number of winners and the orders of a market book.  Bets on removed runners are voided.
+         */
+        void apply(const MarketBook& marketBook);
+
+        /**
+         * Void a bet.
+         */
+        void voidBet(const std::string& betId);
+
+        /**
+         * Void the bets on a runner, eg because it has been removed.
+         */
+        void voidRunner(const std::string& marketId, int64_t selectionId, double handicap = 0);
+
+        /**
+         * Forget a market and its bets, eg once it has been settled.
+         */
+        void remove(const std::string& marketId);
+
+        void clear();
+
+        std::vector<std::string> getMarketIds() const;
+
+        /**
+         * Gets the profit and loss of a market, rounded to hundredths.
+         *
+         * @param marketId The market id.
+         * @param marketProfitAndLoss Set to the profit and loss, with a RunnerProfitAndLoss for each runner
+         *        that has been bet on.
+         * @return false if there are no bets on the market.
+         */
+        bool getProfitAndLoss(const std::string& marketId, MarketProfitAndLoss& marketProfitAndLoss) const;
+
+        /**
+         * Compare the local profit and loss with the exchange's.
+         *
+         * @param marketProfitAndLosses The exchange's profit and loss, from listMarketProfitAndLoss.
+         * @param tolerance The largest difference that isn't a discrepancy.
+         * @return The runners that differ.
+         */
+        std::vector<Discrepancy> reconcile(const std::vector<MarketProfitAndLoss>& marketProfitAndLosses,
+            double tolerance = 0.01) const;
+
+        /**
+         * Request the profit and loss of every market with bets and compare it with the local profit and loss.
+         *
+         * @param exchangeApi The api to call listMarketProfitAndLoss with.
+         * @param tolerance The largest difference that isn't a discrepancy.
+         * @return The runners that differ.
+         * @throws std::runtime_error if a request fails.
+         */
+        std::vector<Discrepancy> reconcile(const ExchangeApi& exchangeApi, double tolerance = 0.01) const;
+
+    private:
+        typedef std::pair<int64_t, double> RunnerKey;
+
+        struct RunnerPosition {
+            RunnerPosition() : ifWin(0), ifLose(0), voided(false) {
+            }
+
+            /** The profit of the bets on this runner if it wins. */
+            double ifWin;
+            /** The profit of the bets on this runner if it loses. */
+            double ifLose;
+            bool voided;
+        };
+
+        struct MarketPosition {
+            MarketPosition() : numberOfWinners(1), commissionRate(0), bets(0) {
+            }
+
+            int32_t numberOfWinners;
+            double commissionRate;
+            size_t bets;
+            std::map<RunnerKey, RunnerPosition> runners;
+        };
+
+        struct BetPosition {
+            std::string marketId;
+            RunnerKey runner;
+            bool back;
+            double size;
+            double price;
+            bool voided;
+        };
+
+        mutable std::mutex mutex;
+        bool netOfCommission;
+        std::unordered_map<std::string, MarketPosition> markets;
+        std::unordered_map<std::string, BetPosition> bets;
+
+        void updateBet(const std::string& marketId, const std::string& betId, const RunnerKey& runner, bool back,
+            double size, double price);
+        void voidRunner(const std::string& marketId, const RunnerKey& runner);
+        static void addBet(RunnerPosition& runner, const BetPosition& bet, double sign);
+        void getProfitAndLoss(const std::string& marketId, const MarketPosition& market,
+            MarketProfitAndLoss& marketProfitAndLoss, bool round) const;
+        double netProfit(const MarketPosition& market, double profit) const;
+
+        // no copying
+        ProfitAndLossEngine(const ProfitAndLossEngine&);
+        ProfitAndLossEngine& operator=(const ProfitAndLossEngine&);
+};
+
+}
+}
+
+#endif // TRADING_PROFITANDLOSSENGINE_H
@@ -0,0 +1,353 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#ifndef TRADING_RISKENGINE_H
+#define TRADING_RISKENGINE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "greentop/ExchangeApi.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Checks orders against exposure limits and available funds before they are placed, so that orders the
+ * exchange would reject don't cost a request.
+ *
+ * The engine tracks the worst case loss of the orders it is given, per runner, market, market group (event)
+ * and account.  Unmatched orders are counted at their worst: a back as losing its stake if the runner loses,
+ * a lay as paying its liability if the runner wins.  In a market with one winner a market's exposure is the
+ * largest loss over the outcomes of the market, so backing or laying several runners offsets; in a market with
+ * more winners, or whose number of runners isn't known, each runner's worst case is added up.
+ *
+ * Limits mirror the exchange's: the market group limits from listExposureLimitsForMarketGroups, and the
+ * account's exposure limit and available to bet balance from getAccountFunds.  A local per market limit can
+ * also be set.
+ *
+ * check() costs time in proportion to the number of instructions, sorting them by runner, not the number of
+ * orders, and never waits for a thread that is updating the engine: updates build a new copy of
+ * the changed market and publish it with the new totals, sharing the unchanged markets, and a check reads
+ * whichever copy was last published.
+ * Orders that pass a check count towards later checks once their execution report is applied.
+ *
+ *     trading::RiskEngine riskEngine;
+ *     riskEngine.setEventId(marketId, eventId);
+ *     riskEngine.apply(exchangeApi.listExposureLimitsForMarketGroups(request));
+ *     riskEngine.reconcile(exchangeApi);
+ *     trading::RiskEngine::Check check = riskEngine.check(marketId, instructions);
+ *     if (check.isAccepted()) {
+ *         riskEngine.apply(exchangeApi.placeOrders(PlaceOrdersRequest(marketId, instructions)));
+ *     }
+ *
+ * An engine is thread safe.
+ */
+class RiskEngine {
+    public:
+        /**
+         * The limit a batch of instructions would breach.
+         */
+        enum Breach {
+            NO_BREACH,
+            /** The market group is blocked. */
+            MARKET_GROUP_BLOCKED,
+            /** The market's exposure would exceed the local market limit. */
+            MARKET_LIMIT,
+            /** The group's exposure would exceed its total limit. */
+            MARKET_GROUP_TOTAL_LIMIT,
+            /** The group's matched exposure would exceed its matched limit if the instructions were matched. */
+            MARKET_GROUP_MATCHED_LIMIT,
+            /** The account's exposure would exceed its limit. */
+            ACCOUNT_LIMIT,
+            /** The account's exposure would increase by more than its available to bet balance. */
+            INSUFFICIENT_FUNDS
+        };
+
+        /**
+         * The result of checking a batch of instructions.  Exposures are those after the instructions are
+         * placed, as positive amounts.
+         */
+        struct Check {
+            Breach breach;
+            double marketExposure;
+            double marketGroupExposure;
+            double accountExposure;
+
+            bool isAccepted() const;
+        };
+
+        RiskEngine();
+
+        /**
+         * Sets the event a market belongs to, which is its market group.  Markets without an event aren't
+         * checked against group limits.
+         */
+        void setEventId(const std::string& marketId, int64_t eventId);
+
+        /**
+         * Sets the number of winners of a market.  Defaults to 1.
+         */
+        void setNumberOfWinners(const std::string& marketId, int32_t numberOfWinners);
+
+        /**
+         * Sets the number of runners in a market.  Until it is known, the runners that haven't been bet on
+         * are assumed to include a winner.
+         */
+        void setNumberOfRunners(const std::string& marketId, int32_t numberOfRunners);
+
+        /**
+         * Sets the event and number of runners of a market from its catalogue.
+         */
+        void apply(const MarketCatalogue& marketCatalogue);
+
+        /**
+         * Sets the number of winners and active runners of a market from its book.
+         */
+        void apply(const MarketBook& marketBook);
+
+        /**
+         * Sets the limits of the event market groups.  Other types of group are ignored.
+         */
+        void setExposureLimits(const ExposureLimitsForMarketGroups& exposureLimits);
+
+        /**
+         * Sets the market group limits from listExposureLimitsForMarketGroups.
+         */
+        void apply(const ListExposureLimitsForMarketGroupsResponse& response);
+
+        /**
+         * Sets the largest exposure allowed on a market.  Defaults to no limit.
+         */
+        void setMarketLimit(double marketLimit);
+
+        /**
+         * Sets the account's available to bet balance and exposure limit.  Checks compare the increase in the
+         * account's exposure since then with the balance.
+         */
+        void setAccountFunds(const AccountFundsResponse& accountFunds);
+
+        /**
+         * Request the account's funds, set them and compare the exchange's exposure with the local exposure.
+         *
+         * @param exchangeApi The api to call getAccountFunds with.
+         * @return The local exposure less the exchange's.
+         * @throws std::runtime_error if the request fails.
+         */
+        double reconcile(const ExchangeApi& exchangeApi);
+
+        /**
+         * Apply the orders placed by a placeOrders request.
+         */
+        void apply(const PlaceExecutionReport& placeExecutionReport);
+
+        /**
+         * Apply the sizes cancelled by a cancelOrders request.
+         */
+        void apply(const CancelExecutionReport& cancelExecutionReport);
+
+        /**
+         * Apply the current state of an order, eg from listCurrentOrders or the order stream.
+         */
+        void apply(const CurrentOrderSummary& currentOrderSummary);
+
+        void apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries);
+
+        /**
+         * Forget a market and its orders, eg once it has been settled.
+         */
+        void remove(const std::string& marketId);
+
+        void clear();
+
+        /**
+         * Check a batch of instructions for a market against the limits.
+         *
+         * @param marketId The market id.
+         * @param instructions The instructions.
+         * @return The first limit breached, and the exposures if the instructions are placed.
+         */
+        Check check(const std::string& marketId, const std::vector<PlaceInstruction>& instructions) const;
+
+        /**
+         * Gets the worst case loss of the orders on a runner.
+         */
+        double getRunnerExposure(const std::string& marketId, int64_t selectionId, double handicap = 0) const;
+
+        /**
+         * Gets the worst case loss of the orders on a market.
+         *
+         * @param marketId The market id.
+         * @param matched Whether to count matched orders only.
+         */
+        double getMarketExposure(const std::string& marketId, bool matched = false) const;
+
+        double getMarketGroupExposure(int64_t eventId, bool matched = false) const;
+
+        double getAccountExposure(bool matched = false) const;
+
+    private:
+        typedef std::pair<int64_t, double> RunnerKey;
+
+        /**
+         * The profit of a runner's orders if it wins and if it loses, before and after counting unmatched
+         * orders at their worst.
+         */
+        struct RunnerExposure {
+            RunnerExposure() : matchedIfWin(0), matchedIfLose(0), unmatchedBack(0), unmatchedLay(0) {
+            }
+
+            double matchedIfWin;
+            double matchedIfLose;
+            /** The stake of unmatched backs. */
+            double unmatchedBack;
+            /** The liability of unmatched lays. */
+            double unmatchedLay;
+
+            double getIfWin(bool matched) const;
+            double getIfLose(bool matched) const;
+        };
+
+        /**
+         * What a market's exposure is worked out from, with or without unmatched orders.
+         */
+        struct Outcomes {
+            Outcomes() : loseSum(0), worstSum(0), exposure(0) {
+            }
+
+            /** The sum of the runners' profit if they lose. */
+            double loseSum;
+            /** The sum of the runners' worst profit. */
+            double worstSum;
+            /** Each runner's profit if it wins less its profit if it loses, smallest first. */
+            std::vector<std::pair<double, RunnerKey>> differences;
+            double exposure;
+        };
+
+        /**
+         * A published market, never changed once published.
+         */
+        struct MarketExposure {
+            MarketExposure() : eventId(0), numberOfWinners(1), numberOfRunners(0) {
+            }
+
+            int64_t eventId;
+            int32_t numberOfWinners;
+            int32_t numberOfRunners;
+            std::map<RunnerKey, RunnerExposure> runners;
+            Outcomes matched;
+            Outcomes total;
+        };
+
+        struct GroupLimit {
+            double matched;
+            double total;
+        };
+
+        struct Exposure {
+            Exposure() : matched(0), total(0) {
+            }
+
+            double matched;
+            double total;
+        };
+
+        /**
+         * Everything a check reads, published as a whole.
+         */
+        typedef std::unordered_map<std::string, std::shared_ptr<const MarketExposure>> Markets;
+        typedef std::unordered_map<int64_t, Exposure> Groups;
+
+        /** What changes with the limits and funds rather than with the orders. */
+        struct Limits {
+            GroupLimit defaultLimit;
+            std::unordered_map<int64_t, GroupLimit> groupLimits;
+            std::set<int64_t> blockedGroups;
+            double marketLimit;
+            double accountLimit;
+            double availableToBet;
+            double fundedExposure;
+        };
+
+        /**
+         * The published state.  The markets and groups are shared with earlier snapshots, and those changed since
+         * they were last merged are held alongside, so an update copies the changes and the totals rather than
+         * every market.
+         */
+        struct Snapshot {
+            std::shared_ptr<const Markets> markets;
+            /** The markets changed since the shared ones were merged, null if removed. */
+            Markets changedMarkets;
+            std::shared_ptr<const Groups> groups;
+            Groups changedGroups;
+            Exposure account;
+            std::shared_ptr<const Limits> limits;
+
+            /**
+             * @return The market, NULL if there isn't one.
+             */
+            const MarketExposure* getMarket(const std::string& marketId) const;
+            /**
+             * Replace a market, or remove it if market is null.
+             */
+            void setMarket(const std::string& marketId, const std::shared_ptr<const MarketExposure>& market);
+            Exposure getGroup(int64_t eventId) const;
+            void addToGroup(int64_t eventId, double matched, double total);
+        };
+
+        struct OrderExposure {
+            RunnerKey runner;
+            bool back;
+            double sizeMatched;
+            double averagePriceMatched;
+            /** The stake of an unmatched back or the liability of an unmatched lay. */
+            double unmatched;
+            /** The liability of a unit of unmatched size. */
+            double liabilityPerUnit;
+            /** The size of a limit order, or 0 if the order is sized by its liability. */
+            double size;
+            /** The size cancelled as the order was last known. */
+            double sizeCancelled;
+            /** The size lapsed or voided as the order was last known. */
+            double sizeLapsedOrVoided;
+            /** The total size cancelled by the cancel reports applied to the order. */
+            double reportedCancelled;
+        };
+
+        typedef std::unordered_map<std::string, OrderExposure> Orders;
+        /** Changes to runners' exposure, sorted by runner. */
+        typedef std::vector<std::pair<RunnerKey, RunnerExposure>> Deltas;
+
+        mutable std::mutex mutex;
+        std::shared_ptr<const Snapshot> snapshot;
+        std::unordered_map<std::string, Orders> orders;
+
+        std::shared_ptr<const Snapshot> load() const;
+        void update(const std::set<std::string>& marketIds, Snapshot& next);
+        void publish(const Snapshot& next);
+        void configure(const std::string& marketId, int64_t eventId, int32_t numberOfWinners,
+            int32_t numberOfRunners);
+        void apply(const CurrentOrderSummary& currentOrderSummary, std::set<std::string>& marketIds);
+        static void applyCancels(OrderExposure& order);
+        static void addOrder(RunnerExposure& runner, const OrderExposure& order);
+        static void buildOutcomes(const MarketExposure& market, bool matched, Outcomes& outcomes);
+        static void sortDeltas(Deltas& deltas);
+        static double getExposure(const MarketExposure& market, bool matched, const Deltas& deltas);
+        static GroupLimit getGroupLimit(const ExposureLimit& limit);
+
+        // no copying
+        RiskEngine(const RiskEngine&);
+        RiskEngine& operator=(const RiskEngine&);
+};
+
+}
+}
+
+#endif // TRADING_RISKENGINE_H
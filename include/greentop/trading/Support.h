@@ -0,0 +1,37 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#ifndef TRADING_SUPPORT_H
+#define TRADING_SUPPORT_H
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "greentop/Optional.h"
+
+namespace greentop {
+namespace trading {
+
+/**
+ * Gets a prefix for the customer order refs a component generates, from the time it was created, so that
+ * generated refs are unique across restarts as well as within the component.
+ */
+inline std::string getRefPrefix() {
+    std::ostringstream prefix;
+    prefix << "gt" << std::hex << std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return prefix.str();
+}
+
+/**
+ * Gets an amount the exchange may leave out, eg an order's size lapsed, as 0 if it isn't there.
+ */
+inline double getOrZero(const Optional<double>& value) {
+    return value.isValid() ? value.getValue() : 0;
+}
+
+}
+}
+
+#endif // TRADING_SUPPORT_H
@@ -2,6 +2,8 @@
  * Copyright 2018 Colin Doig.  Distributed under the MIT license.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <curl/curl.h>
 #include <fstream>
@@ -127,6 +129,14 @@ void ExchangeApi::setSsoid(const std::string& ssoid) {
     this->ssoid = ssoid;
 }
 
+const std::string& ExchangeApi::getApplicationKey() const {
+    return applicationKey;
+}
+
+const std::string& ExchangeApi::getSsoid() const {
+    return ssoid;
+}
+
 bool ExchangeApi::retrieveMenu(const std::string& cacheFilename) {
     pendingMenuJson = Json::Value();
     bool refreshResult = false;
@@ -194,6 +204,18 @@ menu::Menu& ExchangeApi::getMenu() {
     return menu;
 }
 
+void ExchangeApi::setTimingCallback(const TimingCallback& timingCallback) {
+    this->timingCallback = timingCallback;
+}
+
+void ExchangeApi::setRequestHook(const std::shared_ptr<RequestHook>& requestHook) {
+    this->requestHook = requestHook;
+}
+
+const std::shared_ptr<RequestHook>& ExchangeApi::getRequestHook() const {
+    return requestHook;
+}
+
 ListEventTypesResponse
 ExchangeApi::listEventTypes(const ListEventTypesRequest& request) const {
     ListEventTypesResponse response;
@@ -257,6 +279,10 @@ ExchangeApi::listMarketBook(const ListMarketBookRequest& request) const {
     return response;
 }
 
+bool ExchangeApi::listMarketBook(const ListMarketBookRequest& request, JsonResponse& response) const {
+    return performRequest(Api::BETTING, "listMarketBook", request, response);
+}
+
 ListRunnerBookResponse
 ExchangeApi::listRunnerBook(const ListRunnerBookRequest& request) const {
     ListRunnerBookResponse response;
@@ -547,15 +573,35 @@ bool ExchangeApi::performRequest(const Api api,
         const std::string& method,
         const JsonRequest& jsonRequest,
         JsonResponse& jsonResponse) const {
+    RequestHook* hook = requestHook.get();
+    const bool timed = timingCallback || hook;
+    RequestTiming timing;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point serialized;
+    if (timed) {
+        start = std::chrono::steady_clock::now();
+    }
+
     CurlHandle handle = curl->easyInit();
 
     if (handle.get()) {
 
+        std::chrono::steady_clock::time_point serializing;
+        if (timed) {
+            serializing = std::chrono::steady_clock::now();
+        }
+        std::string request = jsonRequest.toString();
+        if (timed) {
+            serialized = std::chrono::steady_clock::now();
+            timing.serialize = serialized - serializing;
+            if (hook) {
+                notify(RequestHook::BUILT, method, serialized);
+            }
+        }
+
         SList headers;
         initRequest(api, method, handle, headers);
 
-        std::string request = jsonRequest.toString();
-
         if (request != "") {
             curl->easySetopt(handle, CURLOPT_POSTFIELDS, request.c_str());
         }
@@ -568,19 +614,91 @@ bool ExchangeApi::performRequest(const Api api,
         curl->easySetopt(handle, CURLOPT_ERRORBUFFER, errorBuffer);
         errorBuffer[0] = 0;
 
+        std::chrono::steady_clock::time_point performed;
+        std::chrono::steady_clock::time_point received;
+        if (timed) {
+            performed = std::chrono::steady_clock::now();
+            // getting the handle counts as setup, not serializing
+            timing.setup = (serializing - start) + (performed - serialized);
+            if (hook) {
+                notify(RequestHook::SENT, method, performed);
+            }
+        }
+
         CURLcode curlResult = curl->easyPerform(handle);
+
+        if (timed) {
+            received = std::chrono::steady_clock::now();
+            timing.operation = method;
+            timing.curlCode = curlResult;
+            timing.bytesSent = request.size();
+            timing.bytesReceived = static_cast<size_t>(std::max<std::streamoff>(result.tellp(), 0));
+            getTransferTimes(handle, received - performed, timing);
+            if (hook && curlResult == CURLE_OK) {
+                // curl's times are from the start of the transfer, which is where SENT was reported
+                notify(RequestHook::FIRST_BYTE, method, timing.startTransfer.count() > 0 ?
+                    performed + timing.startTransfer : received);
+                notify(RequestHook::BODY_COMPLETE, method, performed + timing.transfer);
+            }
+        }
+
         if (curlResult == CURLE_OK) {
             result >> jsonResponse;
         } else {
+            if (timed) {
+                std::chrono::steady_clock::time_point failed = std::chrono::steady_clock::now();
+                timing.total = failed - start;
+                if (timingCallback) {
+                    timingCallback(timing);
+                }
+                if (hook) {
+                    notify(RequestHook::FAILED, method, failed);
+                }
+            }
             throw std::runtime_error(errorBuffer);
         }
 
+        if (timed) {
+            std::chrono::steady_clock::time_point parsed = std::chrono::steady_clock::now();
+            timing.parse = parsed - received;
+            timing.total = parsed - start;
+            timing.success = jsonResponse.isSuccess();
+            timing.faultCode = jsonResponse.getFaultCode();
+            if (hook) {
+                notify(RequestHook::PARSED, method, parsed);
+            }
+            if (timingCallback) {
+                timingCallback(timing);
+            }
+            if (hook) {
+                notify(RequestHook::DELIVERED, method, std::chrono::steady_clock::now());
+            }
+        }
+
         return jsonResponse.isSuccess();
     }
 
     return false;
 }
 
+void ExchangeApi::getTransferTimes(const CurlHandle& handle, const std::chrono::nanoseconds& elapsed,
+        RequestTiming& timing) const {
+    const CURLINFO infos[] = {CURLINFO_NAMELOOKUP_TIME, CURLINFO_CONNECT_TIME, CURLINFO_APPCONNECT_TIME,
+        CURLINFO_PRETRANSFER_TIME, CURLINFO_STARTTRANSFER_TIME, CURLINFO_TOTAL_TIME};
+    std::chrono::nanoseconds* times[] = {&timing.nameLookup, &timing.connect, &timing.appConnect,
+        &timing.preTransfer, &timing.startTransfer, &timing.transfer};
+
+    for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+        double seconds = 0;
+        if (curl->easyGetinfo(handle, infos[i], &seconds) != CURLE_OK) {
+            // without curl's times, the whole of easyPerform counts as the transfer
+            timing.transfer = elapsed;
+            return;
+        }
+        *times[i] = std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1e9));
+    }
+}
+
 bool ExchangeApi::initRequest(const Api api, const std::string method, const CurlHandle& handle, SList& headers) const {
     curl->easySetopt(handle, CURLOPT_URL, buildUri(api, method).c_str());
     curl->easySetopt(handle, CURLOPT_USE_SSL, CURLUSESSL_ALL);
@@ -598,6 +716,11 @@ bool ExchangeApi::initRequest(const Api api, const std::string method, const Cur
     return true;
 }
 
+void ExchangeApi::notify(RequestHook::Event event, const std::string& method,
+        const std::chrono::steady_clock::time_point& time) const {
+    requestHook->onEvent(event, method, time, RequestHook::getContext());
+}
+
 std::string ExchangeApi::buildUri(const Api api, const std::string method) const {
 
     std::string apiString;
@@ -0,0 +1,29 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/RequestHook.h"
+
+namespace greentop {
+
+RequestHook::Scope::Scope(const std::shared_ptr<void>& context) : previous(getCurrentContext()) {
+    getCurrentContext() = context;
+}
+
+RequestHook::Scope::~Scope() {
+    getCurrentContext() = previous;
+}
+
+const std::shared_ptr<void>& RequestHook::getContext() {
+    return getCurrentContext();
+}
+
+std::shared_ptr<void>& RequestHook::getCurrentContext() {
+    static thread_local std::shared_ptr<void> context;
+    return context;
+}
+
+RequestHook::~RequestHook() {
+}
+
+}
@@ -0,0 +1,31 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#include "greentop/Time.h"
+
+namespace greentop {
+
+std::time_t timegm(std::tm* tm) {
+#ifdef _WIN32
+    return _mkgmtime(tm);
+#else
+    return ::timegm(tm);
+#endif
+}
+
+std::time_t toTime(const std::tm& tm) {
+    std::tm copy = tm;
+    return greentop::timegm(&copy);
+}
+
+std::tm fromTime(std::time_t seconds) {
+    std::tm tm = std::tm();
+#ifdef _WIN32
+    gmtime_s(&tm, &seconds);
+#else
+    gmtime_r(&seconds, &tm);
+#endif
+    return tm;
+}
+
+}
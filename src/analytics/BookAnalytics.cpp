@@ -0,0 +1,187 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GREENTOP_HAVE_SSE2
+#endif
+
+#include "greentop/analytics/BookAnalytics.h"
+
+namespace greentop {
+namespace analytics {
+
+namespace {
+
+void resize(const BookBatch& batch, BookMetrics& metrics) {
+    size_t runners = batch.getRunnerCount();
+    metrics.backBookPercentage.resize(batch.getMarketCount());
+    metrics.layBookPercentage.resize(batch.getMarketCount());
+    metrics.backPercentage.resize(runners);
+    metrics.layPercentage.resize(runners);
+    metrics.weightOfMoney.resize(runners);
+    metrics.microprice.resize(runners);
+    metrics.vwap.resize(runners);
+}
+
+/**
+ * Compute the runner metrics of runner r, except vwap.
+ */
+void computeRunner(const BookBatch& batch, unsigned levels, size_t r, BookMetrics& metrics) {
+    double bestBack = batch.getBackPrices(0)[r];
+    double bestBackSize = batch.getBackSizes(0)[r];
+    double bestLay = batch.getLayPrices(0)[r];
+    double bestLaySize = batch.getLaySizes(0)[r];
+
+    double backTotal = 0;
+    double layTotal = 0;
+    for (unsigned level = 0; level < levels; ++level) {
+        backTotal += batch.getBackSizes(level)[r];
+        layTotal += batch.getLaySizes(level)[r];
+    }
+    double total = backTotal + layTotal;
+
+    metrics.backPercentage[r] = bestBack > 0 ? 100 / bestBack : 0;
+    metrics.layPercentage[r] = bestLay > 0 ? 100 / bestLay : 0;
+    metrics.weightOfMoney[r] = total > 0 ? backTotal / total : 0;
+    metrics.microprice[r] = bestBack > 0 && bestLay > 0 ?
+        (bestBack * bestLaySize + bestLay * bestBackSize) / (bestBackSize + bestLaySize) : 0;
+}
+
+double computeVwapScalar(const double* prices, const double* sizes, size_t begin, size_t end) {
+    double value = 0;
+    double volume = 0;
+    for (size_t i = begin; i < end; ++i) {
+        value += prices[i] * sizes[i];
+        volume += sizes[i];
+    }
+    return volume > 0 ? value / volume : 0;
+}
+
+#ifdef GREENTOP_HAVE_SSE2
+
+/**
+ * Compute the runner metrics of runners r and r + 1, except vwap.
+ */
+void computeRunnerPair(const BookBatch& batch, unsigned levels, size_t r, BookMetrics& metrics) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d hundred = _mm_set1_pd(100);
+
+    __m128d bestBack = _mm_loadu_pd(batch.getBackPrices(0) + r);
+    __m128d bestBackSize = _mm_loadu_pd(batch.getBackSizes(0) + r);
+    __m128d bestLay = _mm_loadu_pd(batch.getLayPrices(0) + r);
+    __m128d bestLaySize = _mm_loadu_pd(batch.getLaySizes(0) + r);
+
+    __m128d backTotal = zero;
+    __m128d layTotal = zero;
+    for (unsigned level = 0; level < levels; ++level) {
+        backTotal = _mm_add_pd(backTotal, _mm_loadu_pd(batch.getBackSizes(level) + r));
+        layTotal = _mm_add_pd(layTotal, _mm_loadu_pd(batch.getLaySizes(level) + r));
+    }
+    __m128d total = _mm_add_pd(backTotal, layTotal);
+
+    // lanes that would divide by zero are masked to 0
+    __m128d hasBack = _mm_cmpgt_pd(bestBack, zero);
+    __m128d hasLay = _mm_cmpgt_pd(bestLay, zero);
+    _mm_storeu_pd(&metrics.backPercentage[r], _mm_and_pd(hasBack, _mm_div_pd(hundred, bestBack)));
+    _mm_storeu_pd(&metrics.layPercentage[r], _mm_and_pd(hasLay, _mm_div_pd(hundred, bestLay)));
+    _mm_storeu_pd(&metrics.weightOfMoney[r],
+        _mm_and_pd(_mm_cmpgt_pd(total, zero), _mm_div_pd(backTotal, total)));
+
+    __m128d weighted = _mm_add_pd(_mm_mul_pd(bestBack, bestLaySize), _mm_mul_pd(bestLay, bestBackSize));
+    __m128d microprice = _mm_div_pd(weighted, _mm_add_pd(bestBackSize, bestLaySize));
+    _mm_storeu_pd(&metrics.microprice[r], _mm_and_pd(_mm_and_pd(hasBack, hasLay), microprice));
+}
+
+double computeVwap(const double* prices, const double* sizes, size_t begin, size_t end) {
+    __m128d value = _mm_setzero_pd();
+    __m128d volume = _mm_setzero_pd();
+    size_t i = begin;
+    for (; i + 2 <= end; i += 2) {
+        __m128d size = _mm_loadu_pd(sizes + i);
+        value = _mm_add_pd(value, _mm_mul_pd(_mm_loadu_pd(prices + i), size));
+        volume = _mm_add_pd(volume, size);
+    }
+    double values[2];
+    double volumes[2];
+    _mm_storeu_pd(values, value);
+    _mm_storeu_pd(volumes, volume);
+    double totalValue = values[0] + values[1];
+    double totalVolume = volumes[0] + volumes[1];
+    if (i < end) {
+        totalValue += prices[i] * sizes[i];
+        totalVolume += sizes[i];
+    }
+    return totalVolume > 0 ? totalValue / totalVolume : 0;
+}
+
+#endif
+
+void sumBooks(const BookBatch& batch, BookMetrics& metrics) {
+    for (size_t m = 0; m < batch.getMarketCount(); ++m) {
+        double back = 0;
+        double lay = 0;
+        for (size_t r = batch.getMarketStart(m); r < batch.getMarketStart(m + 1); ++r) {
+            back += metrics.backPercentage[r];
+            lay += metrics.layPercentage[r];
+        }
+        metrics.backBookPercentage[m] = back;
+        metrics.layBookPercentage[m] = lay;
+    }
+}
+
+}
+
+void BookAnalytics::compute(const BookBatch& batch, unsigned levels, BookMetrics& metrics) {
+#ifdef GREENTOP_HAVE_SSE2
+    levels = std::min(levels, batch.getDepth());
+    resize(batch, metrics);
+    size_t runners = batch.getRunnerCount();
+    const double* tradedPrices = batch.getTradedPrices();
+    const double* tradedSizes = batch.getTradedSizes();
+
+    size_t r = 0;
+    for (; r + 2 <= runners; r += 2) {
+        computeRunnerPair(batch, levels, r, metrics);
+        metrics.vwap[r] = computeVwap(tradedPrices, tradedSizes, batch.getTradedStart(r),
+            batch.getTradedStart(r + 1));
+        metrics.vwap[r + 1] = computeVwap(tradedPrices, tradedSizes, batch.getTradedStart(r + 1),
+            batch.getTradedStart(r + 2));
+    }
+    if (r < runners) {
+        computeRunner(batch, levels, r, metrics);
+        metrics.vwap[r] = computeVwap(tradedPrices, tradedSizes, batch.getTradedStart(r),
+            batch.getTradedStart(r + 1));
+    }
+    sumBooks(batch, metrics);
+#else
+    computeScalar(batch, levels, metrics);
+#endif
+}
+
+void BookAnalytics::computeScalar(const BookBatch& batch, unsigned levels, BookMetrics& metrics) {
+    levels = std::min(levels, batch.getDepth());
+    resize(batch, metrics);
+    const double* tradedPrices = batch.getTradedPrices();
+    const double* tradedSizes = batch.getTradedSizes();
+    for (size_t r = 0; r < batch.getRunnerCount(); ++r) {
+        computeRunner(batch, levels, r, metrics);
+        metrics.vwap[r] = computeVwapScalar(tradedPrices, tradedSizes, batch.getTradedStart(r),
+            batch.getTradedStart(r + 1));
+    }
+    sumBooks(batch, metrics);
+}
+
+bool BookAnalytics::isVectorized() {
+#ifdef GREENTOP_HAVE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
+}
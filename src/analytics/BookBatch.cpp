@@ -0,0 +1,136 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <stdexcept>
+
+#include "greentop/analytics/BookBatch.h"
+
+namespace greentop {
+namespace analytics {
+
+BookBatch::BookBatch(unsigned depth) :
+    depth(depth),
+    backPrices(depth),
+    backSizes(depth),
+    layPrices(depth),
+    laySizes(depth) {
+    if (depth == 0) {
+        throw std::runtime_error("a book batch needs at least one level");
+    }
+    marketStarts.push_back(0);
+    tradedStarts.push_back(0);
+}
+
+void BookBatch::clear() {
+    marketIds.clear();
+    marketStarts.resize(1);
+    selectionIds.clear();
+    handicaps.clear();
+    for (unsigned level = 0; level < depth; ++level) {
+        backPrices[level].clear();
+        backSizes[level].clear();
+        layPrices[level].clear();
+        laySizes[level].clear();
+    }
+    tradedStarts.resize(1);
+    tradedPrices.clear();
+    tradedSizes.clear();
+}
+
+void BookBatch::add(const MarketBook& marketBook) {
+    const std::vector<Runner>& runners = marketBook.getRunners();
+    for (auto it = runners.begin(); it != runners.end(); ++it) {
+        const Runner& runner = *it;
+        selectionIds.push_back(runner.getSelectionId().isValid() ? runner.getSelectionId().getValue() : 0);
+        handicaps.push_back(runner.getHandicap().isValid() ? runner.getHandicap().getValue() : 0);
+
+        const ExchangePrices& ex = runner.getEx();
+        addLadder(ex.getAvailableToBack(), backPrices, backSizes);
+        addLadder(ex.getAvailableToLay(), layPrices, laySizes);
+
+        const std::vector<PriceSize>& traded = ex.getTradedVolume();
+        for (auto priceSize = traded.begin(); priceSize != traded.end(); ++priceSize) {
+            if (priceSize->getPrice().isValid() && priceSize->getSize().isValid()) {
+                tradedPrices.push_back(priceSize->getPrice().getValue());
+                tradedSizes.push_back(priceSize->getSize().getValue());
+            }
+        }
+        tradedStarts.push_back(tradedPrices.size());
+    }
+    marketIds.push_back(marketBook.getMarketId());
+    marketStarts.push_back(selectionIds.size());
+}
+
+void BookBatch::addLadder(const std::vector<PriceSize>& ladder, std::vector<std::vector<double>>& prices,
+    std::vector<std::vector<double>>& sizes) {
+    for (unsigned level = 0; level < depth; ++level) {
+        double price = 0;
+        double size = 0;
+        if (level < ladder.size() && ladder[level].getPrice().isValid() && ladder[level].getSize().isValid()) {
+            price = ladder[level].getPrice().getValue();
+            size = ladder[level].getSize().getValue();
+        }
+        prices[level].push_back(price);
+        sizes[level].push_back(size);
+    }
+}
+
+unsigned BookBatch::getDepth() const {
+    return depth;
+}
+
+size_t BookBatch::getMarketCount() const {
+    return marketIds.size();
+}
+
+size_t BookBatch::getRunnerCount() const {
+    return selectionIds.size();
+}
+
+const std::string& BookBatch::getMarketId(size_t market) const {
+    return marketIds[market];
+}
+
+size_t BookBatch::getMarketStart(size_t market) const {
+    return marketStarts[market];
+}
+
+int64_t BookBatch::getSelectionId(size_t runner) const {
+    return selectionIds[runner];
+}
+
+double BookBatch::getHandicap(size_t runner) const {
+    return handicaps[runner];
+}
+
+const double* BookBatch::getBackPrices(unsigned level) const {
+    return backPrices[level].data();
+}
+
+const double* BookBatch::getBackSizes(unsigned level) const {
+    return backSizes[level].data();
+}
+
+const double* BookBatch::getLayPrices(unsigned level) const {
+    return layPrices[level].data();
+}
+
+const double* BookBatch::getLaySizes(unsigned level) const {
+    return laySizes[level].data();
+}
+
+size_t BookBatch::getTradedStart(size_t runner) const {
+    return tradedStarts[runner];
+}
+
+const double* BookBatch::getTradedPrices() const {
+    return tradedPrices.data();
+}
+
+const double* BookBatch::getTradedSizes() const {
+    return tradedSizes.data();
+}
+
+}
+}
@@ -0,0 +1,165 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GREENTOP_HAVE_SSE2
+#endif
+
+#include "greentop/analytics/GreeningCalculator.h"
+
+namespace greentop {
+namespace analytics {
+
+namespace {
+
+void prepare(const BookBatch& books, const PositionBatch& positions, GreeningResults& results) {
+    size_t runners = books.getRunnerCount();
+    if (positions.size() != runners) {
+        throw std::runtime_error("the positions don't match the book batch");
+    }
+    results.sides.resize(runners);
+    results.stakes.resize(runners);
+    results.prices.resize(runners);
+    results.profits.resize(runners);
+}
+
+void computeRunner(const BookBatch& books, const PositionBatch& positions, size_t r, GreeningResults& results) {
+    double backStake = positions.getBackStakes()[r];
+    double layStake = positions.getLayStakes()[r];
+    double lose = layStake - backStake;
+    double win = (positions.getBackReturns()[r] - backStake) - (positions.getLayReturns()[r] - layStake);
+    double difference = win - lose;
+    double bestBack = books.getBackPrices(0)[r];
+    double bestLay = books.getLayPrices(0)[r];
+
+    if (difference > 0 && bestLay > 0) {
+        double stake = difference / bestLay;
+        results.sides[r] = HedgeSide::LAY;
+        results.stakes[r] = stake;
+        results.prices[r] = bestLay;
+        results.profits[r] = lose + stake;
+    } else if (difference < 0 && bestBack > 0) {
+        double stake = -difference / bestBack;
+        results.sides[r] = HedgeSide::BACK;
+        results.stakes[r] = stake;
+        results.prices[r] = bestBack;
+        results.profits[r] = lose - stake;
+    } else {
+        results.sides[r] = HedgeSide::NONE;
+        results.stakes[r] = 0;
+        results.prices[r] = 0;
+        results.profits[r] = std::min(win, lose);
+    }
+}
+
+#ifdef GREENTOP_HAVE_SSE2
+
+void computeRunnerPair(const BookBatch& books, const PositionBatch& positions, size_t r,
+    GreeningResults& results) {
+    const __m128d zero = _mm_setzero_pd();
+
+    __m128d backStake = _mm_loadu_pd(positions.getBackStakes() + r);
+    __m128d layStake = _mm_loadu_pd(positions.getLayStakes() + r);
+    __m128d lose = _mm_sub_pd(layStake, backStake);
+    __m128d win = _mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(positions.getBackReturns() + r), backStake),
+        _mm_sub_pd(_mm_loadu_pd(positions.getLayReturns() + r), layStake));
+    __m128d difference = _mm_sub_pd(win, lose);
+    __m128d bestBack = _mm_loadu_pd(books.getBackPrices(0) + r);
+    __m128d bestLay = _mm_loadu_pd(books.getLayPrices(0) + r);
+
+    __m128d lay = _mm_and_pd(_mm_cmpgt_pd(difference, zero), _mm_cmpgt_pd(bestLay, zero));
+    __m128d back = _mm_and_pd(_mm_cmplt_pd(difference, zero), _mm_cmpgt_pd(bestBack, zero));
+    __m128d none = _mm_andnot_pd(_mm_or_pd(lay, back), _mm_castsi128_pd(_mm_set1_epi32(-1)));
+
+    // lanes that would divide by zero are masked out
+    __m128d layStakes = _mm_and_pd(lay, _mm_div_pd(difference, bestLay));
+    __m128d backStakes = _mm_and_pd(back, _mm_div_pd(_mm_sub_pd(zero, difference), bestBack));
+
+    _mm_storeu_pd(&results.stakes[r], _mm_or_pd(layStakes, backStakes));
+    _mm_storeu_pd(&results.prices[r], _mm_or_pd(_mm_and_pd(lay, bestLay), _mm_and_pd(back, bestBack)));
+    _mm_storeu_pd(&results.profits[r], _mm_or_pd(
+        _mm_or_pd(_mm_and_pd(lay, _mm_add_pd(lose, layStakes)), _mm_and_pd(back, _mm_sub_pd(lose, backStakes))),
+        _mm_and_pd(none, _mm_min_pd(win, lose))));
+
+    int layBits = _mm_movemask_pd(lay);
+    int backBits = _mm_movemask_pd(back);
+    for (int i = 0; i < 2; ++i) {
+        results.sides[r + i] = layBits & (1 << i) ? HedgeSide::LAY :
+            backBits & (1 << i) ? HedgeSide::BACK : HedgeSide::NONE;
+    }
+}
+
+#endif
+
+}
+
+const unsigned GreeningCalculator::MAX_INSTRUCTIONS;
+
+void GreeningCalculator::compute(const BookBatch& books, const PositionBatch& positions,
+    GreeningResults& results) {
+#ifdef GREENTOP_HAVE_SSE2
+    prepare(books, positions, results);
+    size_t runners = books.getRunnerCount();
+    size_t r = 0;
+    for (; r + 2 <= runners; r += 2) {
+        computeRunnerPair(books, positions, r, results);
+    }
+    if (r < runners) {
+        computeRunner(books, positions, r, results);
+    }
+#else
+    computeScalar(books, positions, results);
+#endif
+}
+
+void GreeningCalculator::computeScalar(const BookBatch& books, const PositionBatch& positions,
+    GreeningResults& results) {
+    prepare(books, positions, results);
+    for (size_t r = 0; r < books.getRunnerCount(); ++r) {
+        computeRunner(books, positions, r, results);
+    }
+}
+
+std::vector<PlaceOrdersRequest> GreeningCalculator::toPlaceOrdersRequests(const BookBatch& books,
+    const GreeningResults& results, double minimumStake, const PersistenceType& persistenceType,
+    const std::string& customerStrategyRef) {
+    const OrderType limit(OrderType::LIMIT);
+    const Side back(Side::BACK);
+    const Side lay(Side::LAY);
+
+    std::vector<PlaceOrdersRequest> requests;
+    for (size_t m = 0; m < books.getMarketCount(); ++m) {
+        std::vector<PlaceInstruction> instructions;
+        for (size_t r = books.getMarketStart(m); r < books.getMarketStart(m + 1); ++r) {
+            if (results.sides[r] == HedgeSide::NONE) {
+                continue;
+            }
+            double stake = std::round(results.stakes[r] * 100) / 100;
+            if (stake <= 0 || stake < minimumStake) {
+                continue;
+            }
+            instructions.push_back(PlaceInstruction(limit, books.getSelectionId(r), books.getHandicap(r),
+                results.sides[r] == HedgeSide::BACK ? back : lay,
+                LimitOrder(stake, results.prices[r], persistenceType)));
+            if (instructions.size() == MAX_INSTRUCTIONS) {
+                requests.push_back(PlaceOrdersRequest(books.getMarketId(m), instructions, std::string(),
+                    MarketVersion(), customerStrategyRef));
+                instructions.clear();
+            }
+        }
+        if (!instructions.empty()) {
+            requests.push_back(PlaceOrdersRequest(books.getMarketId(m), instructions, std::string(),
+                MarketVersion(), customerStrategyRef));
+        }
+    }
+    return requests;
+}
+
+}
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <unordered_map>
+
+#include "greentop/analytics/PositionBatch.h"
+
+namespace greentop {
+namespace analytics {
+
+PositionBatch::PositionBatch() {
+}
+
+void PositionBatch::reset(size_t runners) {
+    backStakes.assign(runners, 0);
+    backReturns.assign(runners, 0);
+    layStakes.assign(runners, 0);
+    layReturns.assign(runners, 0);
+}
+
+void PositionBatch::add(size_t runner, const Side& side, double price, double size) {
+    static const Side back(Side::BACK);
+    if (side == back) {
+        backStakes[runner] += size;
+        backReturns[runner] += size * price;
+    } else {
+        layStakes[runner] += size;
+        layReturns[runner] += size * price;
+    }
+}
+
+size_t PositionBatch::add(const BookBatch& books, const std::vector<CurrentOrderSummary>& orders) {
+    std::unordered_map<std::string, size_t> markets;
+    for (size_t m = 0; m < books.getMarketCount(); ++m) {
+        markets[books.getMarketId(m)] = m;
+    }
+
+    size_t added = 0;
+    for (auto it = orders.begin(); it != orders.end(); ++it) {
+        const CurrentOrderSummary& order = *it;
+        if (!order.getSizeMatched().isValid() || order.getSizeMatched().getValue() <= 0 ||
+            !order.getAveragePriceMatched().isValid() || !order.getSelectionId().isValid()) {
+            continue;
+        }
+        auto market = markets.find(order.getMarketId());
+        if (market == markets.end()) {
+            continue;
+        }
+        int64_t selectionId = order.getSelectionId().getValue();
+        double handicap = order.getHandicap().isValid() ? order.getHandicap().getValue() : 0;
+        for (size_t r = books.getMarketStart(market->second); r < books.getMarketStart(market->second + 1); ++r) {
+            if (books.getSelectionId(r) == selectionId && books.getHandicap(r) == handicap) {
+                add(r, order.getSide(), order.getAveragePriceMatched().getValue(),
+                    order.getSizeMatched().getValue());
+                ++added;
+                break;
+            }
+        }
+    }
+    return added;
+}
+
+size_t PositionBatch::size() const {
+    return backStakes.size();
+}
+
+double PositionBatch::getBackStake(size_t runner) const {
+    return backStakes[runner];
+}
+
+double PositionBatch::getAverageBackPrice(size_t runner) const {
+    return backStakes[runner] > 0 ? backReturns[runner] / backStakes[runner] : 0;
+}
+
+double PositionBatch::getLayStake(size_t runner) const {
+    return layStakes[runner];
+}
+
+double PositionBatch::getAverageLayPrice(size_t runner) const {
+    return layStakes[runner] > 0 ? layReturns[runner] / layStakes[runner] : 0;
+}
+
+const double* PositionBatch::getBackStakes() const {
+    return backStakes.data();
+}
+
+const double* PositionBatch::getBackReturns() const {
+    return backReturns.data();
+}
+
+const double* PositionBatch::getLayStakes() const {
+    return layStakes.data();
+}
+
+const double* PositionBatch::getLayReturns() const {
+    return layReturns.data();
+}
+
+}
+}
@@ -0,0 +1,32 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/archive/ColumnarFormat.h"
+
+namespace greentop {
+namespace archive {
+
+const uint32_t ColumnarFormat::FILE_MAGIC;
+const uint32_t ColumnarFormat::FILE_VERSION;
+const uint32_t ColumnarFormat::DICTIONARY_MAGIC;
+const uint32_t ColumnarFormat::BLOCK_MAGIC;
+const size_t ColumnarFormat::DICTIONARY_HEADER_SIZE;
+const size_t ColumnarFormat::BLOCK_HEADER_SIZE;
+const size_t ColumnarFormat::ALIGNMENT;
+const int64_t ColumnarFormat::NULL_INT64;
+
+bool ColumnarFormat::Column::operator==(const Column& other) const {
+    return name == other.name && type == other.type;
+}
+
+bool ColumnarFormat::Column::operator!=(const Column& other) const {
+    return !(*this == other);
+}
+
+size_t ColumnarFormat::getPadding(size_t length) {
+    return (ALIGNMENT - length % ALIGNMENT) % ALIGNMENT;
+}
+
+}
+}
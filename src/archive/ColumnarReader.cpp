@@ -0,0 +1,181 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include "greentop/archive/ColumnarReader.h"
+#include "greentop/archive/Encoding.h"
+
+namespace greentop {
+namespace archive {
+
+namespace {
+
+uint32_t readFixed32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+}
+
+ColumnarReader::ColumnarReader(const std::string& fileName) : file(fileName), rowCount(0) {
+    ByteReader header(file.data(), file.size());
+    if (header.getFixed32() != ColumnarFormat::FILE_MAGIC) {
+        throw std::runtime_error(fileName + " is not a columnar file");
+    }
+    if (header.getFixed32() != ColumnarFormat::FILE_VERSION) {
+        throw std::runtime_error(fileName + " has an unsupported version");
+    }
+    columns.resize(header.getVarint());
+    for (ColumnarFormat::Column& column : columns) {
+        column.name = header.getString();
+        column.type = static_cast<ColumnarFormat::Type>(header.getVarint());
+    }
+    header.getBytes(ColumnarFormat::getPadding(header.position()));
+    symbols.push_back("");
+
+    // the session that completed each window, the first if it was exported more than once
+    std::map<std::pair<int64_t, int64_t>, uint32_t> completeWindows;
+    std::vector<std::pair<Block, uint32_t>> candidates;
+
+    size_t offset = header.position();
+    while (file.size() - offset >= ColumnarFormat::DICTIONARY_HEADER_SIZE) {
+        ByteReader record(file.data() + offset, file.size() - offset);
+        uint32_t magic = record.getFixed32();
+        uint32_t countOrFlags = record.getFixed32();
+        uint64_t payloadLength = record.getFixed64();
+        if (magic == ColumnarFormat::DICTIONARY_MAGIC) {
+            if (record.remaining() < payloadLength) {
+                break;
+            }
+            ByteReader payload(record.getBytes(payloadLength), payloadLength);
+            for (uint32_t i = 0; i < countOrFlags; ++i) {
+                symbols.push_back(payload.getString());
+            }
+            offset += ColumnarFormat::DICTIONARY_HEADER_SIZE;
+        } else if (magic == ColumnarFormat::BLOCK_MAGIC) {
+            if (record.remaining() < ColumnarFormat::BLOCK_HEADER_SIZE - ColumnarFormat::DICTIONARY_HEADER_SIZE) {
+                break;
+            }
+            Block block;
+            block.from = static_cast<int64_t>(record.getFixed64());
+            block.to = static_cast<int64_t>(record.getFixed64());
+            block.rowCount = record.getFixed32();
+            uint32_t session = record.getFixed32();
+            if (record.remaining() < payloadLength) {
+                break;
+            }
+            ByteReader payload(record.getBytes(payloadLength), payloadLength);
+            for (const ColumnarFormat::Column& column : columns) {
+                block.columns.push_back(payload.getBytes(0));
+                size_t width = column.type == ColumnarFormat::SYMBOL || column.type == ColumnarFormat::TEXT ?
+                    sizeof(uint32_t) : sizeof(uint64_t);
+                size_t length = block.rowCount * width;
+                if (column.type == ColumnarFormat::TEXT) {
+                    payload.getBytes(length);
+                    length = readFixed32(payload.getBytes(sizeof(uint32_t)));
+                }
+                payload.getBytes(length);
+                payload.getBytes(ColumnarFormat::getPadding(payload.position()));
+            }
+            if ((countOrFlags & ColumnarFormat::WINDOW_COMPLETE) != 0) {
+                completeWindows.insert(std::make_pair(std::make_pair(block.from, block.to), session));
+            }
+            candidates.push_back(std::make_pair(block, session));
+            offset += ColumnarFormat::BLOCK_HEADER_SIZE;
+        } else {
+            break;
+        }
+        offset += payloadLength + ColumnarFormat::getPadding(payloadLength);
+        if (offset > file.size()) {
+            break;
+        }
+    }
+
+    for (const std::pair<Block, uint32_t>& candidate : candidates) {
+        auto it = completeWindows.find(std::make_pair(candidate.first.from, candidate.first.to));
+        if (it != completeWindows.end() && it->second == candidate.second) {
+            blocks.push_back(candidate.first);
+            rowCount += candidate.first.rowCount;
+        }
+    }
+}
+
+const std::vector<ColumnarFormat::Column>& ColumnarReader::getColumns() const {
+    return columns;
+}
+
+size_t ColumnarReader::findColumn(const std::string& name) const {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].name == name) {
+            return i;
+        }
+    }
+    throw std::runtime_error("no column " + name);
+}
+
+size_t ColumnarReader::getBlockCount() const {
+    return blocks.size();
+}
+
+uint32_t ColumnarReader::getRowCount(size_t block) const {
+    return blocks.at(block).rowCount;
+}
+
+uint64_t ColumnarReader::getRowCount() const {
+    return rowCount;
+}
+
+int64_t ColumnarReader::getWindowFrom(size_t block) const {
+    return blocks.at(block).from;
+}
+
+int64_t ColumnarReader::getWindowTo(size_t block) const {
+    return blocks.at(block).to;
+}
+
+const char* ColumnarReader::getColumn(size_t block, size_t column, ColumnarFormat::Type type) const {
+    if (columns.at(column).type != type) {
+        throw std::runtime_error("column " + columns[column].name + " has a different type");
+    }
+    return blocks.at(block).columns[column];
+}
+
+const int64_t* ColumnarReader::getInt64s(size_t block, size_t column) const {
+    return reinterpret_cast<const int64_t*>(getColumn(block, column, ColumnarFormat::INT64));
+}
+
+const double* ColumnarReader::getDoubles(size_t block, size_t column) const {
+    return reinterpret_cast<const double*>(getColumn(block, column, ColumnarFormat::DOUBLE));
+}
+
+const uint32_t* ColumnarReader::getSymbols(size_t block, size_t column) const {
+    return reinterpret_cast<const uint32_t*>(getColumn(block, column, ColumnarFormat::SYMBOL));
+}
+
+const std::string& ColumnarReader::getSymbol(uint32_t id) const {
+    return symbols.at(id);
+}
+
+uint32_t ColumnarReader::getSymbolCount() const {
+    return static_cast<uint32_t>(symbols.size());
+}
+
+std::string ColumnarReader::getText(size_t block, size_t column, uint32_t row) const {
+    const char* data = getColumn(block, column, ColumnarFormat::TEXT);
+    uint32_t rows = blocks[block].rowCount;
+    if (row >= rows) {
+        throw std::out_of_range("row out of range");
+    }
+    const char* text = data + (rows + 1) * sizeof(uint32_t);
+    uint32_t begin = readFixed32(data + row * sizeof(uint32_t));
+    uint32_t end = readFixed32(data + (row + 1) * sizeof(uint32_t));
+    return std::string(text + begin, end - begin);
+}
+
+}
+}
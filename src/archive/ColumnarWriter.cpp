@@ -0,0 +1,335 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "greentop/archive/ColumnarWriter.h"
+#include "greentop/archive/Encoding.h"
+#include "greentop/archive/MappedFile.h"
+
+namespace greentop {
+namespace archive {
+
+namespace {
+
+void pad(ByteWriter& writer) {
+    static const char zeros[ColumnarFormat::ALIGNMENT] = {};
+    writer.putBytes(zeros, ColumnarFormat::getPadding(writer.size()));
+}
+
+void truncateFile(const std::string& fileName, uint64_t length) {
+#ifdef _WIN32
+    int fd = -1;
+    if (_sopen_s(&fd, fileName.c_str(), _O_RDWR | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE) != 0) {
+        throw std::runtime_error("cannot open " + fileName);
+    }
+    int result = _chsize_s(fd, static_cast<__int64>(length));
+    _close(fd);
+#else
+    int result = ::truncate(fileName.c_str(), static_cast<off_t>(length));
+#endif
+    if (result != 0) {
+        throw std::runtime_error("cannot truncate " + fileName);
+    }
+}
+
+}
+
+ColumnarBlock::ColumnarBlock(const std::vector<ColumnarFormat::Column>& columns) :
+    columns(columns.size()), rowCount(0) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        this->columns[i].type = columns[i].type;
+        this->columns[i].offsets.push_back(0);
+    }
+}
+
+void ColumnarBlock::putInt64(size_t column, int64_t value) {
+    columns.at(column).int64s.push_back(value);
+}
+
+void ColumnarBlock::putDouble(size_t column, double value) {
+    columns.at(column).doubles.push_back(value);
+}
+
+void ColumnarBlock::putSymbol(size_t column, const std::string& value) {
+    columns.at(column).symbols.push_back(value);
+}
+
+void ColumnarBlock::putText(size_t column, const std::string& value) {
+    ColumnData& data = columns.at(column);
+    data.text += value;
+    data.offsets.push_back(static_cast<uint32_t>(data.text.size()));
+}
+
+void ColumnarBlock::endRow() {
+    ++rowCount;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].size() != rowCount) {
+            throw std::runtime_error("column " + std::to_string(i) + " has the wrong number of values");
+        }
+    }
+}
+
+uint32_t ColumnarBlock::getRowCount() const {
+    return rowCount;
+}
+
+void ColumnarBlock::clear() {
+    for (ColumnData& data : columns) {
+        data.int64s.clear();
+        data.doubles.clear();
+        data.symbols.clear();
+        data.offsets.resize(1);
+        data.text.clear();
+    }
+    rowCount = 0;
+}
+
+size_t ColumnarBlock::ColumnData::size() const {
+    switch (type) {
+        case ColumnarFormat::INT64:
+            return int64s.size();
+        case ColumnarFormat::DOUBLE:
+            return doubles.size();
+        case ColumnarFormat::SYMBOL:
+            return symbols.size();
+        default:
+            return offsets.size() - 1;
+    }
+}
+
+ColumnarWriter::ColumnarWriter(const std::string& fileName, const std::vector<ColumnarFormat::Column>& columns) :
+    columns(columns), session(0), rowsWritten(0) {
+    symbolIds[""] = 0;
+    uint64_t length = load(fileName);
+
+    if (length == 0) {
+        output.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+        if (!output) {
+            throw std::runtime_error("cannot create " + fileName);
+        }
+        ByteWriter header;
+        header.putFixed32(ColumnarFormat::FILE_MAGIC);
+        header.putFixed32(ColumnarFormat::FILE_VERSION);
+        header.putVarint(columns.size());
+        for (const ColumnarFormat::Column& column : columns) {
+            header.putString(column.name);
+            header.putVarint(column.type);
+        }
+        pad(header);
+        output.write(header.getBuffer().data(), header.size());
+        output.flush();
+    } else {
+        output.open(fileName.c_str(), std::ios::binary | std::ios::app);
+    }
+    if (!output) {
+        throw std::runtime_error("cannot write " + fileName);
+    }
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+    }
+}
+
+uint64_t ColumnarWriter::load(const std::string& fileName) {
+    if (!std::ifstream(fileName.c_str())) {
+        return 0;
+    }
+
+    uint64_t valid = 0;
+    uint64_t fileSize = 0;
+    uint32_t lastSession = 0;
+    {
+        MappedFile file(fileName);
+        fileSize = file.size();
+        if (fileSize == 0) {
+            return 0;
+        }
+
+        ByteReader header(file.data(), file.size());
+        if (header.getFixed32() != ColumnarFormat::FILE_MAGIC) {
+            throw std::runtime_error(fileName + " is not a columnar file");
+        }
+        if (header.getFixed32() != ColumnarFormat::FILE_VERSION) {
+            throw std::runtime_error(fileName + " has an unsupported version");
+        }
+        std::vector<ColumnarFormat::Column> existing(header.getVarint());
+        for (ColumnarFormat::Column& column : existing) {
+            column.name = header.getString();
+            column.type = static_cast<ColumnarFormat::Type>(header.getVarint());
+        }
+        if (existing != columns) {
+            throw std::runtime_error(fileName + " has different columns");
+        }
+        header.getBytes(ColumnarFormat::getPadding(header.position()));
+
+        // stop at the first record that wasn't written in full
+        valid = header.position();
+        while (fileSize - valid >= ColumnarFormat::DICTIONARY_HEADER_SIZE) {
+            ByteReader record(file.data() + valid, fileSize - valid);
+            uint32_t magic = record.getFixed32();
+            uint32_t countOrFlags = record.getFixed32();
+            uint64_t payloadLength = record.getFixed64();
+            uint64_t headerSize;
+            if (magic == ColumnarFormat::DICTIONARY_MAGIC) {
+                headerSize = ColumnarFormat::DICTIONARY_HEADER_SIZE;
+            } else if (magic == ColumnarFormat::BLOCK_MAGIC) {
+                headerSize = ColumnarFormat::BLOCK_HEADER_SIZE;
+            } else {
+                break;
+            }
+            uint64_t available = fileSize - valid;
+            if (available < headerSize || available - headerSize < payloadLength +
+                ColumnarFormat::getPadding(payloadLength)) {
+                break;
+            }
+
+            if (magic == ColumnarFormat::DICTIONARY_MAGIC) {
+                ByteReader payload(record.getBytes(payloadLength), payloadLength);
+                for (uint32_t i = 0; i < countOrFlags; ++i) {
+                    symbolIds.insert(std::make_pair(payload.getString(), static_cast<uint32_t>(symbolIds.size())));
+                }
+            } else {
+                int64_t from = static_cast<int64_t>(record.getFixed64());
+                int64_t to = static_cast<int64_t>(record.getFixed64());
+                record.getFixed32();
+                uint32_t blockSession = record.getFixed32();
+                if ((countOrFlags & ColumnarFormat::WINDOW_COMPLETE) != 0) {
+                    completeWindows.insert(std::make_pair(from, to));
+                }
+                lastSession = std::max(lastSession, blockSession);
+            }
+            valid += headerSize + payloadLength + ColumnarFormat::getPadding(payloadLength);
+        }
+    }
+
+    if (valid < fileSize) {
+        truncateFile(fileName, valid);
+    }
+    session = lastSession + 1;
+    return valid;
+}
+
+const std::vector<ColumnarFormat::Column>& ColumnarWriter::getColumns() const {
+    return columns;
+}
+
+bool ColumnarWriter::isComplete(int64_t from, int64_t to) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return completeWindows.find(std::make_pair(from, to)) != completeWindows.end();
+}
+
+uint32_t ColumnarWriter::getSymbolId(const std::string& symbol, std::vector<std::string>& added) {
+    auto it = symbolIds.find(symbol);
+    if (it == symbolIds.end()) {
+        it = symbolIds.insert(std::make_pair(symbol, static_cast<uint32_t>(symbolIds.size()))).first;
+        added.push_back(symbol);
+    }
+    return it->second;
+}
+
+void ColumnarWriter::write(const ColumnarBlock& block, int64_t from, int64_t to, bool complete) {
+    if (block.columns.size() != columns.size()) {
+        throw std::runtime_error("block has the wrong number of columns");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!output.is_open()) {
+        throw std::runtime_error("writer is closed");
+    }
+
+    std::vector<std::string> added;
+    ByteWriter payload;
+    for (const ColumnarBlock::ColumnData& data : block.columns) {
+        switch (data.type) {
+            case ColumnarFormat::INT64:
+                for (int64_t value : data.int64s) {
+                    payload.putFixed64(static_cast<uint64_t>(value));
+                }
+                break;
+            case ColumnarFormat::DOUBLE:
+                for (double value : data.doubles) {
+                    uint64_t bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    payload.putFixed64(bits);
+                }
+                break;
+            case ColumnarFormat::SYMBOL:
+                for (const std::string& value : data.symbols) {
+                    payload.putFixed32(getSymbolId(value, added));
+                }
+                break;
+            default:
+                for (uint32_t offset : data.offsets) {
+                    payload.putFixed32(offset);
+                }
+                payload.putBytes(data.text.data(), data.text.size());
+                break;
+        }
+        pad(payload);
+    }
+
+    // new symbols go in a dictionary record ahead of the block that uses them
+    ByteWriter record;
+    if (!added.empty()) {
+        ByteWriter dictionary;
+        for (const std::string& symbol : added) {
+            dictionary.putString(symbol);
+        }
+        record.putFixed32(ColumnarFormat::DICTIONARY_MAGIC);
+        record.putFixed32(static_cast<uint32_t>(added.size()));
+        record.putFixed64(dictionary.size());
+        record.putBytes(dictionary.getBuffer().data(), dictionary.size());
+        pad(record);
+    }
+    record.putFixed32(ColumnarFormat::BLOCK_MAGIC);
+    record.putFixed32(complete ? ColumnarFormat::WINDOW_COMPLETE : 0);
+    record.putFixed64(payload.size());
+    record.putFixed64(static_cast<uint64_t>(from));
+    record.putFixed64(static_cast<uint64_t>(to));
+    record.putFixed32(block.rowCount);
+    record.putFixed32(session);
+    record.putBytes(payload.getBuffer().data(), payload.size());
+
+    output.write(record.getBuffer().data(), record.size());
+    if (complete) {
+        output.flush();
+    }
+    if (!output) {
+        throw std::runtime_error("cannot write block");
+    }
+    rowsWritten += block.rowCount;
+    if (complete) {
+        completeWindows.insert(std::make_pair(from, to));
+    }
+}
+
+void ColumnarWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (output.is_open()) {
+        output.close();
+    }
+}
+
+uint64_t ColumnarWriter::getRowsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return rowsWritten;
+}
+
+}
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <stdexcept>
+
+#include "greentop/archive/Encoding.h"
+
+namespace greentop {
+namespace archive {
+
+ByteWriter::ByteWriter() {
+}
+
+void ByteWriter::putFixed32(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    buffer.append(bytes, 4);
+}
+
+void ByteWriter::putFixed64(uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    buffer.append(bytes, 8);
+}
+
+void ByteWriter::putString(const std::string& value) {
+    putVarint(value.size());
+    buffer.append(value);
+}
+
+void ByteWriter::putBytes(const char* data, size_t length) {
+    buffer.append(data, length);
+}
+
+const std::string& ByteWriter::getBuffer() const {
+    return buffer;
+}
+
+size_t ByteWriter::size() const {
+    return buffer.size();
+}
+
+void ByteWriter::clear() {
+    buffer.clear();
+}
+
+ByteReader::ByteReader() : begin(NULL), current(NULL), end(NULL) {
+}
+
+ByteReader::ByteReader(const char* data, size_t length) : begin(data), current(data), end(data + length) {
+}
+
+uint32_t ByteReader::getFixed32() {
+    require(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(current[i])) << (8 * i);
+    }
+    current += 4;
+    return value;
+}
+
+uint64_t ByteReader::getFixed64() {
+    require(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(current[i])) << (8 * i);
+    }
+    current += 8;
+    return value;
+}
+
+std::string ByteReader::getString() {
+    size_t length = static_cast<size_t>(getVarint());
+    const char* data = getBytes(length);
+    return std::string(data, length);
+}
+
+const char* ByteReader::getBytes(size_t length) {
+    require(length);
+    const char* data = current;
+    current += length;
+    return data;
+}
+
+size_t ByteReader::remaining() const {
+    return end - current;
+}
+
+size_t ByteReader::position() const {
+    return current - begin;
+}
+
+bool ByteReader::atEnd() const {
+    return current == end;
+}
+
+}
+}
@@ -0,0 +1,161 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "greentop/archive/HistoricalDataReader.h"
+
+namespace greentop {
+namespace archive {
+
+HistoricalDataReader::HistoricalDataReader(const std::string& fileName) :
+    lineReader(fileName),
+    publishTime(0) {
+    Json::CharReaderBuilder builder;
+    builder["collectComments"] = false;
+    jsonReader.reset(builder.newCharReader());
+}
+
+void HistoricalDataReader::setMarketFilter(const std::set<std::string>& marketIds) {
+    marketFilter = marketIds;
+}
+
+bool HistoricalDataReader::readMessage() {
+    const char* data;
+    size_t length;
+    std::string errors;
+    while (lineReader.next(data, length)) {
+        if (!jsonReader->parse(data, data + length, &message, &errors)) {
+            throw std::runtime_error("invalid historical data message: " + errors);
+        }
+        if (message.isObject() && message["op"].asString() == "mcm") {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HistoricalDataReader::applyMessage(const ChangeCallback* callback, uint64_t& changes) {
+    if (!readMessage()) {
+        return false;
+    }
+    publishTime = message["pt"].asInt64();
+    const Json::Value& marketChanges = message["mc"];
+    for (unsigned i = 0; i < marketChanges.size(); ++i) {
+        const Json::Value& marketChange = marketChanges[i];
+        std::string marketId = marketChange["id"].asString();
+        if (!marketFilter.empty() && marketFilter.count(marketId) == 0) {
+            continue;
+        }
+        cache.applyMarketChange(marketChange, publishTime);
+        if (marketChange.isMember("marketDefinition")) {
+            // sent as a string
+            const Json::Value& eventTypeId = marketChange["marketDefinition"]["eventTypeId"];
+            if (eventTypeId.isString()) {
+                eventTypeIds[marketId] = std::atoi(eventTypeId.asCString());
+            } else if (eventTypeId.isNumeric()) {
+                eventTypeIds[marketId] = eventTypeId.asInt();
+            }
+        }
+        ++changes;
+        if (callback) {
+            (*callback)(publishTime, marketChange);
+        } else {
+            changedMarketIds.push_back(marketId);
+        }
+    }
+    return true;
+}
+
+bool HistoricalDataReader::next(RecordedMarketBook& recorded) {
+    uint64_t changes = 0;
+    while (changedMarketIds.empty()) {
+        if (!applyMessage(NULL, changes)) {
+            return false;
+        }
+    }
+    std::string marketId = changedMarketIds.front();
+    changedMarketIds.pop_front();
+    recorded.receivedTime = publishTime;
+    auto eventTypeId = eventTypeIds.find(marketId);
+    recorded.eventTypeId = eventTypeId != eventTypeIds.end() ? eventTypeId->second : 0;
+    recorded.marketBook = cache.getMarketBook(marketId);
+    return true;
+}
+
+uint64_t HistoricalDataReader::read(const MarketBookCallback& callback) {
+    uint64_t count = 0;
+    RecordedMarketBook recorded;
+    while (next(recorded)) {
+        callback(recorded);
+        ++count;
+    }
+    return count;
+}
+
+uint64_t HistoricalDataReader::readChanges(const ChangeCallback& callback) {
+    uint64_t changes = 0;
+    while (applyMessage(&callback, changes)) {
+    }
+    return changes;
+}
+
+const stream::MarketCache& HistoricalDataReader::getCache() const {
+    return cache;
+}
+
+uint64_t HistoricalDataReader::readFiles(const std::vector<std::string>& fileNames,
+    const MarketBookCallback& callback, unsigned threads, const std::set<std::string>& marketIds) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > fileNames.size()) {
+        threads = static_cast<unsigned>(fileNames.size());
+    }
+
+    std::atomic<size_t> nextFile(0);
+    std::atomic<uint64_t> count(0);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto worker = [&]() {
+        size_t index;
+        while ((index = nextFile++) < fileNames.size()) {
+            try {
+                HistoricalDataReader reader(fileNames[index]);
+                reader.setMarketFilter(marketIds);
+                count += reader.read(callback);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return count;
+}
+
+}
+}
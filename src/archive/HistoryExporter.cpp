@@ -0,0 +1,378 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "greentop/Time.h"
+#include "greentop/archive/ColumnarWriter.h"
+#include "greentop/archive/HistoryExporter.h"
+
+namespace greentop {
+namespace archive {
+
+namespace {
+
+/**
+ * A slice of the requested date range, in seconds since the epoch.  The last window includes its end.
+ */
+struct Window {
+    std::time_t from;
+    std::time_t to;
+    bool last;
+
+    bool contains(std::time_t time) const {
+        return time >= from && (time < to || (last && time == to));
+    }
+};
+
+typedef std::function<uint64_t(const Window&, ColumnarBlock&)> WindowExporter;
+
+bool isSet(const std::tm& tm) {
+    return tm.tm_year > 0;
+}
+
+int64_t toMillis(const std::tm& tm) {
+    return isSet(tm) ? static_cast<int64_t>(toTime(tm)) * 1000 : ColumnarFormat::NULL_INT64;
+}
+
+double getOrNull(const Optional<double>& value) {
+    return value.isValid() ? value.getValue() : std::numeric_limits<double>::quiet_NaN();
+}
+
+template<class T>
+int64_t getOrNull(const Optional<T>& value) {
+    return value.isValid() ? static_cast<int64_t>(value.getValue()) : ColumnarFormat::NULL_INT64;
+}
+
+std::vector<Window> split(const TimeRange& range, std::time_t window, const std::string& name) {
+    if (!isSet(range.getFrom()) || !isSet(range.getTo())) {
+        throw std::runtime_error("the request needs a " + name + " with both ends");
+    }
+    std::time_t from = toTime(range.getFrom());
+    std::time_t to = toTime(range.getTo());
+    if (to < from) {
+        throw std::runtime_error(name + " ends before it starts");
+    }
+    std::vector<Window> windows;
+    do {
+        Window slice;
+        slice.from = from;
+        slice.to = to - from > window ? from + window : to;
+        slice.last = slice.to == to;
+        windows.push_back(slice);
+        from = slice.to;
+    } while (from < to);
+    return windows;
+}
+
+/**
+ * Export the windows the file doesn't have yet, several at a time.
+ */
+uint64_t exportWindows(ColumnarWriter& writer, const std::vector<Window>& windows, unsigned threads,
+        const WindowExporter& exportWindow) {
+    std::vector<Window> pending;
+    for (const Window& window : windows) {
+        if (!writer.isComplete(window.from * 1000, window.to * 1000)) {
+            pending.push_back(window);
+        }
+    }
+    threads = std::max(1u, std::min(threads, static_cast<unsigned>(pending.size())));
+
+    std::atomic<size_t> nextWindow(0);
+    std::atomic<uint64_t> count(0);
+    std::atomic<bool> failed(false);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto worker = [&]() {
+        ColumnarBlock block(writer.getColumns());
+        size_t index;
+        while (!failed && (index = nextWindow++) < pending.size()) {
+            try {
+                block.clear();
+                count += exportWindow(pending[index], block);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return count;
+}
+
+void encode(const ClearedOrderSummary& order, ColumnarBlock& block) {
+    const ItemDescription& item = order.getItemDescription();
+    size_t column = 0;
+    block.putSymbol(column++, order.getEventTypeId());
+    block.putSymbol(column++, order.getEventId());
+    block.putSymbol(column++, order.getMarketId());
+    block.putInt64(column++, getOrNull(order.getSelectionId()));
+    block.putDouble(column++, getOrNull(order.getHandicap()));
+    block.putText(column++, order.getBetId());
+    block.putInt64(column++, toMillis(order.getPlacedDate()));
+    block.putSymbol(column++, order.getPersistenceType().getValue());
+    block.putSymbol(column++, order.getOrderType().getValue());
+    block.putSymbol(column++, order.getSide().getValue());
+    block.putSymbol(column++, order.getBetOutcome());
+    block.putDouble(column++, getOrNull(order.getPriceRequested()));
+    block.putInt64(column++, toMillis(order.getSettledDate()));
+    block.putInt64(column++, toMillis(order.getLastMatchedDate()));
+    block.putInt64(column++, getOrNull(order.getBetCount()));
+    block.putDouble(column++, getOrNull(order.getCommission()));
+    block.putDouble(column++, getOrNull(order.getPriceMatched()));
+    block.putInt64(column++, getOrNull(order.getPriceReduced()));
+    block.putDouble(column++, getOrNull(order.getSizeSettled()));
+    block.putDouble(column++, getOrNull(order.getProfit()));
+    block.putDouble(column++, getOrNull(order.getSizeCancelled()));
+    block.putText(column++, order.getCustomerOrderRef());
+    block.putSymbol(column++, order.getCustomerStrategyRef());
+    block.putSymbol(column++, item.getEventTypeDesc());
+    block.putSymbol(column++, item.getEventDesc());
+    block.putSymbol(column++, item.getMarketDesc());
+    block.putSymbol(column++, item.getMarketType());
+    block.putInt64(column++, toMillis(item.getMarketStartTime()));
+    block.putSymbol(column++, item.getRunnerDesc());
+    block.putInt64(column++, getOrNull(item.getNumberOfWinners()));
+    block.putDouble(column++, getOrNull(item.getEachWayDivisor()));
+    block.endRow();
+}
+
+void encode(const StatementItem& item, ColumnarBlock& block, Json::StreamWriterBuilder& builder) {
+    const StatementLegacyData& legacy = item.getLegacyData();
+    std::string itemClassData;
+    if (!item.getItemClassData().empty()) {
+        Json::Value json(Json::objectValue);
+        for (auto it = item.getItemClassData().begin(); it != item.getItemClassData().end(); ++it) {
+            json[it->first] = it->second;
+        }
+        itemClassData = Json::writeString(builder, json);
+    }
+    size_t column = 0;
+    block.putText(column++, item.getRefId());
+    block.putInt64(column++, toMillis(item.getItemDate()));
+    block.putDouble(column++, getOrNull(item.getAmount()));
+    block.putDouble(column++, getOrNull(item.getBalance()));
+    block.putSymbol(column++, item.getItemClass().getValue());
+    block.putText(column++, itemClassData);
+    block.putDouble(column++, getOrNull(legacy.getAvgPrice()));
+    block.putDouble(column++, getOrNull(legacy.getBetSize()));
+    block.putSymbol(column++, legacy.getBetType());
+    block.putSymbol(column++, legacy.getBetCategoryType());
+    block.putSymbol(column++, legacy.getCommissionRate());
+    block.putInt64(column++, getOrNull(legacy.getEventId()));
+    block.putInt64(column++, getOrNull(legacy.getEventTypeId()));
+    block.putSymbol(column++, legacy.getFullMarketName());
+    block.putDouble(column++, getOrNull(legacy.getGrossBetAmount()));
+    block.putSymbol(column++, legacy.getMarketName());
+    block.putSymbol(column++, legacy.getMarketType());
+    block.putInt64(column++, toMillis(legacy.getPlacedDate()));
+    block.putInt64(column++, getOrNull(legacy.getSelectionId()));
+    block.putSymbol(column++, legacy.getSelectionName());
+    block.putInt64(column++, toMillis(legacy.getStartDate()));
+    block.putSymbol(column++, legacy.getTransactionType());
+    block.putInt64(column++, getOrNull(legacy.getTransactionId()));
+    block.putSymbol(column++, legacy.getWinLose());
+    block.endRow();
+}
+
+}
+
+const int32_t HistoryExporter::MAX_CLEARED_ORDERS;
+const int32_t HistoryExporter::MAX_STATEMENT_ITEMS;
+
+HistoryExporter::HistoryExporter(const ExchangeApi& exchangeApi) :
+    exchangeApi(exchangeApi),
+    window(24 * 60 * 60),
+    threads(4),
+    blockRows(4096) {
+}
+
+void HistoryExporter::setWindow(std::time_t window) {
+    this->window = std::max<std::time_t>(1, window);
+}
+
+void HistoryExporter::setThreads(unsigned threads) {
+    this->threads = std::max(1u, threads);
+}
+
+void HistoryExporter::setBlockRows(uint32_t blockRows) {
+    this->blockRows = std::max(1u, blockRows);
+}
+
+uint64_t HistoryExporter::exportClearedOrders(const ListClearedOrdersRequest& request,
+        const std::string& fileName) {
+    std::vector<Window> windows = split(request.getSettledDateRange(), window, "settledDateRange");
+    ColumnarWriter writer(fileName, getClearedOrderColumns());
+
+    return exportWindows(writer, windows, threads, [&](const Window& slice, ColumnarBlock& block) {
+        ListClearedOrdersRequest sliceRequest(request);
+        sliceRequest.setSettledDateRange(TimeRange(fromTime(slice.from), fromTime(slice.to)));
+        sliceRequest.setRecordCount(MAX_CLEARED_ORDERS);
+        uint64_t count = 0;
+        int32_t fromRecord = 0;
+        bool moreAvailable = true;
+        while (moreAvailable) {
+            sliceRequest.setFromRecord(fromRecord);
+            ClearedOrderSummaryReport report = exchangeApi.listClearedOrders(sliceRequest);
+            if (!report.isSuccess()) {
+                throw std::runtime_error("listClearedOrders failed: " + report.getFaultString());
+            }
+            const std::vector<ClearedOrderSummary>& orders = report.getClearedOrders();
+            for (const ClearedOrderSummary& order : orders) {
+                // a window's ends are whole seconds and are shared with its neighbours
+                const std::tm& settledDate = order.getSettledDate();
+                if (isSet(settledDate) && !slice.contains(toTime(settledDate))) {
+                    continue;
+                }
+                encode(order, block);
+                ++count;
+                if (block.getRowCount() >= blockRows) {
+                    writer.write(block, slice.from * 1000, slice.to * 1000, false);
+                    block.clear();
+                }
+            }
+            fromRecord += static_cast<int32_t>(orders.size());
+            moreAvailable = !orders.empty() && report.getMoreAvailable().isValid() &&
+                report.getMoreAvailable().getValue();
+        }
+        writer.write(block, slice.from * 1000, slice.to * 1000, true);
+        return count;
+    });
+}
+
+uint64_t HistoryExporter::exportAccountStatement(const GetAccountStatementRequest& request,
+        const std::string& fileName) {
+    std::vector<Window> windows = split(request.getItemDateRange(), window, "itemDateRange");
+    ColumnarWriter writer(fileName, getStatementColumns());
+
+    return exportWindows(writer, windows, threads, [&](const Window& slice, ColumnarBlock& block) {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        GetAccountStatementRequest sliceRequest(request);
+        sliceRequest.setItemDateRange(TimeRange(fromTime(slice.from), fromTime(slice.to)));
+        sliceRequest.setRecordCount(MAX_STATEMENT_ITEMS);
+        uint64_t count = 0;
+        int32_t fromRecord = 0;
+        bool moreAvailable = true;
+        while (moreAvailable) {
+            sliceRequest.setFromRecord(fromRecord);
+            AccountStatementReport report = exchangeApi.getAccountStatement(sliceRequest);
+            if (!report.isSuccess()) {
+                throw std::runtime_error("getAccountStatement failed: " + report.getFaultString());
+            }
+            const std::vector<StatementItem>& items = report.getAccountStatement();
+            for (const StatementItem& item : items) {
+                const std::tm& itemDate = item.getItemDate();
+                if (isSet(itemDate) && !slice.contains(toTime(itemDate))) {
+                    continue;
+                }
+                encode(item, block, builder);
+                ++count;
+                if (block.getRowCount() >= blockRows) {
+                    writer.write(block, slice.from * 1000, slice.to * 1000, false);
+                    block.clear();
+                }
+            }
+            fromRecord += static_cast<int32_t>(items.size());
+            moreAvailable = !items.empty() && report.getMoreAvailable().isValid() &&
+                report.getMoreAvailable().getValue();
+        }
+        writer.write(block, slice.from * 1000, slice.to * 1000, true);
+        return count;
+    });
+}
+
+const std::vector<ColumnarFormat::Column>& HistoryExporter::getClearedOrderColumns() {
+    static const ColumnarFormat::Column columns[] = {
+        {"eventTypeId", ColumnarFormat::SYMBOL},
+        {"eventId", ColumnarFormat::SYMBOL},
+        {"marketId", ColumnarFormat::SYMBOL},
+        {"selectionId", ColumnarFormat::INT64},
+        {"handicap", ColumnarFormat::DOUBLE},
+        {"betId", ColumnarFormat::TEXT},
+        {"placedDate", ColumnarFormat::INT64},
+        {"persistenceType", ColumnarFormat::SYMBOL},
+        {"orderType", ColumnarFormat::SYMBOL},
+        {"side", ColumnarFormat::SYMBOL},
+        {"betOutcome", ColumnarFormat::SYMBOL},
+        {"priceRequested", ColumnarFormat::DOUBLE},
+        {"settledDate", ColumnarFormat::INT64},
+        {"lastMatchedDate", ColumnarFormat::INT64},
+        {"betCount", ColumnarFormat::INT64},
+        {"commission", ColumnarFormat::DOUBLE},
+        {"priceMatched", ColumnarFormat::DOUBLE},
+        {"priceReduced", ColumnarFormat::INT64},
+        {"sizeSettled", ColumnarFormat::DOUBLE},
+        {"profit", ColumnarFormat::DOUBLE},
+        {"sizeCancelled", ColumnarFormat::DOUBLE},
+        {"customerOrderRef", ColumnarFormat::TEXT},
+        {"customerStrategyRef", ColumnarFormat::SYMBOL},
+        {"eventTypeDesc", ColumnarFormat::SYMBOL},
+        {"eventDesc", ColumnarFormat::SYMBOL},
+        {"marketDesc", ColumnarFormat::SYMBOL},
+        {"marketType", ColumnarFormat::SYMBOL},
+        {"marketStartTime", ColumnarFormat::INT64},
+        {"runnerDesc", ColumnarFormat::SYMBOL},
+        {"numberOfWinners", ColumnarFormat::INT64},
+        {"eachWayDivisor", ColumnarFormat::DOUBLE}
+    };
+    static const std::vector<ColumnarFormat::Column> list(columns, columns + sizeof(columns) / sizeof(columns[0]));
+    return list;
+}
+
+const std::vector<ColumnarFormat::Column>& HistoryExporter::getStatementColumns() {
+    static const ColumnarFormat::Column columns[] = {
+        {"refId", ColumnarFormat::TEXT},
+        {"itemDate", ColumnarFormat::INT64},
+        {"amount", ColumnarFormat::DOUBLE},
+        {"balance", ColumnarFormat::DOUBLE},
+        {"itemClass", ColumnarFormat::SYMBOL},
+        {"itemClassData", ColumnarFormat::TEXT},
+        {"avgPrice", ColumnarFormat::DOUBLE},
+        {"betSize", ColumnarFormat::DOUBLE},
+        {"betType", ColumnarFormat::SYMBOL},
+        {"betCategoryType", ColumnarFormat::SYMBOL},
+        {"commissionRate", ColumnarFormat::SYMBOL},
+        {"eventId", ColumnarFormat::INT64},
+        {"eventTypeId", ColumnarFormat::INT64},
+        {"fullMarketName", ColumnarFormat::SYMBOL},
+        {"grossBetAmount", ColumnarFormat::DOUBLE},
+        {"marketName", ColumnarFormat::SYMBOL},
+        {"marketType", ColumnarFormat::SYMBOL},
+        {"placedDate", ColumnarFormat::INT64},
+        {"selectionId", ColumnarFormat::INT64},
+        {"selectionName", ColumnarFormat::SYMBOL},
+        {"startDate", ColumnarFormat::INT64},
+        {"transactionType", ColumnarFormat::SYMBOL},
+        {"transactionId", ColumnarFormat::INT64},
+        {"winLose", ColumnarFormat::SYMBOL}
+    };
+    static const std::vector<ColumnarFormat::Column> list(columns, columns + sizeof(columns) / sizeof(columns[0]));
+    return list;
+}
+
+}
+}
@@ -0,0 +1,175 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include "greentop/archive/LineReader.h"
+
+namespace greentop {
+namespace archive {
+
+namespace {
+
+const size_t INPUT_SIZE = 256 * 1024;
+const size_t BUFFER_SIZE = 1024 * 1024;
+
+}
+
+LineReader::LineReader(const std::string& fileName) :
+    file(std::fopen(fileName.c_str(), "rb")),
+    compressed(false),
+    streamOpen(false),
+    endOfFile(false),
+    stream(),
+    input(INPUT_SIZE),
+    buffer(BUFFER_SIZE),
+    start(0),
+    searched(0),
+    end(0),
+    bytesRead(0) {
+    if (!file) {
+        throw std::runtime_error("cannot open " + fileName);
+    }
+    size_t length = readInput();
+    compressed = length >= 3 && std::memcmp(&input[0], "BZh", 3) == 0;
+    if (compressed) {
+        if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) {
+            std::fclose(file);
+            throw std::runtime_error("cannot initialise bzip2 decompression");
+        }
+        streamOpen = true;
+        stream.next_in = &input[0];
+        stream.avail_in = static_cast<unsigned>(length);
+    } else {
+        std::memcpy(&buffer[0], &input[0], length);
+        end = length;
+    }
+}
+
+LineReader::~LineReader() {
+    if (streamOpen) {
+        BZ2_bzDecompressEnd(&stream);
+    }
+    std::fclose(file);
+}
+
+size_t LineReader::readInput() {
+    size_t length = std::fread(&input[0], 1, input.size(), file);
+    if (length < input.size()) {
+        if (std::ferror(file)) {
+            throw std::runtime_error("error reading file");
+        }
+        endOfFile = true;
+    }
+    bytesRead += length;
+    return length;
+}
+
+bool LineReader::fill() {
+    // keep the partial line, making room after it
+    if (start > 0) {
+        std::memmove(buffer.data(), buffer.data() + start, end - start);
+        end -= start;
+        searched -= start;
+        start = 0;
+    }
+    // grow while the partial line fills most of the buffer, so a long line isn't moved for every small read
+    if (end > buffer.size() / 2) {
+        buffer.resize(buffer.size() * 2);
+    }
+
+    if (!compressed) {
+        if (endOfFile) {
+            return false;
+        }
+        size_t length = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+        if (length == 0) {
+            endOfFile = true;
+            return false;
+        }
+        bytesRead += length;
+        end += length;
+        return true;
+    }
+
+    size_t before = end;
+    while (end == before) {
+        if (stream.avail_in == 0) {
+            if (!endOfFile) {
+                stream.next_in = &input[0];
+                stream.avail_in = static_cast<unsigned>(readInput());
+            }
+            if (stream.avail_in == 0) {
+                if (streamOpen) {
+                    throw std::runtime_error("truncated bzip2 data");
+                }
+                return false;
+            }
+        }
+        if (!streamOpen) {
+            // the start of another concatenated stream
+            if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) {
+                throw std::runtime_error("cannot initialise bzip2 decompression");
+            }
+            streamOpen = true;
+        }
+        stream.next_out = buffer.data() + end;
+        stream.avail_out = static_cast<unsigned>(buffer.size() - end);
+        int result = BZ2_bzDecompress(&stream);
+        end = buffer.size() - stream.avail_out;
+        if (result == BZ_STREAM_END) {
+            char* nextIn = stream.next_in;
+            unsigned availIn = stream.avail_in;
+            BZ2_bzDecompressEnd(&stream);
+            streamOpen = false;
+            stream = bz_stream();
+            stream.next_in = nextIn;
+            stream.avail_in = availIn;
+        } else if (result != BZ_OK) {
+            throw std::runtime_error("corrupt bzip2 data");
+        }
+    }
+    return true;
+}
+
+bool LineReader::next(const char*& data, size_t& length) {
+    while (true) {
+        const char* newLine = static_cast<const char*>(std::memchr(buffer.data() + searched, '\n', end - searched));
+        if (newLine) {
+            size_t lineEnd = newLine - buffer.data();
+            size_t lineStart = start;
+            start = lineEnd + 1;
+            searched = start;
+            if (lineEnd > lineStart && buffer[lineEnd - 1] == '\r') {
+                --lineEnd;
+            }
+            if (lineEnd == lineStart) {
+                continue;
+            }
+            data = buffer.data() + lineStart;
+            length = lineEnd - lineStart;
+            return true;
+        }
+        // the bytes searched so far have no line terminator, so only what fill() adds needs searching
+        searched = end;
+        if (!fill()) {
+            // the last line may not be terminated
+            if (end > start) {
+                data = buffer.data() + start;
+                length = end - start;
+                start = end;
+                return true;
+            }
+            return false;
+        }
+    }
+}
+
+uint64_t LineReader::getBytesRead() const {
+    return bytesRead;
+}
+
+}
+}
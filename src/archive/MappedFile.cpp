@@ -0,0 +1,77 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GREENTOP_HAVE_MMAP
+#endif
+
+#include "greentop/archive/MappedFile.h"
+
+namespace greentop {
+namespace archive {
+
+MappedFile::MappedFile(const std::string& fileName) : address(NULL), length(0), mapped(false) {
+#ifdef GREENTOP_HAVE_MMAP
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + fileName);
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + fileName);
+    }
+    length = static_cast<size_t>(status.st_size);
+    if (length > 0) {
+        void* result = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (result == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot map " + fileName);
+        }
+        ::madvise(result, length, MADV_SEQUENTIAL);
+        address = static_cast<const char*>(result);
+        mapped = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream input(fileName.c_str(), std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("cannot open " + fileName);
+    }
+    input.seekg(0, std::ios::end);
+    contents.resize(static_cast<size_t>(input.tellg()));
+    input.seekg(0, std::ios::beg);
+    if (!contents.empty()) {
+        input.read(&contents[0], contents.size());
+        address = &contents[0];
+    }
+    length = contents.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef GREENTOP_HAVE_MMAP
+    if (mapped) {
+        ::munmap(const_cast<char*>(address), length);
+    }
+#endif
+}
+
+const char* MappedFile::data() const {
+    return address;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+}
+}
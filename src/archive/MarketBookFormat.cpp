@@ -0,0 +1,86 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <string>
+
+#include "greentop/archive/MarketBookFormat.h"
+
+namespace greentop {
+namespace archive {
+
+namespace {
+
+// codes are positions in these tables plus one; append only.
+const char* const MARKET_STATUSES[] = {
+    "INACTIVE", "OPEN", "SUSPENDED", "CLOSED"
+};
+
+const char* const RUNNER_STATUSES[] = {
+    "ACTIVE", "WINNER", "LOSER", "REMOVED_VACANT", "REMOVED", "PLACED"
+};
+
+}
+
+const uint32_t MarketBookFormat::FILE_MAGIC;
+const uint32_t MarketBookFormat::FILE_VERSION;
+const uint32_t MarketBookFormat::BLOCK_MAGIC;
+const uint32_t MarketBookFormat::INDEX_MAGIC;
+const uint32_t MarketBookFormat::TRAILER_MAGIC;
+const size_t MarketBookFormat::FILE_HEADER_SIZE;
+const size_t MarketBookFormat::BLOCK_HEADER_SIZE;
+const size_t MarketBookFormat::TRAILER_SIZE;
+const int64_t MarketBookFormat::PRICE_SCALE;
+const int64_t MarketBookFormat::ADJUSTMENT_SCALE;
+
+MarketBookFormat::RunnerState::RunnerState() :
+    selectionId(0), handicap(0), adjustment(0), lastPriceTraded(0), totalMatched(0) {
+}
+
+MarketBookFormat::MarketState::MarketState() : version(0), totalMatched(0), totalAvailable(0), lastMatchTime(0) {
+}
+
+uint32_t MarketBookFormat::encodeMarketStatus(const MarketStatus& status) {
+    if (status.isValid()) {
+        std::string value = status.getValue();
+        for (uint32_t i = 0; i < sizeof(MARKET_STATUSES) / sizeof(MARKET_STATUSES[0]); ++i) {
+            if (value == MARKET_STATUSES[i]) {
+                return i + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+MarketStatus MarketBookFormat::decodeMarketStatus(uint32_t code) {
+    // decoded once, constructing an enum validates the string.
+    static const MarketStatus DECODED[] = {
+        MarketStatus(), MarketStatus(MARKET_STATUSES[0]), MarketStatus(MARKET_STATUSES[1]),
+        MarketStatus(MARKET_STATUSES[2]), MarketStatus(MARKET_STATUSES[3])
+    };
+    return code < sizeof(DECODED) / sizeof(DECODED[0]) ? DECODED[code] : DECODED[0];
+}
+
+uint32_t MarketBookFormat::encodeRunnerStatus(const RunnerStatus& status) {
+    if (status.isValid()) {
+        std::string value = status.getValue();
+        for (uint32_t i = 0; i < sizeof(RUNNER_STATUSES) / sizeof(RUNNER_STATUSES[0]); ++i) {
+            if (value == RUNNER_STATUSES[i]) {
+                return i + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+RunnerStatus MarketBookFormat::decodeRunnerStatus(uint32_t code) {
+    static const RunnerStatus DECODED[] = {
+        RunnerStatus(), RunnerStatus(RUNNER_STATUSES[0]), RunnerStatus(RUNNER_STATUSES[1]),
+        RunnerStatus(RUNNER_STATUSES[2]), RunnerStatus(RUNNER_STATUSES[3]), RunnerStatus(RUNNER_STATUSES[4]),
+        RunnerStatus(RUNNER_STATUSES[5])
+    };
+    return code < sizeof(DECODED) / sizeof(DECODED[0]) ? DECODED[code] : DECODED[0];
+}
+
+}
+}
@@ -0,0 +1,439 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <ctime>
+#include <stdexcept>
+
+#include "greentop/Time.h"
+#include "greentop/archive/MarketBookReader.h"
+
+namespace greentop {
+namespace archive {
+
+MarketBookReader::MarketBookReader(const std::string& fileName) :
+    file(fileName),
+    filtered(false),
+    seekTime(0),
+    nextBlock(0),
+    remaining(0),
+    currentBlock(NULL),
+    lastTime(0) {
+    if (file.size() < MarketBookFormat::FILE_HEADER_SIZE) {
+        throw std::runtime_error(fileName + " is not a market book recording");
+    }
+    ByteReader header(file.data(), MarketBookFormat::FILE_HEADER_SIZE);
+    if (header.getFixed32() != MarketBookFormat::FILE_MAGIC) {
+        throw std::runtime_error(fileName + " is not a market book recording");
+    }
+    if (header.getFixed32() > MarketBookFormat::FILE_VERSION) {
+        throw std::runtime_error(fileName + " was recorded by a newer version");
+    }
+
+    bool indexed = false;
+    if (file.size() >= MarketBookFormat::FILE_HEADER_SIZE + MarketBookFormat::TRAILER_SIZE) {
+        ByteReader trailer(file.data() + file.size() - MarketBookFormat::TRAILER_SIZE,
+            MarketBookFormat::TRAILER_SIZE);
+        uint64_t indexOffset = trailer.getFixed64();
+        if (trailer.getFixed32() == MarketBookFormat::TRAILER_MAGIC && indexOffset < file.size()) {
+            readIndex(indexOffset);
+            indexed = true;
+        }
+    }
+    if (!indexed) {
+        // not closed cleanly, recover what was written
+        scanBlocks();
+    }
+    wanted.assign(marketIds.size(), true);
+}
+
+void MarketBookReader::readIndex(uint64_t indexOffset) {
+    ByteReader index(file.data() + indexOffset, file.size() - MarketBookFormat::TRAILER_SIZE - indexOffset);
+    if (index.getFixed32() != MarketBookFormat::INDEX_MAGIC) {
+        throw std::runtime_error("corrupt market book recording index");
+    }
+    size_t marketCount = static_cast<size_t>(index.getVarint());
+    for (size_t i = 0; i < marketCount; ++i) {
+        marketIds.push_back(index.getString());
+        eventTypeIds.push_back(static_cast<int32_t>(index.getSigned()));
+        marketIndexes[marketIds.back()] = static_cast<uint32_t>(i);
+    }
+    size_t blockCount = static_cast<size_t>(index.getVarint());
+    blocks.resize(blockCount);
+    for (BlockInfo& block : blocks) {
+        block.offset = index.getVarint();
+        block.snapshots = static_cast<uint32_t>(index.getVarint());
+        block.minTime = index.getSigned();
+        block.maxTime = index.getSigned();
+        block.markets.resize(static_cast<size_t>(index.getVarint()));
+        for (uint32_t& market : block.markets) {
+            market = static_cast<uint32_t>(index.getVarint());
+            if (market >= marketIds.size()) {
+                throw std::runtime_error("corrupt market book recording index");
+            }
+        }
+    }
+}
+
+void MarketBookReader::scanBlocks() {
+    uint64_t offset = MarketBookFormat::FILE_HEADER_SIZE;
+    while (offset + MarketBookFormat::BLOCK_HEADER_SIZE <= file.size()) {
+        ByteReader header(file.data() + offset, MarketBookFormat::BLOCK_HEADER_SIZE);
+        if (header.getFixed32() != MarketBookFormat::BLOCK_MAGIC) {
+            break;
+        }
+        uint32_t payloadLength = header.getFixed32();
+        if (offset + MarketBookFormat::BLOCK_HEADER_SIZE + payloadLength > file.size()) {
+            // a partly written block
+            break;
+        }
+        BlockInfo block;
+        block.offset = offset;
+        block.snapshots = header.getFixed32();
+        block.minTime = static_cast<int64_t>(header.getFixed64());
+        block.maxTime = static_cast<int64_t>(header.getFixed64());
+
+        ByteReader payload(file.data() + offset + MarketBookFormat::BLOCK_HEADER_SIZE, payloadLength);
+        size_t marketCount = static_cast<size_t>(payload.getVarint());
+        for (size_t i = 0; i < marketCount; ++i) {
+            std::string marketId = payload.getString();
+            int32_t eventTypeId = static_cast<int32_t>(payload.getSigned());
+            auto it = marketIndexes.find(marketId);
+            if (it == marketIndexes.end()) {
+                it = marketIndexes.insert(std::make_pair(marketId, static_cast<uint32_t>(marketIds.size()))).first;
+                marketIds.push_back(marketId);
+                eventTypeIds.push_back(eventTypeId);
+            }
+            block.markets.push_back(it->second);
+        }
+        blocks.push_back(block);
+        offset += MarketBookFormat::BLOCK_HEADER_SIZE + payloadLength;
+    }
+}
+
+void MarketBookReader::setMarketFilter(const std::set<std::string>& marketIds) {
+    marketFilter = marketIds;
+    updateFilter();
+}
+
+void MarketBookReader::setEventTypeFilter(const std::set<int32_t>& eventTypeIds) {
+    eventTypeFilter = eventTypeIds;
+    updateFilter();
+}
+
+void MarketBookReader::updateFilter() {
+    filtered = !marketFilter.empty() || !eventTypeFilter.empty();
+    for (size_t i = 0; i < marketIds.size(); ++i) {
+        wanted[i] = (marketFilter.empty() || marketFilter.count(marketIds[i]) > 0) &&
+            (eventTypeFilter.empty() || eventTypeFilter.count(eventTypeIds[i]) > 0);
+    }
+}
+
+void MarketBookReader::seek(int64_t time) {
+    seekTime = time;
+    // the recorder rejects times that decrease, so the blocks' max times are in order
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), time,
+        [](const BlockInfo& block, int64_t time) {
+            return block.maxTime < time;
+        });
+    nextBlock = it - blocks.begin();
+    remaining = 0;
+    currentBlock = NULL;
+}
+
+bool MarketBookReader::isWanted(const BlockInfo& block) const {
+    if (block.maxTime < seekTime) {
+        return false;
+    }
+    if (!filtered) {
+        return true;
+    }
+    for (uint32_t market : block.markets) {
+        if (wanted[market]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MarketBookReader::openBlock(const BlockInfo& block) {
+    ByteReader header(file.data() + block.offset, MarketBookFormat::BLOCK_HEADER_SIZE);
+    if (header.getFixed32() != MarketBookFormat::BLOCK_MAGIC) {
+        throw std::runtime_error("corrupt market book recording block");
+    }
+    uint32_t payloadLength = header.getFixed32();
+    if (block.offset + MarketBookFormat::BLOCK_HEADER_SIZE + payloadLength > file.size()) {
+        throw std::runtime_error("truncated market book recording block");
+    }
+    ByteReader payload(file.data() + block.offset + MarketBookFormat::BLOCK_HEADER_SIZE, payloadLength);
+    size_t marketCount = static_cast<size_t>(payload.getVarint());
+    for (size_t i = 0; i < marketCount; ++i) {
+        payload.getString();
+        payload.getSigned();
+    }
+
+    size_t columnCount = static_cast<size_t>(payload.getVarint());
+    std::vector<size_t> lengths(columnCount);
+    for (size_t& length : lengths) {
+        length = static_cast<size_t>(payload.getVarint());
+    }
+    for (size_t i = 0; i < columnCount; ++i) {
+        const char* data = payload.getBytes(lengths[i]);
+        // columns added by later versions are ignored
+        if (i < MarketBookFormat::COLUMN_COUNT) {
+            columns[i] = ByteReader(data, lengths[i]);
+        }
+    }
+    for (size_t i = columnCount; i < MarketBookFormat::COLUMN_COUNT; ++i) {
+        columns[i] = ByteReader();
+    }
+
+    currentBlock = &block;
+    remaining = block.snapshots;
+    blockStates.assign(marketCount, MarketBookFormat::MarketState());
+    lastTime = 0;
+}
+
+bool MarketBookReader::next(RecordedMarketBook& recorded) {
+    while (true) {
+        if (remaining == 0) {
+            while (nextBlock < blocks.size() && !isWanted(blocks[nextBlock])) {
+                ++nextBlock;
+            }
+            if (nextBlock >= blocks.size()) {
+                return false;
+            }
+            openBlock(blocks[nextBlock++]);
+            if (remaining == 0) {
+                continue;
+            }
+        }
+        --remaining;
+        if (decodeSnapshot(recorded)) {
+            return true;
+        }
+    }
+}
+
+bool MarketBookReader::decodeSnapshot(RecordedMarketBook& recorded) {
+    // every snapshot is decoded to keep the deltas in step, but only wanted ones are materialised.
+    lastTime += columns[MarketBookFormat::TIME].getSigned();
+    size_t local = static_cast<size_t>(columns[MarketBookFormat::MARKET].getVarint());
+    if (local >= currentBlock->markets.size()) {
+        throw std::runtime_error("corrupt market book recording block");
+    }
+    uint32_t market = currentBlock->markets[local];
+    MarketBookFormat::MarketState& state = blockStates[local];
+    bool build = lastTime >= seekTime && wanted[market];
+
+    uint32_t flags = static_cast<uint32_t>(columns[MarketBookFormat::MARKET_FLAGS].getVarint());
+    uint32_t status = static_cast<uint32_t>(columns[MarketBookFormat::MARKET_STATUS].getVarint());
+    if (flags & MarketBookFormat::HAS_VERSION) {
+        state.version += columns[MarketBookFormat::VERSION].getSigned();
+    }
+    if (flags & MarketBookFormat::HAS_MARKET_MATCHED) {
+        state.totalMatched += columns[MarketBookFormat::MARKET_MATCHED].getSigned();
+    }
+    if (flags & MarketBookFormat::HAS_MARKET_AVAILABLE) {
+        state.totalAvailable += columns[MarketBookFormat::MARKET_AVAILABLE].getSigned();
+    }
+    if (flags & MarketBookFormat::HAS_LAST_MATCH) {
+        state.lastMatchTime += columns[MarketBookFormat::LAST_MATCH].getSigned();
+    }
+    ByteReader& counts = columns[MarketBookFormat::MARKET_COUNTS];
+    Optional<int32_t> betDelay;
+    Optional<int32_t> numberOfWinners;
+    Optional<int32_t> numberOfActiveRunners;
+    Optional<int32_t> numberOfRunners;
+    if (flags & MarketBookFormat::HAS_BET_DELAY) {
+        betDelay = static_cast<int32_t>(counts.getSigned());
+    }
+    if (flags & MarketBookFormat::HAS_NUMBER_OF_WINNERS) {
+        numberOfWinners = static_cast<int32_t>(counts.getSigned());
+    }
+    if (flags & MarketBookFormat::HAS_ACTIVE_RUNNERS) {
+        numberOfActiveRunners = static_cast<int32_t>(counts.getSigned());
+    }
+    if (flags & MarketBookFormat::HAS_NUMBER_OF_RUNNERS) {
+        numberOfRunners = static_cast<int32_t>(counts.getSigned());
+    }
+
+    size_t runnerCount = static_cast<size_t>(columns[MarketBookFormat::RUNNER_COUNT].getVarint());
+    if (state.runners.size() < runnerCount) {
+        state.runners.resize(runnerCount);
+    }
+    std::vector<Runner> runners(build ? runnerCount : 0);
+    for (size_t i = 0; i < runnerCount; ++i) {
+        decodeRunner(state.runners[i], build ? &runners[i] : NULL);
+    }
+
+    if (!build) {
+        return false;
+    }
+
+    recorded.receivedTime = lastTime;
+    recorded.eventTypeId = eventTypeIds[market];
+    MarketBook& marketBook = recorded.marketBook;
+    marketBook = MarketBook();
+    marketBook.setMarketId(marketIds[market]);
+    if (flags & MarketBookFormat::HAS_DELAYED) {
+        marketBook.setIsMarketDataDelayed((flags & MarketBookFormat::DELAYED) != 0);
+    }
+    marketBook.setStatus(MarketBookFormat::decodeMarketStatus(status));
+    marketBook.setBetDelay(betDelay);
+    if (flags & MarketBookFormat::HAS_BSP_RECONCILED) {
+        marketBook.setBspReconciled((flags & MarketBookFormat::BSP_RECONCILED) != 0);
+    }
+    if (flags & MarketBookFormat::HAS_COMPLETE) {
+        marketBook.setComplete((flags & MarketBookFormat::COMPLETE) != 0);
+    }
+    if (flags & MarketBookFormat::HAS_INPLAY) {
+        marketBook.setInplay((flags & MarketBookFormat::INPLAY) != 0);
+    }
+    marketBook.setNumberOfWinners(numberOfWinners);
+    marketBook.setNumberOfRunners(numberOfRunners);
+    marketBook.setNumberOfActiveRunners(numberOfActiveRunners);
+    marketBook.setLastMatchTime((flags & MarketBookFormat::HAS_LAST_MATCH) ?
+        fromTime(static_cast<std::time_t>(state.lastMatchTime)) : std::tm());
+    if (flags & MarketBookFormat::HAS_MARKET_MATCHED) {
+        marketBook.setTotalMatched(MarketBookFormat::fromFixed(state.totalMatched, MarketBookFormat::PRICE_SCALE));
+    }
+    if (flags & MarketBookFormat::HAS_MARKET_AVAILABLE) {
+        marketBook.setTotalAvailable(MarketBookFormat::fromFixed(state.totalAvailable,
+            MarketBookFormat::PRICE_SCALE));
+    }
+    if (flags & MarketBookFormat::HAS_CROSS_MATCHING) {
+        marketBook.setCrossMatching((flags & MarketBookFormat::CROSS_MATCHING) != 0);
+    }
+    if (flags & MarketBookFormat::HAS_RUNNERS_VOIDABLE) {
+        marketBook.setRunnersVoidable((flags & MarketBookFormat::RUNNERS_VOIDABLE) != 0);
+    }
+    if (flags & MarketBookFormat::HAS_VERSION) {
+        marketBook.setVersion(state.version);
+    }
+    marketBook.setRunners(runners);
+    return true;
+}
+
+void MarketBookReader::decodeRunner(MarketBookFormat::RunnerState& state, Runner* runner) {
+    state.selectionId += columns[MarketBookFormat::SELECTION].getSigned();
+    uint32_t status = static_cast<uint32_t>(columns[MarketBookFormat::RUNNER_STATUS].getVarint());
+    uint32_t flags = static_cast<uint32_t>(columns[MarketBookFormat::RUNNER_FLAGS].getVarint());
+    if (flags & MarketBookFormat::HAS_HANDICAP) {
+        state.handicap += columns[MarketBookFormat::HANDICAP].getSigned();
+    }
+    if (flags & MarketBookFormat::HAS_ADJUSTMENT) {
+        state.adjustment += columns[MarketBookFormat::ADJUSTMENT].getSigned();
+    }
+    if (flags & MarketBookFormat::HAS_LTP) {
+        state.lastPriceTraded += columns[MarketBookFormat::LTP].getSigned();
+    }
+    if (flags & MarketBookFormat::HAS_RUNNER_MATCHED) {
+        state.totalMatched += columns[MarketBookFormat::RUNNER_MATCHED].getSigned();
+    }
+
+    size_t levels[MarketBookFormat::LADDER_COUNT];
+    for (int i = 0; i < MarketBookFormat::LADDER_COUNT; ++i) {
+        levels[i] = static_cast<size_t>(columns[MarketBookFormat::LADDER_SIZES].getVarint());
+    }
+    if (!runner) {
+        for (int i = 0; i < MarketBookFormat::LADDER_COUNT; ++i) {
+            decodeLadder(state.ladders[i], levels[i], NULL);
+        }
+        return;
+    }
+    std::vector<PriceSize> ladders[MarketBookFormat::LADDER_COUNT];
+    for (int i = 0; i < MarketBookFormat::LADDER_COUNT; ++i) {
+        decodeLadder(state.ladders[i], levels[i], &ladders[i]);
+    }
+
+    runner->setSelectionId(state.selectionId);
+    if (flags & MarketBookFormat::HAS_HANDICAP) {
+        runner->setHandicap(MarketBookFormat::fromFixed(state.handicap, MarketBookFormat::PRICE_SCALE));
+    }
+    runner->setStatus(MarketBookFormat::decodeRunnerStatus(status));
+    if (flags & MarketBookFormat::HAS_ADJUSTMENT) {
+        runner->setAdjustmentFactor(MarketBookFormat::fromFixed(state.adjustment, MarketBookFormat::ADJUSTMENT_SCALE));
+    }
+    if (flags & MarketBookFormat::HAS_LTP) {
+        runner->setLastPriceTraded(MarketBookFormat::fromFixed(state.lastPriceTraded, MarketBookFormat::PRICE_SCALE));
+    }
+    if (flags & MarketBookFormat::HAS_RUNNER_MATCHED) {
+        runner->setTotalMatched(MarketBookFormat::fromFixed(state.totalMatched, MarketBookFormat::PRICE_SCALE));
+    }
+    runner->setRemovalDate(std::tm());
+    runner->setEx(ExchangePrices(ladders[MarketBookFormat::BACK], ladders[MarketBookFormat::LAY],
+        ladders[MarketBookFormat::TRADED]));
+}
+
+void MarketBookReader::decodeLadder(MarketBookFormat::LadderState& state, size_t levels,
+    std::vector<PriceSize>* ladder) {
+    ByteReader& prices = columns[MarketBookFormat::PRICE];
+    ByteReader& sizes = columns[MarketBookFormat::SIZE];
+    int64_t previousPrice = state.prices.empty() ? 0 : state.prices[0];
+    size_t previousLevels = state.sizes.size();
+    state.prices.resize(levels);
+    if (state.sizes.size() < levels) {
+        state.sizes.resize(levels, 0);
+    }
+    if (ladder) {
+        ladder->reserve(levels);
+    }
+
+    for (size_t i = 0; i < levels; ++i) {
+        int64_t price = previousPrice + prices.getSigned();
+        int64_t size = (i < previousLevels ? state.sizes[i] : 0) + sizes.getSigned();
+        previousPrice = price;
+        state.prices[i] = price;
+        state.sizes[i] = size;
+        if (ladder) {
+            ladder->push_back(PriceSize(MarketBookFormat::fromFixed(price, MarketBookFormat::PRICE_SCALE),
+                MarketBookFormat::fromFixed(size, MarketBookFormat::PRICE_SCALE)));
+        }
+    }
+    state.sizes.resize(levels);
+}
+
+const std::vector<std::string>& MarketBookReader::getMarketIds() const {
+    return marketIds;
+}
+
+const std::vector<int32_t>& MarketBookReader::getEventTypeIds() const {
+    return eventTypeIds;
+}
+
+const std::vector<MarketBookReader::BlockInfo>& MarketBookReader::getBlocks() const {
+    return blocks;
+}
+
+uint64_t MarketBookReader::getSnapshotCount() const {
+    uint64_t count = 0;
+    for (const BlockInfo& block : blocks) {
+        count += block.snapshots;
+    }
+    return count;
+}
+
+int64_t MarketBookReader::getStartTime() const {
+    int64_t startTime = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (i == 0 || blocks[i].minTime < startTime) {
+            startTime = blocks[i].minTime;
+        }
+    }
+    return startTime;
+}
+
+int64_t MarketBookReader::getEndTime() const {
+    int64_t endTime = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (i == 0 || blocks[i].maxTime > endTime) {
+            endTime = blocks[i].maxTime;
+        }
+    }
+    return endTime;
+}
+
+}
+}
@@ -0,0 +1,361 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <stdexcept>
+
+#include "greentop/Time.h"
+#include "greentop/archive/MarketBookRecorder.h"
+
+namespace greentop {
+namespace archive {
+
+namespace {
+
+uint32_t flag(const Optional<bool>& value, uint32_t hasBit, uint32_t valueBit) {
+    if (!value.isValid()) {
+        return 0;
+    }
+    return value.getValue() ? hasBit | valueBit : hasBit;
+}
+
+}
+
+MarketBookRecorder::MarketBookRecorder(const std::string& fileName) :
+    blockSnapshots(4096),
+    snapshotCount(0),
+    bytesWritten(0),
+    blockSnapshotCount(0),
+    blockMinTime(0),
+    blockMaxTime(0),
+    lastTime(0),
+    latestTime(0) {
+    output.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("cannot create " + fileName);
+    }
+    ByteWriter header;
+    header.putFixed32(MarketBookFormat::FILE_MAGIC);
+    header.putFixed32(MarketBookFormat::FILE_VERSION);
+    write(header.getBuffer());
+}
+
+MarketBookRecorder::~MarketBookRecorder() {
+    try {
+        close();
+    } catch (const std::exception&) {
+    }
+}
+
+void MarketBookRecorder::setBlockSnapshots(uint32_t blockSnapshots) {
+    this->blockSnapshots = blockSnapshots > 0 ? blockSnapshots : 1;
+}
+
+void MarketBookRecorder::record(const MarketBook& marketBook, int64_t receivedTime, int32_t eventTypeId) {
+    if (!output.is_open()) {
+        throw std::runtime_error("recorder is closed");
+    }
+    // the reader finds a seek time's block by binary search on the blocks' times
+    if (snapshotCount > 0 && receivedTime < latestTime) {
+        throw std::runtime_error("snapshot received before the last one recorded");
+    }
+
+    const std::string& marketId = marketBook.getMarketId();
+    auto global = marketIndexes.find(marketId);
+    if (global == marketIndexes.end()) {
+        global = marketIndexes.insert(std::make_pair(marketId, static_cast<uint32_t>(marketIds.size()))).first;
+        marketIds.push_back(marketId);
+        eventTypeIds.push_back(eventTypeId);
+    } else if (eventTypeId != 0 && eventTypeIds[global->second] == 0) {
+        eventTypeIds[global->second] = eventTypeId;
+    }
+    auto local = blockMarketIndexes.find(marketId);
+    if (local == blockMarketIndexes.end()) {
+        local = blockMarketIndexes.insert(
+            std::make_pair(marketId, static_cast<uint32_t>(blockMarkets.size()))).first;
+        blockMarkets.push_back(global->second);
+        blockStates.push_back(MarketBookFormat::MarketState());
+    }
+    MarketBookFormat::MarketState& state = blockStates[local->second];
+
+    if (blockSnapshotCount == 0 || receivedTime < blockMinTime) {
+        blockMinTime = receivedTime;
+    }
+    if (blockSnapshotCount == 0 || receivedTime > blockMaxTime) {
+        blockMaxTime = receivedTime;
+    }
+    columns[MarketBookFormat::TIME].putSigned(receivedTime - lastTime);
+    lastTime = receivedTime;
+    latestTime = receivedTime;
+    columns[MarketBookFormat::MARKET].putVarint(local->second);
+
+    uint32_t flags =
+        flag(marketBook.getIsMarketDataDelayed(), MarketBookFormat::HAS_DELAYED, MarketBookFormat::DELAYED) |
+        flag(marketBook.getBspReconciled(), MarketBookFormat::HAS_BSP_RECONCILED,
+            MarketBookFormat::BSP_RECONCILED) |
+        flag(marketBook.getComplete(), MarketBookFormat::HAS_COMPLETE, MarketBookFormat::COMPLETE) |
+        flag(marketBook.getInplay(), MarketBookFormat::HAS_INPLAY, MarketBookFormat::INPLAY) |
+        flag(marketBook.getCrossMatching(), MarketBookFormat::HAS_CROSS_MATCHING,
+            MarketBookFormat::CROSS_MATCHING) |
+        flag(marketBook.getRunnersVoidable(), MarketBookFormat::HAS_RUNNERS_VOIDABLE,
+            MarketBookFormat::RUNNERS_VOIDABLE);
+    if (marketBook.getBetDelay().isValid()) {
+        flags |= MarketBookFormat::HAS_BET_DELAY;
+    }
+    if (marketBook.getNumberOfWinners().isValid()) {
+        flags |= MarketBookFormat::HAS_NUMBER_OF_WINNERS;
+    }
+    if (marketBook.getVersion().isValid()) {
+        flags |= MarketBookFormat::HAS_VERSION;
+    }
+    if (marketBook.getTotalMatched().isValid()) {
+        flags |= MarketBookFormat::HAS_MARKET_MATCHED;
+    }
+    if (marketBook.getTotalAvailable().isValid()) {
+        flags |= MarketBookFormat::HAS_MARKET_AVAILABLE;
+    }
+    if (marketBook.getLastMatchTime().tm_year > 0) {
+        flags |= MarketBookFormat::HAS_LAST_MATCH;
+    }
+    if (marketBook.getNumberOfActiveRunners().isValid()) {
+        flags |= MarketBookFormat::HAS_ACTIVE_RUNNERS;
+    }
+    if (marketBook.getNumberOfRunners().isValid()) {
+        flags |= MarketBookFormat::HAS_NUMBER_OF_RUNNERS;
+    }
+    columns[MarketBookFormat::MARKET_FLAGS].putVarint(flags);
+    columns[MarketBookFormat::MARKET_STATUS].putVarint(MarketBookFormat::encodeMarketStatus(marketBook.getStatus()));
+
+    if (flags & MarketBookFormat::HAS_VERSION) {
+        int64_t version = marketBook.getVersion().getValue();
+        columns[MarketBookFormat::VERSION].putSigned(version - state.version);
+        state.version = version;
+    }
+    if (flags & MarketBookFormat::HAS_MARKET_MATCHED) {
+        int64_t totalMatched = MarketBookFormat::toFixed(marketBook.getTotalMatched().getValue(),
+            MarketBookFormat::PRICE_SCALE);
+        columns[MarketBookFormat::MARKET_MATCHED].putSigned(totalMatched - state.totalMatched);
+        state.totalMatched = totalMatched;
+    }
+    if (flags & MarketBookFormat::HAS_MARKET_AVAILABLE) {
+        int64_t totalAvailable = MarketBookFormat::toFixed(marketBook.getTotalAvailable().getValue(),
+            MarketBookFormat::PRICE_SCALE);
+        columns[MarketBookFormat::MARKET_AVAILABLE].putSigned(totalAvailable - state.totalAvailable);
+        state.totalAvailable = totalAvailable;
+    }
+    if (flags & MarketBookFormat::HAS_LAST_MATCH) {
+        int64_t seconds = static_cast<int64_t>(toTime(marketBook.getLastMatchTime()));
+        columns[MarketBookFormat::LAST_MATCH].putSigned(seconds - state.lastMatchTime);
+        state.lastMatchTime = seconds;
+    }
+    ByteWriter& counts = columns[MarketBookFormat::MARKET_COUNTS];
+    if (flags & MarketBookFormat::HAS_BET_DELAY) {
+        counts.putSigned(marketBook.getBetDelay().getValue());
+    }
+    if (flags & MarketBookFormat::HAS_NUMBER_OF_WINNERS) {
+        counts.putSigned(marketBook.getNumberOfWinners().getValue());
+    }
+    if (flags & MarketBookFormat::HAS_ACTIVE_RUNNERS) {
+        counts.putSigned(marketBook.getNumberOfActiveRunners().getValue());
+    }
+    if (flags & MarketBookFormat::HAS_NUMBER_OF_RUNNERS) {
+        counts.putSigned(marketBook.getNumberOfRunners().getValue());
+    }
+
+    const std::vector<Runner>& runners = marketBook.getRunners();
+    columns[MarketBookFormat::RUNNER_COUNT].putVarint(runners.size());
+    if (state.runners.size() < runners.size()) {
+        state.runners.resize(runners.size());
+    }
+    for (size_t i = 0; i < runners.size(); ++i) {
+        encodeRunner(runners[i], state.runners[i]);
+    }
+
+    ++snapshotCount;
+    if (++blockSnapshotCount >= blockSnapshots) {
+        flush();
+    }
+}
+
+void MarketBookRecorder::encodeRunner(const Runner& runner, MarketBookFormat::RunnerState& state) {
+    int64_t selectionId = runner.getSelectionId().isValid() ? runner.getSelectionId().getValue() : 0;
+    columns[MarketBookFormat::SELECTION].putSigned(selectionId - state.selectionId);
+    state.selectionId = selectionId;
+    columns[MarketBookFormat::RUNNER_STATUS].putVarint(MarketBookFormat::encodeRunnerStatus(runner.getStatus()));
+
+    uint32_t flags = 0;
+    if (runner.getHandicap().isValid()) {
+        flags |= MarketBookFormat::HAS_HANDICAP;
+    }
+    if (runner.getAdjustmentFactor().isValid()) {
+        flags |= MarketBookFormat::HAS_ADJUSTMENT;
+    }
+    if (runner.getLastPriceTraded().isValid()) {
+        flags |= MarketBookFormat::HAS_LTP;
+    }
+    if (runner.getTotalMatched().isValid()) {
+        flags |= MarketBookFormat::HAS_RUNNER_MATCHED;
+    }
+    columns[MarketBookFormat::RUNNER_FLAGS].putVarint(flags);
+
+    if (flags & MarketBookFormat::HAS_HANDICAP) {
+        int64_t handicap = MarketBookFormat::toFixed(runner.getHandicap().getValue(), MarketBookFormat::PRICE_SCALE);
+        columns[MarketBookFormat::HANDICAP].putSigned(handicap - state.handicap);
+        state.handicap = handicap;
+    }
+    if (flags & MarketBookFormat::HAS_ADJUSTMENT) {
+        int64_t adjustment = MarketBookFormat::toFixed(runner.getAdjustmentFactor().getValue(),
+            MarketBookFormat::ADJUSTMENT_SCALE);
+        columns[MarketBookFormat::ADJUSTMENT].putSigned(adjustment - state.adjustment);
+        state.adjustment = adjustment;
+    }
+    if (flags & MarketBookFormat::HAS_LTP) {
+        int64_t lastPriceTraded = MarketBookFormat::toFixed(runner.getLastPriceTraded().getValue(),
+            MarketBookFormat::PRICE_SCALE);
+        columns[MarketBookFormat::LTP].putSigned(lastPriceTraded - state.lastPriceTraded);
+        state.lastPriceTraded = lastPriceTraded;
+    }
+    if (flags & MarketBookFormat::HAS_RUNNER_MATCHED) {
+        int64_t totalMatched = MarketBookFormat::toFixed(runner.getTotalMatched().getValue(),
+            MarketBookFormat::PRICE_SCALE);
+        columns[MarketBookFormat::RUNNER_MATCHED].putSigned(totalMatched - state.totalMatched);
+        state.totalMatched = totalMatched;
+    }
+
+    const ExchangePrices& ex = runner.getEx();
+    const std::vector<PriceSize>* ladders[MarketBookFormat::LADDER_COUNT] = {
+        &ex.getAvailableToBack(), &ex.getAvailableToLay(), &ex.getTradedVolume()
+    };
+    for (int i = 0; i < MarketBookFormat::LADDER_COUNT; ++i) {
+        columns[MarketBookFormat::LADDER_SIZES].putVarint(ladders[i]->size());
+    }
+    for (int i = 0; i < MarketBookFormat::LADDER_COUNT; ++i) {
+        encodeLadder(*ladders[i], state.ladders[i]);
+    }
+}
+
+void MarketBookRecorder::encodeLadder(const std::vector<PriceSize>& ladder, MarketBookFormat::LadderState& state) {
+    ByteWriter& prices = columns[MarketBookFormat::PRICE];
+    ByteWriter& sizes = columns[MarketBookFormat::SIZE];
+    int64_t previousPrice = state.prices.empty() ? 0 : state.prices[0];
+    size_t previousLevels = state.sizes.size();
+    state.prices.resize(ladder.size());
+    if (state.sizes.size() < ladder.size()) {
+        state.sizes.resize(ladder.size(), 0);
+    }
+
+    for (size_t i = 0; i < ladder.size(); ++i) {
+        const PriceSize& priceSize = ladder[i];
+        int64_t price = MarketBookFormat::toFixed(priceSize.getPrice().isValid() ? priceSize.getPrice().getValue() : 0,
+            MarketBookFormat::PRICE_SCALE);
+        int64_t size = MarketBookFormat::toFixed(priceSize.getSize().isValid() ? priceSize.getSize().getValue() : 0,
+            MarketBookFormat::PRICE_SCALE);
+        prices.putSigned(price - previousPrice);
+        sizes.putSigned(size - (i < previousLevels ? state.sizes[i] : 0));
+        previousPrice = price;
+        state.prices[i] = price;
+        state.sizes[i] = size;
+    }
+    state.sizes.resize(ladder.size());
+}
+
+void MarketBookRecorder::flush() {
+    if (blockSnapshotCount == 0 || !output.is_open()) {
+        return;
+    }
+
+    ByteWriter payload;
+    payload.putVarint(blockMarkets.size());
+    for (uint32_t market : blockMarkets) {
+        payload.putString(marketIds[market]);
+        payload.putSigned(eventTypeIds[market]);
+    }
+    payload.putVarint(MarketBookFormat::COLUMN_COUNT);
+    for (int i = 0; i < MarketBookFormat::COLUMN_COUNT; ++i) {
+        payload.putVarint(columns[i].size());
+    }
+
+    size_t payloadLength = payload.size();
+    for (int i = 0; i < MarketBookFormat::COLUMN_COUNT; ++i) {
+        payloadLength += columns[i].size();
+    }
+
+    ByteWriter header;
+    header.putFixed32(MarketBookFormat::BLOCK_MAGIC);
+    header.putFixed32(static_cast<uint32_t>(payloadLength));
+    header.putFixed32(blockSnapshotCount);
+    header.putFixed64(static_cast<uint64_t>(blockMinTime));
+    header.putFixed64(static_cast<uint64_t>(blockMaxTime));
+
+    BlockIndex index;
+    index.offset = bytesWritten;
+    index.snapshots = blockSnapshotCount;
+    index.minTime = blockMinTime;
+    index.maxTime = blockMaxTime;
+    index.markets = blockMarkets;
+    blocks.push_back(index);
+
+    write(header.getBuffer());
+    write(payload.getBuffer());
+    for (int i = 0; i < MarketBookFormat::COLUMN_COUNT; ++i) {
+        write(columns[i].getBuffer());
+        columns[i].clear();
+    }
+    output.flush();
+
+    blockMarketIndexes.clear();
+    blockMarkets.clear();
+    blockStates.clear();
+    blockSnapshotCount = 0;
+    lastTime = 0;
+}
+
+void MarketBookRecorder::close() {
+    if (!output.is_open()) {
+        return;
+    }
+    flush();
+
+    uint64_t indexOffset = bytesWritten;
+    ByteWriter index;
+    index.putFixed32(MarketBookFormat::INDEX_MAGIC);
+    index.putVarint(marketIds.size());
+    for (size_t i = 0; i < marketIds.size(); ++i) {
+        index.putString(marketIds[i]);
+        index.putSigned(eventTypeIds[i]);
+    }
+    index.putVarint(blocks.size());
+    for (const BlockIndex& block : blocks) {
+        index.putVarint(block.offset);
+        index.putVarint(block.snapshots);
+        index.putSigned(block.minTime);
+        index.putSigned(block.maxTime);
+        index.putVarint(block.markets.size());
+        for (uint32_t market : block.markets) {
+            index.putVarint(market);
+        }
+    }
+    index.putFixed64(indexOffset);
+    index.putFixed32(MarketBookFormat::TRAILER_MAGIC);
+    write(index.getBuffer());
+    output.close();
+}
+
+void MarketBookRecorder::write(const std::string& data) {
+    output.write(data.data(), data.size());
+    if (!output) {
+        throw std::runtime_error("failed to write recording");
+    }
+    bytesWritten += data.size();
+}
+
+uint64_t MarketBookRecorder::getSnapshotCount() const {
+    return snapshotCount;
+}
+
+uint64_t MarketBookRecorder::getBytesWritten() const {
+    return bytesWritten;
+}
+
+}
+}
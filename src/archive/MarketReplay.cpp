@@ -0,0 +1,174 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "greentop/archive/MarketReplay.h"
+
+namespace greentop {
+namespace archive {
+
+MarketReplay::MarketReplay() :
+    primed(false),
+    seekTime(0),
+    speed(0),
+    stopped(false),
+    currentTime(0),
+    paceStarted(false),
+    paceStartTime(0) {
+}
+
+void MarketReplay::addFile(const std::string& fileName) {
+    std::unique_ptr<Source> source(new Source());
+    source->reader.reset(new MarketBookReader(fileName));
+    source->reader->setMarketFilter(marketFilter);
+    source->reader->setEventTypeFilter(eventTypeFilter);
+    source->reader->seek(seekTime);
+    source->hasHead = false;
+    sources.push_back(std::move(source));
+    primed = false;
+}
+
+void MarketReplay::setMarketFilter(const std::set<std::string>& marketIds) {
+    marketFilter = marketIds;
+    for (const std::unique_ptr<Source>& source : sources) {
+        source->reader->setMarketFilter(marketIds);
+    }
+    refilter();
+}
+
+void MarketReplay::setEventTypeFilter(const std::set<int32_t>& eventTypeIds) {
+    eventTypeFilter = eventTypeIds;
+    for (const std::unique_ptr<Source>& source : sources) {
+        source->reader->setEventTypeFilter(eventTypeIds);
+    }
+    refilter();
+}
+
+void MarketReplay::refilter() {
+    // the heads were read with the old filter, so read again from where the replay has got to
+    int64_t time = currentTime != 0 ? currentTime : seekTime;
+    for (const std::unique_ptr<Source>& source : sources) {
+        source->reader->seek(time);
+        source->hasHead = false;
+    }
+    primed = false;
+}
+
+void MarketReplay::seek(int64_t time) {
+    seekTime = time;
+    for (const std::unique_ptr<Source>& source : sources) {
+        source->reader->seek(time);
+        source->hasHead = false;
+    }
+    primed = false;
+    paceStarted = false;
+    currentTime = 0;
+}
+
+void MarketReplay::setSpeed(double speed) {
+    this->speed = speed > 0 ? speed : 0;
+    paceStarted = false;
+}
+
+bool MarketReplay::later(size_t a, size_t b) const {
+    // ties go to the source added first so the order is deterministic
+    int64_t timeA = sources[a]->head.receivedTime;
+    int64_t timeB = sources[b]->head.receivedTime;
+    return timeA > timeB || (timeA == timeB && a > b);
+}
+
+void MarketReplay::prime() {
+    heap.clear();
+    for (size_t i = 0; i < sources.size(); ++i) {
+        Source& source = *sources[i];
+        if (!source.hasHead) {
+            source.hasHead = source.reader->next(source.head);
+        }
+        if (source.hasHead) {
+            heap.push_back(i);
+        }
+    }
+    auto compare = [this](size_t a, size_t b) {
+        return later(a, b);
+    };
+    std::make_heap(heap.begin(), heap.end(), compare);
+    primed = true;
+}
+
+bool MarketReplay::next(RecordedMarketBook& recorded) {
+    if (!primed) {
+        prime();
+    }
+    if (heap.empty()) {
+        return false;
+    }
+    auto compare = [this](size_t a, size_t b) {
+        return later(a, b);
+    };
+    std::pop_heap(heap.begin(), heap.end(), compare);
+    size_t index = heap.back();
+    heap.pop_back();
+
+    Source& source = *sources[index];
+    std::swap(recorded, source.head);
+    source.hasHead = source.reader->next(source.head);
+    if (source.hasHead) {
+        heap.push_back(index);
+        std::push_heap(heap.begin(), heap.end(), compare);
+    }
+
+    pace(recorded.receivedTime);
+    currentTime = recorded.receivedTime;
+    return true;
+}
+
+void MarketReplay::pace(int64_t receivedTime) {
+    if (speed <= 0) {
+        return;
+    }
+    if (!paceStarted) {
+        paceStarted = true;
+        paceStartTime = receivedTime;
+        paceStart = std::chrono::steady_clock::now();
+        return;
+    }
+    std::chrono::steady_clock::time_point due = paceStart + std::chrono::microseconds(
+        static_cast<int64_t>((receivedTime - paceStartTime) * 1000 / speed));
+    // sleep in short steps so stop() takes effect promptly
+    while (!stopped) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= due) {
+            break;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(due - now,
+            std::chrono::milliseconds(100)));
+    }
+}
+
+uint64_t MarketReplay::run(const Callback& callback) {
+    uint64_t count = 0;
+    RecordedMarketBook recorded;
+    while (!stopped && next(recorded)) {
+        callback(recorded);
+        ++count;
+    }
+    return count;
+}
+
+void MarketReplay::stop() {
+    stopped = true;
+}
+
+void MarketReplay::reset() {
+    stopped = false;
+}
+
+int64_t MarketReplay::getCurrentTime() const {
+    return currentTime;
+}
+
+}
+}
@@ -37,6 +37,10 @@ CURLcode Curl::easyPerform(const CurlHandle& handle) const {
     return curl_easy_perform(handle.get());
 }
 
+CURLcode Curl::easyGetinfo(const CurlHandle& handle, const CURLINFO& info, double* parameter) const {
+    return curl_easy_getinfo(handle.get(), info, parameter);
+}
+
 Curl::~Curl() {
     curl_global_cleanup();
 }
@@ -0,0 +1,38 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/market/CachedListMarketBookResponse.h"
+
+namespace greentop {
+namespace market {
+
+CachedListMarketBookResponse::CachedListMarketBookResponse(MarketBookCache& cache, const std::string& projection) :
+    cache(cache),
+    projection(projection) {
+}
+
+void CachedListMarketBookResponse::fromJson(const Json::Value& json) {
+    if (validateJson(json)) {
+        marketBooks = cache.update(json, projection);
+    }
+}
+
+Json::Value CachedListMarketBookResponse::toJson() const {
+    Json::Value json(Json::arrayValue);
+    for (unsigned i = 0; i < marketBooks.size(); ++i) {
+        json.append(marketBooks[i]->toJson());
+    }
+    return json;
+}
+
+bool CachedListMarketBookResponse::isValid() const {
+    return marketBooks.size() > 0;
+}
+
+const std::vector<std::shared_ptr<const MarketBook>>& CachedListMarketBookResponse::getMarketBooks() const {
+    return marketBooks;
+}
+
+}
+}
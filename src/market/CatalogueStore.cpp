@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "greentop/market/CatalogueStore.h"
+
+namespace greentop {
+namespace market {
+
+CatalogueStore::CatalogueStore() : strings(new StringPool()) {
+}
+
+std::shared_ptr<const CompactMarketCatalogue> CatalogueStore::put(const MarketCatalogue& marketCatalogue) {
+    std::shared_ptr<const CompactMarketCatalogue> compact(new CompactMarketCatalogue(marketCatalogue, *this));
+    std::lock_guard<std::mutex> lock(mutex);
+    catalogues[marketCatalogue.getMarketId()] = compact;
+    return compact;
+}
+
+std::shared_ptr<const CompactMarketCatalogue> CatalogueStore::get(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = catalogues.find(marketId);
+    if (it != catalogues.end()) {
+        return it->second;
+    }
+    return std::shared_ptr<const CompactMarketCatalogue>();
+}
+
+void CatalogueStore::remove(const std::string& marketId) {
+    std::shared_ptr<const CompactMarketCatalogue> removed;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = catalogues.find(marketId);
+    if (it != catalogues.end()) {
+        // released after the lock, as it may release shared objects
+        removed.swap(it->second);
+        catalogues.erase(it);
+    }
+}
+
+void CatalogueStore::clear() {
+    // released after the lock, as they may release shared objects
+    std::unordered_map<std::string, std::shared_ptr<const CompactMarketCatalogue>> removed;
+    std::shared_ptr<StringPool> removedStrings(new StringPool());
+    std::lock_guard<std::mutex> lock(mutex);
+    removed.swap(catalogues);
+    // catalogues still held elsewhere keep the old pool
+    removedStrings.swap(strings);
+    eventTypes = SharedMap<std::string, EventType>();
+    competitions = SharedMap<std::string, Competition>();
+    events = SharedMap<std::string, Event>();
+    descriptions = SharedMap<size_t, MarketDescription>();
+}
+
+size_t CatalogueStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return catalogues.size();
+}
+
+std::shared_ptr<const EventType> CatalogueStore::share(const EventType& eventType) {
+    if (eventType.getId().empty()) {
+        return std::shared_ptr<const EventType>();
+    }
+    return share(eventTypes, eventType.getId(), eventType);
+}
+
+std::shared_ptr<const Competition> CatalogueStore::share(const Competition& competition) {
+    if (competition.getId().empty()) {
+        return std::shared_ptr<const Competition>();
+    }
+    return share(competitions, competition.getId(), competition);
+}
+
+std::shared_ptr<const Event> CatalogueStore::share(const Event& event) {
+    if (event.getId().empty()) {
+        return std::shared_ptr<const Event>();
+    }
+    return share(events, event.getId(), event);
+}
+
+std::shared_ptr<const MarketDescription> CatalogueStore::share(const MarketDescription& description) {
+    if (!description.isValid()) {
+        return std::shared_ptr<const MarketDescription>();
+    }
+    size_t key = std::hash<std::string>()(description.toString());
+    return share(descriptions, key, description);
+}
+
+std::shared_ptr<StringPool> CatalogueStore::getStringPool() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return strings;
+}
+
+template <typename K, typename T>
+std::shared_ptr<const T> CatalogueStore::share(SharedMap<K, T>& shared, const K& key, const T& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::weak_ptr<const T>& object = shared.objects[key];
+    std::shared_ptr<const T> existing = object.lock();
+    // an object with the same id may have changed, eg an event's name, in which case later catalogues share
+    // the new version.
+    if (existing && existing->toJson() == value.toJson()) {
+        return existing;
+    }
+    std::shared_ptr<const T> copy(new T(value));
+    object = copy;
+
+    if (shared.objects.size() >= shared.sweepSize) {
+        for (auto it = shared.objects.begin(); it != shared.objects.end(); ) {
+            if (it->second.expired()) {
+                it = shared.objects.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        shared.sweepSize = std::max<size_t>(64, shared.objects.size() * 2);
+    }
+    return copy;
+}
+
+}
+}
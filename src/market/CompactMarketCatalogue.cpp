@@ -0,0 +1,91 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/market/CatalogueStore.h"
+#include "greentop/market/CompactMarketCatalogue.h"
+
+namespace greentop {
+namespace market {
+
+namespace {
+
+template <typename T>
+const T& valueOrEmpty(const std::shared_ptr<const T>& value) {
+    static const T empty;
+    return value ? *value : empty;
+}
+
+}
+
+CompactMarketCatalogue::CompactMarketCatalogue(const MarketCatalogue& marketCatalogue, CatalogueStore& store) :
+    marketId(marketCatalogue.getMarketId()),
+    marketName(marketCatalogue.getMarketName()),
+    marketStartTime(marketCatalogue.getMarketStartTime()),
+    totalMatched(marketCatalogue.getTotalMatched()),
+    description(store.share(marketCatalogue.getDescription())),
+    eventType(store.share(marketCatalogue.getEventType())),
+    competition(store.share(marketCatalogue.getCompetition())),
+    event(store.share(marketCatalogue.getEvent())),
+    strings(store.getStringPool()) {
+    const std::vector<RunnerCatalog>& runnerCatalogs = marketCatalogue.getRunners();
+    runners.reserve(runnerCatalogs.size());
+    for (auto it = runnerCatalogs.begin(); it != runnerCatalogs.end(); ++it) {
+        runners.push_back(CompactRunnerCatalog(*it, *strings));
+    }
+    runnerIndex.build(runners);
+}
+
+const std::string& CompactMarketCatalogue::getMarketId() const {
+    return marketId;
+}
+
+const std::string& CompactMarketCatalogue::getMarketName() const {
+    return marketName;
+}
+
+const std::tm& CompactMarketCatalogue::getMarketStartTime() const {
+    return marketStartTime;
+}
+
+const MarketDescription& CompactMarketCatalogue::getDescription() const {
+    return valueOrEmpty(description);
+}
+
+const Optional<double>& CompactMarketCatalogue::getTotalMatched() const {
+    return totalMatched;
+}
+
+const std::vector<CompactRunnerCatalog>& CompactMarketCatalogue::getRunners() const {
+    return runners;
+}
+
+const CompactRunnerCatalog* CompactMarketCatalogue::getRunner(int64_t selectionId, double handicap) const {
+    int32_t position = runnerIndex.find(selectionId, handicap);
+    return position == RunnerIndex::NOT_FOUND ? NULL : &runners[position];
+}
+
+const EventType& CompactMarketCatalogue::getEventType() const {
+    return valueOrEmpty(eventType);
+}
+
+const Competition& CompactMarketCatalogue::getCompetition() const {
+    return valueOrEmpty(competition);
+}
+
+const Event& CompactMarketCatalogue::getEvent() const {
+    return valueOrEmpty(event);
+}
+
+MarketCatalogue CompactMarketCatalogue::toMarketCatalogue() const {
+    std::vector<RunnerCatalog> runnerCatalogs;
+    runnerCatalogs.reserve(runners.size());
+    for (auto it = runners.begin(); it != runners.end(); ++it) {
+        runnerCatalogs.push_back(it->toRunnerCatalog());
+    }
+    return MarketCatalogue(marketId, marketName, marketStartTime, getDescription(), totalMatched,
+        runnerCatalogs, getEventType(), getCompetition(), getEvent());
+}
+
+}
+}
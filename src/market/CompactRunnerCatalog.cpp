@@ -0,0 +1,75 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+
+#include "greentop/market/CompactRunnerCatalog.h"
+
+namespace greentop {
+namespace market {
+
+namespace {
+
+bool keyLess(const std::pair<const std::string*, const std::string*>& entry, const std::string& key) {
+    return *entry.first < key;
+}
+
+}
+
+CompactRunnerCatalog::CompactRunnerCatalog(const RunnerCatalog& runnerCatalog, StringPool& strings) :
+    selectionId(runnerCatalog.getSelectionId()),
+    runnerName(strings.intern(runnerCatalog.getRunnerName())),
+    handicap(runnerCatalog.getHandicap()),
+    sortPriority(runnerCatalog.getSortPriority()) {
+    // the map is already sorted by key
+    const std::map<std::string, std::string>& entries = runnerCatalog.getMetadata();
+    metadata.reserve(entries.size());
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        metadata.push_back(std::make_pair(strings.intern(it->first), strings.intern(it->second)));
+    }
+}
+
+const Optional<int64_t>& CompactRunnerCatalog::getSelectionId() const {
+    return selectionId;
+}
+
+const std::string& CompactRunnerCatalog::getRunnerName() const {
+    return *runnerName;
+}
+
+const Optional<double>& CompactRunnerCatalog::getHandicap() const {
+    return handicap;
+}
+
+const Optional<int32_t>& CompactRunnerCatalog::getSortPriority() const {
+    return sortPriority;
+}
+
+std::map<std::string, std::string> CompactRunnerCatalog::getMetadata() const {
+    std::map<std::string, std::string> entries;
+    for (auto it = metadata.begin(); it != metadata.end(); ++it) {
+        entries.insert(entries.end(), std::make_pair(*it->first, *it->second));
+    }
+    return entries;
+}
+
+const std::string* CompactRunnerCatalog::getMetadataValue(const std::string& key) const {
+    auto it = std::lower_bound(metadata.begin(), metadata.end(), key, keyLess);
+    if (it != metadata.end() && *it->first == key) {
+        return it->second;
+    }
+    return NULL;
+}
+
+const std::vector<std::pair<const std::string*, const std::string*>>&
+    CompactRunnerCatalog::getMetadataEntries() const {
+    return metadata;
+}
+
+RunnerCatalog CompactRunnerCatalog::toRunnerCatalog() const {
+    return RunnerCatalog(selectionId, *runnerName, handicap, sortPriority, getMetadata());
+}
+
+}
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/market/Fnv.h"
+#include "greentop/market/MarketBookCache.h"
+
+namespace greentop {
+namespace market {
+
+namespace {
+
+uint64_t hashJson(uint64_t hash, const Json::Value& json) {
+    unsigned char type = static_cast<unsigned char>(json.type());
+    hash = hashBytes(hash, &type, 1);
+    switch (json.type()) {
+        case Json::intValue:
+        case Json::uintValue:
+        case Json::realValue: {
+            double value = json.asDouble();
+            return hashBytes(hash, &value, sizeof(value));
+        }
+        case Json::stringValue: {
+            const char* begin;
+            const char* end;
+            json.getString(&begin, &end);
+            return hashBytes(hash, begin, end - begin + 1);
+        }
+        case Json::booleanValue: {
+            unsigned char value = json.asBool();
+            return hashBytes(hash, &value, 1);
+        }
+        case Json::arrayValue:
+            for (unsigned i = 0; i < json.size(); ++i) {
+                hash = hashJson(hash, json[i]);
+            }
+            // separate adjacent arrays
+            return hashBytes(hash, "]", 1);
+        case Json::objectValue:
+            for (auto it = json.begin(); it != json.end(); ++it) {
+                const char* end;
+                const char* name = it.memberName(&end);
+                hash = hashBytes(hash, name, end - name + 1);
+                hash = hashJson(hash, *it);
+            }
+            return hashBytes(hash, "}", 1);
+        default:
+            return hash;
+    }
+}
+
+}
+
+bool MarketBookCache::Fingerprint::operator==(const Fingerprint& other) const {
+    return hasVersion == other.hasVersion && version == other.version && status == other.status &&
+        totalMatched == other.totalMatched && totalAvailable == other.totalAvailable &&
+        lastMatchTime == other.lastMatchTime && numberOfRunners == other.numberOfRunners &&
+        runnersHash == other.runnersHash;
+}
+
+MarketBookCache::MarketBookCache() : hits(0), misses(0) {
+}
+
+MarketBookCache::Fingerprint MarketBookCache::makeFingerprint(const Json::Value& json) {
+    Fingerprint fingerprint;
+    fingerprint.hasVersion = json.isMember("version");
+    fingerprint.version = fingerprint.hasVersion ? json["version"].asInt64() : 0;
+    fingerprint.status = json.isMember("status") ? json["status"].asString() : "";
+    fingerprint.totalMatched = json.isMember("totalMatched") ? json["totalMatched"].asDouble() : -1;
+    fingerprint.totalAvailable = json.isMember("totalAvailable") ? json["totalAvailable"].asDouble() : -1;
+    fingerprint.lastMatchTime = json.isMember("lastMatchTime") ? json["lastMatchTime"].asString() : "";
+    fingerprint.numberOfRunners = json.isMember("runners") ? json["runners"].size() : 0;
+    // the ladders can be reshuffled without any of the totals moving
+    fingerprint.runnersHash = hashJson(FNV_OFFSET_BASIS, json["runners"]);
+    return fingerprint;
+}
+
+std::vector<std::shared_ptr<const MarketBook>> MarketBookCache::update(const Json::Value& json,
+        const std::string& projection) {
+    std::vector<std::shared_ptr<const MarketBook>> marketBooks;
+    if (json.isArray()) {
+        marketBooks.reserve(json.size());
+        for (unsigned i = 0; i < json.size(); ++i) {
+            marketBooks.push_back(updateMarketBook(json[i], projection));
+        }
+    }
+    return marketBooks;
+}
+
+std::shared_ptr<const MarketBook> MarketBookCache::updateMarketBook(const Json::Value& json,
+        const std::string& projection) {
+    std::string marketId = json["marketId"].asString();
+    Fingerprint fingerprint = makeFingerprint(json);
+
+    // a market without a version can't be trusted to be unchanged.
+    if (fingerprint.hasVersion) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto market = entries.find(marketId);
+        if (market != entries.end()) {
+            auto it = market->second.find(projection);
+            if (it != market->second.end() && it->second.fingerprint == fingerprint) {
+                ++hits;
+                return it->second.marketBook;
+            }
+        }
+    }
+
+    ++misses;
+    std::shared_ptr<MarketBook> marketBook(new MarketBook());
+    marketBook->fromJson(json);
+
+    Entry entry = {fingerprint, marketBook};
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[marketId][projection] = entry;
+    return marketBook;
+}
+
+std::shared_ptr<const MarketBook> MarketBookCache::get(const std::string& marketId,
+        const std::string& projection) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto market = entries.find(marketId);
+    if (market != entries.end()) {
+        auto it = market->second.find(projection);
+        if (it != market->second.end()) {
+            return it->second.marketBook;
+        }
+    }
+    return std::shared_ptr<const MarketBook>();
+}
+
+void MarketBookCache::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(marketId);
+}
+
+void MarketBookCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+uint64_t MarketBookCache::getHits() const {
+    return hits;
+}
+
+uint64_t MarketBookCache::getMisses() const {
+    return misses;
+}
+
+double MarketBookCache::getHitRate() const {
+    uint64_t h = hits;
+    uint64_t total = h + misses;
+    return total > 0 ? static_cast<double>(h) / total : 0;
+}
+
+void MarketBookCache::resetCounters() {
+    hits = 0;
+    misses = 0;
+}
+
+std::string MarketBookCache::getProjection(const ListMarketBookRequest& request) {
+    Json::Value json = request.toJson();
+    json.removeMember("marketIds");
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, json);
+}
+
+}
+}
@@ -0,0 +1,343 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "greentop/market/Fnv.h"
+#include "greentop/market/MarketBookDiffer.h"
+
+namespace greentop {
+namespace market {
+
+namespace {
+
+uint64_t hashDouble(uint64_t hash, const Optional<double>& value) {
+    double d = value.isValid() ? value.getValue() : -1;
+    return hashBytes(hash, &d, sizeof(d));
+}
+
+uint64_t hashString(uint64_t hash, const std::string& value) {
+    return hashBytes(hash, value.data(), value.size() + 1);
+}
+
+uint64_t hashLadder(uint64_t hash, const std::vector<PriceSize>& ladder) {
+    for (const PriceSize& priceSize : ladder) {
+        hash = hashDouble(hash, priceSize.getPrice());
+        hash = hashDouble(hash, priceSize.getSize());
+    }
+    // separate adjacent ladders
+    return hashBytes(hash, "|", 1);
+}
+
+uint64_t hashRunner(const Runner& runner) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = hashString(hash, runner.getStatus().getValue());
+    hash = hashDouble(hash, runner.getLastPriceTraded());
+    hash = hashDouble(hash, runner.getTotalMatched());
+    hash = hashLadder(hash, runner.getEx().getAvailableToBack());
+    hash = hashLadder(hash, runner.getEx().getAvailableToLay());
+    hash = hashLadder(hash, runner.getEx().getTradedVolume());
+    for (const Order& order : runner.getOrders()) {
+        hash = hashString(hash, order.getBetId());
+        hash = hashString(hash, order.getStatus().getValue());
+        hash = hashDouble(hash, order.getPrice());
+        hash = hashDouble(hash, order.getSize());
+        hash = hashDouble(hash, order.getAvgPriceMatched());
+        hash = hashDouble(hash, order.getSizeMatched());
+        hash = hashDouble(hash, order.getSizeRemaining());
+        hash = hashDouble(hash, order.getSizeLapsed());
+        hash = hashDouble(hash, order.getSizeCancelled());
+        hash = hashDouble(hash, order.getSizeVoided());
+    }
+    for (const Match& match : runner.getMatches()) {
+        hash = hashString(hash, match.getBetId());
+        hash = hashString(hash, match.getMatchId());
+        hash = hashString(hash, match.getSide().getValue());
+        hash = hashDouble(hash, match.getPrice());
+        hash = hashDouble(hash, match.getSize());
+    }
+    return hash;
+}
+
+template<typename T>
+T valueOr(const Optional<T>& optional, T defaultValue) {
+    return optional.isValid() ? optional.getValue() : defaultValue;
+}
+
+bool isEqual(const Optional<double>& a, const Optional<double>& b) {
+    return a.isValid() == b.isValid() && (!a.isValid() || a.getValue() == b.getValue());
+}
+
+bool isEqual(const Optional<bool>& a, const Optional<bool>& b) {
+    return a.isValid() == b.isValid() && (!a.isValid() || a.getValue() == b.getValue());
+}
+
+bool isEqual(const Optional<int64_t>& a, const Optional<int64_t>& b) {
+    return a.isValid() == b.isValid() && (!a.isValid() || a.getValue() == b.getValue());
+}
+
+typedef std::vector<std::pair<double, double>> Levels;
+
+void toSortedLevels(const std::vector<PriceSize>& ladder, Levels& levels) {
+    levels.clear();
+    levels.reserve(ladder.size());
+    for (const PriceSize& priceSize : ladder) {
+        levels.push_back(std::make_pair(valueOr(priceSize.getPrice(), 0.0), valueOr(priceSize.getSize(), 0.0)));
+    }
+    std::sort(levels.begin(), levels.end());
+}
+
+void diffLadder(const std::vector<PriceSize>& previous, const std::vector<PriceSize>& current,
+    LadderChange::Ladder ladder, std::vector<LadderChange>& changes) {
+
+    Levels before;
+    Levels after;
+    toSortedLevels(previous, before);
+    toSortedLevels(current, after);
+
+    auto it1 = before.begin();
+    auto it2 = after.begin();
+    while (it1 != before.end() || it2 != after.end()) {
+        if (it2 == after.end() || (it1 != before.end() && it1->first < it2->first)) {
+            changes.push_back(LadderChange(ladder, it1->first, 0));
+            ++it1;
+        } else if (it1 == before.end() || it2->first < it1->first) {
+            changes.push_back(LadderChange(ladder, it2->first, it2->second));
+            ++it2;
+        } else {
+            if (it1->second != it2->second) {
+                changes.push_back(LadderChange(ladder, it2->first, it2->second));
+            }
+            ++it1;
+            ++it2;
+        }
+    }
+}
+
+bool isOrderChanged(const Order& previous, const Order& current) {
+    return previous.getStatus() != current.getStatus() ||
+        !isEqual(previous.getPrice(), current.getPrice()) ||
+        !isEqual(previous.getSize(), current.getSize()) ||
+        !isEqual(previous.getAvgPriceMatched(), current.getAvgPriceMatched()) ||
+        !isEqual(previous.getSizeMatched(), current.getSizeMatched()) ||
+        !isEqual(previous.getSizeRemaining(), current.getSizeRemaining()) ||
+        !isEqual(previous.getSizeLapsed(), current.getSizeLapsed()) ||
+        !isEqual(previous.getSizeCancelled(), current.getSizeCancelled()) ||
+        !isEqual(previous.getSizeVoided(), current.getSizeVoided());
+}
+
+void diffOrders(const std::vector<Order>& previous, const std::vector<Order>& current,
+    std::vector<Order>& changes) {
+
+    std::unordered_map<std::string, const Order*> previousByBetId;
+    for (const Order& order : previous) {
+        previousByBetId[order.getBetId()] = &order;
+    }
+    for (const Order& order : current) {
+        auto it = previousByBetId.find(order.getBetId());
+        if (it == previousByBetId.end() || isOrderChanged(*it->second, order)) {
+            changes.push_back(order);
+        }
+    }
+}
+
+std::string makeMatchKey(const Match& match) {
+    char price[32];
+    snprintf(price, sizeof(price), "%.17g", valueOr(match.getPrice(), 0.0));
+    return match.getBetId() + "|" + match.getMatchId() + "|" + match.getSide().getValue() + "|" + price;
+}
+
+void diffMatches(const std::vector<Match>& previous, const std::vector<Match>& current,
+    std::vector<Match>& changes) {
+
+    std::unordered_map<std::string, const Match*> previousByKey;
+    for (const Match& match : previous) {
+        previousByKey[makeMatchKey(match)] = &match;
+    }
+    for (const Match& match : current) {
+        auto it = previousByKey.find(makeMatchKey(match));
+        if (it == previousByKey.end() || !isEqual(it->second->getSize(), match.getSize())) {
+            changes.push_back(match);
+        }
+    }
+}
+
+void fillNewRunner(const Runner& runner, RunnerDelta& delta) {
+    delta.isNew = true;
+    delta.statusChanged = true;
+    delta.status = runner.getStatus();
+    delta.lastPriceTradedChanged = true;
+    delta.lastPriceTraded = runner.getLastPriceTraded();
+    delta.totalMatchedChanged = true;
+    delta.totalMatched = runner.getTotalMatched();
+    diffLadder(std::vector<PriceSize>(), runner.getEx().getAvailableToBack(),
+        LadderChange::Ladder::AVAILABLE_TO_BACK, delta.ladderChanges);
+    diffLadder(std::vector<PriceSize>(), runner.getEx().getAvailableToLay(),
+        LadderChange::Ladder::AVAILABLE_TO_LAY, delta.ladderChanges);
+    diffLadder(std::vector<PriceSize>(), runner.getEx().getTradedVolume(),
+        LadderChange::Ladder::TRADED_VOLUME, delta.ladderChanges);
+    delta.orders = runner.getOrders();
+    delta.matches = runner.getMatches();
+}
+
+}
+
+MarketBookDiffer::MarketBookDiffer() {
+}
+
+MarketBookDelta MarketBookDiffer::update(const MarketBook& marketBook) {
+    return update(marketBook, std::shared_ptr<const MarketBook>());
+}
+
+MarketBookDelta MarketBookDiffer::update(const std::shared_ptr<const MarketBook>& marketBook) {
+    auto previousIt = snapshots.find(marketBook->getMarketId());
+    if (previousIt != snapshots.end() && previousIt->second.source == marketBook) {
+        MarketBookDelta delta;
+        delta.marketId = marketBook->getMarketId();
+        delta.version = marketBook->getVersion();
+        delta.status = marketBook->getStatus();
+        delta.inplay = marketBook->getInplay();
+        delta.totalMatched = marketBook->getTotalMatched();
+        return delta;
+    }
+    return update(*marketBook, marketBook);
+}
+
+MarketBookDelta MarketBookDiffer::update(const MarketBook& marketBook,
+    const std::shared_ptr<const MarketBook>& source) {
+
+    MarketBookDelta delta;
+    delta.marketId = marketBook.getMarketId();
+    delta.version = marketBook.getVersion();
+    delta.status = marketBook.getStatus();
+    delta.inplay = marketBook.getInplay();
+    delta.totalMatched = marketBook.getTotalMatched();
+
+    std::map<RunnerKey, std::pair<const Runner*, uint64_t>> arrived;
+    for (const Runner& runner : marketBook.getRunners()) {
+        RunnerKey key(valueOr(runner.getSelectionId(), int64_t(0)), valueOr(runner.getHandicap(), 0.0));
+        arrived[key] = std::make_pair(&runner, hashRunner(runner));
+    }
+
+    Snapshot current;
+    current.version = marketBook.getVersion();
+    current.status = marketBook.getStatus();
+    current.inplay = marketBook.getInplay();
+    current.totalMatched = marketBook.getTotalMatched();
+    current.source = source;
+
+    // a shared book outlives the snapshot, so its runners are referenced rather than copied.
+    auto keep = [&source](const Runner* runner) {
+        return source ? std::shared_ptr<const Runner>(source, runner) : std::make_shared<const Runner>(*runner);
+    };
+
+    auto previousIt = snapshots.find(marketBook.getMarketId());
+    if (previousIt == snapshots.end()) {
+        delta.isNew = true;
+        delta.versionChanged = true;
+        delta.statusChanged = true;
+        delta.inplayChanged = true;
+        delta.totalMatchedChanged = true;
+        for (auto it = arrived.begin(); it != arrived.end(); ++it) {
+            RunnerDelta runnerDelta;
+            runnerDelta.selectionId = it->first.first;
+            runnerDelta.handicap = it->first.second;
+            fillNewRunner(*it->second.first, runnerDelta);
+            delta.runners.push_back(runnerDelta);
+            RunnerSnapshot runnerSnapshot = {keep(it->second.first), it->second.second};
+            current.runners[it->first] = runnerSnapshot;
+        }
+        snapshots[marketBook.getMarketId()] = std::move(current);
+        return delta;
+    }
+
+    const Snapshot& previous = previousIt->second;
+
+    // the version only moves when the market definition changes, eg status or inplay.
+    bool definitionChanged = !marketBook.getVersion().isValid() ||
+        !isEqual(previous.version, marketBook.getVersion());
+    if (definitionChanged) {
+        delta.versionChanged = !isEqual(previous.version, marketBook.getVersion());
+        delta.statusChanged = previous.status != marketBook.getStatus();
+        delta.inplayChanged = !isEqual(previous.inplay, marketBook.getInplay());
+    }
+    delta.totalMatchedChanged = !isEqual(previous.totalMatched, marketBook.getTotalMatched());
+
+    auto it1 = previous.runners.begin();
+    auto it2 = arrived.begin();
+    while (it1 != previous.runners.end() || it2 != arrived.end()) {
+        RunnerDelta runnerDelta;
+        if (it2 == arrived.end() || (it1 != previous.runners.end() && it1->first < it2->first)) {
+            runnerDelta.selectionId = it1->first.first;
+            runnerDelta.handicap = it1->first.second;
+            runnerDelta.isRemoved = true;
+            delta.runners.push_back(runnerDelta);
+            ++it1;
+        } else if (it1 == previous.runners.end() || it2->first < it1->first) {
+            runnerDelta.selectionId = it2->first.first;
+            runnerDelta.handicap = it2->first.second;
+            fillNewRunner(*it2->second.first, runnerDelta);
+            delta.runners.push_back(runnerDelta);
+            RunnerSnapshot runnerSnapshot = {keep(it2->second.first), it2->second.second};
+            current.runners[it2->first] = runnerSnapshot;
+            ++it2;
+        } else {
+            if (it1->second.hash == it2->second.second) {
+                current.runners[it2->first] = it1->second;
+            } else {
+                runnerDelta.selectionId = it2->first.first;
+                runnerDelta.handicap = it2->first.second;
+                diffRunner(*it1->second.runner, *it2->second.first, definitionChanged, runnerDelta);
+                delta.runners.push_back(runnerDelta);
+                RunnerSnapshot runnerSnapshot = {keep(it2->second.first), it2->second.second};
+                current.runners[it2->first] = runnerSnapshot;
+            }
+            ++it1;
+            ++it2;
+        }
+    }
+
+    previousIt->second = std::move(current);
+    return delta;
+}
+
+void MarketBookDiffer::diffRunner(const Runner& previous, const Runner& current, bool definitionChanged,
+    RunnerDelta& delta) const {
+
+    delta.status = current.getStatus();
+    delta.lastPriceTraded = current.getLastPriceTraded();
+    delta.totalMatched = current.getTotalMatched();
+
+    // runner status is part of the market definition, it can't change without the version changing too.
+    if (definitionChanged) {
+        delta.statusChanged = previous.getStatus() != current.getStatus();
+    }
+    delta.lastPriceTradedChanged = !isEqual(previous.getLastPriceTraded(), current.getLastPriceTraded());
+    delta.totalMatchedChanged = !isEqual(previous.getTotalMatched(), current.getTotalMatched());
+
+    diffLadder(previous.getEx().getAvailableToBack(), current.getEx().getAvailableToBack(),
+        LadderChange::Ladder::AVAILABLE_TO_BACK, delta.ladderChanges);
+    diffLadder(previous.getEx().getAvailableToLay(), current.getEx().getAvailableToLay(),
+        LadderChange::Ladder::AVAILABLE_TO_LAY, delta.ladderChanges);
+    diffLadder(previous.getEx().getTradedVolume(), current.getEx().getTradedVolume(),
+        LadderChange::Ladder::TRADED_VOLUME, delta.ladderChanges);
+    diffOrders(previous.getOrders(), current.getOrders(), delta.orders);
+    diffMatches(previous.getMatches(), current.getMatches(), delta.matches);
+}
+
+void MarketBookDiffer::remove(const std::string& marketId) {
+    snapshots.erase(marketId);
+}
+
+void MarketBookDiffer::clear() {
+    snapshots.clear();
+}
+
+bool MarketBookDiffer::hasSnapshot(const std::string& marketId) const {
+    return snapshots.find(marketId) != snapshots.end();
+}
+
+}
+}
@@ -0,0 +1,387 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#if defined _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "greentop/archive/Encoding.h"
+#include "greentop/market/MarketCatalogueCache.h"
+
+namespace greentop {
+namespace market {
+
+namespace {
+
+/** "GTMC" */
+const uint32_t MAGIC = 0x434d5447;
+const uint32_t VERSION = 1;
+
+// the bit of each projection in Entry::projections
+const char* const PROJECTIONS[] = {
+    "COMPETITION",
+    "EVENT",
+    "EVENT_TYPE",
+    "MARKET_START_TIME",
+    "MARKET_DESCRIPTION",
+    "RUNNER_DESCRIPTION",
+    "RUNNER_METADATA"
+};
+const unsigned PROJECTION_COUNT = sizeof(PROJECTIONS) / sizeof(PROJECTIONS[0]);
+
+const uint32_t MARKET_START_TIME_BIT = 1 << 3;
+const uint32_t MARKET_DESCRIPTION_BIT = 1 << 4;
+const uint32_t RUNNER_DESCRIPTION_BIT = 1 << 5;
+const uint32_t RUNNER_METADATA_BIT = 1 << 6;
+
+unsigned getWeight(uint32_t projections) {
+    unsigned weight = 0;
+    if (projections & MARKET_DESCRIPTION_BIT) {
+        weight += 1;
+    }
+    if (projections & RUNNER_METADATA_BIT) {
+        weight += 1;
+    }
+    return weight;
+}
+
+}
+
+const unsigned MarketCatalogueCache::MAX_WEIGHT;
+const unsigned MarketCatalogueCache::MAX_RESULTS;
+
+MarketCatalogueCache::MarketCatalogueCache(const ExchangeApi& exchangeApi, const std::string& fileName) :
+    exchangeApi(exchangeApi),
+    fileName(fileName),
+    ttl(std::chrono::hours(1)),
+    maxWeight(MAX_WEIGHT),
+    hits(0),
+    misses(0),
+    requests(0),
+    errors(0) {
+    Json::CharReaderBuilder builder;
+    builder["collectComments"] = false;
+    reader.reset(builder.newCharReader());
+    if (!fileName.empty()) {
+        load();
+    }
+}
+
+void MarketCatalogueCache::setTtl(const std::chrono::seconds& ttl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->ttl = ttl;
+}
+
+void MarketCatalogueCache::setMaxWeight(unsigned maxWeight) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxWeight = std::max(1u, maxWeight);
+}
+
+void MarketCatalogueCache::setLocale(const std::string& locale) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->locale = locale;
+}
+
+std::vector<std::shared_ptr<const MarketCatalogue>> MarketCatalogueCache::get(
+    const std::vector<std::string>& marketIds, const std::set<MarketProjection>& marketProjection) {
+    uint32_t wanted = toProjections(marketProjection);
+
+    // markets to fetch, grouped by the projections to fetch them with.
+    std::map<uint32_t, std::vector<std::string>> toFetch;
+    unsigned weightLimit;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t time = now();
+        std::set<std::string> seen;
+        for (const std::string& marketId : marketIds) {
+            if (!seen.insert(marketId).second) {
+                continue;
+            }
+            auto it = entries.find(marketId);
+            bool fresh = it != entries.end() && time - it->second.fetchedTime < ttl.count();
+            if (fresh && (it->second.projections & wanted) == wanted && decode(it->second)) {
+                ++hits;
+                continue;
+            }
+            ++misses;
+            // refetch what the cached catalogue already has too, so that the new catalogue replaces it.
+            toFetch[fresh ? wanted | it->second.projections : wanted].push_back(marketId);
+        }
+        weightLimit = maxWeight;
+    }
+
+    for (auto it = toFetch.begin(); it != toFetch.end(); ++it) {
+        unsigned weight = getWeight(it->first);
+        size_t size = weight > 0 ? std::max<size_t>(1, weightLimit / weight) : MAX_RESULTS;
+        size = std::min<size_t>(size, MAX_RESULTS);
+        const std::vector<std::string>& pending = it->second;
+        for (size_t start = 0; start < pending.size(); start += size) {
+            size_t end = std::min(pending.size(), start + size);
+            fetch(std::vector<std::string>(pending.begin() + start, pending.begin() + end), it->first);
+        }
+    }
+
+    std::vector<std::shared_ptr<const MarketCatalogue>> catalogues;
+    catalogues.reserve(marketIds.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::string& marketId : marketIds) {
+        auto it = entries.find(marketId);
+        if (it != entries.end() && (it->second.projections & wanted) == wanted && decode(it->second)) {
+            catalogues.push_back(it->second.catalogue);
+        }
+    }
+    return catalogues;
+}
+
+std::shared_ptr<const MarketCatalogue> MarketCatalogueCache::get(const std::string& marketId,
+    const std::set<MarketProjection>& marketProjection) {
+    std::vector<std::shared_ptr<const MarketCatalogue>> catalogues =
+        get(std::vector<std::string>(1, marketId), marketProjection);
+    return catalogues.empty() ? std::shared_ptr<const MarketCatalogue>() : catalogues[0];
+}
+
+std::shared_ptr<const MarketCatalogue> MarketCatalogueCache::find(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(marketId);
+    if (it != entries.end()) {
+        return decode(it->second);
+    }
+    return std::shared_ptr<const MarketCatalogue>();
+}
+
+void MarketCatalogueCache::put(const MarketCatalogue& marketCatalogue,
+    const std::set<MarketProjection>& marketProjection) {
+    Entry entry = {now(), toProjections(marketProjection),
+        std::shared_ptr<const MarketCatalogue>(new MarketCatalogue(marketCatalogue)), NULL, 0};
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[marketCatalogue.getMarketId()] = entry;
+}
+
+void MarketCatalogueCache::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(marketId);
+}
+
+void MarketCatalogueCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+size_t MarketCatalogueCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void MarketCatalogueCache::save() const {
+    if (fileName.empty()) {
+        throw std::runtime_error("no file to save the market catalogue cache to");
+    }
+
+    // take a copy of the entries so that encoding doesn't hold up readers.  The undecoded json points into the
+    // mapped file, which lives as long as the cache.
+    std::vector<std::pair<std::string, Entry>> toSave;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t time = now();
+        toSave.reserve(entries.size());
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (time - it->second.fetchedTime < ttl.count()) {
+                toSave.push_back(*it);
+            }
+        }
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+
+    archive::ByteWriter output;
+    output.putFixed32(MAGIC);
+    output.putFixed32(VERSION);
+    for (auto it = toSave.begin(); it != toSave.end(); ++it) {
+        const Entry& entry = it->second;
+        output.putString(it->first);
+        output.putSigned(entry.fetchedTime);
+        output.putVarint(entry.projections);
+        if (entry.catalogue) {
+            std::ostringstream json;
+            writer->write(entry.catalogue->toJson(), &json);
+            output.putString(json.str());
+        } else {
+            output.putVarint(entry.jsonLength);
+            output.putBytes(entry.json, entry.jsonLength);
+        }
+    }
+
+    // write a new file and move it into place, so a crash can't leave a partly written cache.
+    std::string tempFileName = fileName + ".tmp";
+    {
+        std::ofstream file(tempFileName.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(output.getBuffer().data(), output.getBuffer().size());
+        if (!file) {
+            throw std::runtime_error("cannot write " + tempFileName);
+        }
+    }
+#ifdef _WIN32
+    // rename() won't replace a file on Windows.  MappedFile reads the old file into memory there rather than
+    // mapping it, so nothing holds it open and it can be replaced in one step.
+    bool renamed = MoveFileExA(tempFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+#endif
+    if (!renamed) {
+        throw std::runtime_error("cannot rename " + tempFileName + " to " + fileName);
+    }
+}
+
+uint64_t MarketCatalogueCache::getHits() const {
+    return hits;
+}
+
+uint64_t MarketCatalogueCache::getMisses() const {
+    return misses;
+}
+
+uint64_t MarketCatalogueCache::getRequests() const {
+    return requests;
+}
+
+uint64_t MarketCatalogueCache::getErrors() const {
+    return errors;
+}
+
+void MarketCatalogueCache::resetCounters() {
+    hits = 0;
+    misses = 0;
+    requests = 0;
+    errors = 0;
+}
+
+unsigned MarketCatalogueCache::getMarketWeight(const std::set<MarketProjection>& marketProjection) {
+    return getWeight(toProjections(marketProjection));
+}
+
+uint32_t MarketCatalogueCache::toProjections(const std::set<MarketProjection>& marketProjection) {
+    uint32_t projections = 0;
+    for (auto it = marketProjection.begin(); it != marketProjection.end(); ++it) {
+        std::string value = it->getValue();
+        for (unsigned i = 0; i < PROJECTION_COUNT; ++i) {
+            if (value == PROJECTIONS[i]) {
+                projections |= 1 << i;
+                break;
+            }
+        }
+    }
+    // runner metadata comes with the runner descriptions
+    if (projections & RUNNER_METADATA_BIT) {
+        projections |= RUNNER_DESCRIPTION_BIT;
+    }
+    return projections;
+}
+
+std::set<MarketProjection> MarketCatalogueCache::fromProjections(uint32_t projections) {
+    std::set<MarketProjection> marketProjection;
+    for (unsigned i = 0; i < PROJECTION_COUNT; ++i) {
+        if (projections & (1 << i)) {
+            marketProjection.insert(MarketProjection(PROJECTIONS[i]));
+        }
+    }
+    return marketProjection;
+}
+
+int64_t MarketCatalogueCache::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void MarketCatalogueCache::load() {
+    if (!std::ifstream(fileName.c_str())) {
+        return;
+    }
+    file.reset(new archive::MappedFile(fileName));
+    if (file->size() == 0) {
+        return;
+    }
+    archive::ByteReader input(file->data(), file->size());
+    if (input.remaining() < 8 || input.getFixed32() != MAGIC || input.getFixed32() != VERSION) {
+        throw std::runtime_error(fileName + " isn't a market catalogue cache");
+    }
+    try {
+        while (!input.atEnd()) {
+            std::string marketId = input.getString();
+            Entry entry;
+            entry.fetchedTime = input.getSigned();
+            entry.projections = static_cast<uint32_t>(input.getVarint());
+            entry.jsonLength = static_cast<size_t>(input.getVarint());
+            entry.json = input.getBytes(entry.jsonLength);
+            entries[marketId] = entry;
+        }
+    } catch (const std::runtime_error&) {
+        // a truncated last entry is dropped
+    }
+}
+
+void MarketCatalogueCache::fetch(const std::vector<std::string>& marketIds, uint32_t projections) {
+    MarketFilter filter;
+    filter.setMarketIds(std::set<std::string>(marketIds.begin(), marketIds.end()));
+    ListMarketCatalogueRequest request(filter, fromProjections(projections), MarketSort(),
+        static_cast<int32_t>(marketIds.size()));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request.setLocale(locale);
+    }
+
+    ++requests;
+    ListMarketCatalogueResponse response;
+    bool success = false;
+    try {
+        response = exchangeApi.listMarketCatalogue(request);
+        success = response.isSuccess();
+    } catch (const std::exception&) {
+        success = false;
+    }
+    if (!success) {
+        ++errors;
+        return;
+    }
+
+    const std::vector<MarketCatalogue>& catalogues = response.getMarketCatalogues();
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t time = now();
+    for (auto it = catalogues.begin(); it != catalogues.end(); ++it) {
+        MarketCatalogue* catalogue = new MarketCatalogue(*it);
+        if (!(projections & MARKET_START_TIME_BIT)) {
+            // not sent, so never set
+            catalogue->setMarketStartTime(std::tm());
+        }
+        Entry entry = {time, projections, std::shared_ptr<const MarketCatalogue>(catalogue), NULL, 0};
+        entries[it->getMarketId()] = entry;
+    }
+}
+
+const std::shared_ptr<const MarketCatalogue>& MarketCatalogueCache::decode(Entry& entry) const {
+    if (!entry.catalogue && entry.json) {
+        Json::Value json;
+        std::string errs;
+        if (reader->parse(entry.json, entry.json + entry.jsonLength, &json, &errs)) {
+            MarketCatalogue* catalogue = new MarketCatalogue();
+            catalogue->setMarketStartTime(std::tm());
+            catalogue->fromJson(json);
+            entry.catalogue.reset(catalogue);
+        }
+        entry.json = NULL;
+        entry.jsonLength = 0;
+    }
+    return entry.catalogue;
+}
+
+}
+}
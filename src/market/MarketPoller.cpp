@@ -0,0 +1,393 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "greentop/Time.h"
+#include "greentop/market/MarketPoller.h"
+
+namespace greentop {
+namespace market {
+
+namespace {
+
+time_t toStartTime(const std::tm& tm) {
+    return tm.tm_year > 0 ? toTime(tm) : 0;
+}
+
+}
+
+const unsigned MarketPoller::NUMBER_OF_PRIORITIES;
+const unsigned MarketPoller::MAX_WEIGHT;
+
+MarketPoller::MarketPoller(const ExchangeApi& exchangeApi, const ListMarketBookRequest& requestTemplate) :
+    exchangeApi(exchangeApi),
+    requestTemplate(requestTemplate),
+    maxWeight(MAX_WEIGHT),
+    nearStartThreshold(300),
+    preStartThreshold(7200),
+    requestsPerSecond(10),
+    tokens(1),
+    lastRefill(Clock::now()),
+    nextSubscriberId(1),
+    errors(0),
+    running(false) {
+    intervals[static_cast<int>(Priority::IN_PLAY)] = std::chrono::milliseconds(250);
+    intervals[static_cast<int>(Priority::NEAR_START)] = std::chrono::milliseconds(500);
+    intervals[static_cast<int>(Priority::PRE_START)] = std::chrono::milliseconds(5000);
+    intervals[static_cast<int>(Priority::DISTANT)] = std::chrono::milliseconds(60000);
+}
+
+MarketPoller::~MarketPoller() {
+    stop();
+}
+
+void MarketPoller::setInterval(Priority priority, const std::chrono::milliseconds& interval) {
+    std::lock_guard<std::mutex> lock(mutex);
+    intervals[static_cast<int>(priority)] = interval;
+}
+
+void MarketPoller::setNearStartThreshold(const std::chrono::seconds& threshold) {
+    std::lock_guard<std::mutex> lock(mutex);
+    nearStartThreshold = threshold;
+}
+
+void MarketPoller::setPreStartThreshold(const std::chrono::seconds& threshold) {
+    std::lock_guard<std::mutex> lock(mutex);
+    preStartThreshold = threshold;
+}
+
+void MarketPoller::setRequestsPerSecond(double requestsPerSecond) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->requestsPerSecond = requestsPerSecond;
+}
+
+void MarketPoller::setMaxWeight(unsigned maxWeight) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxWeight = maxWeight;
+}
+
+void MarketPoller::watch(const std::string& marketId, const std::tm& marketStartTime) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = markets.find(marketId);
+        if (it != markets.end()) {
+            it->second.marketStartTime = toStartTime(marketStartTime);
+            return;
+        }
+        WatchedMarket market;
+        market.marketStartTime = toStartTime(marketStartTime);
+        market.inplay = false;
+        market.pinned = false;
+        market.pinnedPriority = Priority::DISTANT;
+        market.priority = classify(market, time(NULL));
+        market.due = Clock::now();
+        market.refreshed = false;
+        market.pending = false;
+        markets[marketId] = market;
+        schedule.insert(ScheduleEntry(market.due, marketId));
+    }
+    condition.notify_all();
+}
+
+void MarketPoller::watch(const MarketCatalogue& marketCatalogue) {
+    watch(marketCatalogue.getMarketId(), marketCatalogue.getMarketStartTime());
+}
+
+void MarketPoller::unwatch(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    if (it != markets.end()) {
+        if (it->second.pending) {
+            pending.erase(std::remove(pending.begin(), pending.end(), marketId), pending.end());
+        } else {
+            schedule.erase(ScheduleEntry(it->second.due, marketId));
+        }
+        markets.erase(it);
+    }
+}
+
+void MarketPoller::setPriority(const std::string& marketId, Priority priority) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    if (it != markets.end()) {
+        it->second.pinned = true;
+        it->second.pinnedPriority = priority;
+        if (!it->second.pending) {
+            schedule.erase(ScheduleEntry(it->second.due, marketId));
+            reschedule(marketId, it->second, it->second.refreshed ? it->second.lastRefresh : Clock::now());
+        }
+    }
+}
+
+void MarketPoller::clearPriority(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    if (it != markets.end()) {
+        it->second.pinned = false;
+    }
+}
+
+bool MarketPoller::isWatched(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return markets.find(marketId) != markets.end();
+}
+
+unsigned MarketPoller::subscribe(const Subscriber& subscriber) {
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned subscriberId = nextSubscriberId++;
+    subscribers[subscriberId] = subscriber;
+    return subscriberId;
+}
+
+void MarketPoller::unsubscribe(unsigned subscriberId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscribers.erase(subscriberId);
+}
+
+MarketPoller::Priority MarketPoller::classify(const WatchedMarket& market, time_t now) const {
+    if (market.pinned) {
+        return market.pinnedPriority;
+    }
+    if (market.inplay) {
+        return Priority::IN_PLAY;
+    }
+    if (market.marketStartTime == 0) {
+        return Priority::PRE_START;
+    }
+    time_t secondsToStart = market.marketStartTime - now;
+    if (secondsToStart <= nearStartThreshold.count()) {
+        return Priority::NEAR_START;
+    }
+    if (secondsToStart <= preStartThreshold.count()) {
+        return Priority::PRE_START;
+    }
+    return Priority::DISTANT;
+}
+
+void MarketPoller::reschedule(const std::string& marketId, WatchedMarket& market, const Clock::time_point& from) {
+    market.priority = classify(market, time(NULL));
+    market.due = from + intervals[static_cast<int>(market.priority)];
+    schedule.insert(ScheduleEntry(market.due, marketId));
+}
+
+bool MarketPoller::takeToken(const Clock::time_point& now) {
+    std::chrono::duration<double> elapsed = now - lastRefill;
+    lastRefill = now;
+    tokens = std::min(std::max(1.0, requestsPerSecond), tokens + elapsed.count() * requestsPerSecond);
+    if (tokens >= 1) {
+        tokens -= 1;
+        return true;
+    }
+    return false;
+}
+
+MarketPoller::Clock::time_point MarketPoller::poll() {
+    std::vector<std::vector<std::string>> batches;
+    Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!schedule.empty() && schedule.begin()->first <= now) {
+            std::string marketId = schedule.begin()->second;
+            schedule.erase(schedule.begin());
+            markets[marketId].pending = true;
+            pending.push_back(marketId);
+        }
+
+        // highest priority first, then the longest waiting.
+        std::sort(pending.begin(), pending.end(), [this](const std::string& a, const std::string& b) {
+            const WatchedMarket& ma = markets[a];
+            const WatchedMarket& mb = markets[b];
+            if (ma.priority != mb.priority) {
+                return ma.priority < mb.priority;
+            }
+            return ma.due < mb.due;
+        });
+
+        unsigned weight = getMarketWeight(requestTemplate.getPriceProjection());
+        size_t batchSize = std::max(1u, maxWeight / weight);
+        size_t taken = 0;
+        while (taken < pending.size() && takeToken(now)) {
+            size_t end = std::min(pending.size(), taken + batchSize);
+            batches.push_back(std::vector<std::string>(pending.begin() + taken, pending.begin() + end));
+            taken = end;
+        }
+        pending.erase(pending.begin(), pending.begin() + taken);
+    }
+
+    for (const std::vector<std::string>& batch : batches) {
+        refresh(batch);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    now = Clock::now();
+    if (!pending.empty() && requestsPerSecond > 0) {
+        double wait = std::max(0.0, (1 - tokens) / requestsPerSecond);
+        return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait));
+    }
+    if (!schedule.empty()) {
+        return schedule.begin()->first;
+    }
+    return now + std::chrono::seconds(1);
+}
+
+void MarketPoller::refresh(const std::vector<std::string>& marketIds) {
+    ListMarketBookRequest request(requestTemplate);
+    request.setMarketIds(marketIds);
+    ListMarketBookResponse response;
+    bool success = false;
+    try {
+        response = exchangeApi.listMarketBook(request);
+        success = response.isSuccess();
+    } catch (const std::exception&) {
+        success = false;
+    }
+
+    std::vector<Subscriber> toNotify;
+    std::set<std::string> closed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Clock::time_point now = Clock::now();
+        if (!success) {
+            ++errors;
+        }
+        for (const MarketBook& marketBook : response.getMarketBooks()) {
+            auto it = markets.find(marketBook.getMarketId());
+            if (it == markets.end()) {
+                continue;
+            }
+            WatchedMarket& market = it->second;
+            Metrics& m = metrics[static_cast<int>(market.priority)];
+            if (market.refreshed) {
+                double interval = std::chrono::duration<double, std::milli>(now - market.lastRefresh).count();
+                ++m.refreshes;
+                m.totalIntervalMs += interval;
+                m.maxIntervalMs = std::max(m.maxIntervalMs, interval);
+            }
+            std::chrono::milliseconds target = intervals[static_cast<int>(market.priority)];
+            if (target.count() > 0 && now > market.due) {
+                m.conflated += static_cast<uint64_t>((now - market.due) / target);
+            }
+            market.lastRefresh = now;
+            market.refreshed = true;
+            market.inplay = marketBook.getInplay().isValid() && marketBook.getInplay().getValue();
+            if (marketBook.getStatus().isValid() && marketBook.getStatus() == MarketStatus(MarketStatus::CLOSED)) {
+                closed.insert(marketBook.getMarketId());
+            }
+        }
+        for (const std::string& marketId : marketIds) {
+            auto it = markets.find(marketId);
+            if (it == markets.end() || !it->second.pending) {
+                continue;
+            }
+            it->second.pending = false;
+            if (closed.count(marketId) > 0) {
+                markets.erase(it);
+            } else {
+                reschedule(marketId, it->second, now);
+            }
+        }
+        for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+            toNotify.push_back(it->second);
+        }
+    }
+
+    for (const MarketBook& marketBook : response.getMarketBooks()) {
+        for (const Subscriber& subscriber : toNotify) {
+            subscriber(marketBook);
+        }
+    }
+}
+
+void MarketPoller::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        thread = std::thread(&MarketPoller::run, this);
+    }
+}
+
+void MarketPoller::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void MarketPoller::run() {
+    while (true) {
+        Clock::time_point next = poll();
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!running) {
+            break;
+        }
+        condition.wait_until(lock, std::min(next, Clock::now() + std::chrono::seconds(1)));
+        if (!running) {
+            break;
+        }
+    }
+}
+
+MarketPoller::Metrics MarketPoller::getMetrics(Priority priority) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metrics result = metrics[static_cast<int>(priority)];
+    for (auto it = markets.begin(); it != markets.end(); ++it) {
+        if (it->second.priority == priority) {
+            ++result.markets;
+        }
+    }
+    return result;
+}
+
+uint64_t MarketPoller::getErrors() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errors;
+}
+
+void MarketPoller::resetMetrics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned i = 0; i < NUMBER_OF_PRIORITIES; ++i) {
+        metrics[i] = Metrics();
+    }
+    errors = 0;
+}
+
+unsigned MarketPoller::getMarketWeight(const PriceProjection& priceProjection) {
+    const std::set<PriceData>& priceData = priceProjection.getPriceData();
+    bool bestOffers = priceData.count(PriceData(PriceData::EX_BEST_OFFERS)) > 0;
+    bool allOffers = priceData.count(PriceData(PriceData::EX_ALL_OFFERS)) > 0;
+    bool traded = priceData.count(PriceData(PriceData::EX_TRADED)) > 0;
+
+    unsigned weight = 0;
+    if (priceData.count(PriceData(PriceData::SP_AVAILABLE)) > 0) {
+        weight += 3;
+    }
+    if (priceData.count(PriceData(PriceData::SP_TRADED)) > 0) {
+        weight += 7;
+    }
+    if (allOffers) {
+        weight += 17;
+    } else if (bestOffers) {
+        // the weight of best offers scales with the requested depth, the default depth being 3.
+        const Optional<int32_t>& depth = priceProjection.getExBestOffersOverrides().getBestPricesDepth();
+        unsigned levels = depth.isValid() && depth.getValue() > 3 ? depth.getValue() : 3;
+        weight += 5 * static_cast<unsigned>(std::ceil(levels / 3.0));
+    }
+    if (traded) {
+        weight += 17;
+        if (allOffers || bestOffers) {
+            // combined projections are weighted slightly less than the sum
+            weight -= 2;
+        }
+    }
+    return weight > 0 ? weight : 2;
+}
+
+}
+}
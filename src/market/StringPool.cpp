@@ -0,0 +1,25 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/market/StringPool.h"
+
+namespace greentop {
+namespace market {
+
+StringPool::StringPool() {
+}
+
+const std::string* StringPool::intern(const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // elements of an unordered_set don't move when it rehashes, so the pointer stays valid.
+    return &*strings.insert(value).first;
+}
+
+size_t StringPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return strings.size();
+}
+
+}
+}
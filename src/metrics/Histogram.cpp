@@ -0,0 +1,165 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "greentop/metrics/Histogram.h"
+
+namespace greentop {
+namespace metrics {
+
+namespace {
+
+unsigned getLog2(uint64_t value) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    unsigned log2 = 0;
+    while (value >>= 1) {
+        ++log2;
+    }
+    return log2;
+#endif
+}
+
+}
+
+const unsigned Histogram::SUB_BUCKET_BITS;
+const uint64_t Histogram::MAX_VALUE;
+const size_t Histogram::BUCKETS;
+
+Histogram::Histogram() {
+    clear();
+}
+
+Histogram::Histogram(const Histogram& other) {
+    clear();
+    add(other);
+}
+
+Histogram& Histogram::operator=(const Histogram& other) {
+    if (this != &other) {
+        clear();
+        add(other);
+    }
+    return *this;
+}
+
+void Histogram::record(uint64_t value) {
+    if (value > MAX_VALUE) {
+        value = MAX_VALUE;
+    }
+    increase(counts[getIndex(value)], 1);
+    increase(count, 1);
+    increase(sum, value);
+    if (value > max.load(std::memory_order_relaxed)) {
+        max.store(value, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::add(const Histogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        uint64_t n = other.counts[i].load(std::memory_order_relaxed);
+        if (n > 0) {
+            increase(counts[i], n);
+        }
+    }
+    increase(count, other.count.load(std::memory_order_relaxed));
+    increase(sum, other.sum.load(std::memory_order_relaxed));
+    uint64_t otherMax = other.max.load(std::memory_order_relaxed);
+    if (otherMax > max.load(std::memory_order_relaxed)) {
+        max.store(otherMax, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::clear() {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::getSum() const {
+    return sum.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+double Histogram::getMean() const {
+    uint64_t n = getCount();
+    return n > 0 ? static_cast<double>(getSum()) / n : 0;
+}
+
+uint64_t Histogram::getValueAtPercentile(double percentile) const {
+    // the buckets may be counted a little ahead of count while a value is being recorded, so total them here
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        total += counts[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(percentile / 100 * total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t value = getHighestValue(i);
+            uint64_t maxValue = getMax();
+            return value < maxValue ? value : maxValue;
+        }
+    }
+    return getMax();
+}
+
+void Histogram::increase(std::atomic<uint64_t>& value, uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+size_t Histogram::getIndex(uint64_t value) {
+    if (value < (uint64_t(2) << SUB_BUCKET_BITS)) {
+        return static_cast<size_t>(value);
+    }
+    unsigned shift = getLog2(value) - SUB_BUCKET_BITS;
+    return (static_cast<size_t>(shift) << SUB_BUCKET_BITS) + static_cast<size_t>(value >> shift);
+}
+
+uint64_t Histogram::getLowestValue(size_t index) {
+    if (index < (size_t(2) << SUB_BUCKET_BITS)) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index >> SUB_BUCKET_BITS) - 1;
+    return static_cast<uint64_t>(index - (static_cast<size_t>(shift) << SUB_BUCKET_BITS)) << shift;
+}
+
+uint64_t Histogram::getHighestValue(size_t index) {
+    if (index < (size_t(2) << SUB_BUCKET_BITS)) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index >> SUB_BUCKET_BITS) - 1;
+    return getLowestValue(index) + (uint64_t(1) << shift) - 1;
+}
+
+}
+}
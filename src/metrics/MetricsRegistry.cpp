@@ -0,0 +1,221 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#if defined _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "greentop/metrics/MetricsRegistry.h"
+
+namespace greentop {
+namespace metrics {
+
+namespace {
+
+uint64_t getNanoseconds(const std::chrono::nanoseconds& duration) {
+    return duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+}
+
+std::string escape(const std::string& labelValue) {
+    std::string escaped;
+    for (char c : labelValue) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void writeHeader(std::ostream& stream, const std::string& name, const std::string& help, const char* type) {
+    stream << "# HELP " << name << " " << help << "\n";
+    stream << "# TYPE " << name << " " << type << "\n";
+}
+
+}
+
+const double MetricsRegistry::QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+std::atomic<uint64_t> MetricsRegistry::nextId(1);
+
+MetricsRegistry::Operation::Operation() : calls(0), errors(0), bytesSent(0), bytesReceived(0) {
+}
+
+MetricsRegistry::Counters::Counters() : calls(0), errors(0), bytesSent(0), bytesReceived(0) {
+}
+
+MetricsRegistry::MetricsRegistry() : id(nextId++) {
+}
+
+MetricsRegistry::Shard& MetricsRegistry::getShard() {
+    // the shard this thread last recorded to, and its shards of every registry it has recorded to
+    static thread_local uint64_t lastId = 0;
+    static thread_local Shard* lastShard = NULL;
+    static thread_local std::unordered_map<uint64_t, Shard*> threadShards;
+
+    if (lastId != id) {
+        auto it = threadShards.find(id);
+        if (it != threadShards.end()) {
+            lastShard = it->second;
+        } else {
+            std::lock_guard<std::mutex> lock(mutex);
+            shards.push_back(std::unique_ptr<Shard>(new Shard()));
+            lastShard = shards.back().get();
+            threadShards[id] = lastShard;
+        }
+        lastId = id;
+    }
+    return *lastShard;
+}
+
+void MetricsRegistry::record(const RequestTiming& timing) {
+    Shard& shard = getShard();
+
+    Counters* counters;
+    auto it = shard.operations.find(timing.operation);
+    if (it != shard.operations.end()) {
+        counters = it->second.get();
+    } else {
+        std::unique_ptr<Counters> added(new Counters());
+        counters = added.get();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.operations[timing.operation] = std::move(added);
+    }
+
+    Histogram::increase(counters->calls, 1);
+    Histogram::increase(counters->bytesSent, timing.bytesSent);
+    Histogram::increase(counters->bytesReceived, timing.bytesReceived);
+    counters->total.record(getNanoseconds(timing.total));
+    counters->network.record(getNanoseconds(timing.transfer));
+    if (timing.curlCode == CURLE_OK) {
+        counters->parse.record(getNanoseconds(timing.parse));
+    }
+
+    if (timing.curlCode != CURLE_OK || !timing.success) {
+        Histogram::increase(counters->errors, 1);
+        std::string fault = timing.curlCode != CURLE_OK ? "curl:" + std::to_string(timing.curlCode) :
+            timing.faultCode;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++counters->faults[fault];
+    }
+}
+
+std::map<std::string, MetricsRegistry::Operation> MetricsRegistry::getSnapshot() const {
+    std::map<std::string, Operation> snapshot;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::unique_ptr<Shard>& shard : shards) {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        for (auto it = shard->operations.begin(); it != shard->operations.end(); ++it) {
+            const Counters& counters = *it->second;
+            Operation& operation = snapshot[it->first];
+            operation.calls += counters.calls.load(std::memory_order_relaxed);
+            operation.errors += counters.errors.load(std::memory_order_relaxed);
+            operation.bytesSent += counters.bytesSent.load(std::memory_order_relaxed);
+            operation.bytesReceived += counters.bytesReceived.load(std::memory_order_relaxed);
+            operation.total.add(counters.total);
+            operation.network.add(counters.network);
+            operation.parse.add(counters.parse);
+            for (auto fault = counters.faults.begin(); fault != counters.faults.end(); ++fault) {
+                operation.faults[fault->first] += fault->second;
+            }
+        }
+    }
+    return snapshot;
+}
+
+void MetricsRegistry::writeSummary(std::ostream& stream, const std::string& name, const std::string& help,
+        const std::map<std::string, Operation>& operations, Histogram Operation::* histogram) {
+    writeHeader(stream, name, help, "summary");
+    for (auto it = operations.begin(); it != operations.end(); ++it) {
+        const Histogram& values = it->second.*histogram;
+        std::string operation = escape(it->first);
+        for (double quantile : QUANTILES) {
+            stream << name << "{operation=\"" << operation << "\",quantile=\"" << quantile << "\"} " <<
+                values.getValueAtPercentile(quantile * 100) / 1e9 << "\n";
+        }
+        stream << name << "_sum{operation=\"" << operation << "\"} " << values.getSum() / 1e9 << "\n";
+        stream << name << "_count{operation=\"" << operation << "\"} " << values.getCount() << "\n";
+    }
+}
+
+void MetricsRegistry::writePrometheus(std::ostream& stream) const {
+    std::map<std::string, Operation> operations = getSnapshot();
+
+    std::ostringstream text;
+    text.precision(9);
+
+    writeHeader(text, "greentop_requests_total", "Requests made.", "counter");
+    for (auto it = operations.begin(); it != operations.end(); ++it) {
+        text << "greentop_requests_total{operation=\"" << escape(it->first) << "\"} " << it->second.calls << "\n";
+    }
+
+    writeHeader(text, "greentop_request_errors_total", "Requests that failed, by fault code.", "counter");
+    for (auto it = operations.begin(); it != operations.end(); ++it) {
+        std::string operation = escape(it->first);
+        for (auto fault = it->second.faults.begin(); fault != it->second.faults.end(); ++fault) {
+            text << "greentop_request_errors_total{operation=\"" << operation << "\",fault=\"" <<
+                escape(fault->first) << "\"} " << fault->second << "\n";
+        }
+    }
+
+    writeHeader(text, "greentop_request_sent_bytes_total", "Bytes of request bodies sent.", "counter");
+    for (auto it = operations.begin(); it != operations.end(); ++it) {
+        text << "greentop_request_sent_bytes_total{operation=\"" << escape(it->first) << "\"} " <<
+            it->second.bytesSent << "\n";
+    }
+
+    writeHeader(text, "greentop_request_received_bytes_total", "Bytes of response bodies received.", "counter");
+    for (auto it = operations.begin(); it != operations.end(); ++it) {
+        text << "greentop_request_received_bytes_total{operation=\"" << escape(it->first) << "\"} " <<
+            it->second.bytesReceived << "\n";
+    }
+
+    writeSummary(text, "greentop_request_duration_seconds", "Time from making a request to parsing its response.",
+        operations, &Operation::total);
+    writeSummary(text, "greentop_request_network_seconds", "Time spent transferring requests and responses.",
+        operations, &Operation::network);
+    writeSummary(text, "greentop_request_parse_seconds", "Time spent parsing responses.",
+        operations, &Operation::parse);
+
+    stream << text.str();
+}
+
+std::string MetricsRegistry::getPrometheusText() const {
+    std::ostringstream text;
+    writePrometheus(text);
+    return text.str();
+}
+
+void MetricsRegistry::writePrometheus(const std::string& fileName) const {
+    std::string tempFileName = fileName + ".tmp";
+    {
+        std::ofstream file(tempFileName.c_str(), std::ios::trunc);
+        writePrometheus(file);
+        if (!file) {
+            throw std::runtime_error("cannot write " + tempFileName);
+        }
+    }
+#ifdef _WIN32
+    // rename() won't replace a file on Windows
+    bool renamed = MoveFileExA(tempFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+#endif
+    if (!renamed) {
+        throw std::runtime_error("cannot rename " + tempFileName + " to " + fileName);
+    }
+}
+
+}
+}
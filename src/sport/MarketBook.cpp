@@ -45,6 +45,7 @@ MarketBook::MarketBook(const std::string& marketId,
     version(version),
     runners(runners),
     keyLineDescription(keyLineDescription) {
+    runnerIndex.build(this->runners);
 }
 
 void MarketBook::fromJson(const Json::Value& json) {
@@ -97,11 +98,15 @@ void MarketBook::fromJson(const Json::Value& json) {
         version = json["version"].asInt64();
     }
     if (json.isMember("runners")) {
-        for (unsigned i = 0; i < json["runners"].size(); ++i) {
-            Runner runner;
-            runner.fromJson(json["runners"][i]);
-            runners.push_back(runner);
+        // replace rather than append to any runners, so that an object can be reused to parse another response.
+        const Json::Value& runnersJson = json["runners"];
+        runners.clear();
+        runners.reserve(runnersJson.size());
+        for (unsigned i = 0; i < runnersJson.size(); ++i) {
+            runners.push_back(Runner());
+            runners.back().fromJson(runnersJson[i]);
         }
+        runnerIndex.build(runners);
     }
     if (json.isMember("keyLineDescription")) {
         keyLineDescription.fromJson(json["keyLineDescription"]);
@@ -292,6 +297,12 @@ const std::vector<Runner>& MarketBook::getRunners() const {
 }
 void MarketBook::setRunners(const std::vector<Runner>& runners) {
     this->runners = runners;
+    runnerIndex.build(this->runners);
+}
+
+const Runner* MarketBook::getRunner(int64_t selectionId, double handicap) const {
+    int32_t position = runnerIndex.find(selectionId, handicap);
+    return position == RunnerIndex::NOT_FOUND ? NULL : &runners[position];
 }
 
 const KeyLineDescription& MarketBook::getKeyLineDescription() const {
@@ -27,6 +27,7 @@ MarketCatalogue::MarketCatalogue(const std::string& marketId,
     eventType(eventType),
     competition(competition),
     event(event) {
+    runnerIndex.build(this->runners);
 }
 
 void MarketCatalogue::fromJson(const Json::Value& json) {
@@ -46,11 +47,15 @@ void MarketCatalogue::fromJson(const Json::Value& json) {
         totalMatched = json["totalMatched"].asDouble();
     }
     if (json.isMember("runners")) {
-        for (unsigned i = 0; i < json["runners"].size(); ++i) {
-            RunnerCatalog runner;
-            runner.fromJson(json["runners"][i]);
-            runners.push_back(runner);
+        // replace rather than append to any runners, so that an object can be reused to parse another response.
+        const Json::Value& runnersJson = json["runners"];
+        runners.clear();
+        runners.reserve(runnersJson.size());
+        for (unsigned i = 0; i < runnersJson.size(); ++i) {
+            runners.push_back(RunnerCatalog());
+            runners.back().fromJson(runnersJson[i]);
         }
+        runnerIndex.build(runners);
     }
     if (json.isMember("eventType")) {
         eventType.fromJson(json["eventType"]);
@@ -143,6 +148,12 @@ const std::vector<RunnerCatalog>& MarketCatalogue::getRunners() const {
 }
 void MarketCatalogue::setRunners(const std::vector<RunnerCatalog>& runners) {
     this->runners = runners;
+    runnerIndex.build(this->runners);
+}
+
+const RunnerCatalog* MarketCatalogue::getRunner(int64_t selectionId, double handicap) const {
+    int32_t position = runnerIndex.find(selectionId, handicap);
+    return position == RunnerIndex::NOT_FOUND ? NULL : &runners[position];
 }
 
 const EventType& MarketCatalogue::getEventType() const {
@@ -0,0 +1,58 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/sport/RunnerIndex.h"
+
+namespace greentop {
+
+const int32_t RunnerIndex::NOT_FOUND;
+
+RunnerIndex::RunnerIndex() : mask(0), count(0) {
+}
+
+void RunnerIndex::clear() {
+    slots.clear();
+    mask = 0;
+    count = 0;
+}
+
+size_t RunnerIndex::size() const {
+    return count;
+}
+
+void RunnerIndex::reset(size_t size) {
+    count = 0;
+    if (size == 0) {
+        slots.clear();
+        mask = 0;
+        return;
+    }
+    // keep the table at most half full so that probe sequences stay short.
+    size_t capacity = 8;
+    while (capacity < size * 2) {
+        capacity *= 2;
+    }
+    Slot empty = {0, 0, NOT_FOUND};
+    slots.assign(capacity, empty);
+    mask = capacity - 1;
+}
+
+void RunnerIndex::insert(int64_t selectionId, double handicap, int32_t position) {
+    handicap += 0.0;
+    for (size_t i = hash(selectionId, handicap) & mask; ; i = (i + 1) & mask) {
+        Slot& slot = slots[i];
+        if (slot.position == NOT_FOUND) {
+            slot.selectionId = selectionId;
+            slot.handicap = handicap;
+            slot.position = position;
+            ++count;
+            return;
+        }
+        if (slot.selectionId == selectionId && slot.handicap == handicap) {
+            return;
+        }
+    }
+}
+
+}
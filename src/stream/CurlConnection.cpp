@@ -0,0 +1,120 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+#if defined _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+#include <stdexcept>
+
+#include "greentop/stream/CurlConnection.h"
+
+namespace greentop {
+namespace stream {
+
+CurlConnection::CurlConnection() : handle(NULL, curl_easy_cleanup) {
+}
+
+void CurlConnection::open(const std::string& url) {
+    handle = CurlHandle(curl_easy_init(), curl_easy_cleanup);
+    if (!handle.get()) {
+        throw std::runtime_error("curl_easy_init failed");
+    }
+    curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle.get(), CURLOPT_CONNECT_ONLY, 1L);
+    curl_easy_setopt(handle.get(), CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle.get(), CURLOPT_CONNECTTIMEOUT, 15L);
+    curl_easy_setopt(handle.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle.get(), CURLOPT_TCP_NODELAY, 1L);
+
+    CURLcode result = curl_easy_perform(handle.get());
+    if (result != CURLE_OK) {
+        handle.reset();
+        throw std::runtime_error(std::string("stream connection failed: ") + curl_easy_strerror(result));
+    }
+}
+
+void CurlConnection::close() {
+    handle.reset();
+}
+
+bool CurlConnection::isOpen() const {
+    return handle.get() != NULL;
+}
+
+void CurlConnection::send(const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        if (!handle.get()) {
+            throw std::runtime_error("stream connection is closed");
+        }
+        size_t sent = 0;
+        CURLcode result = curl_easy_send(handle.get(), data.data() + offset, data.size() - offset, &sent);
+        if (result == CURLE_AGAIN) {
+            wait(false, 1000);
+        } else if (result != CURLE_OK) {
+            handle.reset();
+            throw std::runtime_error(std::string("stream send failed: ") + curl_easy_strerror(result));
+        }
+        offset += sent;
+    }
+}
+
+size_t CurlConnection::receive(char* buffer, size_t length, int timeoutMs) {
+    if (!handle.get()) {
+        throw std::runtime_error("stream connection is closed");
+    }
+    // TLS may already have decrypted data buffered, so try before waiting on the socket.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        size_t received = 0;
+        CURLcode result = curl_easy_recv(handle.get(), buffer, length, &received);
+        if (result == CURLE_OK) {
+            if (received == 0) {
+                handle.reset();
+                throw std::runtime_error("stream connection closed by server");
+            }
+            return received;
+        }
+        if (result != CURLE_AGAIN) {
+            handle.reset();
+            throw std::runtime_error(std::string("stream receive failed: ") + curl_easy_strerror(result));
+        }
+        if (attempt == 0 && !wait(true, timeoutMs)) {
+            break;
+        }
+    }
+    return 0;
+}
+
+bool CurlConnection::wait(bool forRead, int timeoutMs) const {
+    curl_socket_t socket = CURL_SOCKET_BAD;
+    curl_easy_getinfo(handle.get(), CURLINFO_ACTIVESOCKET, &socket);
+    if (socket == CURL_SOCKET_BAD) {
+        return false;
+    }
+
+    // poll, unlike select, works whatever the socket's number
+#if defined _WIN32
+    WSAPOLLFD fd;
+#else
+    struct pollfd fd;
+#endif
+    fd.fd = socket;
+    fd.events = forRead ? POLLIN : POLLOUT;
+    fd.revents = 0;
+
+#if defined _WIN32
+    int result = WSAPoll(&fd, 1, timeoutMs);
+#else
+    int result = poll(&fd, 1, timeoutMs);
+#endif
+    return result > 0;
+}
+
+CurlConnection::~CurlConnection() {
+}
+
+}
+}
@@ -0,0 +1,358 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+#include "greentop/Time.h"
+#include "greentop/stream/MarketCache.h"
+
+namespace greentop {
+namespace stream {
+
+namespace {
+
+void updatePriceLadder(std::map<double, double>& ladder, const Json::Value& changes) {
+    for (unsigned i = 0; i < changes.size(); ++i) {
+        double price = changes[i][0].asDouble();
+        double size = changes[i][1].asDouble();
+        if (size == 0) {
+            ladder.erase(price);
+        } else {
+            ladder[price] = size;
+        }
+    }
+}
+
+void updateLevelLadder(std::map<int, std::pair<double, double>>& ladder, const Json::Value& changes) {
+    for (unsigned i = 0; i < changes.size(); ++i) {
+        int level = changes[i][0].asInt();
+        double price = changes[i][1].asDouble();
+        double size = changes[i][2].asDouble();
+        if (size == 0) {
+            ladder.erase(level);
+        } else {
+            ladder[level] = std::make_pair(price, size);
+        }
+    }
+}
+
+std::vector<PriceSize> fromLevels(const std::map<int, std::pair<double, double>>& ladder) {
+    std::vector<PriceSize> priceSizes;
+    priceSizes.reserve(ladder.size());
+    for (auto it = ladder.begin(); it != ladder.end(); ++it) {
+        priceSizes.push_back(PriceSize(it->second.first, it->second.second));
+    }
+    return priceSizes;
+}
+
+std::vector<PriceSize> fromPricesAscending(const std::map<double, double>& ladder) {
+    std::vector<PriceSize> priceSizes;
+    priceSizes.reserve(ladder.size());
+    for (auto it = ladder.begin(); it != ladder.end(); ++it) {
+        priceSizes.push_back(PriceSize(it->first, it->second));
+    }
+    return priceSizes;
+}
+
+std::vector<PriceSize> fromPricesDescending(const std::map<double, double>& ladder) {
+    std::vector<PriceSize> priceSizes;
+    priceSizes.reserve(ladder.size());
+    for (auto it = ladder.rbegin(); it != ladder.rend(); ++it) {
+        priceSizes.push_back(PriceSize(it->first, it->second));
+    }
+    return priceSizes;
+}
+
+void setOptional(Optional<double>& value, const Json::Value& json, const char* key) {
+    if (json.isMember(key)) {
+        value = json[key].asDouble();
+    }
+}
+
+}
+
+MarketCache::MarketCache() {
+}
+
+std::vector<std::string> MarketCache::applyMarketChangeMessage(const Json::Value& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = closedMarketIds.begin(); it != closedMarketIds.end(); ++it) {
+            markets.erase(*it);
+        }
+        closedMarketIds.clear();
+    }
+    std::vector<std::string> marketIds;
+    int64_t publishTime = message["pt"].asInt64();
+    const Json::Value& marketChanges = message["mc"];
+    for (unsigned i = 0; i < marketChanges.size(); ++i) {
+        applyMarketChange(marketChanges[i], publishTime);
+        marketIds.push_back(marketChanges[i]["id"].asString());
+    }
+    return marketIds;
+}
+
+void MarketCache::applyMarketChange(const Json::Value& marketChange, int64_t publishTime) {
+    std::string marketId = marketChange["id"].asString();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    MarketState& market = markets[marketId];
+
+    if (marketChange.isMember("img") && marketChange["img"].asBool()) {
+        // an image replaces everything except a definition that isn't part of the image
+        Json::Value definition = market.definition;
+        market = MarketState();
+        market.definition = definition;
+    }
+    market.publishTime = publishTime;
+    if (marketChange.isMember("marketDefinition")) {
+        market.definition = marketChange["marketDefinition"];
+        if (market.definition["status"].asString() == MarketStatus::CLOSED) {
+            closedMarketIds.push_back(marketId);
+        }
+    }
+    if (marketChange.isMember("tv")) {
+        market.totalMatched = marketChange["tv"].asDouble();
+    }
+
+    const Json::Value& runnerChanges = marketChange["rc"];
+    for (unsigned i = 0; i < runnerChanges.size(); ++i) {
+        const Json::Value& runnerChange = runnerChanges[i];
+        RunnerKey key(runnerChange["id"].asInt64(), runnerChange.isMember("hc") ? runnerChange["hc"].asDouble() : 0);
+        auto it = market.runners.find(key);
+        if (it == market.runners.end()) {
+            RunnerState runner;
+            runner.selectionId = key.first;
+            runner.handicap = key.second;
+            it = market.runners.insert(std::make_pair(key, runner)).first;
+        }
+        applyRunnerChange(runnerChange, it->second);
+    }
+}
+
+void MarketCache::applyRunnerChange(const Json::Value& runnerChange, RunnerState& runner) {
+    if (runnerChange.isMember("atb")) {
+        updatePriceLadder(runner.availableToBack, runnerChange["atb"]);
+    }
+    if (runnerChange.isMember("atl")) {
+        updatePriceLadder(runner.availableToLay, runnerChange["atl"]);
+    }
+    if (runnerChange.isMember("trd")) {
+        updatePriceLadder(runner.traded, runnerChange["trd"]);
+    }
+    if (runnerChange.isMember("batb")) {
+        updateLevelLadder(runner.bestAvailableToBack, runnerChange["batb"]);
+    }
+    if (runnerChange.isMember("batl")) {
+        updateLevelLadder(runner.bestAvailableToLay, runnerChange["batl"]);
+    }
+    if (runnerChange.isMember("bdatb")) {
+        updateLevelLadder(runner.bestDisplayAvailableToBack, runnerChange["bdatb"]);
+    }
+    if (runnerChange.isMember("bdatl")) {
+        updateLevelLadder(runner.bestDisplayAvailableToLay, runnerChange["bdatl"]);
+    }
+    if (runnerChange.isMember("spb")) {
+        updatePriceLadder(runner.spBackStakeTaken, runnerChange["spb"]);
+    }
+    if (runnerChange.isMember("spl")) {
+        updatePriceLadder(runner.spLayLiabilityTaken, runnerChange["spl"]);
+    }
+    setOptional(runner.lastPriceTraded, runnerChange, "ltp");
+    setOptional(runner.totalMatched, runnerChange, "tv");
+    setOptional(runner.spNearPrice, runnerChange, "spn");
+    setOptional(runner.spFarPrice, runnerChange, "spf");
+}
+
+bool MarketCache::hasMarket(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return markets.find(marketId) != markets.end();
+}
+
+MarketBook MarketCache::getMarketBook(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    if (it == markets.end()) {
+        return MarketBook();
+    }
+    return toMarketBook(marketId, it->second);
+}
+
+MarketBook MarketCache::toMarketBook(const std::string& marketId, const MarketState& market) {
+    MarketBook marketBook;
+    marketBook.setMarketId(marketId);
+    marketBook.setIsMarketDataDelayed(false);
+
+    const Json::Value& definition = market.definition;
+    if (definition.isMember("status")) {
+        try {
+            marketBook.setStatus(MarketStatus(definition["status"].asString()));
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    if (definition.isMember("betDelay")) {
+        marketBook.setBetDelay(definition["betDelay"].asInt());
+    }
+    if (definition.isMember("bspReconciled")) {
+        marketBook.setBspReconciled(definition["bspReconciled"].asBool());
+    }
+    if (definition.isMember("complete")) {
+        marketBook.setComplete(definition["complete"].asBool());
+    }
+    if (definition.isMember("inPlay")) {
+        marketBook.setInplay(definition["inPlay"].asBool());
+    }
+    if (definition.isMember("numberOfWinners")) {
+        marketBook.setNumberOfWinners(definition["numberOfWinners"].asInt());
+    }
+    if (definition.isMember("crossMatching")) {
+        marketBook.setCrossMatching(definition["crossMatching"].asBool());
+    }
+    if (definition.isMember("runnersVoidable")) {
+        marketBook.setRunnersVoidable(definition["runnersVoidable"].asBool());
+    }
+    if (definition.isMember("version")) {
+        marketBook.setVersion(definition["version"].asInt64());
+    }
+    marketBook.setTotalMatched(market.totalMatched);
+
+    // runners in the order of the definition, followed by any that only appear in price changes.
+    std::vector<std::pair<int, const Json::Value*>> definedRunners;
+    const Json::Value& runnerDefinitions = definition["runners"];
+    for (unsigned i = 0; i < runnerDefinitions.size(); ++i) {
+        int sortPriority = runnerDefinitions[i].isMember("sortPriority") ?
+            runnerDefinitions[i]["sortPriority"].asInt() : static_cast<int>(i);
+        definedRunners.push_back(std::make_pair(sortPriority, &runnerDefinitions[i]));
+    }
+    std::stable_sort(definedRunners.begin(), definedRunners.end(),
+        [](const std::pair<int, const Json::Value*>& a, const std::pair<int, const Json::Value*>& b) {
+            return a.first < b.first;
+        });
+
+    std::vector<Runner> runners;
+    runners.reserve(std::max(definedRunners.size(), market.runners.size()));
+    std::set<RunnerKey> seen;
+    int numberOfActiveRunners = 0;
+    static const RunnerState EMPTY_RUNNER = RunnerState();
+
+    auto addRunner = [&](const RunnerKey& key, const Json::Value* runnerDefinition) {
+        // built in place, runners are expensive to copy
+        runners.push_back(Runner());
+        Runner& runner = runners.back();
+        runner.setSelectionId(key.first);
+        runner.setHandicap(key.second);
+
+        if (runnerDefinition) {
+            if (runnerDefinition->isMember("status")) {
+                try {
+                    runner.setStatus(RunnerStatus((*runnerDefinition)["status"].asString()));
+                } catch (const std::invalid_argument&) {
+                }
+                if ((*runnerDefinition)["status"].asString() == RunnerStatus::ACTIVE) {
+                    ++numberOfActiveRunners;
+                }
+            }
+            if (runnerDefinition->isMember("adjustmentFactor")) {
+                runner.setAdjustmentFactor((*runnerDefinition)["adjustmentFactor"].asDouble());
+            }
+            if (runnerDefinition->isMember("removalDate")) {
+                std::tm removalDate = std::tm();
+                strptime((*runnerDefinition)["removalDate"].asString().c_str(), "%Y-%m-%dT%H:%M:%S", &removalDate);
+                runner.setRemovalDate(removalDate);
+            }
+        }
+
+        auto stateIt = market.runners.find(key);
+        const RunnerState& state = stateIt != market.runners.end() ? stateIt->second : EMPTY_RUNNER;
+
+        runner.setLastPriceTraded(state.lastPriceTraded);
+        runner.setTotalMatched(state.totalMatched);
+
+        StartingPrices sp(state.spNearPrice, state.spFarPrice);
+        if (runnerDefinition && runnerDefinition->isMember("bsp")) {
+            sp.setActualSP((*runnerDefinition)["bsp"].asDouble());
+        }
+        sp.setBackStakeTaken(fromPricesAscending(state.spBackStakeTaken));
+        sp.setLayLiabilityTaken(fromPricesAscending(state.spLayLiabilityTaken));
+        runner.setSp(sp);
+
+        std::vector<PriceSize> back;
+        std::vector<PriceSize> lay;
+        if (!state.bestDisplayAvailableToBack.empty() || !state.bestDisplayAvailableToLay.empty()) {
+            back = fromLevels(state.bestDisplayAvailableToBack);
+            lay = fromLevels(state.bestDisplayAvailableToLay);
+        } else if (!state.bestAvailableToBack.empty() || !state.bestAvailableToLay.empty()) {
+            back = fromLevels(state.bestAvailableToBack);
+            lay = fromLevels(state.bestAvailableToLay);
+        } else {
+            back = fromPricesDescending(state.availableToBack);
+            lay = fromPricesAscending(state.availableToLay);
+        }
+        runner.setEx(ExchangePrices(back, lay, fromPricesAscending(state.traded)));
+
+        seen.insert(key);
+    };
+
+    for (const std::pair<int, const Json::Value*>& definedRunner : definedRunners) {
+        const Json::Value& runnerDefinition = *definedRunner.second;
+        RunnerKey key(runnerDefinition["id"].asInt64(),
+            runnerDefinition.isMember("hc") ? runnerDefinition["hc"].asDouble() : 0);
+        addRunner(key, &runnerDefinition);
+    }
+    for (auto it = market.runners.begin(); it != market.runners.end(); ++it) {
+        if (seen.count(it->first) == 0) {
+            addRunner(it->first, NULL);
+        }
+    }
+
+    marketBook.setNumberOfRunners(static_cast<int32_t>(runners.size()));
+    if (!definedRunners.empty()) {
+        marketBook.setNumberOfActiveRunners(numberOfActiveRunners);
+    }
+    marketBook.setRunners(runners);
+    return marketBook;
+}
+
+std::vector<std::string> MarketCache::getMarketIds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> marketIds;
+    marketIds.reserve(markets.size());
+    for (auto it = markets.begin(); it != markets.end(); ++it) {
+        marketIds.push_back(it->first);
+    }
+    return marketIds;
+}
+
+int64_t MarketCache::getPublishTime(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    return it != markets.end() ? it->second.publishTime : 0;
+}
+
+Json::Value MarketCache::getMarketDefinition(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    return it != markets.end() ? it->second.definition : Json::Value();
+}
+
+void MarketCache::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    markets.erase(marketId);
+}
+
+void MarketCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    markets.clear();
+    closedMarketIds.clear();
+}
+
+size_t MarketCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return markets.size();
+}
+
+}
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/stream/MarketDataFilter.h"
+
+namespace greentop {
+namespace stream {
+
+MarketDataFilter::MarketDataFilter(const std::set<std::string>& fields,
+    const Optional<int32_t>& ladderLevels) :
+    fields(fields),
+    ladderLevels(ladderLevels) {
+}
+
+void MarketDataFilter::fromJson(const Json::Value& json) {
+    if (json.isMember("fields")) {
+        for (unsigned i = 0; i < json["fields"].size(); ++i) {
+            fields.insert(json["fields"][i].asString());
+        }
+    }
+    if (json.isMember("ladderLevels")) {
+        ladderLevels = json["ladderLevels"].asInt();
+    }
+}
+
+Json::Value MarketDataFilter::toJson() const {
+    Json::Value json(Json::objectValue);
+    if (fields.size() > 0) {
+        for (std::set<std::string>::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+            json["fields"].append(*it);
+        }
+    }
+    if (ladderLevels.isValid()) {
+        json["ladderLevels"] = ladderLevels.toJson();
+    }
+    return json;
+}
+
+bool MarketDataFilter::isValid() const {
+    return true;
+}
+
+const std::set<std::string>& MarketDataFilter::getFields() const {
+    return fields;
+}
+void MarketDataFilter::setFields(const std::set<std::string>& fields) {
+    this->fields = fields;
+}
+
+const Optional<int32_t>& MarketDataFilter::getLadderLevels() const {
+    return ladderLevels;
+}
+void MarketDataFilter::setLadderLevels(const Optional<int32_t>& ladderLevels) {
+    this->ladderLevels = ladderLevels;
+}
+
+}
+}
@@ -0,0 +1,55 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/stream/MarketStream.h"
+
+namespace greentop {
+namespace stream {
+
+MarketStream::MarketStream(const ExchangeApi& exchangeApi, const MarketFilter& marketFilter,
+    const MarketDataFilter& marketDataFilter, std::unique_ptr<IConnection>&& connection) :
+    StreamClient(exchangeApi, std::move(connection)),
+    marketFilter(marketFilter),
+    marketDataFilter(marketDataFilter) {
+}
+
+MarketStream::MarketStream(const std::string& applicationKey, const std::string& session,
+    const MarketFilter& marketFilter, const MarketDataFilter& marketDataFilter,
+    std::unique_ptr<IConnection>&& connection) :
+    StreamClient(applicationKey, session, std::move(connection)),
+    marketFilter(marketFilter),
+    marketDataFilter(marketDataFilter) {
+}
+
+MarketStream::~MarketStream() {
+    stop();
+}
+
+const MarketCache& MarketStream::getCache() const {
+    return cache;
+}
+
+Json::Value MarketStream::buildSubscription() const {
+    Json::Value subscription(Json::objectValue);
+    subscription["op"] = "marketSubscription";
+    subscription["marketFilter"] = marketFilter.toJson();
+    subscription["marketDataFilter"] = marketDataFilter.toJson();
+    subscription["segmentationEnabled"] = true;
+    return subscription;
+}
+
+std::string MarketStream::getChangeOp() const {
+    return "mcm";
+}
+
+std::vector<std::string> MarketStream::applyChange(const Json::Value& message) {
+    return cache.applyMarketChangeMessage(message);
+}
+
+void MarketStream::clearCache() {
+    cache.clear();
+}
+
+}
+}
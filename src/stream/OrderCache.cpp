@@ -0,0 +1,304 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <ctime>
+
+#include "greentop/Time.h"
+#include "greentop/stream/OrderCache.h"
+
+namespace greentop {
+namespace stream {
+
+namespace {
+
+Optional<double> getDouble(const Json::Value& json, const char* key) {
+    if (json.isMember(key)) {
+        return json[key].asDouble();
+    }
+    return Optional<double>();
+}
+
+void updateLadder(std::map<double, double>& ladder, const Json::Value& changes) {
+    for (unsigned i = 0; i < changes.size(); ++i) {
+        double price = changes[i][0].asDouble();
+        double size = changes[i][1].asDouble();
+        if (size == 0) {
+            ladder.erase(price);
+        } else {
+            ladder[price] = size;
+        }
+    }
+}
+
+std::vector<PriceSize> toPriceSizes(const std::map<double, double>& ladder) {
+    std::vector<PriceSize> priceSizes;
+    priceSizes.reserve(ladder.size());
+    for (auto it = ladder.begin(); it != ladder.end(); ++it) {
+        priceSizes.push_back(PriceSize(it->first, it->second));
+    }
+    return priceSizes;
+}
+
+}
+
+OrderCache::OrderCache() {
+}
+
+std::vector<std::string> OrderCache::applyOrderChangeMessage(const Json::Value& message) {
+    std::vector<std::string> marketIds;
+    const Json::Value& orderMarketChanges = message["oc"];
+    for (unsigned i = 0; i < orderMarketChanges.size(); ++i) {
+        applyOrderMarketChange(orderMarketChanges[i]);
+        marketIds.push_back(orderMarketChanges[i]["id"].asString());
+    }
+    return marketIds;
+}
+
+void OrderCache::applyOrderMarketChange(const Json::Value& orderMarketChange) {
+    std::string marketId = orderMarketChange["id"].asString();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    MarketOrders& market = markets[marketId];
+
+    if (orderMarketChange["fullImage"].asBool()) {
+        for (auto it = market.runners.begin(); it != market.runners.end(); ++it) {
+            removeBets(it->second);
+        }
+        market.runners.clear();
+    }
+    if (orderMarketChange.isMember("closed")) {
+        market.closed = orderMarketChange["closed"].asBool();
+    }
+
+    const Json::Value& orderRunnerChanges = orderMarketChange["orc"];
+    for (unsigned i = 0; i < orderRunnerChanges.size(); ++i) {
+        const Json::Value& orderRunnerChange = orderRunnerChanges[i];
+        RunnerKey key(orderRunnerChange["id"].asInt64(),
+            orderRunnerChange.isMember("hc") ? orderRunnerChange["hc"].asDouble() : 0);
+        RunnerOrders& runner = market.runners[key];
+
+        if (orderRunnerChange["fullImage"].asBool()) {
+            removeBets(runner);
+            runner = RunnerOrders();
+        }
+
+        // each unmatched order is sent in full whenever it changes
+        const Json::Value& unmatchedOrders = orderRunnerChange["uo"];
+        for (unsigned j = 0; j < unmatchedOrders.size(); ++j) {
+            CurrentOrderSummary order = toCurrentOrderSummary(marketId, key, unmatchedOrders[j]);
+            BetLocation location;
+            location.marketId = marketId;
+            location.runner = key;
+            bets[order.getBetId()] = location;
+            runner.orders[order.getBetId()] = order;
+        }
+        if (orderRunnerChange.isMember("mb")) {
+            updateLadder(runner.matchedBacks, orderRunnerChange["mb"]);
+        }
+        if (orderRunnerChange.isMember("ml")) {
+            updateLadder(runner.matchedLays, orderRunnerChange["ml"]);
+        }
+    }
+}
+
+CurrentOrderSummary OrderCache::toCurrentOrderSummary(const std::string& marketId, const RunnerKey& key,
+    const Json::Value& unmatchedOrder) {
+    Side side;
+    std::string code = unmatchedOrder["side"].asString();
+    if (code == "B") {
+        side = Side::BACK;
+    } else if (code == "L") {
+        side = Side::LAY;
+    }
+
+    OrderStatus status;
+    code = unmatchedOrder["status"].asString();
+    if (code == "E") {
+        status = OrderStatus::EXECUTABLE;
+    } else if (code == "EC") {
+        status = OrderStatus::EXECUTION_COMPLETE;
+    }
+
+    PersistenceType persistenceType;
+    code = unmatchedOrder["pt"].asString();
+    if (code == "L") {
+        persistenceType = PersistenceType::LAPSE;
+    } else if (code == "P") {
+        persistenceType = PersistenceType::PERSIST;
+    } else if (code == "MOC") {
+        persistenceType = PersistenceType::MARKET_ON_CLOSE;
+    }
+
+    OrderType orderType;
+    code = unmatchedOrder["ot"].asString();
+    if (code == "L") {
+        orderType = OrderType::LIMIT;
+    } else if (code == "LOC") {
+        orderType = OrderType::LIMIT_ON_CLOSE;
+    } else if (code == "MOC") {
+        orderType = OrderType::MARKET_ON_CLOSE;
+    }
+
+    // dates are sent as milliseconds since the epoch; a zeroed tm is treated as unset.
+    std::tm placedDate = std::tm();
+    if (unmatchedOrder.isMember("pd")) {
+        placedDate = fromTime(static_cast<std::time_t>(unmatchedOrder["pd"].asInt64() / 1000));
+    }
+    std::tm matchedDate = std::tm();
+    if (unmatchedOrder.isMember("md")) {
+        matchedDate = fromTime(static_cast<std::time_t>(unmatchedOrder["md"].asInt64() / 1000));
+    }
+
+    return CurrentOrderSummary(unmatchedOrder["id"].asString(), marketId, key.first, key.second,
+        PriceSize(getDouble(unmatchedOrder, "p"), getDouble(unmatchedOrder, "s")),
+        getDouble(unmatchedOrder, "bsp"), side, status, persistenceType, orderType, placedDate, matchedDate,
+        getDouble(unmatchedOrder, "avp"), getDouble(unmatchedOrder, "sm"), getDouble(unmatchedOrder, "sr"),
+        getDouble(unmatchedOrder, "sl"), getDouble(unmatchedOrder, "sc"), getDouble(unmatchedOrder, "sv"),
+        unmatchedOrder["rac"].asString(), unmatchedOrder["rc"].asString(), unmatchedOrder["rfo"].asString(),
+        unmatchedOrder["rfs"].asString());
+}
+
+void OrderCache::removeBets(const RunnerOrders& runner) {
+    for (auto it = runner.orders.begin(); it != runner.orders.end(); ++it) {
+        bets.erase(it->first);
+    }
+}
+
+const OrderCache::RunnerOrders* OrderCache::findRunner(const std::string& marketId, const RunnerKey& key) const {
+    auto marketIt = markets.find(marketId);
+    if (marketIt == markets.end()) {
+        return NULL;
+    }
+    auto runnerIt = marketIt->second.runners.find(key);
+    if (runnerIt == marketIt->second.runners.end()) {
+        return NULL;
+    }
+    return &runnerIt->second;
+}
+
+bool OrderCache::hasMarket(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return markets.find(marketId) != markets.end();
+}
+
+bool OrderCache::isMarketClosed(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    return it != markets.end() && it->second.closed;
+}
+
+std::vector<std::string> OrderCache::getMarketIds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> marketIds;
+    marketIds.reserve(markets.size());
+    for (auto it = markets.begin(); it != markets.end(); ++it) {
+        marketIds.push_back(it->first);
+    }
+    return marketIds;
+}
+
+bool OrderCache::getCurrentOrder(const std::string& betId, CurrentOrderSummary& order) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto betIt = bets.find(betId);
+    if (betIt == bets.end()) {
+        return false;
+    }
+    const RunnerOrders* runner = findRunner(betIt->second.marketId, betIt->second.runner);
+    if (!runner) {
+        return false;
+    }
+    auto orderIt = runner->orders.find(betId);
+    if (orderIt == runner->orders.end()) {
+        return false;
+    }
+    order = orderIt->second;
+    return true;
+}
+
+std::vector<CurrentOrderSummary> OrderCache::getCurrentOrders() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<CurrentOrderSummary> orders;
+    orders.reserve(bets.size());
+    for (auto marketIt = markets.begin(); marketIt != markets.end(); ++marketIt) {
+        for (auto runnerIt = marketIt->second.runners.begin(); runnerIt != marketIt->second.runners.end(); ++runnerIt) {
+            for (auto it = runnerIt->second.orders.begin(); it != runnerIt->second.orders.end(); ++it) {
+                orders.push_back(it->second);
+            }
+        }
+    }
+    return orders;
+}
+
+std::vector<CurrentOrderSummary> OrderCache::getCurrentOrders(const std::string& marketId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<CurrentOrderSummary> orders;
+    auto marketIt = markets.find(marketId);
+    if (marketIt != markets.end()) {
+        for (auto runnerIt = marketIt->second.runners.begin(); runnerIt != marketIt->second.runners.end(); ++runnerIt) {
+            for (auto it = runnerIt->second.orders.begin(); it != runnerIt->second.orders.end(); ++it) {
+                orders.push_back(it->second);
+            }
+        }
+    }
+    return orders;
+}
+
+std::vector<Order> OrderCache::getOrders(const std::string& marketId, int64_t selectionId, double handicap) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Order> orders;
+    const RunnerOrders* runner = findRunner(marketId, RunnerKey(selectionId, handicap));
+    if (runner) {
+        orders.reserve(runner->orders.size());
+        for (auto it = runner->orders.begin(); it != runner->orders.end(); ++it) {
+            const CurrentOrderSummary& summary = it->second;
+            Order order(summary.getBetId(), summary.getOrderType(), summary.getStatus(),
+                summary.getPersistenceType(), summary.getSide(), summary.getPriceSize().getPrice(),
+                summary.getPriceSize().getSize(), summary.getBspLiability(), summary.getPlacedDate(),
+                summary.getAveragePriceMatched(), summary.getSizeMatched(), summary.getSizeRemaining(),
+                summary.getSizeLapsed(), summary.getSizeCancelled(), summary.getSizeVoided(),
+                summary.getCustomerOrderRef(), summary.getCustomerStrategyRef());
+            orders.push_back(order);
+        }
+    }
+    return orders;
+}
+
+std::vector<PriceSize> OrderCache::getMatchedBacks(const std::string& marketId, int64_t selectionId,
+    double handicap) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const RunnerOrders* runner = findRunner(marketId, RunnerKey(selectionId, handicap));
+    return runner ? toPriceSizes(runner->matchedBacks) : std::vector<PriceSize>();
+}
+
+std::vector<PriceSize> OrderCache::getMatchedLays(const std::string& marketId, int64_t selectionId,
+    double handicap) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const RunnerOrders* runner = findRunner(marketId, RunnerKey(selectionId, handicap));
+    return runner ? toPriceSizes(runner->matchedLays) : std::vector<PriceSize>();
+}
+
+void OrderCache::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = markets.find(marketId);
+    if (it != markets.end()) {
+        for (auto runnerIt = it->second.runners.begin(); runnerIt != it->second.runners.end(); ++runnerIt) {
+            removeBets(runnerIt->second);
+        }
+        markets.erase(it);
+    }
+}
+
+void OrderCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    markets.clear();
+    bets.clear();
+}
+
+size_t OrderCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bets.size();
+}
+
+}
+}
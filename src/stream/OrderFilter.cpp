@@ -0,0 +1,74 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/stream/OrderFilter.h"
+
+namespace greentop {
+namespace stream {
+
+OrderFilter::OrderFilter(const Optional<bool>& includeOverallPosition,
+    const std::set<std::string>& customerStrategyRefs,
+    const Optional<bool>& partitionMatchedByStrategyRef) :
+    includeOverallPosition(includeOverallPosition),
+    customerStrategyRefs(customerStrategyRefs),
+    partitionMatchedByStrategyRef(partitionMatchedByStrategyRef) {
+}
+
+void OrderFilter::fromJson(const Json::Value& json) {
+    if (json.isMember("includeOverallPosition")) {
+        includeOverallPosition = json["includeOverallPosition"].asBool();
+    }
+    if (json.isMember("customerStrategyRefs")) {
+        for (unsigned i = 0; i < json["customerStrategyRefs"].size(); ++i) {
+            customerStrategyRefs.insert(json["customerStrategyRefs"][i].asString());
+        }
+    }
+    if (json.isMember("partitionMatchedByStrategyRef")) {
+        partitionMatchedByStrategyRef = json["partitionMatchedByStrategyRef"].asBool();
+    }
+}
+
+Json::Value OrderFilter::toJson() const {
+    Json::Value json(Json::objectValue);
+    if (includeOverallPosition.isValid()) {
+        json["includeOverallPosition"] = includeOverallPosition.toJson();
+    }
+    if (customerStrategyRefs.size() > 0) {
+        for (std::set<std::string>::const_iterator it = customerStrategyRefs.begin(); it != customerStrategyRefs.end(); ++it) {
+            json["customerStrategyRefs"].append(*it);
+        }
+    }
+    if (partitionMatchedByStrategyRef.isValid()) {
+        json["partitionMatchedByStrategyRef"] = partitionMatchedByStrategyRef.toJson();
+    }
+    return json;
+}
+
+bool OrderFilter::isValid() const {
+    return true;
+}
+
+const Optional<bool>& OrderFilter::getIncludeOverallPosition() const {
+    return includeOverallPosition;
+}
+void OrderFilter::setIncludeOverallPosition(const Optional<bool>& includeOverallPosition) {
+    this->includeOverallPosition = includeOverallPosition;
+}
+
+const std::set<std::string>& OrderFilter::getCustomerStrategyRefs() const {
+    return customerStrategyRefs;
+}
+void OrderFilter::setCustomerStrategyRefs(const std::set<std::string>& customerStrategyRefs) {
+    this->customerStrategyRefs = customerStrategyRefs;
+}
+
+const Optional<bool>& OrderFilter::getPartitionMatchedByStrategyRef() const {
+    return partitionMatchedByStrategyRef;
+}
+void OrderFilter::setPartitionMatchedByStrategyRef(const Optional<bool>& partitionMatchedByStrategyRef) {
+    this->partitionMatchedByStrategyRef = partitionMatchedByStrategyRef;
+}
+
+}
+}
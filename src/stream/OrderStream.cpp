@@ -0,0 +1,51 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include "greentop/stream/OrderStream.h"
+
+namespace greentop {
+namespace stream {
+
+OrderStream::OrderStream(const ExchangeApi& exchangeApi, const OrderFilter& orderFilter,
+    std::unique_ptr<IConnection>&& connection) :
+    StreamClient(exchangeApi, std::move(connection)),
+    orderFilter(orderFilter) {
+}
+
+OrderStream::OrderStream(const std::string& applicationKey, const std::string& session,
+    const OrderFilter& orderFilter, std::unique_ptr<IConnection>&& connection) :
+    StreamClient(applicationKey, session, std::move(connection)),
+    orderFilter(orderFilter) {
+}
+
+OrderStream::~OrderStream() {
+    stop();
+}
+
+const OrderCache& OrderStream::getCache() const {
+    return cache;
+}
+
+Json::Value OrderStream::buildSubscription() const {
+    Json::Value subscription(Json::objectValue);
+    subscription["op"] = "orderSubscription";
+    subscription["orderFilter"] = orderFilter.toJson();
+    subscription["segmentationEnabled"] = true;
+    return subscription;
+}
+
+std::string OrderStream::getChangeOp() const {
+    return "ocm";
+}
+
+std::vector<std::string> OrderStream::applyChange(const Json::Value& message) {
+    return cache.applyOrderChangeMessage(message);
+}
+
+void OrderStream::clearCache() {
+    cache.clear();
+}
+
+}
+}
@@ -0,0 +1,357 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+#include "greentop/stream/StreamClient.h"
+
+namespace greentop {
+namespace stream {
+
+namespace {
+
+// errors that won't go away by reconnecting
+const std::set<std::string> PERMANENT_ERRORS = {
+    "NO_APP_KEY", "INVALID_APP_KEY", "NO_SESSION", "INVALID_SESSION_INFORMATION", "NOT_AUTHORIZED",
+    "INVALID_INPUT", "SUBSCRIPTION_LIMIT_EXCEEDED"
+};
+
+std::string toCompactString(const Json::Value& json) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, json);
+}
+
+}
+
+const std::string StreamClient::END_POINT = "https://stream-api.betfair.com:443";
+const std::string StreamClient::INTEGRATION_END_POINT = "https://stream-api-integration.betfair.com:443";
+
+StreamClient::StreamClient(const ExchangeApi& exchangeApi, std::unique_ptr<IConnection>&& connection) :
+    exchangeApi(&exchangeApi),
+    connection(std::move(connection)),
+    endPoint(END_POINT),
+    heartbeatMs(5000),
+    conflateMs(0),
+    reconnectDelayMs(1000),
+    messageId(0),
+    running(false),
+    connected(false),
+    resubscribeRequested(false),
+    reconnects(0),
+    permanentFailure(false) {
+}
+
+StreamClient::StreamClient(const std::string& applicationKey, const std::string& session,
+    std::unique_ptr<IConnection>&& connection) :
+    exchangeApi(NULL),
+    applicationKey(applicationKey),
+    session(session),
+    connection(std::move(connection)),
+    endPoint(END_POINT),
+    heartbeatMs(5000),
+    conflateMs(0),
+    reconnectDelayMs(1000),
+    messageId(0),
+    running(false),
+    connected(false),
+    resubscribeRequested(false),
+    reconnects(0),
+    permanentFailure(false) {
+}
+
+StreamClient::~StreamClient() {
+    stop();
+}
+
+void StreamClient::setEndPoint(const std::string& endPoint) {
+    this->endPoint = endPoint;
+}
+
+void StreamClient::setHeartbeatMs(int heartbeatMs) {
+    this->heartbeatMs = heartbeatMs;
+}
+
+void StreamClient::setConflateMs(int conflateMs) {
+    this->conflateMs = conflateMs;
+}
+
+void StreamClient::setReconnectDelayMs(int reconnectDelayMs) {
+    this->reconnectDelayMs = reconnectDelayMs;
+}
+
+void StreamClient::setErrorCallback(const ErrorCallback& errorCallback) {
+    this->errorCallback = errorCallback;
+}
+
+void StreamClient::setChangeCallback(const ChangeCallback& changeCallback) {
+    this->changeCallback = changeCallback;
+}
+
+void StreamClient::start() {
+    if (!thread.joinable()) {
+        running = true;
+        thread = std::thread(&StreamClient::runLoop, this);
+    }
+}
+
+void StreamClient::stop() {
+    running = false;
+    if (thread.joinable()) {
+        if (thread.get_id() == std::this_thread::get_id()) {
+            // called from a callback: the thread can't join itself, so let it finish on its own
+            thread.detach();
+        } else {
+            thread.join();
+        }
+    }
+}
+
+void StreamClient::run() {
+    running = true;
+    runLoop();
+}
+
+void StreamClient::runLoop() {
+    permanentFailure = false;
+    bool firstAttempt = true;
+    std::string buffer;
+    std::vector<char> chunk(65536);
+
+    while (running && !permanentFailure) {
+        if (!firstAttempt) {
+            ++reconnects;
+        }
+        firstAttempt = false;
+        buffer.clear();
+
+        try {
+            connect();
+            std::chrono::steady_clock::time_point lastReceived = std::chrono::steady_clock::now();
+            std::chrono::milliseconds timeout(3 * heartbeatMs);
+
+            while (running && connection->isOpen() && !resubscribeRequested) {
+                size_t received = connection->receive(chunk.data(), chunk.size(), 250);
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if (received == 0) {
+                    if (now - lastReceived > timeout) {
+                        throw std::runtime_error("no data or heartbeat received, reconnecting");
+                    }
+                    continue;
+                }
+                lastReceived = now;
+                buffer.append(chunk.data(), received);
+
+                size_t start = 0;
+                size_t newLine;
+                while ((newLine = buffer.find('\n', start)) != std::string::npos) {
+                    size_t end = newLine;
+                    if (end > start && buffer[end - 1] == '\r') {
+                        --end;
+                    }
+                    if (end > start) {
+                        processMessage(buffer.substr(start, end - start));
+                    }
+                    start = newLine + 1;
+                }
+                buffer.erase(0, start);
+            }
+        } catch (const std::exception& e) {
+            reportError("CONNECTION_FAILED", e.what());
+        }
+
+        connected = false;
+        connection->close();
+
+        if (resubscribeRequested) {
+            // the clocks are cleared here rather than in resubscribe() so that a change being processed can't
+            // set them again
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                initialClk = "";
+                clk = "";
+            }
+            resubscribeRequested = false;
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point retryAt =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(reconnectDelayMs);
+        while (running && !permanentFailure && std::chrono::steady_clock::now() < retryAt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    running = false;
+}
+
+void StreamClient::resubscribe() {
+    resubscribeRequested = true;
+}
+
+void StreamClient::connect() {
+    std::string appKey = applicationKey;
+    std::string ssoid = session;
+    if (exchangeApi) {
+        appKey = exchangeApi->getApplicationKey();
+        ssoid = exchangeApi->getSsoid();
+    }
+
+    connection->open(endPoint);
+    connected = true;
+
+    Json::Value authentication(Json::objectValue);
+    authentication["op"] = "authentication";
+    authentication["appKey"] = appKey;
+    authentication["session"] = ssoid;
+    send(authentication);
+
+    Json::Value subscription = buildSubscription();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (initialClk != "") {
+            subscription["initialClk"] = initialClk;
+        }
+        if (clk != "") {
+            subscription["clk"] = clk;
+        }
+    }
+    if (!subscription.isMember("initialClk") && !subscription.isMember("clk")) {
+        reset();
+    }
+    subscription["heartbeatMs"] = heartbeatMs;
+    if (conflateMs > 0) {
+        subscription["conflateMs"] = conflateMs;
+    }
+    send(subscription);
+}
+
+void StreamClient::send(const Json::Value& message) {
+    Json::Value json(message);
+    json["id"] = ++messageId;
+    connection->send(toCompactString(json) + "\r\n");
+}
+
+void StreamClient::processMessage(const std::string& message) {
+    Json::Value json;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    std::istringstream input(message);
+    if (!Json::parseFromStream(builder, input, &json, &errors) || !json.isObject()) {
+        reportError("INVALID_MESSAGE", errors);
+        return;
+    }
+
+    std::string op = json["op"].asString();
+    if (op == "connection") {
+        std::lock_guard<std::mutex> lock(mutex);
+        connectionId = json["connectionId"].asString();
+    } else if (op == "status") {
+        handleStatus(json);
+    } else if (op == getChangeOp()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (json.isMember("initialClk")) {
+                initialClk = json["initialClk"].asString();
+            }
+            if (json.isMember("clk")) {
+                clk = json["clk"].asString();
+            }
+        }
+        try {
+            handleChange(json);
+        } catch (const std::exception& e) {
+            reportError("INVALID_MESSAGE", e.what());
+        }
+    }
+}
+
+void StreamClient::handleStatus(const Json::Value& message) {
+    if (message["statusCode"].asString() == "SUCCESS") {
+        return;
+    }
+
+    std::string errorCode = message["errorCode"].asString();
+    reportError(errorCode, message["errorMessage"].asString());
+
+    if (errorCode == "INVALID_CLOCK") {
+        std::lock_guard<std::mutex> lock(mutex);
+        initialClk = "";
+        clk = "";
+    }
+    if (PERMANENT_ERRORS.count(errorCode) > 0) {
+        permanentFailure = true;
+    }
+    if (permanentFailure || message["connectionClosed"].asBool()) {
+        connection->close();
+    }
+}
+
+void StreamClient::handleChange(const Json::Value& message) {
+    std::string changeType = message["ct"].asString();
+    if (changeType == "HEARTBEAT") {
+        return;
+    }
+    std::string segmentType = message["segmentType"].asString();
+
+    if (changeType == "SUB_IMAGE" && (segmentType == "" || segmentType == "SEG_START")) {
+        // a full image replaces everything
+        reset();
+    }
+
+    std::vector<std::string> marketIds = applyChange(message);
+    for (const std::string& marketId : marketIds) {
+        if (pendingSet.insert(marketId).second) {
+            pendingMarketIds.push_back(marketId);
+        }
+    }
+
+    if (segmentType == "" || segmentType == "SEG_END") {
+        std::vector<std::string> changed;
+        changed.swap(pendingMarketIds);
+        pendingSet.clear();
+        if (changeCallback && !changed.empty()) {
+            changeCallback(changed);
+        }
+    }
+}
+
+void StreamClient::reset() {
+    clearCache();
+    pendingMarketIds.clear();
+    pendingSet.clear();
+}
+
+void StreamClient::reportError(const std::string& errorCode, const std::string& errorMessage) {
+    if (errorCallback) {
+        errorCallback(errorCode, errorMessage);
+    }
+}
+
+bool StreamClient::isConnected() const {
+    return connected;
+}
+
+std::string StreamClient::getConnectionId() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return connectionId;
+}
+
+std::string StreamClient::getInitialClk() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return initialClk;
+}
+
+std::string StreamClient::getClk() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return clk;
+}
+
+uint64_t StreamClient::getReconnects() const {
+    return reconnects;
+}
+
+}
+}
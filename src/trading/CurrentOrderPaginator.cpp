@@ -0,0 +1,180 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "greentop/Time.h"
+#include "greentop/trading/CurrentOrderPaginator.h"
+
+namespace greentop {
+namespace trading {
+
+namespace {
+
+struct Page {
+    std::vector<CurrentOrderSummary> orders;
+    bool moreAvailable;
+};
+
+/**
+ * One partition of the request and its pages in flight, oldest first.
+ */
+struct Scan {
+    ListCurrentOrdersRequest request;
+    std::deque<std::future<Page>> pages;
+    int32_t nextRecord;
+    bool finished;
+};
+
+Page fetchPage(const ExchangeApi& exchangeApi, ListCurrentOrdersRequest request, int32_t fromRecord,
+        int32_t recordCount) {
+    request.setFromRecord(fromRecord);
+    request.setRecordCount(recordCount);
+    CurrentOrderSummaryReport report = exchangeApi.listCurrentOrders(request);
+    if (!report.isSuccess()) {
+        throw std::runtime_error("listCurrentOrders failed: " + report.getFaultString());
+    }
+    Page page;
+    page.orders = report.getCurrentOrders();
+    page.moreAvailable = report.getMoreAvailable().isValid() && report.getMoreAvailable().getValue();
+    return page;
+}
+
+}
+
+const unsigned CurrentOrderPaginator::MAX_RECORDS;
+
+CurrentOrderPaginator::CurrentOrderPaginator(const ExchangeApi& exchangeApi) :
+    exchangeApi(exchangeApi),
+    pageSize(MAX_RECORDS),
+    pageOverlap(10),
+    maxRequests(4),
+    maxPartitions(4) {
+}
+
+void CurrentOrderPaginator::setPageSize(unsigned pageSize) {
+    this->pageSize = std::max(1u, std::min(pageSize, MAX_RECORDS));
+}
+
+void CurrentOrderPaginator::setPageOverlap(unsigned pageOverlap) {
+    this->pageOverlap = pageOverlap;
+}
+
+void CurrentOrderPaginator::setMaxRequests(unsigned maxRequests) {
+    this->maxRequests = std::max(1u, maxRequests);
+}
+
+void CurrentOrderPaginator::setMaxPartitions(unsigned maxPartitions) {
+    this->maxPartitions = std::max(1u, maxPartitions);
+}
+
+uint64_t CurrentOrderPaginator::read(const ListCurrentOrdersRequest& request, const Callback& callback) const {
+    std::vector<ListCurrentOrdersRequest> partitions = partition(request, maxPartitions);
+    int32_t step = static_cast<int32_t>(pageOverlap < pageSize ? pageSize - pageOverlap : pageSize);
+    size_t depth = std::max<size_t>(1, maxRequests / partitions.size());
+
+    std::vector<Scan> scans(partitions.size());
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        scans[i].request = partitions[i];
+        scans[i].nextRecord = 0;
+        scans[i].finished = false;
+    }
+    // requests for pages past the end, finished with when the scan is
+    std::vector<std::future<Page>> unused;
+
+    auto prefetch = [&](Scan& scan) {
+        while (!scan.finished && scan.pages.size() < depth) {
+            scan.pages.push_back(std::async(std::launch::async, fetchPage, std::cref(exchangeApi), scan.request,
+                scan.nextRecord, static_cast<int32_t>(pageSize)));
+            scan.nextRecord += step;
+        }
+    };
+
+    for (Scan& scan : scans) {
+        prefetch(scan);
+    }
+
+    std::unordered_set<std::string> seen;
+    uint64_t count = 0;
+    bool reading = true;
+    while (reading) {
+        reading = false;
+        for (Scan& scan : scans) {
+            if (scan.pages.empty()) {
+                continue;
+            }
+            Page page = scan.pages.front().get();
+            scan.pages.pop_front();
+            for (const CurrentOrderSummary& order : page.orders) {
+                if (seen.insert(order.getBetId()).second) {
+                    callback(order);
+                    ++count;
+                }
+            }
+            if (page.moreAvailable && !page.orders.empty()) {
+                prefetch(scan);
+            } else {
+                scan.finished = true;
+                for (auto it = scan.pages.begin(); it != scan.pages.end(); ++it) {
+                    unused.push_back(std::move(*it));
+                }
+                scan.pages.clear();
+            }
+            reading = reading || !scan.pages.empty();
+        }
+    }
+    return count;
+}
+
+std::vector<CurrentOrderSummary> CurrentOrderPaginator::read(const ListCurrentOrdersRequest& request) const {
+    std::vector<CurrentOrderSummary> orders;
+    read(request, [&orders](const CurrentOrderSummary& order) {
+        orders.push_back(order);
+    });
+    return orders;
+}
+
+std::vector<ListCurrentOrdersRequest> CurrentOrderPaginator::partition(const ListCurrentOrdersRequest& request,
+        unsigned maxPartitions) {
+    std::vector<ListCurrentOrdersRequest> partitions;
+    const std::set<std::string>& marketIds = request.getMarketIds();
+    const TimeRange& dateRange = request.getDateRange();
+
+    // the caller asked for an order that partitions would break
+    if (maxPartitions <= 1 || request.getOrderBy().isValid()) {
+        partitions.push_back(request);
+    } else if (marketIds.size() > 1) {
+        size_t n = std::min<size_t>(maxPartitions, marketIds.size());
+        std::vector<std::set<std::string>> groups(n);
+        size_t i = 0;
+        for (auto it = marketIds.begin(); it != marketIds.end(); ++it) {
+            groups[i++ % n].insert(*it);
+        }
+        for (auto it = groups.begin(); it != groups.end(); ++it) {
+            partitions.push_back(request);
+            partitions.back().setMarketIds(*it);
+        }
+    } else if (dateRange.getFrom().tm_year > 0 && dateRange.getTo().tm_year > 0 &&
+        toTime(dateRange.getTo()) > toTime(dateRange.getFrom())) {
+        time_t from = toTime(dateRange.getFrom());
+        time_t span = toTime(dateRange.getTo()) - from;
+        time_t n = std::min<time_t>(maxPartitions, span);
+        // slices share their end second with the next one's start, orders placed then are read twice
+        for (time_t i = 0; i < n; ++i) {
+            partitions.push_back(request);
+            partitions.back().setDateRange(TimeRange(fromTime(from + span * i / n),
+                fromTime(from + span * (i + 1) / n)));
+        }
+    } else {
+        partitions.push_back(request);
+    }
+    return partitions;
+}
+
+}
+}
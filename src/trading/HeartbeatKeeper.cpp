@@ -0,0 +1,278 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+
+#include "greentop/trading/HeartbeatKeeper.h"
+
+namespace greentop {
+namespace trading {
+
+namespace {
+
+/** The shortest and longest timeouts the exchange accepts. */
+const int32_t MIN_TIMEOUT_SECONDS = 10;
+const int32_t MAX_TIMEOUT_SECONDS = 300;
+
+/** The shortest time between heartbeats, however many are asked for per timeout. */
+const std::chrono::milliseconds MIN_INTERVAL(100);
+
+}
+
+HeartbeatKeeper::HeartbeatKeeper(const ExchangeApi& exchangeApi, int32_t preferredTimeoutSeconds) :
+    exchangeApi(exchangeApi),
+    preferredTimeoutSeconds(std::min(std::max(preferredTimeoutSeconds, MIN_TIMEOUT_SECONDS), MAX_TIMEOUT_SECONDS)),
+    beatsPerTimeout(4),
+    marginThreshold(0.5),
+    deadManMargin(2000),
+    running(false),
+    armed(false),
+    actualTimeoutSeconds(0),
+    beats(0),
+    failures(0),
+    maxLateness(0) {
+}
+
+HeartbeatKeeper::~HeartbeatKeeper() {
+    stop();
+}
+
+void HeartbeatKeeper::setBeatsPerTimeout(unsigned beatsPerTimeout) {
+    this->beatsPerTimeout = std::max(1u, beatsPerTimeout);
+}
+
+void HeartbeatKeeper::setMarginThreshold(double marginThreshold) {
+    this->marginThreshold = marginThreshold;
+}
+
+void HeartbeatKeeper::setDeadManMargin(const std::chrono::milliseconds& deadManMargin) {
+    this->deadManMargin = deadManMargin.count();
+}
+
+void HeartbeatKeeper::setAlarmCallback(const AlarmCallback& alarmCallback) {
+    this->alarmCallback = alarmCallback;
+}
+
+void HeartbeatKeeper::setDeadManCallback(const DeadManCallback& deadManCallback) {
+    this->deadManCallback = deadManCallback;
+}
+
+void HeartbeatKeeper::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        beatThread = std::thread(&HeartbeatKeeper::runBeats, this);
+        watchdogThread = std::thread(&HeartbeatKeeper::runWatchdog, this);
+    }
+}
+
+void HeartbeatKeeper::stop(bool unregister) {
+    bool registered;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        armed = false;
+        registered = actualTimeoutSeconds > 0;
+    }
+    condition.notify_all();
+    if (beatThread.joinable()) {
+        beatThread.join();
+    }
+    if (watchdogThread.joinable()) {
+        watchdogThread.join();
+    }
+
+    if (unregister && registered) {
+        try {
+            exchangeApi.heartbeat(HeartbeatRequest(0));
+        } catch (const std::exception&) {
+            // the exchange will cancel unmatched bets when the timeout passes
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        actualTimeoutSeconds = 0;
+    }
+}
+
+void HeartbeatKeeper::runBeats() {
+    unsigned consecutiveFailures = 0;
+    Clock::time_point next = Clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait_until(lock, next, [this]() {
+            return !running;
+        });
+        if (!running) {
+            break;
+        }
+        lock.unlock();
+
+        Clock::time_point due = next;
+        int64_t lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count();
+        if (lateness > maxLateness) {
+            maxLateness = lateness;
+        }
+
+        bool delivered = beat(consecutiveFailures);
+
+        int32_t timeoutSeconds = getActualTimeoutSeconds();
+        if (timeoutSeconds <= 0) {
+            timeoutSeconds = preferredTimeoutSeconds;
+        }
+        Clock::duration interval = std::max<Clock::duration>(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::seconds(timeoutSeconds)) / beatsPerTimeout.load(), MIN_INTERVAL);
+        next = due + interval;
+        Clock::time_point now = Clock::now();
+        if (!delivered) {
+            // don't wait a whole interval to try again
+            next = std::min(next, now + interval / 4);
+        }
+        if (next < now) {
+            // a request took longer than the interval: send now rather than catching up with a burst
+            next = now;
+        }
+
+        lock.lock();
+    }
+}
+
+bool HeartbeatKeeper::beat(unsigned& consecutiveFailures) {
+    static const ActionPerformed none(ActionPerformed::NONE);
+
+    Clock::time_point sent = Clock::now();
+    HeartbeatReport report;
+    std::string error;
+    try {
+        report = exchangeApi.heartbeat(HeartbeatRequest(preferredTimeoutSeconds));
+        if (!report.isSuccess()) {
+            error = report.getFaultCode() + ": " + report.getFaultString();
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+        if (error.empty()) {
+            error = "heartbeat request failed";
+        }
+    }
+    Clock::time_point received = Clock::now();
+
+    if (!error.empty()) {
+        ++failures;
+        ++consecutiveFailures;
+        std::chrono::milliseconds margin = getMargin();
+        raise(HEARTBEAT_FAILED, margin, ActionPerformed(), error, consecutiveFailures);
+        return false;
+    }
+
+    ++beats;
+    consecutiveFailures = 0;
+    int32_t timeoutSeconds = report.getActualTimeoutSeconds().isValid() ?
+        report.getActualTimeoutSeconds().getValue() : preferredTimeoutSeconds;
+    int32_t previousTimeoutSeconds;
+    std::chrono::milliseconds margin(0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        previousTimeoutSeconds = actualTimeoutSeconds;
+        if (previousTimeoutSeconds > 0) {
+            margin = std::chrono::duration_cast<std::chrono::milliseconds>(
+                lastDelivered + std::chrono::seconds(previousTimeoutSeconds) - received);
+        }
+        actualTimeoutSeconds = timeoutSeconds;
+        // the exchange received the heartbeat some time after it was sent, so count from when it was sent
+        lastDelivered = sent;
+        armed = running;
+    }
+    condition.notify_all();
+
+    if (timeoutSeconds != (previousTimeoutSeconds > 0 ? previousTimeoutSeconds : preferredTimeoutSeconds)) {
+        raise(TIMEOUT_CHANGED, margin, report.getActionPerformed(), std::string(), 0);
+    }
+    if (report.getActionPerformed().isValid() && report.getActionPerformed() != none) {
+        raise(ACTION_PERFORMED, margin, report.getActionPerformed(), std::string(), 0);
+    }
+    if (previousTimeoutSeconds > 0 && margin.count() < marginThreshold * previousTimeoutSeconds * 1000) {
+        raise(MARGIN_LOW, margin, report.getActionPerformed(), std::string(), 0);
+    }
+    return true;
+}
+
+void HeartbeatKeeper::runWatchdog() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        if (!armed) {
+            condition.wait(lock, [this]() {
+                return !running || armed;
+            });
+            continue;
+        }
+
+        Clock::time_point delivered = lastDelivered;
+        Clock::time_point deadline = lastDelivered + std::chrono::seconds(actualTimeoutSeconds);
+        Clock::time_point trigger = deadline - std::chrono::milliseconds(deadManMargin.load());
+        condition.wait_until(lock, trigger, [&]() {
+            return !running || !armed || lastDelivered != delivered;
+        });
+        if (!running || !armed || lastDelivered != delivered || Clock::now() < trigger) {
+            continue;
+        }
+
+        armed = false;
+        std::chrono::milliseconds margin = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - Clock::now());
+        lock.unlock();
+        raise(DEAD_MAN, margin, ActionPerformed(), std::string(), 0);
+        if (deadManCallback) {
+            deadManCallback();
+        }
+        lock.lock();
+    }
+}
+
+void HeartbeatKeeper::raise(Alarm alarm, std::chrono::milliseconds margin, const ActionPerformed& actionPerformed,
+        const std::string& error, unsigned consecutiveFailures) const {
+    if (!alarmCallback) {
+        return;
+    }
+    Status status;
+    status.alarm = alarm;
+    status.actualTimeoutSeconds = getActualTimeoutSeconds();
+    status.margin = margin;
+    status.actionPerformed = actionPerformed;
+    status.error = error;
+    status.consecutiveFailures = consecutiveFailures;
+    alarmCallback(status);
+}
+
+int32_t HeartbeatKeeper::getActualTimeoutSeconds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return actualTimeoutSeconds;
+}
+
+HeartbeatKeeper::Clock::time_point HeartbeatKeeper::getLastDelivered() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastDelivered;
+}
+
+std::chrono::milliseconds HeartbeatKeeper::getMargin() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (actualTimeoutSeconds <= 0) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        lastDelivered + std::chrono::seconds(actualTimeoutSeconds) - Clock::now());
+}
+
+uint64_t HeartbeatKeeper::getBeats() const {
+    return beats;
+}
+
+uint64_t HeartbeatKeeper::getFailures() const {
+    return failures;
+}
+
+std::chrono::nanoseconds HeartbeatKeeper::getMaxLateness() const {
+    return std::chrono::nanoseconds(maxLateness.load());
+}
+
+}
+}
@@ -0,0 +1,271 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "greentop/trading/MassCanceller.h"
+
+namespace greentop {
+namespace trading {
+
+namespace {
+
+size_t writeToStream(char* buffer, size_t size, size_t nitems, std::ostream* stream) {
+    size_t realwrote = size * nitems;
+    stream->write(buffer, static_cast<std::streamsize>(realwrote));
+    if (!(*stream)) {
+        realwrote = 0;
+    }
+    return realwrote;
+}
+
+std::string buildWarmBody() {
+    // a bet that doesn't exist, so the response is small
+    std::set<std::string> betIds;
+    betIds.insert("1");
+    return ListCurrentOrdersRequest(betIds).toString();
+}
+
+}
+
+const unsigned MassCanceller::MAX_INSTRUCTIONS;
+
+MassCanceller::Result::Result() : success(true), requests(0), sizeCancelled(0), elapsed(0) {
+}
+
+MassCanceller::MassCanceller(const ExchangeApi& exchangeApi, unsigned connections, std::unique_ptr<ICurl>&& curl) :
+    exchangeApi(exchangeApi),
+    curl(std::move(curl)),
+    cancelUri(exchangeApi.buildUri(ExchangeApi::Api::BETTING, "cancelOrders")),
+    warmUri(exchangeApi.buildUri(ExchangeApi::Api::BETTING, "listCurrentOrders")),
+    timeout(10000),
+    accountRequest(buildRequest(std::string())),
+    warmBody(buildWarmBody()) {
+    for (unsigned i = 0; i < std::max(1u, connections); ++i) {
+        CurlHandle handle = this->curl->easyInit();
+        if (!handle.get()) {
+            throw std::runtime_error("Failed to initialise curl");
+        }
+        this->curl->easySetopt(handle, CURLOPT_USE_SSL, CURLUSESSL_ALL);
+        this->curl->easySetopt(handle, CURLOPT_ACCEPT_ENCODING, "gzip");
+        this->curl->easySetopt(handle, CURLOPT_NOSIGNAL, 1);
+        this->curl->easySetopt(handle, CURLOPT_TCP_NODELAY, 1);
+        this->curl->easySetopt(handle, CURLOPT_TCP_KEEPALIVE, 1);
+        this->curl->easySetopt(handle, CURLOPT_WRITEFUNCTION, writeToStream);
+        handles.push_back(std::move(handle));
+    }
+}
+
+MassCanceller::~MassCanceller() {
+    // the handles use the headers, so must be cleaned up first
+    handles.clear();
+}
+
+void MassCanceller::setMarketIds(const std::vector<std::string>& marketIds) {
+    std::vector<Request> requests;
+    for (const std::string& marketId : marketIds) {
+        requests.push_back(buildRequest(marketId));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    marketRequests.swap(requests);
+}
+
+void MassCanceller::setTimeout(const std::chrono::milliseconds& timeout) {
+    this->timeout = static_cast<long>(timeout.count());
+}
+
+unsigned MassCanceller::warm() {
+    std::lock_guard<std::mutex> lock(mutex);
+    prepare();
+
+    // each connection gets exactly one request, so that every one of them is opened
+    std::atomic<unsigned> warmed(0);
+    auto worker = [&](const CurlHandle& handle) {
+        std::stringstream result;
+        if (perform(handle, warmUri, warmBody, result).empty()) {
+            ++warmed;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < handles.size(); ++i) {
+        workers.push_back(std::thread(worker, std::cref(handles[i])));
+    }
+    worker(handles[0]);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    return warmed;
+}
+
+MassCanceller::Result MassCanceller::cancelAll() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    Result result = send(std::vector<Request>(1, accountRequest));
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+MassCanceller::Result MassCanceller::cancelMarkets() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    Result result = send(marketRequests);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+MassCanceller::Result MassCanceller::cancel(const std::vector<std::string>& marketIds) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Request> requests;
+    for (const std::string& marketId : marketIds) {
+        requests.push_back(buildRequest(marketId));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Result result = send(requests);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+MassCanceller::Result MassCanceller::cancel(const std::map<std::string, std::vector<CancelInstruction>>& instructions) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Request> requests;
+    for (auto it = instructions.begin(); it != instructions.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); i += MAX_INSTRUCTIONS) {
+            size_t end = std::min(it->second.size(), i + MAX_INSTRUCTIONS);
+            std::vector<CancelInstruction> chunk(it->second.begin() + i, it->second.begin() + end);
+            requests.push_back(buildRequest(it->first, chunk));
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Result result = send(requests);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+void MassCanceller::prepare() {
+    const std::string& currentSsoid = exchangeApi.getSsoid();
+    if (!headers || ssoid != currentSsoid) {
+        std::unique_ptr<SList> newHeaders(new SList());
+        newHeaders->append("X-Application: " + exchangeApi.getApplicationKey());
+        newHeaders->append("X-Authentication: " + currentSsoid);
+        newHeaders->append("content-type: application/json");
+        // don't wait for a 100 Continue before sending a large body of instructions
+        newHeaders->append("Expect:");
+        for (const CurlHandle& handle : handles) {
+            curl->easySetopt(handle, CURLOPT_HTTPHEADER, newHeaders->get());
+        }
+        headers.swap(newHeaders);
+        ssoid = currentSsoid;
+    }
+    for (const CurlHandle& handle : handles) {
+        curl->easySetopt(handle, CURLOPT_TIMEOUT_MS, timeout.load());
+    }
+}
+
+MassCanceller::Result MassCanceller::send(const std::vector<Request>& requests) {
+    static const ExecutionReportStatus success(ExecutionReportStatus::SUCCESS);
+
+    Result result;
+    result.requests = static_cast<unsigned>(requests.size());
+    if (requests.empty()) {
+        return result;
+    }
+    prepare();
+
+    std::vector<CancelExecutionReport> reports(requests.size());
+    std::vector<std::string> errors(requests.size());
+    std::atomic<size_t> nextRequest(0);
+
+    auto worker = [&](const CurlHandle& handle) {
+        size_t index;
+        while ((index = nextRequest++) < requests.size()) {
+            std::stringstream response;
+            errors[index] = perform(handle, cancelUri, requests[index].body, response);
+            if (!errors[index].empty()) {
+                continue;
+            }
+            try {
+                response >> reports[index];
+            } catch (const std::exception& e) {
+                errors[index] = std::string("Failed to parse response: ") + e.what();
+                continue;
+            }
+            CancelExecutionReport& report = reports[index];
+            if (!report.isSuccess()) {
+                errors[index] = report.getFaultCode() + ": " + report.getFaultString();
+            } else if (report.getStatus() != success) {
+                errors[index] = report.getStatus().getValue();
+                if (report.getErrorCode().isValid()) {
+                    errors[index] += ": " + report.getErrorCode().getValue();
+                }
+            }
+        }
+    };
+
+    size_t threads = std::min(handles.size(), requests.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.push_back(std::thread(worker, std::cref(handles[i])));
+    }
+    worker(handles[0]);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!errors[i].empty()) {
+            result.success = false;
+            result.failedMarketIds.push_back(requests[i].marketId);
+            result.errors.push_back(errors[i]);
+        }
+        if (reports[i].isSuccess()) {
+            for (const CancelInstructionReport& instructionReport : reports[i].getInstructionReports()) {
+                if (instructionReport.getSizeCancelled().isValid()) {
+                    result.sizeCancelled += instructionReport.getSizeCancelled().getValue();
+                }
+            }
+            result.reports.push_back(reports[i]);
+        }
+    }
+    return result;
+}
+
+std::string MassCanceller::perform(const CurlHandle& handle, const std::string& uri, const std::string& body,
+        std::stringstream& result) const {
+    curl->easySetopt(handle, CURLOPT_URL, uri.c_str());
+    curl->easySetopt(handle, CURLOPT_POSTFIELDS, body.c_str());
+    curl->easySetopt(handle, CURLOPT_WRITEDATA, &result);
+
+    char errorBuffer[CURL_ERROR_SIZE];
+    curl->easySetopt(handle, CURLOPT_ERRORBUFFER, errorBuffer);
+    errorBuffer[0] = 0;
+
+    CURLcode curlResult = curl->easyPerform(handle);
+
+    // the buffer goes out of scope, but the handle lives on
+    curl->easySetopt(handle, CURLOPT_ERRORBUFFER, static_cast<const char*>(NULL));
+
+    if (curlResult == CURLE_OK) {
+        return std::string();
+    }
+    std::string error = errorBuffer;
+    if (error.empty()) {
+        error = curl_easy_strerror(curlResult);
+    }
+    return error;
+}
+
+MassCanceller::Request MassCanceller::buildRequest(const std::string& marketId,
+        const std::vector<CancelInstruction>& instructions) {
+    Request request;
+    request.marketId = marketId;
+    request.body = CancelOrdersRequest(marketId, instructions).toString();
+    return request;
+}
+
+}
+}
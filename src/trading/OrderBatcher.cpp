@@ -0,0 +1,308 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <unordered_set>
+
+#include "greentop/trading/OrderBatcher.h"
+#include "greentop/trading/Support.h"
+
+namespace greentop {
+namespace trading {
+
+const unsigned OrderBatcher::MAX_INSTRUCTIONS;
+
+OrderBatcher::OrderBatcher(const ExchangeApi& exchangeApi, unsigned maxInFlight) :
+    exchangeApi(exchangeApi),
+    maxInFlight(std::max(1u, maxInFlight)),
+    maxDelay(500),
+    maxInstructions(MAX_INSTRUCTIONS),
+    intake(NULL),
+    nextRef(0),
+    running(false),
+    requests(0),
+    instructions(0),
+    errors(0) {
+    refPrefix = getRefPrefix() + "-";
+}
+
+OrderBatcher::~OrderBatcher() {
+    stop();
+}
+
+void OrderBatcher::setMaxDelay(const std::chrono::microseconds& maxDelay) {
+    this->maxDelay = maxDelay.count();
+}
+
+void OrderBatcher::setMaxInstructions(unsigned maxInstructions) {
+    this->maxInstructions = std::max(1u, std::min(maxInstructions, MAX_INSTRUCTIONS));
+}
+
+std::future<PlaceInstructionReport> OrderBatcher::submit(const std::string& marketId,
+        const PlaceInstruction& placeInstruction, const std::string& customerStrategyRef) {
+    std::shared_ptr<std::promise<PlaceInstructionReport>> promise(new std::promise<PlaceInstructionReport>());
+    std::future<PlaceInstructionReport> future = promise->get_future();
+    submit(marketId, placeInstruction, customerStrategyRef, [promise](const PlaceInstructionReport& report) {
+        promise->set_value(report);
+    });
+    return future;
+}
+
+void OrderBatcher::submit(const std::string& marketId, const PlaceInstruction& placeInstruction,
+        const std::string& customerStrategyRef, const Callback& callback) {
+    Node* node = new Node();
+    node->marketId = marketId;
+    node->customerStrategyRef = customerStrategyRef;
+    node->instruction = placeInstruction;
+    if (placeInstruction.getCustomerOrderRef().empty()) {
+        std::ostringstream ref;
+        ref << refPrefix << std::hex << nextRef++;
+        node->instruction.setCustomerOrderRef(ref.str());
+    }
+    node->callback = callback;
+    node->submitted = Clock::now();
+    push(node);
+}
+
+void OrderBatcher::push(Node* node) {
+    node->next = intake.load(std::memory_order_relaxed);
+    while (!intake.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    if (node->next == NULL) {
+        // the batching thread may be waiting for the intake to become non-empty.
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_one();
+    }
+}
+
+void OrderBatcher::drain() {
+    Node* node = intake.exchange(NULL, std::memory_order_acquire);
+
+    // the intake is newest first
+    std::vector<Node*> nodes;
+    for (; node != NULL; node = node->next) {
+        nodes.push_back(node);
+    }
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+        Node* node = *it;
+        Batch& batch = batches[node->marketId + '\0' + node->customerStrategyRef];
+        if (batch.nodes.empty()) {
+            batch.marketId = node->marketId;
+            batch.customerStrategyRef = node->customerStrategyRef;
+            batch.first = node->submitted;
+        }
+        batch.nodes.push_back(node);
+    }
+}
+
+unsigned OrderBatcher::flush() {
+    std::vector<Batch> requests;
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        drain();
+        Clock::time_point next;
+        take(true, next, requests);
+    }
+    {
+        // requests the background thread cut but no sender has taken yet, eg after stop()
+        std::lock_guard<std::mutex> lock(mutex);
+        std::move(outgoing.begin(), outgoing.end(), std::back_inserter(requests));
+        outgoing.clear();
+    }
+    for (const Batch& request : requests) {
+        send(request);
+    }
+    return static_cast<unsigned>(requests.size());
+}
+
+void OrderBatcher::take(bool all, Clock::time_point& next, std::vector<Batch>& requests) {
+    Clock::time_point now = Clock::now();
+    std::chrono::microseconds delay(maxDelay.load());
+    next = Clock::time_point::max();
+    for (auto it = batches.begin(); it != batches.end();) {
+        Batch& batch = it->second;
+        while (!batch.nodes.empty() &&
+            (all || batch.nodes.size() >= maxInstructions || now - batch.first >= delay)) {
+            requests.push_back(take(batch));
+        }
+        if (batch.nodes.empty()) {
+            it = batches.erase(it);
+        } else {
+            next = std::min(next, batch.first + delay);
+            ++it;
+        }
+    }
+}
+
+OrderBatcher::Batch OrderBatcher::take(Batch& batch) {
+    // an instruction whose ref is already in the request waits for the next one, so reports can't be confused
+    std::unordered_set<std::string> refs;
+    size_t count = 0;
+    for (; count < batch.nodes.size() && count < maxInstructions; ++count) {
+        if (!refs.insert(batch.nodes[count]->instruction.getCustomerOrderRef()).second) {
+            break;
+        }
+    }
+    Batch request;
+    request.marketId = batch.marketId;
+    request.customerStrategyRef = batch.customerStrategyRef;
+    request.first = batch.first;
+    request.nodes.assign(batch.nodes.begin(), batch.nodes.begin() + count);
+    batch.nodes.erase(batch.nodes.begin(), batch.nodes.begin() + count);
+    if (!batch.nodes.empty()) {
+        batch.first = batch.nodes.front()->submitted;
+    }
+    return request;
+}
+
+void OrderBatcher::send(const Batch& request) {
+    static const InstructionReportStatus failure(InstructionReportStatus::FAILURE);
+    static const InstructionReportStatus timeout(InstructionReportStatus::TIMEOUT);
+    static const InstructionReportErrorCode relatedActionFailed(InstructionReportErrorCode::RELATED_ACTION_FAILED);
+    static const ExecutionReportStatus executionTimeout(ExecutionReportStatus::TIMEOUT);
+
+    const std::vector<Node*>& nodes = request.nodes;
+    size_t count = nodes.size();
+    std::unordered_map<std::string, size_t> refs;
+    std::vector<PlaceInstruction> placeInstructions;
+    for (size_t i = 0; i < count; ++i) {
+        refs[nodes[i]->instruction.getCustomerOrderRef()] = i;
+        placeInstructions.push_back(nodes[i]->instruction);
+    }
+
+    PlaceOrdersRequest placeOrdersRequest(request.marketId, placeInstructions, "", MarketVersion(),
+        request.customerStrategyRef);
+    ++requests;
+    instructions += count;
+    PlaceExecutionReport report;
+    bool reached = true;
+    try {
+        report = exchangeApi.placeOrders(placeOrdersRequest);
+        if (!report.isSuccess()) {
+            ++errors;
+        }
+    } catch (const std::exception&) {
+        ++errors;
+        reached = false;
+    }
+
+    std::vector<bool> done(count, false);
+    const std::vector<PlaceInstructionReport>& reports = report.getInstructionReports();
+    for (size_t i = 0; i < reports.size(); ++i) {
+        auto ref = refs.find(reports[i].getInstruction().getCustomerOrderRef());
+        // reports are in the order of the instructions, should the exchange not echo a ref
+        size_t index = ref != refs.end() ? ref->second : i;
+        if (index < count && !done[index]) {
+            done[index] = true;
+            nodes[index]->callback(reports[i]);
+        }
+    }
+
+    bool unknown = !reached || (report.getStatus().isValid() && report.getStatus() == executionTimeout);
+    for (size_t i = 0; i < count; ++i) {
+        if (!done[i]) {
+            PlaceInstructionReport failed(unknown ? timeout : failure,
+                unknown ? InstructionReportErrorCode() : relatedActionFailed, OrderStatus(), nodes[i]->instruction);
+            nodes[i]->callback(failed);
+        }
+        delete nodes[i];
+    }
+}
+
+void OrderBatcher::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        thread = std::thread(&OrderBatcher::run, this);
+        for (unsigned i = 0; i < maxInFlight; ++i) {
+            senders.push_back(std::thread(&OrderBatcher::runSender, this));
+        }
+    }
+}
+
+void OrderBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    // the senders finish the requests already cut before they stop
+    sendCondition.notify_all();
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+    senders.clear();
+    flush();
+}
+
+void OrderBatcher::run() {
+    while (true) {
+        Clock::time_point next;
+        std::vector<Batch> ready;
+        {
+            std::lock_guard<std::mutex> lock(sendMutex);
+            drain();
+            take(false, next, ready);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!ready.empty()) {
+            std::move(ready.begin(), ready.end(), std::back_inserter(outgoing));
+            sendCondition.notify_all();
+        }
+        if (!running) {
+            break;
+        }
+        condition.wait_until(lock, std::min(next, Clock::now() + std::chrono::seconds(1)), [this]() {
+            return !running || intake.load(std::memory_order_relaxed) != NULL;
+        });
+        if (!running) {
+            break;
+        }
+    }
+}
+
+void OrderBatcher::runSender() {
+    while (true) {
+        Batch request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            sendCondition.wait(lock, [this]() {
+                return !running || !outgoing.empty();
+            });
+            if (outgoing.empty()) {
+                break;
+            }
+            request = std::move(outgoing.front());
+            outgoing.pop_front();
+        }
+        send(request);
+    }
+}
+
+uint64_t OrderBatcher::getRequests() const {
+    return requests;
+}
+
+uint64_t OrderBatcher::getInstructions() const {
+    return instructions;
+}
+
+uint64_t OrderBatcher::getErrors() const {
+    return errors;
+}
+
+void OrderBatcher::resetCounters() {
+    requests = 0;
+    instructions = 0;
+    errors = 0;
+}
+
+}
+}
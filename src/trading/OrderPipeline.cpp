@@ -0,0 +1,329 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include "greentop/trading/OrderPipeline.h"
+#include "greentop/trading/Support.h"
+
+namespace greentop {
+namespace trading {
+
+const size_t OrderPipeline::MAX_REFS;
+
+OrderPipeline::OrderPipeline(const ExchangeApi& exchangeApi, unsigned maxInFlight) :
+    exchangeApi(exchangeApi),
+    async(true),
+    resolveTimeout(30000),
+    refPrefix(getRefPrefix()),
+    nextRef(0),
+    stopping(false) {
+    for (unsigned i = 0; i < std::max(1u, maxInFlight); ++i) {
+        threads.push_back(std::thread(&OrderPipeline::run, this));
+    }
+}
+
+OrderPipeline::~OrderPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        it->second->promise.set_value(resolve(*it->second, EXPIRED, now));
+    }
+    pending.clear();
+}
+
+void OrderPipeline::setAsync(bool async) {
+    this->async = async;
+}
+
+void OrderPipeline::setResolveTimeout(const std::chrono::milliseconds& resolveTimeout) {
+    this->resolveTimeout = resolveTimeout.count();
+}
+
+std::string OrderPipeline::generateRef(const char* kind) {
+    std::ostringstream ref;
+    ref << refPrefix << kind << std::hex << nextRef++;
+    return ref.str();
+}
+
+OrderPipeline::Handle OrderPipeline::place(const std::string& marketId, const PlaceInstruction& placeInstruction,
+        const std::string& customerStrategyRef) {
+    return place(marketId, std::vector<PlaceInstruction>(1, placeInstruction), customerStrategyRef).front();
+}
+
+std::vector<OrderPipeline::Handle> OrderPipeline::place(const std::string& marketId,
+        const std::vector<PlaceInstruction>& placeInstructions, const std::string& customerStrategyRef) {
+    Request request;
+    request.marketId = marketId;
+    request.customerRef = generateRef("r");
+    request.customerStrategyRef = customerStrategyRef;
+    request.instructions = placeInstructions;
+    std::set<std::string> refs;
+    for (PlaceInstruction& instruction : request.instructions) {
+        if (instruction.getCustomerOrderRef().empty()) {
+            instruction.setCustomerOrderRef(generateRef("-"));
+        }
+        if (!refs.insert(instruction.getCustomerOrderRef()).second) {
+            throw std::runtime_error("customerOrderRef " + instruction.getCustomerOrderRef() + " is repeated");
+        }
+    }
+
+    // requests are sent from the pipeline's threads, so they carry the caller's trace context with them
+    const std::shared_ptr<RequestHook>& hook = exchangeApi.getRequestHook();
+    if (hook) {
+        request.context = RequestHook::getContext();
+    }
+
+    std::vector<Handle> handles;
+    Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::string& ref : refs) {
+            if (pending.count(ref) > 0) {
+                throw std::runtime_error("customerOrderRef " + ref + " is already pending");
+            }
+        }
+        for (const PlaceInstruction& instruction : request.instructions) {
+            std::shared_ptr<Order> order = std::make_shared<Order>();
+            order->marketId = marketId;
+            order->customerOrderRef = instruction.getCustomerOrderRef();
+            order->customerRef = request.customerRef;
+            order->placed = now;
+            order->isSent = false;
+            order->isAcknowledged = false;
+            pending[order->customerOrderRef] = order;
+
+            Handle handle;
+            handle.customerOrderRef = order->customerOrderRef;
+            handle.customerRef = request.customerRef;
+            handle.result = order->promise.get_future().share();
+            handles.push_back(handle);
+        }
+        queue.push_back(request);
+    }
+    condition.notify_one();
+    if (hook) {
+        hook->onEvent(RequestHook::ENQUEUED, "placeOrders", now, request.context);
+    }
+    return handles;
+}
+
+void OrderPipeline::run() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() {
+                return stopping || !queue.empty();
+            });
+            if (queue.empty()) {
+                return;
+            }
+            request = queue.front();
+            queue.pop_front();
+        }
+        send(request);
+    }
+}
+
+void OrderPipeline::send(const Request& request) {
+    static const ExecutionReportStatus executionFailure(ExecutionReportStatus::FAILURE);
+    static const InstructionReportStatus failure(InstructionReportStatus::FAILURE);
+    static const InstructionReportStatus timeout(InstructionReportStatus::TIMEOUT);
+    RequestHook::Scope scope(request.context);
+
+    Clock::time_point sent = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const PlaceInstruction& instruction : request.instructions) {
+            auto it = pending.find(instruction.getCustomerOrderRef());
+            if (it != pending.end()) {
+                it->second->sent = sent;
+                it->second->isSent = true;
+            }
+        }
+    }
+
+    PlaceOrdersRequest placeOrdersRequest(request.marketId, request.instructions, request.customerRef,
+        MarketVersion(), request.customerStrategyRef, async ? Optional<bool>(true) : Optional<bool>());
+    PlaceExecutionReport report;
+    try {
+        report = exchangeApi.placeOrders(placeOrdersRequest);
+    } catch (const std::exception&) {
+        // it isn't known whether the orders were placed, so they stay pending for poll() to find.
+        return;
+    }
+    Clock::time_point now = Clock::now();
+
+    std::unordered_map<std::string, const PlaceInstructionReport*> reports;
+    const std::vector<PlaceInstructionReport>& instructionReports = report.getInstructionReports();
+    for (const PlaceInstructionReport& instructionReport : instructionReports) {
+        reports[instructionReport.getInstruction().getCustomerOrderRef()] = &instructionReport;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < request.instructions.size(); ++i) {
+        auto it = pending.find(request.instructions[i].getCustomerOrderRef());
+        if (it == pending.end()) {
+            // an order update got here first
+            continue;
+        }
+        Order& order = *it->second;
+        order.acknowledged = now;
+        order.isAcknowledged = true;
+
+        auto byRef = reports.find(order.customerOrderRef);
+        const PlaceInstructionReport* instructionReport = byRef != reports.end() ? byRef->second :
+            i < instructionReports.size() ? &instructionReports[i] : NULL;
+
+        Result result;
+        if (!report.isSuccess()) {
+            result = resolve(order, EXECUTION_REPORT, now);
+            result.errorCode = report.getFaultString();
+        } else if (instructionReport == NULL) {
+            if (report.getStatus() != executionFailure) {
+                continue;
+            }
+            result = resolve(order, EXECUTION_REPORT, now);
+            result.errorCode = report.getErrorCode().getValue();
+        } else if (instructionReport->getStatus() == failure) {
+            result = resolve(order, EXECUTION_REPORT, now);
+            result.errorCode = instructionReport->getErrorCode().getValue();
+        } else if (instructionReport->getStatus() == timeout || instructionReport->getBetId().empty()) {
+            // placed asynchronously, or it isn't known whether it was placed
+            continue;
+        } else {
+            result = resolve(order, EXECUTION_REPORT, now);
+            result.success = true;
+            result.betId = instructionReport->getBetId();
+            result.orderStatus = instructionReport->getOrderStatus();
+            result.sizeMatched = getOrZero(instructionReport->getSizeMatched());
+            result.averagePriceMatched = getOrZero(instructionReport->getAveragePriceMatched());
+        }
+        order.promise.set_value(result);
+        pending.erase(it);
+    }
+}
+
+OrderPipeline::Result OrderPipeline::resolve(Order& order, Source source, Clock::time_point now) const {
+    Result result;
+    result.marketId = order.marketId;
+    result.customerOrderRef = order.customerOrderRef;
+    result.customerRef = order.customerRef;
+    result.source = source;
+    result.success = false;
+    result.sizeMatched = 0;
+    result.averagePriceMatched = 0;
+    result.queueTime = order.isSent ? order.sent - order.placed : std::chrono::nanoseconds(0);
+    result.acknowledgeTime = order.isAcknowledged ? order.acknowledged - order.placed : std::chrono::nanoseconds(0);
+    result.latency = now - order.placed;
+    return result;
+}
+
+bool OrderPipeline::resolve(const CurrentOrderSummary& currentOrderSummary, Source source) {
+    auto it = pending.find(currentOrderSummary.getCustomerOrderRef());
+    if (it == pending.end() || it->second->marketId != currentOrderSummary.getMarketId()) {
+        return false;
+    }
+    Result result = resolve(*it->second, source, Clock::now());
+    result.success = true;
+    result.betId = currentOrderSummary.getBetId();
+    result.orderStatus = currentOrderSummary.getStatus();
+    result.sizeMatched = getOrZero(currentOrderSummary.getSizeMatched());
+    result.averagePriceMatched = getOrZero(currentOrderSummary.getAveragePriceMatched());
+    it->second->promise.set_value(result);
+    pending.erase(it);
+    return true;
+}
+
+void OrderPipeline::apply(const CurrentOrderSummary& currentOrderSummary) {
+    std::lock_guard<std::mutex> lock(mutex);
+    resolve(currentOrderSummary, ORDER_UPDATE);
+}
+
+void OrderPipeline::apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const CurrentOrderSummary& currentOrderSummary : currentOrderSummaries) {
+        if (pending.empty()) {
+            break;
+        }
+        resolve(currentOrderSummary, ORDER_UPDATE);
+    }
+}
+
+void OrderPipeline::apply(const stream::OrderCache& orderCache, const std::vector<std::string>& marketIds) {
+    if (getPending() == 0) {
+        return;
+    }
+    for (const std::string& marketId : marketIds) {
+        apply(orderCache.getCurrentOrders(marketId));
+    }
+}
+
+unsigned OrderPipeline::poll() {
+    std::vector<std::set<std::string>> chunks;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = pending.begin(); it != pending.end(); ++it) {
+            if (!it->second->isSent) {
+                continue;
+            }
+            if (chunks.empty() || chunks.back().size() >= MAX_REFS) {
+                chunks.push_back(std::set<std::string>());
+            }
+            chunks.back().insert(it->first);
+        }
+    }
+
+    // orders resolved by other threads meanwhile aren't counted
+    unsigned resolved = 0;
+    for (const std::set<std::string>& refs : chunks) {
+        ListCurrentOrdersRequest request;
+        request.setCustomerOrderRefs(refs);
+        CurrentOrderSummaryReport report = exchangeApi.listCurrentOrders(request);
+        if (!report.isSuccess()) {
+            throw std::runtime_error("listCurrentOrders failed: " + report.getFaultString());
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const CurrentOrderSummary& currentOrderSummary : report.getCurrentOrders()) {
+            if (resolve(currentOrderSummary, POLL)) {
+                ++resolved;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    std::chrono::milliseconds timeout(resolveTimeout.load());
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it->second->isSent && now - it->second->placed >= timeout) {
+            it->second->promise.set_value(resolve(*it->second, EXPIRED, now));
+            it = pending.erase(it);
+            ++resolved;
+        } else {
+            ++it;
+        }
+    }
+    return resolved;
+}
+
+size_t OrderPipeline::getPending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+}
+}
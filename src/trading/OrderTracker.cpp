@@ -0,0 +1,428 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include "greentop/Time.h"
+#include "greentop/trading/OrderTracker.h"
+#include "greentop/trading/Support.h"
+
+namespace greentop {
+namespace trading {
+
+namespace {
+
+// sizes are in hundredths, so anything smaller is rounding
+const double EPSILON = 1e-6;
+
+}
+
+const unsigned OrderTracker::MAX_BET_IDS;
+const unsigned OrderTracker::MAX_RECORDS;
+
+OrderTracker::OrderTracker() : overlap(10), lastSync(0) {
+}
+
+void OrderTracker::setOverlap(const std::chrono::seconds& overlap) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->overlap = overlap;
+}
+
+void OrderTracker::apply(const PlaceExecutionReport& placeExecutionReport, const std::string& customerStrategyRef) {
+    const std::vector<PlaceInstructionReport>& reports = placeExecutionReport.getInstructionReports();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = reports.begin(); it != reports.end(); ++it) {
+        add(placeExecutionReport.getMarketId(), *it, customerStrategyRef);
+    }
+}
+
+void OrderTracker::apply(const std::string& marketId, const PlaceInstructionReport& placeInstructionReport,
+        const std::string& customerStrategyRef) {
+    std::lock_guard<std::mutex> lock(mutex);
+    add(marketId, placeInstructionReport, customerStrategyRef);
+}
+
+void OrderTracker::apply(const CancelExecutionReport& cancelExecutionReport) {
+    const std::vector<CancelInstructionReport>& reports = cancelExecutionReport.getInstructionReports();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = reports.begin(); it != reports.end(); ++it) {
+        cancel(*it);
+    }
+}
+
+void OrderTracker::apply(const CancelInstructionReport& cancelInstructionReport) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancel(cancelInstructionReport);
+}
+
+void OrderTracker::apply(const ReplaceExecutionReport& replaceExecutionReport) {
+    const std::vector<ReplaceInstructionReport>& reports = replaceExecutionReport.getInstructionReports();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = reports.begin(); it != reports.end(); ++it) {
+        const CancelInstructionReport& cancelReport = it->getCancelInstructionReport();
+        std::string marketId = replaceExecutionReport.getMarketId();
+        std::string customerStrategyRef;
+        auto order = orders.find(cancelReport.getInstruction().getBetId());
+        if (order != orders.end()) {
+            marketId = order->second.getMarketId();
+            customerStrategyRef = order->second.getCustomerStrategyRef();
+        }
+        cancel(cancelReport);
+        add(marketId, it->getPlaceInstructionReport(), customerStrategyRef);
+    }
+}
+
+void OrderTracker::apply(const UpdateExecutionReport& updateExecutionReport) {
+    const std::vector<UpdateInstructionReport>& reports = updateExecutionReport.getInstructionReports();
+    for (auto it = reports.begin(); it != reports.end(); ++it) {
+        apply(*it);
+    }
+}
+
+void OrderTracker::apply(const UpdateInstructionReport& updateInstructionReport) {
+    static const InstructionReportStatus success(InstructionReportStatus::SUCCESS);
+    const UpdateInstruction& instruction = updateInstructionReport.getInstruction();
+    if (!updateInstructionReport.getStatus().isValid() || updateInstructionReport.getStatus() != success ||
+        !instruction.getNewPersistenceType().isValid()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto order = orders.find(instruction.getBetId());
+    if (order != orders.end()) {
+        order->second.setPersistenceType(instruction.getNewPersistenceType());
+    }
+}
+
+void OrderTracker::apply(const CurrentOrderSummary& currentOrderSummary) {
+    std::lock_guard<std::mutex> lock(mutex);
+    update(currentOrderSummary);
+}
+
+void OrderTracker::apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = currentOrderSummaries.begin(); it != currentOrderSummaries.end(); ++it) {
+        update(*it);
+    }
+}
+
+unsigned OrderTracker::sync(const ExchangeApi& exchangeApi) {
+    static const OrderBy byPlaceTime(OrderBy::BY_PLACE_TIME);
+    time_t start = time(NULL);
+    time_t since;
+    std::vector<std::string> betIds;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        since = lastSync > 0 ? lastSync - static_cast<time_t>(overlap.count()) : 0;
+        betIds.assign(executable.begin(), executable.end());
+    }
+
+    unsigned changed = 0;
+    if (since == 0) {
+        changed += fetch(exchangeApi, ListCurrentOrdersRequest());
+    } else {
+        // orders placed since the last sync, whoever placed them
+        ListCurrentOrdersRequest request;
+        request.setDateRange(TimeRange(fromTime(since)));
+        request.setOrderBy(byPlaceTime);
+        changed += fetch(exchangeApi, request);
+
+        // and the orders that could have been matched, cancelled or lapsed since
+        for (size_t i = 0; i < betIds.size(); i += MAX_BET_IDS) {
+            size_t end = std::min(betIds.size(), i + MAX_BET_IDS);
+            changed += fetch(exchangeApi,
+                ListCurrentOrdersRequest(std::set<std::string>(betIds.begin() + i, betIds.begin() + end)));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lastSync = start;
+    return changed;
+}
+
+unsigned OrderTracker::fetch(const ExchangeApi& exchangeApi, const ListCurrentOrdersRequest& request) {
+    ListCurrentOrdersRequest page(request);
+    page.setRecordCount(static_cast<int32_t>(MAX_RECORDS));
+    int32_t fromRecord = 0;
+    unsigned changed = 0;
+    while (true) {
+        page.setFromRecord(fromRecord);
+        CurrentOrderSummaryReport report = exchangeApi.listCurrentOrders(page);
+        if (!report.isSuccess()) {
+            throw std::runtime_error("listCurrentOrders failed: " + report.getFaultString());
+        }
+        const std::vector<CurrentOrderSummary>& currentOrders = report.getCurrentOrders();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = currentOrders.begin(); it != currentOrders.end(); ++it) {
+                if (update(*it)) {
+                    ++changed;
+                }
+            }
+        }
+        if (currentOrders.empty() || !report.getMoreAvailable().isValid() || !report.getMoreAvailable().getValue()) {
+            break;
+        }
+        fromRecord += static_cast<int32_t>(currentOrders.size());
+    }
+    return changed;
+}
+
+bool OrderTracker::getOrder(const std::string& betId, CurrentOrderSummary& currentOrderSummary) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto order = orders.find(betId);
+    if (order == orders.end()) {
+        return false;
+    }
+    currentOrderSummary = order->second;
+    return true;
+}
+
+bool OrderTracker::getOrderByCustomerOrderRef(const std::string& customerOrderRef,
+        CurrentOrderSummary& currentOrderSummary) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto betId = customerOrderRefs.find(customerOrderRef);
+    if (betId == customerOrderRefs.end()) {
+        return false;
+    }
+    auto order = orders.find(betId->second);
+    if (order == orders.end()) {
+        return false;
+    }
+    currentOrderSummary = order->second;
+    return true;
+}
+
+std::vector<CurrentOrderSummary> OrderTracker::getOrders(const std::string& marketId) const {
+    std::vector<CurrentOrderSummary> result;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto betIds = markets.find(marketId);
+    if (betIds != markets.end()) {
+        for (auto it = betIds->second.begin(); it != betIds->second.end(); ++it) {
+            result.push_back(orders.find(*it)->second);
+        }
+    }
+    return result;
+}
+
+std::vector<CurrentOrderSummary> OrderTracker::getOrders(const std::string& marketId, int64_t selectionId,
+        const Side& side, double handicap) const {
+    return getRunnerOrders(getRunnerKey(marketId, selectionId, handicap, side), false);
+}
+
+std::vector<CurrentOrderSummary> OrderTracker::getExecutableOrders(const std::string& marketId,
+        int64_t selectionId, const Side& side, double handicap) const {
+    return getRunnerOrders(getRunnerKey(marketId, selectionId, handicap, side), true);
+}
+
+std::vector<CurrentOrderSummary> OrderTracker::getRunnerOrders(const std::string& runnerKey,
+        bool executableOnly) const {
+    std::vector<CurrentOrderSummary> result;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto betIds = runners.find(runnerKey);
+    if (betIds != runners.end()) {
+        for (auto it = betIds->second.begin(); it != betIds->second.end(); ++it) {
+            if (!executableOnly || executable.count(*it) > 0) {
+                result.push_back(orders.find(*it)->second);
+            }
+        }
+    }
+    return result;
+}
+
+void OrderTracker::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto betIds = markets.find(marketId);
+    if (betIds == markets.end()) {
+        return;
+    }
+    for (auto it = betIds->second.begin(); it != betIds->second.end(); ++it) {
+        auto order = orders.find(*it);
+        const CurrentOrderSummary& o = order->second;
+        runners.erase(getRunnerKey(marketId, o.getSelectionId().getValue(), getOrZero(o.getHandicap()), o.getSide()));
+        auto ref = customerOrderRefs.find(o.getCustomerOrderRef());
+        if (ref != customerOrderRefs.end() && ref->second == *it) {
+            customerOrderRefs.erase(ref);
+        }
+        executable.erase(*it);
+        reportedCancels.erase(*it);
+        orders.erase(order);
+    }
+    markets.erase(betIds);
+}
+
+void OrderTracker::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    orders.clear();
+    customerOrderRefs.clear();
+    markets.clear();
+    runners.clear();
+    executable.clear();
+    reportedCancels.clear();
+    lastSync = 0;
+}
+
+size_t OrderTracker::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return orders.size();
+}
+
+std::string OrderTracker::getRunnerKey(const std::string& marketId, int64_t selectionId, double handicap,
+        const Side& side) {
+    static const Side back(Side::BACK);
+    std::ostringstream key;
+    key << marketId << ' ' << selectionId << ' ' << handicap + 0.0 << ' ' << (side == back ? 'B' : 'L');
+    return key.str();
+}
+
+double OrderTracker::getProgress(const CurrentOrderSummary& order) {
+    return getOrZero(order.getSizeMatched()) + getOrZero(order.getSizeCancelled()) +
+        getOrZero(order.getSizeLapsed()) + getOrZero(order.getSizeVoided());
+}
+
+bool OrderTracker::update(const CurrentOrderSummary& currentOrderSummary) {
+    static const OrderStatus executionComplete(OrderStatus::EXECUTION_COMPLETE);
+    const std::string& betId = currentOrderSummary.getBetId();
+    if (betId.empty() || currentOrderSummary.getMarketId().empty() ||
+        !currentOrderSummary.getSelectionId().isValid()) {
+        return false;
+    }
+
+    auto inserted = orders.insert(std::make_pair(betId, currentOrderSummary));
+    CurrentOrderSummary& order = inserted.first->second;
+    if (inserted.second) {
+        markets[order.getMarketId()].push_back(betId);
+        runners[getRunnerKey(order.getMarketId(), order.getSelectionId().getValue(),
+            getOrZero(order.getHandicap()), order.getSide())].push_back(betId);
+    } else {
+        // never go back to an earlier state
+        double progress = getProgress(order);
+        double newProgress = getProgress(currentOrderSummary);
+        bool complete = order.getStatus().isValid() && order.getStatus() == executionComplete;
+        bool newComplete = currentOrderSummary.getStatus().isValid() &&
+            currentOrderSummary.getStatus() == executionComplete;
+        if (newProgress < progress - EPSILON || (newProgress < progress + EPSILON && complete && !newComplete)) {
+            return false;
+        }
+        bool changed = std::fabs(newProgress - progress) >= EPSILON || complete != newComplete ||
+            getOrZero(order.getAveragePriceMatched()) != getOrZero(currentOrderSummary.getAveragePriceMatched()) ||
+            getOrZero(order.getSizeRemaining()) != getOrZero(currentOrderSummary.getSizeRemaining()) ||
+            order.getPersistenceType() != currentOrderSummary.getPersistenceType();
+        std::string customerOrderRef = order.getCustomerOrderRef();
+        std::string customerStrategyRef = order.getCustomerStrategyRef();
+        order = currentOrderSummary;
+        if (order.getCustomerOrderRef().empty()) {
+            order.setCustomerOrderRef(customerOrderRef);
+        }
+        if (order.getCustomerStrategyRef().empty()) {
+            order.setCustomerStrategyRef(customerStrategyRef);
+        }
+        if (!changed) {
+            return false;
+        }
+    }
+
+    if (!order.getCustomerOrderRef().empty()) {
+        customerOrderRefs[order.getCustomerOrderRef()] = betId;
+    }
+    if (order.getStatus().isValid() && order.getStatus() == executionComplete) {
+        executable.erase(betId);
+    } else {
+        executable.insert(betId);
+    }
+    return true;
+}
+
+void OrderTracker::add(const std::string& marketId, const PlaceInstructionReport& placeInstructionReport,
+        const std::string& customerStrategyRef) {
+    static const InstructionReportStatus success(InstructionReportStatus::SUCCESS);
+    static const OrderType limit(OrderType::LIMIT);
+    static const OrderType limitOnClose(OrderType::LIMIT_ON_CLOSE);
+    static const OrderStatus executableStatus(OrderStatus::EXECUTABLE);
+    static const OrderStatus executionComplete(OrderStatus::EXECUTION_COMPLETE);
+    static const PersistenceType marketOnClose(PersistenceType::MARKET_ON_CLOSE);
+
+    const PlaceInstruction& instruction = placeInstructionReport.getInstruction();
+    if (!placeInstructionReport.getStatus().isValid() || placeInstructionReport.getStatus() != success ||
+        placeInstructionReport.getBetId().empty()) {
+        return;
+    }
+
+    PriceSize priceSize;
+    Optional<double> bspLiability;
+    PersistenceType persistenceType = marketOnClose;
+    double size = 0;
+    if (instruction.getOrderType() == limit) {
+        const LimitOrder& limitOrder = instruction.getLimitOrder();
+        size = getOrZero(limitOrder.getSize());
+        priceSize = PriceSize(limitOrder.getPrice(), limitOrder.getSize());
+        persistenceType = limitOrder.getPersistenceType();
+    } else if (instruction.getOrderType() == limitOnClose) {
+        priceSize = PriceSize(instruction.getLimitOnCloseOrder().getPrice(), Optional<double>());
+        bspLiability = instruction.getLimitOnCloseOrder().getLiability();
+    } else {
+        bspLiability = instruction.getMarketOnCloseOrder().getLiability();
+    }
+
+    OrderStatus status = placeInstructionReport.getOrderStatus().isValid() ?
+        placeInstructionReport.getOrderStatus() : executableStatus;
+    double sizeMatched = getOrZero(placeInstructionReport.getSizeMatched());
+    double unmatched = std::max(0.0, size - sizeMatched);
+    bool complete = status == executionComplete;
+
+    CurrentOrderSummary order(placeInstructionReport.getBetId(), marketId, instruction.getSelectionId(),
+        instruction.getHandicap(), priceSize, bspLiability, instruction.getSide(), status, persistenceType,
+        instruction.getOrderType(), placeInstructionReport.getPlacedDate(), std::tm(),
+        placeInstructionReport.getAveragePriceMatched(), sizeMatched, complete ? 0 : unmatched,
+        // an order that completes without being fully matched, eg fill or kill, has lapsed
+        complete ? unmatched : 0, 0.0, 0.0, std::string(), std::string(), instruction.getCustomerOrderRef(),
+        customerStrategyRef);
+    update(order);
+}
+
+void OrderTracker::cancel(const CancelInstructionReport& cancelInstructionReport) {
+    static const InstructionReportStatus success(InstructionReportStatus::SUCCESS);
+    static const OrderStatus executionComplete(OrderStatus::EXECUTION_COMPLETE);
+    if (!cancelInstructionReport.getStatus().isValid() || cancelInstructionReport.getStatus() != success) {
+        return;
+    }
+    const std::string& betId = cancelInstructionReport.getInstruction().getBetId();
+    auto it = orders.find(betId);
+    if (it == orders.end()) {
+        return;
+    }
+    CurrentOrderSummary& order = it->second;
+    double& reported = reportedCancels[betId];
+    reported += getOrZero(cancelInstructionReport.getSizeCancelled());
+    if (order.getStatus().isValid() && order.getStatus() == executionComplete) {
+        // an update has already caught up with the cancel, or with something that ended the order
+        return;
+    }
+
+    // the order may already reflect the cancel if an update got here first, so cancelled is the larger of what
+    // the order says and what has been reported, never the sum
+    double sizeCancelled = std::max(getOrZero(order.getSizeCancelled()), reported);
+    double sizeRemaining;
+    if (order.getPriceSize().getSize().isValid()) {
+        double unmatched = std::max(0.0, order.getPriceSize().getSize().getValue() -
+            getOrZero(order.getSizeMatched()) - getOrZero(order.getSizeLapsed()) - getOrZero(order.getSizeVoided()));
+        sizeCancelled = std::min(sizeCancelled, unmatched);
+        sizeRemaining = unmatched - sizeCancelled;
+    } else {
+        sizeRemaining = std::max(0.0,
+            getOrZero(order.getSizeRemaining()) - (sizeCancelled - getOrZero(order.getSizeCancelled())));
+    }
+    order.setSizeCancelled(sizeCancelled);
+    order.setSizeRemaining(sizeRemaining);
+    if (sizeRemaining < EPSILON) {
+        order.setStatus(executionComplete);
+        executable.erase(betId);
+    }
+}
+
+}
+}
@@ -0,0 +1,367 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+#include "greentop/trading/ProfitAndLossEngine.h"
+#include "greentop/trading/Support.h"
+
+namespace greentop {
+namespace trading {
+
+namespace {
+
+double roundToHundredths(double value) {
+    return std::round(value * 100) / 100;
+}
+
+}
+
+ProfitAndLossEngine::ProfitAndLossEngine() : netOfCommission(false) {
+}
+
+void ProfitAndLossEngine::setNetOfCommission(bool netOfCommission) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->netOfCommission = netOfCommission;
+}
+
+void ProfitAndLossEngine::setCommissionRate(const std::string& marketId, double rate) {
+    std::lock_guard<std::mutex> lock(mutex);
+    markets[marketId].commissionRate = rate;
+}
+
+void ProfitAndLossEngine::setMarketRates(const std::string& marketId, const MarketRates& marketRates,
+        double discountRate) {
+    double rate = getOrZero(marketRates.getMarketBaseRate());
+    if (marketRates.getDiscountAllowed().isValid() && marketRates.getDiscountAllowed().getValue()) {
+        rate *= 1 - discountRate / 100;
+    }
+    setCommissionRate(marketId, rate);
+}
+
+void ProfitAndLossEngine::setNumberOfWinners(const std::string& marketId, int32_t numberOfWinners) {
+    std::lock_guard<std::mutex> lock(mutex);
+    markets[marketId].numberOfWinners = numberOfWinners;
+}
+
+void ProfitAndLossEngine::updateBet(const std::string& marketId, const std::string& betId, int64_t selectionId,
+        double handicap, const Side& side, double sizeMatched, double averagePriceMatched) {
+    static const Side back(Side::BACK);
+    std::lock_guard<std::mutex> lock(mutex);
+    updateBet(marketId, betId, RunnerKey(selectionId, handicap + 0.0), side == back, sizeMatched,
+        averagePriceMatched);
+}
+
+void ProfitAndLossEngine::apply(const PlaceExecutionReport& placeExecutionReport) {
+    static const Side back(Side::BACK);
+    const std::vector<PlaceInstructionReport>& reports = placeExecutionReport.getInstructionReports();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = reports.begin(); it != reports.end(); ++it) {
+        const PlaceInstruction& instruction = it->getInstruction();
+        if (it->getBetId().empty() || !instruction.getSelectionId().isValid() ||
+            !it->getAveragePriceMatched().isValid()) {
+            continue;
+        }
+        RunnerKey runner(instruction.getSelectionId().getValue(), getOrZero(instruction.getHandicap()) + 0.0);
+        updateBet(placeExecutionReport.getMarketId(), it->getBetId(), runner, instruction.getSide() == back,
+            getOrZero(it->getSizeMatched()), it->getAveragePriceMatched().getValue());
+    }
+}
+
+void ProfitAndLossEngine::apply(const CurrentOrderSummary& currentOrderSummary) {
+    apply(std::vector<CurrentOrderSummary>(1, currentOrderSummary));
+}
+
+void ProfitAndLossEngine::apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries) {
+    static const Side back(Side::BACK);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = currentOrderSummaries.begin(); it != currentOrderSummaries.end(); ++it) {
+        if (!it->getSelectionId().isValid() || !it->getAveragePriceMatched().isValid()) {
+            continue;
+        }
+        RunnerKey runner(it->getSelectionId().getValue(), getOrZero(it->getHandicap()) + 0.0);
+        double size = std::max(0.0, getOrZero(it->getSizeMatched()) - getOrZero(it->getSizeVoided()));
+        updateBet(it->getMarketId(), it->getBetId(), runner, it->getSide() == back, size,
+            it->getAveragePriceMatched().getValue());
+    }
+}
+
+void ProfitAndLossEngine::apply(const MarketBook& marketBook) {
+    static const Side back(Side::BACK);
+    static const RunnerStatus removed(RunnerStatus::REMOVED);
+    const std::string& marketId = marketBook.getMarketId();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (marketBook.getNumberOfWinners().isValid()) {
+        markets[marketId].numberOfWinners = marketBook.getNumberOfWinners().getValue();
+    }
+    const std::vector<Runner>& runners = marketBook.getRunners();
+    for (auto it = runners.begin(); it != runners.end(); ++it) {
+        if (!it->getSelectionId().isValid()) {
+            continue;
+        }
+        RunnerKey runner(it->getSelectionId().getValue(), getOrZero(it->getHandicap()) + 0.0);
+        const std::vector<Order>& orders = it->getOrders();
+        for (auto order = orders.begin(); order != orders.end(); ++order) {
+            if (!order->getAvgPriceMatched().isValid()) {
+                continue;
+            }
+            double size = std::max(0.0, getOrZero(order->getSizeMatched()) - getOrZero(order->getSizeVoided()));
+            updateBet(marketId, order->getBetId(), runner, order->getSide() == back, size,
+                order->getAvgPriceMatched().getValue());
+        }
+        if (it->getStatus().isValid() && it->getStatus() == removed) {
+            voidRunner(marketId, runner);
+        }
+    }
+}
+
+void ProfitAndLossEngine::voidBet(const std::string& betId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto bet = bets.find(betId);
+    if (bet == bets.end() || bet->second.voided) {
+        return;
+    }
+    auto market = markets.find(bet->second.marketId);
+    if (market != markets.end()) {
+        auto runner = market->second.runners.find(bet->second.runner);
+        // a voided runner's position was already zeroed, with this bet in it
+        if (runner != market->second.runners.end() && !runner->second.voided) {
+            addBet(runner->second, bet->second, -1);
+        }
+    }
+    bet->second.size = 0;
+    bet->second.voided = true;
+}
+
+void ProfitAndLossEngine::voidRunner(const std::string& marketId, int64_t selectionId, double handicap) {
+    std::lock_guard<std::mutex> lock(mutex);
+    voidRunner(marketId, RunnerKey(selectionId, handicap + 0.0));
+}
+
+void ProfitAndLossEngine::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto market = markets.find(marketId);
+    if (market == markets.end()) {
+        return;
+    }
+    if (market->second.bets > 0) {
+        for (auto it = bets.begin(); it != bets.end();) {
+            if (it->second.marketId == marketId) {
+                it = bets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    markets.erase(market);
+}
+
+void ProfitAndLossEngine::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    markets.clear();
+    bets.clear();
+}
+
+std::vector<std::string> ProfitAndLossEngine::getMarketIds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> marketIds;
+    for (auto it = markets.begin(); it != markets.end(); ++it) {
+        if (it->second.bets > 0) {
+            marketIds.push_back(it->first);
+        }
+    }
+    return marketIds;
+}
+
+bool ProfitAndLossEngine::getProfitAndLoss(const std::string& marketId,
+        MarketProfitAndLoss& marketProfitAndLoss) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto market = markets.find(marketId);
+    if (market == markets.end() || market->second.bets == 0) {
+        return false;
+    }
+    getProfitAndLoss(marketId, market->second, marketProfitAndLoss, true);
+    return true;
+}
+
+std::vector<ProfitAndLossEngine::Discrepancy> ProfitAndLossEngine::reconcile(
+        const std::vector<MarketProfitAndLoss>& marketProfitAndLosses, double tolerance) const {
+    std::vector<Discrepancy> discrepancies;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto server = marketProfitAndLosses.begin(); server != marketProfitAndLosses.end(); ++server) {
+        const std::string& marketId = server->getMarketId();
+        std::map<int64_t, std::pair<double, double> > local;
+        auto market = markets.find(marketId);
+        if (market != markets.end()) {
+            MarketProfitAndLoss profitAndLoss;
+            getProfitAndLoss(marketId, market->second, profitAndLoss, false);
+            const std::vector<RunnerProfitAndLoss>& runners = profitAndLoss.getProfitAndLosses();
+            for (auto it = runners.begin(); it != runners.end(); ++it) {
+                local[it->getSelectionId().getValue()] = std::make_pair(getOrZero(it->getIfWin()),
+                    getOrZero(it->getIfLose()));
+            }
+        }
+
+        // a runner missing from either side has no profit or loss
+        std::set<int64_t> seen;
+        const std::vector<RunnerProfitAndLoss>& runners = server->getProfitAndLosses();
+        for (auto it = runners.begin(); it != runners.end(); ++it) {
+            if (!it->getSelectionId().isValid()) {
+                continue;
+            }
+            int64_t selectionId = it->getSelectionId().getValue();
+            seen.insert(selectionId);
+            std::pair<double, double> localValues = local.count(selectionId) ? local[selectionId] :
+                std::make_pair(0.0, 0.0);
+            Discrepancy discrepancy = {marketId, selectionId, localValues.first, getOrZero(it->getIfWin()),
+                localValues.second, getOrZero(it->getIfLose())};
+            if (std::fabs(discrepancy.localIfWin - discrepancy.serverIfWin) > tolerance ||
+                std::fabs(discrepancy.localIfLose - discrepancy.serverIfLose) > tolerance) {
+                discrepancies.push_back(discrepancy);
+            }
+        }
+        for (auto it = local.begin(); it != local.end(); ++it) {
+            if (seen.count(it->first) == 0 &&
+                (std::fabs(it->second.first) > tolerance || std::fabs(it->second.second) > tolerance)) {
+                Discrepancy discrepancy = {marketId, it->first, it->second.first, 0, it->second.second, 0};
+                discrepancies.push_back(discrepancy);
+            }
+        }
+    }
+    return discrepancies;
+}
+
+std::vector<ProfitAndLossEngine::Discrepancy> ProfitAndLossEngine::reconcile(const ExchangeApi& exchangeApi,
+        double tolerance) const {
+    std::vector<std::string> marketIds = getMarketIds();
+    if (marketIds.empty()) {
+        return std::vector<Discrepancy>();
+    }
+    bool net;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        net = netOfCommission;
+    }
+
+    ListMarketProfitAndLossRequest request(std::set<std::string>(marketIds.begin(), marketIds.end()), false, true,
+        net);
+    ListMarketProfitAndLossResponse response = exchangeApi.listMarketProfitAndLoss(request);
+    if (!response.isSuccess()) {
+        throw std::runtime_error("listMarketProfitAndLoss failed: " + response.getFaultString());
+    }
+
+    // markets the exchange knows nothing about are compared with no profit or loss
+    std::vector<MarketProfitAndLoss> marketProfitAndLosses = response.getMarketProfitAndLosses();
+    std::set<std::string> returned;
+    for (auto it = marketProfitAndLosses.begin(); it != marketProfitAndLosses.end(); ++it) {
+        returned.insert(it->getMarketId());
+    }
+    for (auto it = marketIds.begin(); it != marketIds.end(); ++it) {
+        if (returned.count(*it) == 0) {
+            marketProfitAndLosses.push_back(MarketProfitAndLoss(*it));
+        }
+    }
+    return reconcile(marketProfitAndLosses, tolerance);
+}
+
+void ProfitAndLossEngine::updateBet(const std::string& marketId, const std::string& betId,
+        const RunnerKey& runner, bool back, double size, double price) {
+    if (betId.empty()) {
+        return;
+    }
+    MarketPosition& market = markets[marketId];
+    auto inserted = bets.insert(std::make_pair(betId, BetPosition()));
+    BetPosition& bet = inserted.first->second;
+    if (inserted.second) {
+        BetPosition position = {marketId, runner, back, 0, 0, false};
+        bet = position;
+        ++market.bets;
+    }
+    if (bet.voided) {
+        return;
+    }
+
+    RunnerPosition& runnerPosition = market.runners[bet.runner];
+    if (runnerPosition.voided) {
+        return;
+    }
+    addBet(runnerPosition, bet, -1);
+    bet.size = size;
+    bet.price = price;
+    addBet(runnerPosition, bet, 1);
+}
+
+void ProfitAndLossEngine::voidRunner(const std::string& marketId, const RunnerKey& runner) {
+    MarketPosition& market = markets[marketId];
+    RunnerPosition& runnerPosition = market.runners[runner];
+    if (runnerPosition.voided) {
+        return;
+    }
+    runnerPosition.voided = true;
+    runnerPosition.ifWin = 0;
+    runnerPosition.ifLose = 0;
+}
+
+void ProfitAndLossEngine::addBet(RunnerPosition& runner, const BetPosition& bet, double sign) {
+    double win = sign * bet.size * (bet.price - 1);
+    double lose = sign * bet.size;
+    if (bet.back) {
+        runner.ifWin += win;
+        runner.ifLose -= lose;
+    } else {
+        runner.ifWin -= win;
+        runner.ifLose += lose;
+    }
+}
+
+void ProfitAndLossEngine::getProfitAndLoss(const std::string& marketId, const MarketPosition& market,
+        MarketProfitAndLoss& marketProfitAndLoss, bool round) const {
+    // with one winner, the market's profit if a runner wins is the bets on it winning and every other bet
+    // losing
+    double ifLoseTotal = 0;
+    if (market.numberOfWinners == 1) {
+        for (auto it = market.runners.begin(); it != market.runners.end(); ++it) {
+            if (!it->second.voided) {
+                ifLoseTotal += it->second.ifLose;
+            }
+        }
+    }
+
+    std::vector<RunnerProfitAndLoss> profitAndLosses;
+    for (auto it = market.runners.begin(); it != market.runners.end(); ++it) {
+        if (it->second.voided) {
+            continue;
+        }
+        RunnerProfitAndLoss profitAndLoss(it->first.first);
+        if (market.numberOfWinners == 1) {
+            // as the exchange does, ifLose is only given when more than one runner can win
+            double ifWin = netProfit(market, it->second.ifWin + ifLoseTotal - it->second.ifLose);
+            profitAndLoss.setIfWin(round ? roundToHundredths(ifWin) : ifWin);
+        } else {
+            double ifWin = netProfit(market, it->second.ifWin);
+            double ifLose = netProfit(market, it->second.ifLose);
+            profitAndLoss.setIfWin(round ? roundToHundredths(ifWin) : ifWin);
+            profitAndLoss.setIfLose(round ? roundToHundredths(ifLose) : ifLose);
+        }
+        profitAndLosses.push_back(profitAndLoss);
+    }
+
+    marketProfitAndLoss = MarketProfitAndLoss(marketId, Optional<double>(), profitAndLosses);
+    if (netOfCommission) {
+        marketProfitAndLoss.setCommissionApplied(market.commissionRate);
+    }
+}
+
+double ProfitAndLossEngine::netProfit(const MarketPosition& market, double profit) const {
+    if (netOfCommission && profit > 0) {
+        return profit * (1 - market.commissionRate / 100);
+    }
+    return profit;
+}
+
+}
+}
@@ -0,0 +1,720 @@
+/**
+ * Copyright 2026 Colin Doig.  Distributed under the MIT license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "greentop/trading/RiskEngine.h"
+#include "greentop/trading/Support.h"
+
+namespace greentop {
+namespace trading {
+
+namespace {
+
+/** Exposure changes smaller than this are rounding. */
+const double TOLERANCE = 1e-9;
+
+double getLimit(const Optional<double>& value) {
+    return value.isValid() ? std::fabs(value.getValue()) : HUGE_VAL;
+}
+
+/**
+ * Whether the changes held alongside a shared map should be merged into it: once there are more than the
+ * square root of its size, so that neither copying the changes nor merging them costs much per update.
+ */
+bool isMergeDue(size_t changes, size_t size) {
+    return changes > 16 && changes * changes > size;
+}
+
+}
+
+bool RiskEngine::Check::isAccepted() const {
+    return breach == NO_BREACH;
+}
+
+double RiskEngine::RunnerExposure::getIfWin(bool matched) const {
+    return matched ? matchedIfWin : matchedIfWin - unmatchedLay;
+}
+
+double RiskEngine::RunnerExposure::getIfLose(bool matched) const {
+    return matched ? matchedIfLose : matchedIfLose - unmatchedBack;
+}
+
+const RiskEngine::MarketExposure* RiskEngine::Snapshot::getMarket(const std::string& marketId) const {
+    if (!changedMarkets.empty()) {
+        auto changed = changedMarkets.find(marketId);
+        if (changed != changedMarkets.end()) {
+            return changed->second.get();
+        }
+    }
+    auto market = markets->find(marketId);
+    return market == markets->end() ? NULL : market->second.get();
+}
+
+void RiskEngine::Snapshot::setMarket(const std::string& marketId,
+        const std::shared_ptr<const MarketExposure>& market) {
+    changedMarkets[marketId] = market;
+    if (isMergeDue(changedMarkets.size(), markets->size())) {
+        std::shared_ptr<Markets> merged = std::make_shared<Markets>(*markets);
+        for (auto it = changedMarkets.begin(); it != changedMarkets.end(); ++it) {
+            if (it->second) {
+                (*merged)[it->first] = it->second;
+            } else {
+                merged->erase(it->first);
+            }
+        }
+        markets = merged;
+        changedMarkets.clear();
+    }
+}
+
+RiskEngine::Exposure RiskEngine::Snapshot::getGroup(int64_t eventId) const {
+    auto changed = changedGroups.find(eventId);
+    if (changed != changedGroups.end()) {
+        return changed->second;
+    }
+    auto group = groups->find(eventId);
+    return group == groups->end() ? Exposure() : group->second;
+}
+
+void RiskEngine::Snapshot::addToGroup(int64_t eventId, double matched, double total) {
+    Exposure group = getGroup(eventId);
+    group.matched += matched;
+    group.total += total;
+    changedGroups[eventId] = group;
+    if (isMergeDue(changedGroups.size(), groups->size())) {
+        std::shared_ptr<Groups> merged = std::make_shared<Groups>(*groups);
+        for (auto it = changedGroups.begin(); it != changedGroups.end(); ++it) {
+            (*merged)[it->first] = it->second;
+        }
+        groups = merged;
+        changedGroups.clear();
+    }
+}
+
+RiskEngine::RiskEngine() {
+    std::shared_ptr<Limits> limits = std::make_shared<Limits>();
+    limits->defaultLimit.matched = HUGE_VAL;
+    limits->defaultLimit.total = HUGE_VAL;
+    limits->marketLimit = HUGE_VAL;
+    limits->accountLimit = HUGE_VAL;
+    limits->availableToBet = HUGE_VAL;
+    limits->fundedExposure = 0;
+    std::shared_ptr<Snapshot> initial = std::make_shared<Snapshot>();
+    initial->markets = std::make_shared<Markets>();
+    initial->groups = std::make_shared<Groups>();
+    initial->limits = limits;
+    snapshot = initial;
+}
+
+std::shared_ptr<const RiskEngine::Snapshot> RiskEngine::load() const {
+    return std::atomic_load(&snapshot);
+}
+
+void RiskEngine::publish(const Snapshot& next) {
+    std::atomic_store(&snapshot, std::make_shared<const Snapshot>(next));
+}
+
+void RiskEngine::setEventId(const std::string& marketId, int64_t eventId) {
+    configure(marketId, eventId, 0, -1);
+}
+
+void RiskEngine::setNumberOfWinners(const std::string& marketId, int32_t numberOfWinners) {
+    configure(marketId, -1, numberOfWinners, -1);
+}
+
+void RiskEngine::setNumberOfRunners(const std::string& marketId, int32_t numberOfRunners) {
+    configure(marketId, -1, 0, numberOfRunners);
+}
+
+void RiskEngine::apply(const MarketCatalogue& marketCatalogue) {
+    const std::string& eventId = marketCatalogue.getEvent().getId();
+    configure(marketCatalogue.getMarketId(), eventId.empty() ? -1 : std::strtoll(eventId.c_str(), NULL, 10), 0,
+        static_cast<int32_t>(marketCatalogue.getRunners().size()));
+}
+
+void RiskEngine::apply(const MarketBook& marketBook) {
+    const Optional<int32_t>& numberOfWinners = marketBook.getNumberOfWinners();
+    const Optional<int32_t>& numberOfActiveRunners = marketBook.getNumberOfActiveRunners();
+    configure(marketBook.getMarketId(), -1, numberOfWinners.isValid() ? numberOfWinners.getValue() : 0,
+        numberOfActiveRunners.isValid() ? numberOfActiveRunners.getValue() : -1);
+}
+
+void RiskEngine::configure(const std::string& marketId, int64_t eventId, int32_t numberOfWinners,
+        int32_t numberOfRunners) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Snapshot next(*snapshot);
+    const MarketExposure* previous = next.getMarket(marketId);
+    std::shared_ptr<MarketExposure> market = previous ? std::make_shared<MarketExposure>(*previous) :
+        std::make_shared<MarketExposure>();
+    if (eventId >= 0) {
+        market->eventId = eventId;
+    }
+    if (numberOfWinners > 0) {
+        market->numberOfWinners = numberOfWinners;
+    }
+    if (numberOfRunners >= 0) {
+        market->numberOfRunners = numberOfRunners;
+    }
+    // take the market's exposure off its group, update() adds it to the group it is in now
+    if (previous) {
+        if (previous->eventId != 0) {
+            next.addToGroup(previous->eventId, -previous->matched.exposure, -previous->total.exposure);
+        }
+        next.account.matched -= previous->matched.exposure;
+        next.account.total -= previous->total.exposure;
+        market->matched.exposure = 0;
+        market->total.exposure = 0;
+    }
+    next.setMarket(marketId, market);
+    std::set<std::string> marketIds;
+    marketIds.insert(marketId);
+    update(marketIds, next);
+    publish(next);
+}
+
+void RiskEngine::setExposureLimits(const ExposureLimitsForMarketGroups& exposureLimits) {
+    static const MarketGroupType event(MarketGroupType::EVENT);
+    if (exposureLimits.getMarketGroupType() != event) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Snapshot next(*snapshot);
+    std::shared_ptr<Limits> limits = std::make_shared<Limits>(*next.limits);
+    limits->defaultLimit = getGroupLimit(exposureLimits.getDefaultLimit());
+    limits->groupLimits.clear();
+    const std::vector<MarketGroupExposureLimit>& groupLimits = exposureLimits.getGroupLimits();
+    for (auto it = groupLimits.begin(); it != groupLimits.end(); ++it) {
+        if (it->getGroupId().getEventId().isValid()) {
+            limits->groupLimits[it->getGroupId().getEventId().getValue()] = getGroupLimit(it->getLimit());
+        }
+    }
+    limits->blockedGroups.clear();
+    const std::vector<MarketGroupId>& blockedGroups = exposureLimits.getBlockedMarketGroups();
+    for (auto it = blockedGroups.begin(); it != blockedGroups.end(); ++it) {
+        if (it->getEventId().isValid()) {
+            limits->blockedGroups.insert(it->getEventId().getValue());
+        }
+    }
+    next.limits = limits;
+    publish(next);
+}
+
+void RiskEngine::apply(const ListExposureLimitsForMarketGroupsResponse& response) {
+    const std::vector<ExposureLimitsForMarketGroups>& exposureLimits =
+        response.getExposureLimitsForMarketGroupses();
+    for (auto it = exposureLimits.begin(); it != exposureLimits.end(); ++it) {
+        setExposureLimits(*it);
+    }
+}
+
+void RiskEngine::setMarketLimit(double marketLimit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Snapshot next(*snapshot);
+    std::shared_ptr<Limits> limits = std::make_shared<Limits>(*next.limits);
+    limits->marketLimit = marketLimit;
+    next.limits = limits;
+    publish(next);
+}
+
+void RiskEngine::setAccountFunds(const AccountFundsResponse& accountFunds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Snapshot next(*snapshot);
+    std::shared_ptr<Limits> limits = std::make_shared<Limits>(*next.limits);
+    limits->availableToBet = accountFunds.getAvailableToBetBalance().isValid() ?
+        accountFunds.getAvailableToBetBalance().getValue() : HUGE_VAL;
+    limits->accountLimit = getLimit(accountFunds.getExposureLimit());
+    limits->fundedExposure = next.account.total;
+    next.limits = limits;
+    publish(next);
+}
+
+double RiskEngine::reconcile(const ExchangeApi& exchangeApi) {
+    AccountFundsResponse accountFunds = exchangeApi.getAccountFunds(GetAccountFundsRequest());
+    if (!accountFunds.isSuccess()) {
+        throw std::runtime_error("getAccountFunds failed: " + accountFunds.getFaultString());
+    }
+    setAccountFunds(accountFunds);
+    return getAccountExposure() - std::fabs(getOrZero(accountFunds.getExposure()));
+}
+
+void RiskEngine::apply(const PlaceExecutionReport& placeExecutionReport) {
+    static const Side back(Side::BACK);
+    static const OrderType limit(OrderType::LIMIT);
+    static const OrderStatus executionComplete(OrderStatus::EXECUTION_COMPLETE);
+    const std::vector<PlaceInstructionReport>& reports = placeExecutionReport.getInstructionReports();
+    std::lock_guard<std::mutex> lock(mutex);
+    Orders& marketOrders = orders[placeExecutionReport.getMarketId()];
+    for (auto it = reports.begin(); it != reports.end(); ++it) {
+        const PlaceInstruction& instruction = it->getInstruction();
+        if (it->getBetId().empty() || !instruction.getSelectionId().isValid()) {
+            continue;
+        }
+        OrderExposure order;
+        order.runner = RunnerKey(instruction.getSelectionId().getValue(), getOrZero(instruction.getHandicap()) + 0.0);
+        order.back = instruction.getSide() == back;
+        order.sizeMatched = getOrZero(it->getSizeMatched());
+        double price = instruction.getOrderType() == limit ? getOrZero(instruction.getLimitOrder().getPrice()) :
+            getOrZero(instruction.getLimitOnCloseOrder().getPrice());
+        order.averagePriceMatched = it->getAveragePriceMatched().isValid() ?
+            it->getAveragePriceMatched().getValue() : price;
+        order.size = 0;
+        order.sizeCancelled = 0;
+        order.sizeLapsedOrVoided = 0;
+        order.reportedCancelled = 0;
+        if (instruction.getOrderType() == limit) {
+            order.liabilityPerUnit = order.back ? 1 : price - 1;
+            order.size = getOrZero(instruction.getLimitOrder().getSize());
+            order.unmatched = std::max(0.0, order.size - order.sizeMatched) * order.liabilityPerUnit;
+        } else {
+            order.liabilityPerUnit = 1;
+            order.unmatched = instruction.getLimitOnCloseOrder().getLiability().isValid() ?
+                instruction.getLimitOnCloseOrder().getLiability().getValue() :
+                getOrZero(instruction.getMarketOnCloseOrder().getLiability());
+        }
+        if (it->getOrderStatus() == executionComplete) {
+            order.unmatched = 0;
+        }
+        // an update from the order stream or listCurrentOrders may have got here first
+        marketOrders.insert(std::make_pair(it->getBetId(), order));
+    }
+    Snapshot next(*snapshot);
+    std::set<std::string> marketIds;
+    marketIds.insert(placeExecutionReport.getMarketId());
+    update(marketIds, next);
+    publish(next);
+}
+
+void RiskEngine::apply(const CancelExecutionReport& cancelExecutionReport) {
+    static const ExecutionReportStatus success(ExecutionReportStatus::SUCCESS);
+    const std::vector<CancelInstructionReport>& reports = cancelExecutionReport.getInstructionReports();
+    const std::string& marketId = cancelExecutionReport.getMarketId();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::set<std::string> marketIds;
+    if (reports.empty()) {
+        // every order of the market, or of every market, was cancelled
+        if (cancelExecutionReport.getStatus() != success) {
+            return;
+        }
+        for (auto market = orders.begin(); market != orders.end(); ++market) {
+            if (marketId.empty() || market->first == marketId) {
+                for (auto order = market->second.begin(); order != market->second.end(); ++order) {
+                    order->second.unmatched = 0;
+                }
+                marketIds.insert(market->first);
+            }
+        }
+    } else {
+        Orders& marketOrders = orders[marketId];
+        for (auto it = reports.begin(); it != reports.end(); ++it) {
+            auto order = marketOrders.find(it->getInstruction().getBetId());
+            if (order != marketOrders.end() && it->getSizeCancelled().isValid()) {
+                order->second.reportedCancelled += it->getSizeCancelled().getValue();
+                applyCancels(order->second);
+            }
+        }
+        marketIds.insert(marketId);
+    }
+    Snapshot next(*snapshot);
+    update(marketIds, next);
+    publish(next);
+}
+
+void RiskEngine::apply(const CurrentOrderSummary& currentOrderSummary) {
+    apply(std::vector<CurrentOrderSummary>(1, currentOrderSummary));
+}
+
+void RiskEngine::apply(const std::vector<CurrentOrderSummary>& currentOrderSummaries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::set<std::string> marketIds;
+    for (auto it = currentOrderSummaries.begin(); it != currentOrderSummaries.end(); ++it) {
+        apply(*it, marketIds);
+    }
+    Snapshot next(*snapshot);
+    update(marketIds, next);
+    publish(next);
+}
+
+void RiskEngine::apply(const CurrentOrderSummary& currentOrderSummary, std::set<std::string>& marketIds) {
+    static const Side back(Side::BACK);
+    static const OrderType limit(OrderType::LIMIT);
+    static const OrderStatus executionComplete(OrderStatus::EXECUTION_COMPLETE);
+    if (currentOrderSummary.getBetId().empty() || !currentOrderSummary.getSelectionId().isValid()) {
+        return;
+    }
+    OrderExposure order;
+    order.runner = RunnerKey(currentOrderSummary.getSelectionId().getValue(),
+        getOrZero(currentOrderSummary.getHandicap()) + 0.0);
+    order.back = currentOrderSummary.getSide() == back;
+    order.sizeMatched = getOrZero(currentOrderSummary.getSizeMatched());
+    double price = getOrZero(currentOrderSummary.getPriceSize().getPrice());
+    order.averagePriceMatched = currentOrderSummary.getAveragePriceMatched().isValid() ?
+        currentOrderSummary.getAveragePriceMatched().getValue() : price;
+    order.size = 0;
+    order.sizeCancelled = getOrZero(currentOrderSummary.getSizeCancelled());
+    order.sizeLapsedOrVoided = getOrZero(currentOrderSummary.getSizeLapsed()) +
+        getOrZero(currentOrderSummary.getSizeVoided());
+    order.reportedCancelled = 0;
+    if (currentOrderSummary.getOrderType() == limit) {
+        order.liabilityPerUnit = order.back ? 1 : price - 1;
+        order.size = getOrZero(currentOrderSummary.getPriceSize().getSize());
+        order.unmatched = getOrZero(currentOrderSummary.getSizeRemaining()) * order.liabilityPerUnit;
+    } else {
+        order.liabilityPerUnit = 1;
+        order.unmatched = order.sizeMatched > 0 ? 0 : getOrZero(currentOrderSummary.getBspLiability());
+    }
+    if (currentOrderSummary.getStatus() == executionComplete) {
+        order.unmatched = 0;
+    }
+
+    const std::string& marketId = currentOrderSummary.getMarketId();
+    Orders& marketOrders = orders[marketId];
+    auto existing = marketOrders.find(currentOrderSummary.getBetId());
+    if (existing != marketOrders.end()) {
+        // a cancel report may be ahead of the update
+        order.reportedCancelled = existing->second.reportedCancelled;
+        applyCancels(order);
+    }
+    if (order.sizeMatched > 0 || order.unmatched > 0) {
+        marketOrders[currentOrderSummary.getBetId()] = order;
+    } else {
+        marketOrders.erase(currentOrderSummary.getBetId());
+    }
+    marketIds.insert(marketId);
+}
+
+void RiskEngine::remove(const std::string& marketId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    orders.erase(marketId);
+    Snapshot next(*snapshot);
+    const MarketExposure* market = next.getMarket(marketId);
+    if (market) {
+        if (market->eventId != 0) {
+            next.addToGroup(market->eventId, -market->matched.exposure, -market->total.exposure);
+        }
+        next.account.matched -= market->matched.exposure;
+        next.account.total -= market->total.exposure;
+        next.setMarket(marketId, std::shared_ptr<const MarketExposure>());
+    }
+    publish(next);
+}
+
+void RiskEngine::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    orders.clear();
+    Snapshot next(*snapshot);
+    next.markets = std::make_shared<Markets>();
+    next.changedMarkets.clear();
+    next.groups = std::make_shared<Groups>();
+    next.changedGroups.clear();
+    next.account = Exposure();
+    std::shared_ptr<Limits> limits = std::make_shared<Limits>(*next.limits);
+    limits->fundedExposure = 0;
+    next.limits = limits;
+    publish(next);
+}
+
+void RiskEngine::update(const std::set<std::string>& marketIds, Snapshot& next) {
+    for (auto id = marketIds.begin(); id != marketIds.end(); ++id) {
+        std::shared_ptr<MarketExposure> market = std::make_shared<MarketExposure>();
+        const MarketExposure* previous = next.getMarket(*id);
+        if (previous) {
+            market->eventId = previous->eventId;
+            market->numberOfWinners = previous->numberOfWinners;
+            market->numberOfRunners = previous->numberOfRunners;
+        }
+        auto marketOrders = orders.find(*id);
+        if (marketOrders != orders.end()) {
+            for (auto it = marketOrders->second.begin(); it != marketOrders->second.end(); ++it) {
+                addOrder(market->runners[it->second.runner], it->second);
+            }
+        }
+        buildOutcomes(*market, true, market->matched);
+        buildOutcomes(*market, false, market->total);
+
+        Exposure change;
+        change.matched = market->matched.exposure;
+        change.total = market->total.exposure;
+        if (previous) {
+            change.matched -= previous->matched.exposure;
+            change.total -= previous->total.exposure;
+        }
+        if (market->eventId != 0) {
+            next.addToGroup(market->eventId, change.matched, change.total);
+        }
+        next.account.matched += change.matched;
+        next.account.total += change.total;
+        next.setMarket(*id, market);
+    }
+}
+
+void RiskEngine::applyCancels(OrderExposure& order) {
+    // the order may already reflect a cancel if an update got here first, so cancelled is the larger of what the
+    // order says and what has been reported, never the sum
+    double cancelled = std::max(order.sizeCancelled, order.reportedCancelled);
+    if (cancelled <= order.sizeCancelled) {
+        return;
+    }
+    if (order.size > 0) {
+        double unmatched = std::max(0.0, order.size - order.sizeMatched - order.sizeLapsedOrVoided);
+        cancelled = std::min(cancelled, unmatched);
+        order.unmatched = std::min(order.unmatched, (unmatched - cancelled) * order.liabilityPerUnit);
+    } else {
+        order.unmatched = std::max(0.0,
+            order.unmatched - (cancelled - order.sizeCancelled) * order.liabilityPerUnit);
+    }
+    order.sizeCancelled = cancelled;
+}
+
+void RiskEngine::addOrder(RunnerExposure& runner, const OrderExposure& order) {
+    double profit = order.sizeMatched * (order.averagePriceMatched - 1);
+    if (order.back) {
+        runner.matchedIfWin += profit;
+        runner.matchedIfLose -= order.sizeMatched;
+        runner.unmatchedBack += order.unmatched;
+    } else {
+        runner.matchedIfWin -= profit;
+        runner.matchedIfLose += order.sizeMatched;
+        runner.unmatchedLay += order.unmatched;
+    }
+}
+
+void RiskEngine::buildOutcomes(const MarketExposure& market, bool matched, Outcomes& outcomes) {
+    outcomes.loseSum = 0;
+    outcomes.worstSum = 0;
+    outcomes.differences.clear();
+    outcomes.differences.reserve(market.runners.size());
+    for (auto it = market.runners.begin(); it != market.runners.end(); ++it) {
+        double ifWin = it->second.getIfWin(matched);
+        double ifLose = it->second.getIfLose(matched);
+        outcomes.loseSum += ifLose;
+        outcomes.worstSum += std::min(ifWin, ifLose);
+        outcomes.differences.push_back(std::make_pair(ifWin - ifLose, it->first));
+    }
+    std::sort(outcomes.differences.begin(), outcomes.differences.end());
+    outcomes.exposure = getExposure(market, matched, Deltas());
+}
+
+void RiskEngine::sortDeltas(Deltas& deltas) {
+    std::sort(deltas.begin(), deltas.end(), [](const Deltas::value_type& lhs, const Deltas::value_type& rhs) {
+        return lhs.first < rhs.first;
+    });
+    // combine the changes to each runner
+    auto last = deltas.begin();
+    for (auto it = deltas.begin(); it != deltas.end(); ++it) {
+        if (it == last) {
+            continue;
+        }
+        if (it->first == last->first) {
+            last->second.matchedIfWin += it->second.matchedIfWin;
+            last->second.matchedIfLose += it->second.matchedIfLose;
+            last->second.unmatchedBack += it->second.unmatchedBack;
+            last->second.unmatchedLay += it->second.unmatchedLay;
+        } else {
+            *++last = *it;
+        }
+    }
+    if (last != deltas.end()) {
+        deltas.erase(last + 1, deltas.end());
+    }
+}
+
+double RiskEngine::getExposure(const MarketExposure& market, bool matched, const Deltas& deltas) {
+    static const RunnerExposure none;
+    const Outcomes& outcomes = matched ? market.matched : market.total;
+
+    if (market.numberOfWinners != 1) {
+        // each runner wins or loses on its own
+        double worstSum = outcomes.worstSum;
+        for (auto it = deltas.begin(); it != deltas.end(); ++it) {
+            auto runner = market.runners.find(it->first);
+            const RunnerExposure& current = runner == market.runners.end() ? none : runner->second;
+            double ifWin = current.getIfWin(matched);
+            double ifLose = current.getIfLose(matched);
+            worstSum += std::min(ifWin + it->second.getIfWin(matched), ifLose + it->second.getIfLose(matched)) -
+                std::min(ifWin, ifLose);
+        }
+        return std::max(0.0, -worstSum);
+    }
+
+    // the profit if a runner wins is its ifWin plus the others' ifLose, ie loseSum plus its difference.
+    // a runner that hasn't been bet on has a difference of 0.
+    size_t runnerCount = market.runners.size();
+    double loseSum = outcomes.loseSum;
+    double smallest = HUGE_VAL;
+    for (auto it = deltas.begin(); it != deltas.end(); ++it) {
+        auto runner = market.runners.find(it->first);
+        const RunnerExposure& current = runner == market.runners.end() ? none : runner->second;
+        if (runner == market.runners.end()) {
+            ++runnerCount;
+        }
+        double ifWin = current.getIfWin(matched) + it->second.getIfWin(matched);
+        double ifLose = current.getIfLose(matched) + it->second.getIfLose(matched);
+        loseSum += it->second.getIfLose(matched);
+        smallest = std::min(smallest, ifWin - ifLose);
+    }
+    for (auto it = outcomes.differences.begin(); it != outcomes.differences.end(); ++it) {
+        auto delta = std::lower_bound(deltas.begin(), deltas.end(), it->second,
+            [](const Deltas::value_type& lhs, const RunnerKey& rhs) { return lhs.first < rhs; });
+        if (delta == deltas.end() || delta->first != it->second) {
+            smallest = std::min(smallest, it->first);
+            break;
+        }
+    }
+    if (market.numberOfRunners <= 0 || runnerCount < static_cast<size_t>(market.numberOfRunners) ||
+        smallest == HUGE_VAL) {
+        smallest = std::min(smallest, 0.0);
+    }
+    return std::max(0.0, -(loseSum + smallest));
+}
+
+RiskEngine::GroupLimit RiskEngine::getGroupLimit(const ExposureLimit& limit) {
+    GroupLimit groupLimit;
+    groupLimit.matched = getLimit(limit.getMatched());
+    groupLimit.total = getLimit(limit.getTotal());
+    return groupLimit;
+}
+
+RiskEngine::Check RiskEngine::check(const std::string& marketId,
+        const std::vector<PlaceInstruction>& instructions) const {
+    static const Side back(Side::BACK);
+    static const OrderType limit(OrderType::LIMIT);
+    static const OrderType limitOnClose(OrderType::LIMIT_ON_CLOSE);
+    static const MarketExposure noMarket;
+    std::shared_ptr<const Snapshot> current = load();
+    const Limits& limits = *current->limits;
+    const MarketExposure* found = current->getMarket(marketId);
+    const MarketExposure& market = found ? *found : noMarket;
+
+    // the instructions as unmatched orders, and as if they were matched
+    Deltas unmatched;
+    Deltas matched;
+    unmatched.reserve(instructions.size());
+    matched.reserve(instructions.size());
+    for (auto instruction = instructions.begin(); instruction != instructions.end(); ++instruction) {
+        if (!instruction->getSelectionId().isValid()) {
+            continue;
+        }
+        RunnerKey runner(instruction->getSelectionId().getValue(), getOrZero(instruction->getHandicap()) + 0.0);
+        unmatched.push_back(std::make_pair(runner, RunnerExposure()));
+        matched.push_back(std::make_pair(runner, RunnerExposure()));
+        RunnerExposure& asUnmatched = unmatched.back().second;
+        RunnerExposure& asMatched = matched.back().second;
+
+        bool isBack = instruction->getSide() == back;
+        if (instruction->getOrderType() == limit) {
+            double size = getOrZero(instruction->getLimitOrder().getSize());
+            double profit = size * (getOrZero(instruction->getLimitOrder().getPrice()) - 1);
+            if (isBack) {
+                asUnmatched.unmatchedBack += size;
+                asMatched.matchedIfWin += profit;
+                asMatched.matchedIfLose -= size;
+            } else {
+                asUnmatched.unmatchedLay += profit;
+                asMatched.matchedIfWin -= profit;
+                asMatched.matchedIfLose += size;
+            }
+        } else {
+            // the matched price of a market on close order isn't known, so nothing is counted as won
+            bool onClose = instruction->getOrderType() == limitOnClose;
+            double liability = onClose ? getOrZero(instruction->getLimitOnCloseOrder().getLiability()) :
+                getOrZero(instruction->getMarketOnCloseOrder().getLiability());
+            double price = onClose ? getOrZero(instruction->getLimitOnCloseOrder().getPrice()) : 0;
+            if (isBack) {
+                asUnmatched.unmatchedBack += liability;
+                asMatched.matchedIfWin += price > 1 ? liability * (price - 1) : 0;
+                asMatched.matchedIfLose -= liability;
+            } else {
+                asUnmatched.unmatchedLay += liability;
+                asMatched.matchedIfWin -= liability;
+                asMatched.matchedIfLose += price > 1 ? liability / (price - 1) : 0;
+            }
+        }
+    }
+
+    sortDeltas(unmatched);
+    sortDeltas(matched);
+
+    Check result;
+    result.breach = NO_BREACH;
+    result.marketExposure = getExposure(market, false, unmatched);
+    double totalChange = result.marketExposure - market.total.exposure;
+    double matchedChange = getExposure(market, true, matched) - market.matched.exposure;
+    result.accountExposure = current->account.total + totalChange;
+    result.marketGroupExposure = 0;
+    bool increases = totalChange > TOLERANCE;
+
+    if (market.eventId != 0) {
+        Exposure group = current->getGroup(market.eventId);
+        auto groupLimit = limits.groupLimits.find(market.eventId);
+        const GroupLimit& groupLimits = groupLimit == limits.groupLimits.end() ? limits.defaultLimit :
+            groupLimit->second;
+        result.marketGroupExposure = group.total + totalChange;
+
+        if (!instructions.empty() && limits.blockedGroups.count(market.eventId) > 0) {
+            result.breach = MARKET_GROUP_BLOCKED;
+            return result;
+        }
+        if (increases && result.marketExposure > limits.marketLimit) {
+            result.breach = MARKET_LIMIT;
+            return result;
+        }
+        if (increases && result.marketGroupExposure > groupLimits.total) {
+            result.breach = MARKET_GROUP_TOTAL_LIMIT;
+            return result;
+        }
+        if (matchedChange > TOLERANCE && group.matched + matchedChange > groupLimits.matched) {
+            result.breach = MARKET_GROUP_MATCHED_LIMIT;
+            return result;
+        }
+    } else if (increases && result.marketExposure > limits.marketLimit) {
+        result.breach = MARKET_LIMIT;
+        return result;
+    }
+
+    if (increases && result.accountExposure > limits.accountLimit) {
+        result.breach = ACCOUNT_LIMIT;
+    } else if (increases && result.accountExposure - limits.fundedExposure > limits.availableToBet) {
+        result.breach = INSUFFICIENT_FUNDS;
+    }
+    return result;
+}
+
+double RiskEngine::getRunnerExposure(const std::string& marketId, int64_t selectionId, double handicap) const {
+    std::shared_ptr<const Snapshot> current = load();
+    const MarketExposure* market = current->getMarket(marketId);
+    if (!market) {
+        return 0;
+    }
+    auto runner = market->runners.find(RunnerKey(selectionId, handicap + 0.0));
+    if (runner == market->runners.end()) {
+        return 0;
+    }
+    return std::max(0.0, -std::min(runner->second.getIfWin(false), runner->second.getIfLose(false)));
+}
+
+double RiskEngine::getMarketExposure(const std::string& marketId, bool matched) const {
+    std::shared_ptr<const Snapshot> current = load();
+    const MarketExposure* market = current->getMarket(marketId);
+    if (!market) {
+        return 0;
+    }
+    return matched ? market->matched.exposure : market->total.exposure;
+}
+
+double RiskEngine::getMarketGroupExposure(int64_t eventId, bool matched) const {
+    Exposure group = load()->getGroup(eventId);
+    return std::max(0.0, matched ? group.matched : group.total);
+}
+
+double RiskEngine::getAccountExposure(bool matched) const {
+    std::shared_ptr<const Snapshot> current = load();
+    return std::max(0.0, matched ? current->account.matched : current->account.total);
+}
+
+}
+}